@@ -24,6 +24,8 @@ void Compressor::Init(float sample_rate)
     sample_rate_inv_  = 1.0f / (float)sample_rate_;
     sample_rate_inv2_ = 2.0f / (float)sample_rate_;
 
+    interval_ = 1;
+
     // Initializing the params in this order to avoid dividing by zero
 
     SetRatio(2.0f);
@@ -34,28 +36,20 @@ void Compressor::Init(float sample_rate)
 
     gain_rec_  = 0.1f;
     slope_rec_ = 0.1f;
+    gain_      = 1.0f;
 }
 
 float Compressor::Process(float in)
 {
-    float inAbs   = fabsf(in);
-    float cur_slo = ((slope_rec_ > inAbs) ? rel_slo_ : atk_slo_);
-    slope_rec_    = ((slope_rec_ * cur_slo) + ((1.0f - cur_slo) * inAbs));
-    gain_rec_     = ((atk_slo2_ * gain_rec_)
-                 + (ratio_mul_
-                    * fmax(((20.f * fastlog10f(slope_rec_)) - thresh_), 0.f)));
-    gain_         = pow10f(0.05f * (gain_rec_ + makeup_gain_));
+    Detect(in);
+    gain_ = ComputeGain(atk_slo2_, ratio_mul_);
 
     return gain_ * in;
 }
 
 void Compressor::ProcessBlock(float *in, float *out, float *key, size_t size)
 {
-    for(size_t i = 0; i < size; i++)
-    {
-        Process(key[i]);
-        out[i] = Apply(in[i]);
-    }
+    ProcessBlock(&in, &out, key, 1, size);
 }
 
 // Multi-channel block processing
@@ -65,12 +59,28 @@ void Compressor::ProcessBlock(float **in,
                               size_t  channels,
                               size_t  size)
 {
-    for(size_t i = 0; i < size; i++)
+    for(size_t start = 0; start < size; start += interval_)
     {
-        Process(key[i]);
+        const size_t end = min(start + interval_, size);
+
+        // the level is detected before the gain is applied, so the key may
+        // be one of the outputs
+        for(size_t i = start; i < end; i++)
+            Detect(key[i]);
+
+        // one gain computation per interval, ramped to from the last one
+        const float prev = gain_;
+        gain_            = ComputeGain(block_slo2_, block_ratio_mul_);
+        const float step = (gain_ - prev) / (end - start);
         for(size_t c = 0; c < channels; c++)
         {
-            out[c][i] = Apply(in[c][i]);
+            float gain = prev;
+            for(size_t i = start; i + 1 < end; i++)
+            {
+                gain += step;
+                out[c][i] = gain * in[c][i];
+            }
+            out[c][end - 1] = gain_ * in[c][end - 1];
         }
     }
 }
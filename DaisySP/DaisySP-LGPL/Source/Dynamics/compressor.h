@@ -29,11 +29,19 @@ Modifications made to do:
 - a lot less expensive
 
 by: shensley, improved upon by AvAars
+
+The block functions can compute the gain less often than every sample, see
+SetGainInterval(). The level detector still runs every sample, and the gain
+is ramped linearly in between, which saves most of the log and exp work.
+
 \todo Add soft/hard knee settings
 */
 class Compressor
 {
   public:
+    /** Longest interval between two gain computations */
+    static constexpr size_t kMaxGainInterval = 64;
+
     Compressor() {}
     ~Compressor() {}
     /** Initializes compressor
@@ -162,7 +170,41 @@ class Compressor
     */
     float GetGain() { return fastlog10f(gain_) * 20.0f; }
 
+    /** Sets the number of samples between two gain computations in the
+        block functions, 1 (the default) computes it every sample like
+        Process(). The block size should be a multiple of the interval.
+        \param interval 1 -> kMaxGainInterval
+    */
+    void SetGainInterval(size_t interval)
+    {
+        interval_ = interval < 1 ? 1 : interval;
+        interval_ = interval_ > kMaxGainInterval ? kMaxGainInterval : interval_;
+        RecalculateAttack();
+    }
+
+    /** Gets the number of samples between two gain computations */
+    size_t GetGainInterval() { return interval_; }
+
   private:
+    // Runs the level detector for one sample of the key signal
+    void Detect(float key)
+    {
+        float inAbs   = fabsf(key);
+        float cur_slo = ((slope_rec_ > inAbs) ? rel_slo_ : atk_slo_);
+        slope_rec_    = ((slope_rec_ * cur_slo) + ((1.0f - cur_slo) * inAbs));
+    }
+
+    // Updates the smoothed gain reduction from the detected level, and
+    // returns the resulting linear gain
+    float ComputeGain(float slo2, float ratio_mul)
+    {
+        gain_rec_ = ((slo2 * gain_rec_)
+                     + (ratio_mul
+                        * fmax(((20.f * fastlog10f(slope_rec_)) - thresh_),
+                               0.f)));
+        return pow10f(0.05f * (gain_rec_ + makeup_gain_));
+    }
+
     float ratio_, thresh_, atk_, rel_;
     float makeup_gain_;
     float gain_;
@@ -173,6 +215,10 @@ class Compressor
     // Internals from faust
     float atk_slo2_, ratio_mul_, atk_slo_, rel_slo_;
 
+    // The gain smoothing coefficients for one gain interval
+    float block_slo2_, block_ratio_mul_;
+    size_t interval_;
+
     int   sample_rate_;
     float sample_rate_inv2_, sample_rate_inv_;
 
@@ -182,7 +228,8 @@ class Compressor
     // Methods for recalculating internals
     void RecalculateRatio()
     {
-        ratio_mul_ = ((1.0f - atk_slo2_) * ((1.0f / ratio_) - 1.0f));
+        ratio_mul_       = ((1.0f - atk_slo2_) * ((1.0f / ratio_) - 1.0f));
+        block_ratio_mul_ = ((1.0f - block_slo2_) * ((1.0f / ratio_) - 1.0f));
     }
 
     void RecalculateAttack()
@@ -190,6 +237,9 @@ class Compressor
         atk_slo_  = expf(-(sample_rate_inv_ / atk_));
         atk_slo2_ = expf(-(sample_rate_inv2_ / atk_));
 
+        // the smoothing of `interval_` samples with a constant level
+        block_slo2_ = expf(-(interval_ * sample_rate_inv2_ / atk_));
+
         RecalculateRatio();
     }
 
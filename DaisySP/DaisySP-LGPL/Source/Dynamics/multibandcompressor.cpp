@@ -0,0 +1,159 @@
+// # multibandcompressor
+//
+// Crossover bands, each with its own compressor
+//
+
+#include <cmath>
+#include <stdlib.h>
+#include <stdint.h>
+#include "multibandcompressor.h"
+
+using namespace daisysp;
+
+void MultibandCompressor::Init(float  sample_rate,
+                               size_t num_bands,
+                               size_t num_channels)
+{
+    num_channels_ = num_channels < 1 ? 1 : num_channels;
+    num_channels_ = num_channels_ > kMaxChannels ? kMaxChannels : num_channels_;
+
+    for(size_t c = 0; c < kMaxChannels; c++)
+        xover_[c].Init(sample_rate, num_bands);
+    num_bands_ = xover_[0].GetNumBands();
+
+    for(size_t b = 0; b < kMaxBands; b++)
+    {
+        for(size_t c = 0; c < kMaxChannels; c++)
+        {
+            comp_[b][c].Init(sample_rate);
+            comp_[b][c].AutoMakeup(false);
+            comp_[b][c].SetGainInterval(16);
+        }
+    }
+    link_ = 1.0f;
+}
+
+void MultibandCompressor::SetCrossoverFreq(size_t index, float freq)
+{
+    for(size_t c = 0; c < kMaxChannels; c++)
+        xover_[c].SetFreq(index, freq);
+}
+
+void MultibandCompressor::SetThreshold(size_t band, float threshold)
+{
+    if(band < kMaxBands)
+        for(size_t c = 0; c < kMaxChannels; c++)
+            comp_[band][c].SetThreshold(threshold);
+}
+
+void MultibandCompressor::SetRatio(size_t band, float ratio)
+{
+    if(band < kMaxBands)
+        for(size_t c = 0; c < kMaxChannels; c++)
+            comp_[band][c].SetRatio(ratio);
+}
+
+void MultibandCompressor::SetAttack(size_t band, float attack)
+{
+    if(band < kMaxBands)
+        for(size_t c = 0; c < kMaxChannels; c++)
+            comp_[band][c].SetAttack(attack);
+}
+
+void MultibandCompressor::SetRelease(size_t band, float release)
+{
+    if(band < kMaxBands)
+        for(size_t c = 0; c < kMaxChannels; c++)
+            comp_[band][c].SetRelease(release);
+}
+
+void MultibandCompressor::SetMakeup(size_t band, float gain)
+{
+    if(band < kMaxBands)
+        for(size_t c = 0; c < kMaxChannels; c++)
+            comp_[band][c].SetMakeup(gain);
+}
+
+void MultibandCompressor::SetStereoLink(float link)
+{
+    link_ = fclamp(link, 0.0f, 1.0f);
+}
+
+void MultibandCompressor::SetGainInterval(size_t interval)
+{
+    for(size_t b = 0; b < kMaxBands; b++)
+        for(size_t c = 0; c < kMaxChannels; c++)
+            comp_[b][c].SetGainInterval(interval);
+}
+
+float MultibandCompressor::GetGain(size_t band)
+{
+    if(band >= num_bands_)
+        return 0.0f;
+    float gain = comp_[band][0].GetGain();
+    for(size_t c = 1; c < num_channels_; c++)
+        gain = fmin(gain, comp_[band][c].GetGain());
+    return gain;
+}
+
+void MultibandCompressor::ProcessBlock(float **in, float **out, size_t size)
+{
+    float *in_chunk[kMaxChannels], *out_chunk[kMaxChannels];
+    for(size_t offset = 0; offset < size; offset += kMaxBlockSize)
+    {
+        const size_t n = size - offset < kMaxBlockSize ? size - offset
+                                                       : kMaxBlockSize;
+        for(size_t c = 0; c < num_channels_; c++)
+        {
+            in_chunk[c]  = in[c] + offset;
+            out_chunk[c] = out[c] + offset;
+        }
+        ProcessChunk(in_chunk, out_chunk, n);
+    }
+}
+
+void MultibandCompressor::ProcessChunk(float **in, float **out, size_t size)
+{
+    for(size_t c = 0; c < num_channels_; c++)
+    {
+        float *bands[kMaxBands];
+        for(size_t b = 0; b < num_bands_; b++)
+            bands[b] = bands_[c][b];
+        xover_[c].Process(in[c], bands, size);
+    }
+
+    for(size_t b = 0; b < num_bands_; b++)
+    {
+        if(num_channels_ == 1)
+        {
+            comp_[b][0].ProcessBlock(bands_[0][b], bands_[0][b], size);
+            continue;
+        }
+
+        // each channel is keyed by its own level, moved towards the level
+        // of the louder channel by the link amount
+        const float *left = bands_[0][b], *right = bands_[1][b];
+        for(size_t i = 0; i < size; i++)
+        {
+            const float l    = fabsf(left[i]);
+            const float r    = fabsf(right[i]);
+            const float loud = fmax(l, r);
+            key_[0][i]       = l + link_ * (loud - l);
+            key_[1][i]       = r + link_ * (loud - r);
+        }
+        for(size_t c = 0; c < num_channels_; c++)
+            comp_[b][c].ProcessBlock(
+                bands_[c][b], bands_[c][b], key_[c], size);
+    }
+
+    for(size_t c = 0; c < num_channels_; c++)
+    {
+        for(size_t i = 0; i < size; i++)
+        {
+            float sum = 0.0f;
+            for(size_t b = 0; b < num_bands_; b++)
+                sum += bands_[c][b][i];
+            out[c][i] = sum;
+        }
+    }
+}
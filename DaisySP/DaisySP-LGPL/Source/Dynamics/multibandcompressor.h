@@ -0,0 +1,124 @@
+/*
+Copyright (c) 2023 Electrosmith, Corp
+
+Use of this source code is governed by the LGPL V2.1
+license that can be found in the LICENSE file or at
+https://opensource.org/license/lgpl-2-1/
+*/
+
+#pragma once
+#ifndef DSY_MULTIBANDCOMPRESSOR_H
+#define DSY_MULTIBANDCOMPRESSOR_H
+
+#include "Dynamics/compressor.h"
+#include "Filters/crossover.h"
+
+namespace daisysp
+{
+/** multiband dynamics compressor
+
+Splits each channel into 2 to 4 bands with a Linkwitz-Riley Crossover,
+compresses every band with its own Compressor, and sums the bands again.
+The crossover bands sum to an allpass, so with no gain reduction the output
+has the same magnitude response as the input.
+
+The band compressors use the block functions of Compressor, with a gain
+interval of 16 samples by default, see SetGainInterval().
+
+With stereo linking, each channel of a band is keyed by a mix of its own
+level and the louder of the two channels. Fully linked (the default), both
+channels get the same gain, which keeps the stereo image in place.
+
+Usage:
+\code
+    mbc.Init(sample_rate, 3, 2);
+    mbc.SetCrossoverFreq(0, 200.0f);
+    mbc.SetCrossoverFreq(1, 3000.0f);
+    mbc.SetThreshold(0, -18.0f);
+    mbc.SetRatio(0, 4.0f);
+    ...
+    mbc.ProcessBlock(in, out, size);
+\endcode
+*/
+class MultibandCompressor
+{
+  public:
+    static constexpr size_t kMaxBands    = Crossover::kMaxBands;
+    static constexpr size_t kMaxChannels = 2;
+
+    /** Largest block processed at once, longer blocks are split */
+    static constexpr size_t kMaxBlockSize = Crossover::kMaxBlockSize;
+
+    MultibandCompressor() {}
+    ~MultibandCompressor() {}
+
+    /** Initializes the crossovers and band compressors
+        \param sample_rate rate at which samples will be produced by the audio engine.
+        \param num_bands number of bands, 2 -> kMaxBands
+        \param num_channels 1 or 2
+    */
+    void Init(float sample_rate, size_t num_bands = 3, size_t num_channels = 2);
+
+    /** Compresses a block of audio
+        \param in audio input signals, one per channel
+        \param out audio output signals, may be the same as the inputs
+        \param size the size of the block
+    */
+    void ProcessBlock(float **in, float **out, size_t size);
+
+    /** Sets the frequency of a split between two bands
+        \param index 0 -> number of bands - 2, from the lowest split up
+        \param freq frequency in Hz
+    */
+    void SetCrossoverFreq(size_t index, float freq);
+
+    /** Sets the threshold of a band in dB, see Compressor::SetThreshold() */
+    void SetThreshold(size_t band, float threshold);
+
+    /** Sets the ratio of a band, see Compressor::SetRatio() */
+    void SetRatio(size_t band, float ratio);
+
+    /** Sets the attack time of a band, see Compressor::SetAttack() */
+    void SetAttack(size_t band, float attack);
+
+    /** Sets the release time of a band, see Compressor::SetRelease() */
+    void SetRelease(size_t band, float release);
+
+    /** Sets the makeup gain of a band in dB, 0 by default */
+    void SetMakeup(size_t band, float gain);
+
+    /** Sets how much the channels share their gain
+        \param link 0 (independent) -> 1 (fully linked, the default)
+    */
+    void SetStereoLink(float link);
+
+    /** Sets the number of samples between two gain computations of the
+        band compressors, see Compressor::SetGainInterval()
+    */
+    void SetGainInterval(size_t interval);
+
+    /** Gets the gain reduction of a band in dB, of the most reduced channel */
+    float GetGain(size_t band);
+
+    /** Gets the compressor of a band and channel, e.g. for its getters */
+    Compressor &GetCompressor(size_t band, size_t channel)
+    {
+        return comp_[band][channel];
+    }
+
+  private:
+    void ProcessChunk(float **in, float **out, size_t size);
+
+    size_t num_bands_, num_channels_;
+    float  link_;
+
+    Crossover  xover_[kMaxChannels];
+    Compressor comp_[kMaxBands][kMaxChannels];
+
+    float bands_[kMaxChannels][kMaxBands][kMaxBlockSize];
+    float key_[kMaxChannels][kMaxBlockSize];
+};
+
+} // namespace daisysp
+
+#endif // DSY_MULTIBANDCOMPRESSOR_H
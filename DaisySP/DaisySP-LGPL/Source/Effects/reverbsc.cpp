@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include <string.h>
 #include "reverbsc.h"
+#include "dsp.h"
 
 #define REVSC_OK 0
 #define REVSC_NOT_OK 1
@@ -41,6 +42,7 @@ static int DelayLineMaxSamples(float sr, float i_pitch_mod, int n);
 static int         DelayLineBytesAlloc(float sr, float i_pitch_mod, int n);
 static const float kOutputGain = 0.35;
 static const float kJpScale    = 0.25;
+static const int   kClearChunk = 64; /* samples cleared per Process call */
 
 int ReverbSc::Init(float sr)
 {
@@ -53,7 +55,9 @@ int ReverbSc::Init(float sr)
     damp_fact_     = 1.0;
     prv_lpfreq_    = 0.0;
     init_done_     = 1;
-    int i, n_bytes = 0;
+    clear_line_    = 0;
+    clear_pos_     = 0;
+    int i, n_bytes = 0, longest = 0;
     n_bytes = 0;
     for(i = 0; i < 8; i++)
     {
@@ -62,7 +66,11 @@ int ReverbSc::Init(float sr)
         delay_lines_[i].buf = (aux_) + n_bytes;
         InitDelayLine(&delay_lines_[i], i);
         n_bytes += DelayLineBytesAlloc(sr, 1, i);
+        if(delay_lines_[i].buffer_size > longest)
+            longest = delay_lines_[i].buffer_size;
     }
+    /* the tail is quiet once the longest line only holds quiet samples */
+    silence_.Init(longest);
     return 0;
 }
 
@@ -130,13 +138,29 @@ int ReverbSc::InitDelayLine(ReverbScDl *lp, int n)
     lp->read_pos_frac = (int)(read_pos + 0.5);
     /* initialise first random line segment */
     NextRandomLineseg(lp, n);
-    /* clear delay line to zero */
+    /* the delay line is cleared later by ClearStep */
     lp->filter_state = 0.0;
-    for(int i = 0; i < lp->buffer_size; i++)
+    return REVSC_OK;
+}
+
+void ReverbSc::ClearStep()
+{
+    int remaining = kClearChunk;
+    while(remaining > 0 && clear_line_ < 8)
     {
-        lp->buf[i] = 0;
+        ReverbScDl *lp = &delay_lines_[clear_line_];
+        int         n  = lp->buffer_size - clear_pos_;
+        if(n > remaining)
+            n = remaining;
+        memset(lp->buf + clear_pos_, 0, n * sizeof(float));
+        clear_pos_ += n;
+        remaining -= n;
+        if(clear_pos_ >= lp->buffer_size)
+        {
+            clear_line_++;
+            clear_pos_ = 0;
+        }
     }
-    return REVSC_OK;
 }
 
 int ReverbSc::Process(const float &in1,
@@ -156,6 +180,14 @@ int ReverbSc::Process(const float &in1,
     if(init_done_ <= 0)
         return REVSC_NOT_OK;
 
+    if(!IsReady())
+    {
+        ClearStep();
+        *out1 = 0.0f;
+        *out2 = 0.0f;
+        return REVSC_OK;
+    }
+
     /* calculate tone filter coefficient if frequency changed */
     if(lpfreq_ != prv_lpfreq_)
     {
@@ -186,8 +218,8 @@ int ReverbSc::Process(const float &in1,
 
         /* send input signal and feedback to delay line */
 
-        lp->buf[lp->write_pos]
-            = (float)((n & 1 ? a_in_r : a_in_l) - lp->filter_state);
+        lp->buf[lp->write_pos] = flush_denormal(
+            (float)((n & 1 ? a_in_r : a_in_l) - lp->filter_state));
         if(++lp->write_pos >= buffer_size)
         {
             lp->write_pos -= buffer_size;
@@ -255,7 +287,7 @@ int ReverbSc::Process(const float &in1,
 
         v0 *= (float)feedback_;
         v0               = (lp->filter_state - v0) * damp_fact + v0;
-        lp->filter_state = v0;
+        lp->filter_state = flush_denormal(v0);
 
         /* mix to output */
 
@@ -281,3 +313,33 @@ int ReverbSc::Process(const float &in1,
     *out2 = a_out_r * kOutputGain;
     return REVSC_OK;
 }
+
+bool ReverbSc::ProcessBlock(const float *in1,
+                            const float *in2,
+                            float *      out1,
+                            float *      out2,
+                            size_t       size)
+{
+    const bool in_silent
+        = IsSilentBlock(in1, size) && IsSilentBlock(in2, size);
+    if(in_silent && silence_.IsAsleep())
+    {
+        ClearBlock(out1, size);
+        ClearBlock(out2, size);
+        return true;
+    }
+    for(size_t i = 0; i < size; i++)
+    {
+        const float l = in1[i], r = in2[i];
+        Process(l, r, &out1[i], &out2[i]);
+    }
+
+    /* the outputs are sums of the lines, which could cancel, so the
+       feedback into each line is checked too */
+    bool quiet = in_silent && IsReady() && IsSilentBlock(out1, size)
+                 && IsSilentBlock(out2, size);
+    for(int n = 0; quiet && n < 8; n++)
+        quiet = fabsf(delay_lines_[n].filter_state) <= kSilenceThreshold;
+    silence_.Update(quiet, size);
+    return false;
+}
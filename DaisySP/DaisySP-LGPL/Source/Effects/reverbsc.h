@@ -10,6 +10,9 @@ https://opensource.org/license/lgpl-2-1/
 #ifndef DSYSP_REVERBSC_H
 #define DSYSP_REVERBSC_H
 
+#include <stddef.h>
+#include "Utility/silence.h"
+
 #define DSY_REVERBSC_MAX_SIZE 98936
 
 namespace daisysp
@@ -38,6 +41,10 @@ class ReverbSc
     ~ReverbSc() {}
     /** Initializes the reverb module, and sets the sample_rate at which the Process function will be called.
         Returns 0 if all good, or 1 if it runs out of delay times exceed maximum allowed.
+
+        The delay lines are not cleared here, so Init returns immediately.
+        Instead, each call to Process clears a small part of them and outputs
+        silence until IsReady() returns true, about 8 ms at 48kHz.
     */
     int Init(float sample_rate);
 
@@ -45,6 +52,21 @@ class ReverbSc
     */
     int Process(const float &in1, const float &in2, float *out1, float *out2);
 
+    /** Processes a block of both channels. Once the inputs and the tail
+        have been below kSilenceThreshold for the length of the longest
+        delay line, silent input blocks aren't processed until the input
+        returns.
+        \param in1, in2 input blocks
+        \param out1, out2 output blocks, may be the same as the inputs
+        \param size number of samples
+        \return true if the output blocks are all zeros
+    */
+    bool ProcessBlock(const float *in1,
+                      const float *in2,
+                      float *      out1,
+                      float *      out2,
+                      size_t       size);
+
     /** controls the reverb time. reverb tail becomes infinite when set to 1.0
         \param fb - sets reverb time. range: 0.0 to 1.0
     */
@@ -54,17 +76,25 @@ class ReverbSc
     */
     inline void SetLpFreq(const float &freq) { lpfreq_ = freq; }
 
+    /** Returns true once the delay lines are cleared and the reverb
+        processes audio.
+    */
+    inline bool IsReady() const { return clear_line_ >= 8; }
+
   private:
-    void       NextRandomLineseg(ReverbScDl *lp, int n);
-    int        InitDelayLine(ReverbScDl *lp, int n);
-    float      feedback_, lpfreq_;
-    float      i_sample_rate_, i_pitch_mod_, i_skip_init_;
-    float      sample_rate_;
-    float      damp_fact_;
-    float      prv_lpfreq_;
-    int        init_done_;
-    ReverbScDl delay_lines_[8];
-    float      aux_[DSY_REVERBSC_MAX_SIZE];
+    void           NextRandomLineseg(ReverbScDl *lp, int n);
+    int            InitDelayLine(ReverbScDl *lp, int n);
+    void           ClearStep();
+    float          feedback_, lpfreq_;
+    float          i_sample_rate_, i_pitch_mod_, i_skip_init_;
+    float          sample_rate_;
+    float          damp_fact_;
+    float          prv_lpfreq_;
+    int            init_done_;
+    int            clear_line_, clear_pos_;
+    SilenceTracker silence_;
+    ReverbScDl     delay_lines_[8];
+    float          aux_[DSY_REVERBSC_MAX_SIZE];
 };
 
 
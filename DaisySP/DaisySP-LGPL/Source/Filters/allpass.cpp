@@ -1,5 +1,6 @@
 #include "allpass.h"
 #include <math.h>
+#include "dsp.h"
 
 using namespace daisysp;
 
@@ -26,7 +27,7 @@ float Allpass::Process(float in)
     }
 
     y              = buf_[buf_pos_];
-    z              = coef_ * y + in;
+    z              = flush_denormal(coef_ * y + in);
     buf_[buf_pos_] = z;
     out            = y - coef_ * z;
 
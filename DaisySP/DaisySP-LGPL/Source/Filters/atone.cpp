@@ -17,7 +17,7 @@ float ATone::Process(float &in)
     float out;
 
     out      = c2_ * (prevout_ + in);
-    prevout_ = out - in;
+    prevout_ = flush_denormal(out - in);
 
     return out;
 }
@@ -1,5 +1,6 @@
 #include "comb.h"
 #include <math.h>
+#include "dsp.h"
 
 using namespace daisysp;
 
@@ -41,7 +42,7 @@ float Comb::Process(float in)
 
     // internal delay line
     outsamp                = buf_[(buf_pos_ + mod_) % max_size_];
-    tmp                    = (outsamp * coef) + in;
+    tmp                    = flush_denormal((outsamp * coef) + in);
     buf_[(size_t)buf_pos_] = tmp;
     buf_pos_               = (buf_pos_ - 1 + max_size_) % max_size_;
 
@@ -98,5 +98,10 @@ float MoogLadder::Process(float in)
         delay[5] = (stg[3] + delay[4]) * 0.5f;
         delay[4] = stg[3];
     }
+    // keep the decaying stages out of the subnormal range
+    for(int k = 0; k < 6; k++)
+    {
+        delay[k] = flush_denormal(delay[k]);
+    }
     return delay[5];
 }
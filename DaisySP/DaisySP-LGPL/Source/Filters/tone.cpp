@@ -18,7 +18,7 @@ float Tone::Process(float in)
     float out;
 
     out      = c1_ * in + c2_ * prevout_;
-    prevout_ = out;
+    prevout_ = flush_denormal(out);
 
     return out;
 }
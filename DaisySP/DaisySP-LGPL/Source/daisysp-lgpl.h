@@ -8,6 +8,7 @@
 /** Dynamics Modules */
 #include "Dynamics/balance.h"
 #include "Dynamics/compressor.h"
+#include "Dynamics/multibandcompressor.h"
 
 /** Effects Modules */
 #include "Effects/bitcrush.h"
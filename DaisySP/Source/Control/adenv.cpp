@@ -63,6 +63,12 @@ void AdEnv::Init(float sample_rate)
     }
 }
 
+void AdEnv::SetSampleRate(float sample_rate)
+{
+    phase_       = (uint32_t)(phase_ * (sample_rate / sample_rate_));
+    sample_rate_ = sample_rate;
+}
+
 float AdEnv::Process()
 {
     uint32_t time_samps;
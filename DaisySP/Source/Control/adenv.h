@@ -82,6 +82,11 @@ class AdEnv
         in.
     */
     inline uint8_t GetCurrentSegment() { return current_segment_; }
+    /** Changes the sample rate, keeping the position within the current
+        segment.
+    */
+    void SetSampleRate(float sample_rate);
+
     /** Returns true if the envelope is currently in any stage apart from idle.
     */
     inline bool IsRunning() const { return current_segment_ != ADENV_SEG_IDLE; }
@@ -1,11 +1,13 @@
 #include "adsr.h"
 #include <math.h>
+#include <string.h>
 
 using namespace daisysp;
 
 
 void Adsr::Init(float sample_rate, int blockSize)
 {
+    block_size_   = blockSize;
     sample_rate_  = sample_rate / blockSize;
     attackShape_  = -1.f;
     attackTarget_ = 0.0f;
@@ -76,6 +78,21 @@ void Adsr::SetReleaseTime(float timeInS)
 }
 
 
+void Adsr::SetSampleRate(float sample_rate)
+{
+    const float attack  = attackTime_;
+    const float decay   = decayTime_;
+    const float release = releaseTime_;
+    sample_rate_        = sample_rate / block_size_;
+    // invalidate the cached times so the coefficients are recalculated
+    attackTime_  = -1.f;
+    decayTime_   = -1.f;
+    releaseTime_ = -1.f;
+    SetAttackTime(attack, attackShape_);
+    SetDecayTime(decay);
+    SetReleaseTime(release);
+}
+
 void Adsr::SetTimeConstant(float timeInS, float& time, float& coeff)
 {
     if(timeInS != time)
@@ -134,3 +151,17 @@ float Adsr::Process(bool gate)
     }
     return out;
 }
+
+bool Adsr::ProcessBlock(float* out, size_t size, bool gate)
+{
+    // an idle envelope stays at zero until the gate rises
+    if(mode_ == ADSR_SEG_IDLE && !gate)
+    {
+        gate_ = false;
+        memset(out, 0, size * sizeof(float));
+        return true;
+    }
+    for(size_t i = 0; i < size; i++)
+        out[i] = Process(gate);
+    return false;
+}
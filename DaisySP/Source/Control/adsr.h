@@ -11,6 +11,7 @@ https://opensource.org/licenses/MIT.
 #define DSY_ADSR_H
 
 #include <stdint.h>
+#include <stddef.h>
 #ifdef __cplusplus
 
 namespace daisysp
@@ -56,6 +57,14 @@ class Adsr
         \param gate - trigger the envelope, hold it to sustain 
     */
     float Process(bool gate);
+    /** Processes a block of samples with the gate held for the whole block.
+        Only for an envelope initialized with a block size of 1.
+        \param out envelope output
+        \param size number of samples
+        \param gate - trigger the envelope, hold it to sustain
+        \return true if the envelope is idle and the block is all zeros
+    */
+    bool ProcessBlock(float* out, size_t size, bool gate);
     /** Sets time
         Set time per segment in seconds
     */
@@ -64,6 +73,12 @@ class Adsr
     void SetDecayTime(float timeInS);
     void SetReleaseTime(float timeInS);
 
+    /** Changes the sample rate, keeping the current segment and level, and
+        recalculates the segment coefficients. Uses the block size passed
+        to Init.
+    */
+    void SetSampleRate(float sample_rate);
+
   private:
     void SetTimeConstant(float timeInS, float& time, float& coeff);
 
@@ -98,6 +113,7 @@ class Adsr
     float   decayD0_{0.f};
     float   releaseD0_{0.f};
     int     sample_rate_;
+    int     block_size_{1};
     uint8_t mode_{ADSR_SEG_IDLE};
     bool    gate_{false};
 };
@@ -48,6 +48,13 @@ class Phasor
     /** Initialize phasor with samplerate
     */
     inline void Init(float sample_rate) { Init(sample_rate, 1.0f, 0.0f); }
+    /** Changes the sample rate without resetting the phase */
+    inline void SetSampleRate(float sample_rate)
+    {
+        sample_rate_ = sample_rate;
+        SetFreq(freq_);
+    }
+
     /** processes Phasor and returns current value
     */
     float Process();
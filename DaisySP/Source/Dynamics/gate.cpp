@@ -0,0 +1,300 @@
+#include "gate.h"
+#include "Utility/dsp.h"
+#include "Utility/lut.h"
+#include <math.h>
+#include <string.h>
+
+using namespace daisysp;
+
+namespace
+{
+// below this gain a closing gate snaps to silence, -120 dB
+constexpr float kSilentGain = 1.0e-6f;
+
+// 20 * log10(2) and 10 * log10(2), dB per octave of amplitude and power
+constexpr float kDbPerLog2Amplitude = 6.0205999f;
+constexpr float kDbPerLog2Power     = 3.0103f;
+
+inline float TimeToCoeff(float seconds, float sample_rate)
+{
+    return seconds > 0.0f ? 1.0f - expf(-1.0f / (seconds * sample_rate))
+                          : 1.0f;
+}
+} // namespace
+
+void Gate::Init(float* buffer,
+                float  sample_rate,
+                size_t num_channels,
+                size_t max_lookahead,
+                size_t window)
+{
+    sample_rate_   = sample_rate;
+    num_channels_  = num_channels < 1 ? 1 : num_channels;
+    num_channels_  = num_channels_ > kMaxChannels ? kMaxChannels : num_channels_;
+    max_lookahead_ = max_lookahead;
+    window_        = window < 1 ? 1 : window;
+
+    delay_  = buffer;
+    ring_   = delay_ + num_channels_ * max_lookahead_;
+    suffix_ = ring_ + window_;
+    memset(delay_, 0, num_channels_ * max_lookahead_ * sizeof(float));
+    lookahead_ = 0;
+    delay_pos_ = 0;
+
+    for(size_t c = 0; c < kMaxChannels; c++)
+    {
+        highpass_[c].Init();
+        highpass_[c].SetFilterMode(OnePole::FILTER_MODE_HIGH_PASS);
+        lowpass_[c].Init();
+        lowpass_[c].SetFilterMode(OnePole::FILTER_MODE_LOW_PASS);
+    }
+    SetSidechainFilter(0.0f, sample_rate_ * 0.5f);
+
+    threshold_db_  = -50.0f;
+    hysteresis_db_ = 6.0f;
+    range_db_      = kLutDbMin;
+    ratio_         = 0.0f;
+    SetDetector(Detector::PEAK);
+    SetHold(0.05f);
+    SetAttack(0.001f);
+    SetRelease(0.1f);
+
+    hold_count_ = 0;
+    gain_       = floor_gain_;
+    open_       = false;
+    silent_     = false;
+}
+
+void Gate::SetThreshold(float db)
+{
+    threshold_db_ = db;
+    UpdateThresholds();
+}
+
+void Gate::SetHysteresis(float db)
+{
+    hysteresis_db_ = fmax(db, 0.0f);
+    UpdateThresholds();
+}
+
+void Gate::SetHold(float seconds)
+{
+    hold_samples_ = static_cast<size_t>(fmax(seconds, 0.0f) * sample_rate_);
+}
+
+void Gate::SetAttack(float seconds)
+{
+    attack_coeff_ = TimeToCoeff(seconds, sample_rate_);
+}
+
+void Gate::SetRelease(float seconds)
+{
+    release_coeff_ = TimeToCoeff(seconds, sample_rate_);
+}
+
+void Gate::SetRange(float db)
+{
+    range_db_ = fmin(db, 0.0f);
+    UpdateThresholds();
+}
+
+void Gate::SetRatio(float ratio)
+{
+    ratio_ = fmax(ratio, 0.0f);
+}
+
+void Gate::SetLookahead(size_t samples)
+{
+    samples = samples > max_lookahead_ ? max_lookahead_ : samples;
+    if(samples == lookahead_)
+        return;
+    // the delay lines are restarted at the new length
+    lookahead_ = samples;
+    delay_pos_ = 0;
+    memset(delay_, 0, num_channels_ * max_lookahead_ * sizeof(float));
+}
+
+void Gate::SetDetector(Detector detector)
+{
+    // the window holds rectified or squared samples depending on the
+    // detector, so it starts over
+    detector_ = detector;
+    memset(ring_, 0, window_ * sizeof(float));
+    memset(suffix_, 0, window_ * sizeof(float));
+    ring_pos_   = 0;
+    sum_        = 0.0f;
+    fresh_sum_  = 0.0f;
+    prefix_max_ = 0.0f;
+    UpdateThresholds();
+}
+
+void Gate::SetSidechainFilter(float low, float high)
+{
+    const float nyquist = sample_rate_ * 0.5f;
+    filter_             = low > 0.0f || high < nyquist;
+    for(size_t c = 0; c < kMaxChannels; c++)
+    {
+        highpass_[c].SetFrequency(fmax(low, 0.0f) / sample_rate_);
+        lowpass_[c].SetFrequency(fmin(high, nyquist) / sample_rate_);
+    }
+}
+
+void Gate::UpdateThresholds()
+{
+    const float open  = pow10f(threshold_db_ * 0.05f);
+    const float close = pow10f((threshold_db_ - hysteresis_db_) * 0.05f);
+    if(detector_ == Detector::RMS)
+    {
+        // compared to the sum of squares over the window
+        open_level_  = open * open * window_;
+        close_level_ = close * close * window_;
+    }
+    else
+    {
+        open_level_  = open;
+        close_level_ = close;
+    }
+    floor_gain_ = lut_db_to_gain(range_db_);
+}
+
+float Gate::Detect(float key)
+{
+    const float old  = ring_[ring_pos_];
+    ring_[ring_pos_] = key;
+
+    float level;
+    if(detector_ == Detector::RMS)
+    {
+        sum_ += key - old;
+        fresh_sum_ += key;
+        level = fmax(sum_, 0.0f);
+    }
+    else
+    {
+        // the window is the samples since the ring last wrapped, and the
+        // older ones after the write position, whose maxima were taken
+        // when it wrapped
+        prefix_max_ = fmax(prefix_max_, key);
+        level       = ring_pos_ + 1 < window_
+                          ? fmax(prefix_max_, suffix_[ring_pos_ + 1])
+                          : prefix_max_;
+    }
+
+    if(++ring_pos_ >= window_)
+    {
+        ring_pos_ = 0;
+        if(detector_ == Detector::RMS)
+        {
+            // the sum of the ring is restarted from the exact sum of the
+            // last window, so rounding errors do not build up
+            sum_       = fresh_sum_;
+            fresh_sum_ = 0.0f;
+        }
+        else
+        {
+            suffix_[window_ - 1] = ring_[window_ - 1];
+            for(size_t i = window_ - 1; i-- > 0;)
+                suffix_[i] = fmax(ring_[i], suffix_[i + 1]);
+            prefix_max_ = 0.0f;
+        }
+    }
+    return level;
+}
+
+bool Gate::ProcessBlock(const float* const* in, float** out, size_t size)
+{
+    return Run<false>(in, out, nullptr, size);
+}
+
+bool Gate::ProcessBlock(const float* const* in,
+                        float**             out,
+                        const float*        key,
+                        size_t              size)
+{
+    return Run<true>(in, out, key, size);
+}
+
+template <bool external>
+bool Gate::Run(const float* const* in,
+               float**             out,
+               const float*        key,
+               size_t              size)
+{
+    const bool rms    = detector_ == Detector::RMS;
+    bool       silent = true;
+    for(size_t n = 0; n < size; n++)
+    {
+        // the key is the loudest channel, or the external key
+        float k = 0.0f;
+        if(external)
+        {
+            float x = key[n];
+            if(filter_)
+                x = lowpass_[0].Process(highpass_[0].Process(x));
+            k = rms ? x * x : fabsf(x);
+        }
+        else
+        {
+            for(size_t c = 0; c < num_channels_; c++)
+            {
+                float x = in[c][n];
+                if(filter_)
+                    x = lowpass_[c].Process(highpass_[c].Process(x));
+                k = fmax(k, rms ? x * x : fabsf(x));
+            }
+        }
+        const float level = Detect(k);
+
+        if(level >= open_level_)
+        {
+            open_       = true;
+            hold_count_ = hold_samples_;
+        }
+        else if(level < close_level_)
+        {
+            if(hold_count_ > 0)
+                hold_count_--;
+            else
+                open_ = false;
+        }
+
+        float target = 1.0f;
+        if(!open_)
+        {
+            target = floor_gain_;
+            if(ratio_ > 1.0f && level > 0.0f)
+            {
+                // level relative to the threshold in dB, then expanded
+                const float db
+                    = rms ? kDbPerLog2Power * fastlog2f(level / window_)
+                          : kDbPerLog2Amplitude * fastlog2f(level);
+                const float gain_db
+                    = fmax((db - threshold_db_) * (ratio_ - 1.0f), range_db_);
+                target = lut_db_to_gain(fmin(gain_db, 0.0f));
+            }
+        }
+
+        const float coeff = target > gain_ ? attack_coeff_ : release_coeff_;
+        gain_ += coeff * (target - gain_);
+        if(target == 0.0f && gain_ < kSilentGain)
+            gain_ = 0.0f;
+        silent = silent && gain_ == 0.0f;
+
+        for(size_t c = 0; c < num_channels_; c++)
+        {
+            float x = in[c][n];
+            if(lookahead_ > 0)
+            {
+                float* delay = delay_ + c * max_lookahead_;
+                const float delayed = delay[delay_pos_];
+                delay[delay_pos_]   = x;
+                x                   = delayed;
+            }
+            out[c][n] = x * gain_;
+        }
+        if(lookahead_ > 0 && ++delay_pos_ >= lookahead_)
+            delay_pos_ = 0;
+    }
+    silent_ = silent;
+    return silent;
+}
@@ -0,0 +1,187 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_GATE_H
+#define DSY_GATE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Filters/onepole.h"
+#ifdef __cplusplus
+
+/** @file gate.h */
+
+namespace daisysp
+{
+/**
+    @brief Noise gate and downward expander with lookahead.
+
+    The level is measured over a sliding window, as the peak or the RMS of
+    the key signal. Both cost the same per sample whatever the window size:
+    the RMS is a running sum, and the peak a van Herk/Gil-Werman running
+    maximum.
+
+    With several channels, the detection is linked: the key is the loudest
+    channel, so all channels open and close together. An external key can
+    be used instead, and the key can be band limited to ignore e.g. rumble
+    or cymbal bleed.
+
+    The gate opens above the threshold, and closes once the level has been
+    below the threshold minus the hysteresis for the hold time. The audio
+    can be delayed by a lookahead, so the gate is already open when a
+    transient passes.
+
+    ProcessBlock() returns true when the output block is all zeros, so the
+    modules after the gate can skip their work.
+
+    \code
+    // 4 channels, up to 2 ms of lookahead, a 5 ms window
+    float DSY_SDRAM_BSS gate_mem[Gate::GetBufferSize(4, 96, 240)];
+    gate.Init(gate_mem, 48000.0f, 4, 96, 240);
+    gate.SetThreshold(-45.0f);
+    gate.SetLookahead(96);
+    ...
+    // directly on the AudioHandle buffers
+    const bool silent = gate.ProcessBlock(in, out, size);
+    \endcode
+*/
+class Gate
+{
+  public:
+    static constexpr size_t kMaxChannels = 8;
+
+    enum class Detector
+    {
+        /** Largest absolute sample in the window */
+        PEAK,
+        /** Root mean square over the window */
+        RMS,
+    };
+
+    Gate() {}
+    ~Gate() {}
+
+    /** Returns the number of floats Init() needs */
+    static constexpr size_t
+    GetBufferSize(size_t num_channels, size_t max_lookahead, size_t window)
+    {
+        // a delay line per channel, the key window and its suffix maxima
+        return num_channels * max_lookahead + 2 * window;
+    }
+
+    /** Initializes the gate, closed.
+        \param buffer memory of at least GetBufferSize() floats
+        \param sample_rate audio engine sample rate
+        \param num_channels 1 to kMaxChannels
+        \param max_lookahead longest lookahead in samples, may be 0
+        \param window detector window in samples, at least 1
+    */
+    void Init(float* buffer,
+              float  sample_rate,
+              size_t num_channels,
+              size_t max_lookahead,
+              size_t window);
+
+    /** Gates a block of all channels, with the detection linked.
+        \param in one input per channel
+        \param out one output per channel, may be the same as the inputs
+        \param size number of samples
+        \return true if the output block is silent
+    */
+    bool ProcessBlock(const float* const* in, float** out, size_t size);
+
+    /** Gates a block of all channels, keyed by an external signal */
+    bool ProcessBlock(const float* const* in,
+                      float**             out,
+                      const float*        key,
+                      size_t              size);
+
+    /** Level that opens the gate in dBFS, -50 by default */
+    void SetThreshold(float db);
+
+    /** How far below the threshold the level has to fall before the gate
+        closes, in dB. 6 by default.
+    */
+    void SetHysteresis(float db);
+
+    /** Time the gate stays open after the level fell, in seconds */
+    void SetHold(float seconds);
+
+    /** Opening time in seconds */
+    void SetAttack(float seconds);
+
+    /** Closing time in seconds */
+    void SetRelease(float seconds);
+
+    /** Attenuation of the closed gate in dB. At or below kLutDbMin (the
+        default), the closed gate is silent.
+    */
+    void SetRange(float db);
+
+    /** Downward expansion ratio below the threshold. Each dB below the
+        threshold is attenuated by another (ratio - 1) dB, down to the
+        range. 0 (the default) is a gate.
+    */
+    void SetRatio(float ratio);
+
+    /** Delay of the audio relative to the key in samples, up to the
+        max_lookahead given to Init(). The latency of the gate.
+    */
+    void SetLookahead(size_t samples);
+
+    /** Peak or RMS detection, peak by default */
+    void SetDetector(Detector detector);
+
+    /** Band limits the key to [low, high] Hz with first order filters.
+        Use 0 and the Nyquist frequency (the defaults) to disable.
+    */
+    void SetSidechainFilter(float low, float high);
+
+    /** True while the level is above the threshold, or holding */
+    inline bool IsOpen() const { return open_; }
+
+    /** Current linear gain */
+    inline float GetGain() const { return gain_; }
+
+    /** True if the output of the last block was silent */
+    inline bool IsSilent() const { return silent_; }
+
+    inline size_t GetLookahead() const { return lookahead_; }
+
+  private:
+    template <bool external>
+    bool Run(const float* const* in, float** out, const float* key, size_t size);
+    float Detect(float key);
+    void  UpdateThresholds();
+
+    float  sample_rate_;
+    size_t num_channels_, max_lookahead_, window_;
+    size_t lookahead_, delay_pos_;
+
+    float*   delay_;  // max_lookahead samples per channel
+    float*   ring_;   // rectified or squared key over the window
+    float*   suffix_; // maxima of the ring from each position to its end
+    size_t   ring_pos_;
+    float    sum_, fresh_sum_, prefix_max_;
+    Detector detector_;
+
+    OnePole highpass_[kMaxChannels], lowpass_[kMaxChannels];
+    bool    filter_;
+
+    float  threshold_db_, hysteresis_db_, range_db_, ratio_;
+    float  open_level_, close_level_; // in the detector's domain
+    float  floor_gain_;
+    float  attack_coeff_, release_coeff_;
+    size_t hold_samples_, hold_count_;
+    float  gain_;
+    bool   open_, silent_;
+};
+} // namespace daisysp
+#endif
+#endif
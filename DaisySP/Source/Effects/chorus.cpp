@@ -15,6 +15,7 @@ void ChorusEngine::Init(float sample_rate)
     SetDelay(.75);
 
     lfo_phase_ = 0.f;
+    lfo_freq_  = 0.f;
     SetLfoFreq(.3f);
     SetLfoDepth(.9f);
 }
@@ -25,7 +26,7 @@ float ChorusEngine::Process(float in)
     del_.SetDelay(lfo_sig + delay_);
 
     float out = del_.Read();
-    del_.Write(in + out * feedback_);
+    del_.Write(flush_denormal(in + out * feedback_));
 
     return (in + out) * .5f; //equal mix
 }
@@ -62,6 +63,15 @@ void ChorusEngine::SetFeedback(float feedback)
     feedback_ = fclamp(feedback, 0.f, 1.f);
 }
 
+void ChorusEngine::SetSampleRate(float sample_rate)
+{
+    const float ratio = sample_rate / sample_rate_;
+    sample_rate_      = sample_rate;
+    delay_ *= ratio;
+    lfo_amp_ *= ratio;
+    lfo_freq_ = fclamp(lfo_freq_ / ratio, -.25f, .25f);
+}
+
 float ChorusEngine::ProcessLfo()
 {
     lfo_phase_ += lfo_freq_;
@@ -90,6 +100,7 @@ void Chorus::Init(float sample_rate)
 
     gain_frac_ = .5f;
     sigl_ = sigr_ = 0.f;
+    silence_.Init(ChorusEngine::kDelayLength);
 }
 
 float Chorus::Process(float in)
@@ -110,6 +121,30 @@ float Chorus::Process(float in)
     return sigl_;
 }
 
+bool Chorus::ProcessBlock(const float* in,
+                          float*       left,
+                          float*       right,
+                          size_t       size)
+{
+    const bool in_silent = IsSilentBlock(in, size);
+    if(in_silent && silence_.IsAsleep())
+    {
+        ClearBlock(left, size);
+        ClearBlock(right, size);
+        sigl_ = sigr_ = 0.f;
+        return true;
+    }
+    for(size_t i = 0; i < size; i++)
+    {
+        left[i]  = Process(in[i]);
+        right[i] = sigr_;
+    }
+    silence_.Update(in_silent && IsSilentBlock(left, size)
+                        && IsSilentBlock(right, size),
+                    size);
+    return false;
+}
+
 float Chorus::GetLeft()
 {
     return sigl_;
@@ -185,3 +220,9 @@ void Chorus::SetFeedback(float feedback)
 {
     SetFeedback(feedback, feedback);
 }
+
+void Chorus::SetSampleRate(float sample_rate)
+{
+    engines_[0].SetSampleRate(sample_rate);
+    engines_[1].SetSampleRate(sample_rate);
+}
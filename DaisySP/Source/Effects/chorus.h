@@ -12,7 +12,9 @@ https://opensource.org/licenses/MIT.
 #ifdef __cplusplus
 
 #include <stdint.h>
+#include <stddef.h>
 #include "Utility/delayline.h"
+#include "Utility/silence.h"
 
 /** @file chorus.h */
 
@@ -25,6 +27,9 @@ namespace daisysp
 class ChorusEngine
 {
   public:
+    static constexpr int32_t kDelayLength
+        = 2400; // 50 ms at 48kHz = .05 * 48000
+
     ChorusEngine() {}
     ~ChorusEngine() {}
 
@@ -63,10 +68,13 @@ class ChorusEngine
     */
     void SetFeedback(float feedback);
 
+    /** Changes the sample rate without clearing the delay line, and
+        rescales the delay time and lfo for the new rate.
+    */
+    void SetSampleRate(float sample_rate);
+
   private:
-    float                    sample_rate_;
-    static constexpr int32_t kDelayLength
-        = 2400; // 50 ms at 48kHz = .05 * 48000
+    float sample_rate_;
 
     //triangle lfos
     float lfo_phase_;
@@ -106,6 +114,17 @@ class Chorus
     */
     float Process(float in);
 
+    /** Processes a block to both channels. Once the input and the tail
+        have been silent for the length of the delay lines, silent input
+        blocks aren't processed, and the lfos pause until the input returns.
+        \param in input block
+        \param left left output, may be the same as in
+        \param right right output
+        \param size number of samples
+        \return true if the output blocks are all zeros
+    */
+    bool ProcessBlock(const float* in, float* left, float* right, size_t size);
+
     /** Get the left channel's last sample */
     float GetLeft();
 
@@ -178,12 +197,17 @@ class Chorus
     */
     void SetFeedback(float feedback);
 
+    /** Changes the sample rate of both engines without clearing them */
+    void SetSampleRate(float sample_rate);
+
   private:
     ChorusEngine engines_[2];
     float        gain_frac_;
     float        pan_[2];
 
     float sigl_, sigr_;
+
+    SilenceTracker silence_;
 };
 } //namespace daisysp
 #endif
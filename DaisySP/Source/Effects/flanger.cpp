@@ -15,8 +15,11 @@ void Flanger::Init(float sample_rate)
     SetDelay(.75);
 
     lfo_phase_ = 0.f;
+    lfo_freq_  = 0.f;
     SetLfoFreq(.3);
     SetLfoDepth(.9);
+
+    silence_.Init(kDelayLength);
 }
 
 float Flanger::Process(float in)
@@ -25,7 +28,7 @@ float Flanger::Process(float in)
     del_.SetDelay(1.f + lfo_sig + delay_);
 
     float out = del_.Read();
-    del_.Write(in + out * feedback_);
+    del_.Write(flush_denormal(in + out * feedback_));
 
     return (in + out) * .5f; //equal mix
 }
@@ -63,6 +66,29 @@ void Flanger::SetDelayMs(float ms)
     lfo_amp_ = fmin(lfo_amp_, delay_); //clip this if needed
 }
 
+void Flanger::SetSampleRate(float sample_rate)
+{
+    const float ratio = sample_rate / sample_rate_;
+    sample_rate_      = sample_rate;
+    delay_ *= ratio;
+    lfo_amp_ *= ratio;
+    lfo_freq_ = fclamp(lfo_freq_ / ratio, -.25f, .25f);
+}
+
+bool Flanger::ProcessBlock(const float* in, float* out, size_t size)
+{
+    const bool in_silent = IsSilentBlock(in, size);
+    if(in_silent && silence_.IsAsleep())
+    {
+        ClearBlock(out, size);
+        return true;
+    }
+    for(size_t i = 0; i < size; i++)
+        out[i] = Process(in[i]);
+    silence_.Update(in_silent && IsSilentBlock(out, size), size);
+    return false;
+}
+
 float Flanger::ProcessLfo()
 {
     lfo_phase_ += lfo_freq_;
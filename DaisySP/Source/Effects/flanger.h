@@ -12,7 +12,9 @@ https://opensource.org/licenses/MIT.
 #ifdef __cplusplus
 
 #include <stdint.h>
+#include <stddef.h>
 #include "Utility/delayline.h"
+#include "Utility/silence.h"
 
 /** @file flanger.h */
 
@@ -36,6 +38,16 @@ class Flanger
     */
     float Process(float in);
 
+    /** Processes a block. Once the input and the tail have been silent
+        for the length of the delay line, silent input blocks aren't
+        processed, and the lfo pauses until the input returns.
+        \param in input block
+        \param out output block, may be the same as in
+        \param size number of samples
+        \return true if the output block is all zeros
+    */
+    bool ProcessBlock(const float* in, float* out, size_t size);
+
     /** How much of the signal to feedback into the delay line.
         \param feedback Works 0-1.
     */
@@ -61,6 +73,11 @@ class Flanger
     */
     void SetDelayMs(float ms);
 
+    /** Changes the sample rate without clearing the delay line, and
+        rescales the delay time and lfo for the new rate.
+    */
+    void SetSampleRate(float sample_rate);
+
   private:
     float                    sample_rate_;
     static constexpr int32_t kDelayLength = 960; // 20 ms at 48kHz = .02 * 48000
@@ -75,6 +92,7 @@ class Flanger
     float delay_;
 
     DelayLine<float, kDelayLength> del_;
+    SilenceTracker                 silence_;
 
     float ProcessLfo();
 };
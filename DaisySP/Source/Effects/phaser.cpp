@@ -21,6 +21,7 @@ void PhaserEngine::Init(float sample_rate)
 
     last_sample_ = 0.f;
     lfo_phase_   = 0.f;
+    lfo_freq_    = 0.f;
     SetLfoFreq(.3);
     SetLfoDepth(.9);
 }
@@ -30,7 +31,8 @@ float PhaserEngine::Process(float in)
     float lfo_sig = ProcessLfo();
     fonepole(deltime_, sample_rate_ / (lfo_sig + ap_freq_ + os_), .0001f);
 
-    last_sample_ = del_.Allpass(in + feedback_ * last_sample_, deltime_, .3f);
+    last_sample_ = flush_denormal(
+        del_.Allpass(in + feedback_ * last_sample_, deltime_, .3f));
 
     return (in + last_sample_) * .5f; //equal mix
 }
@@ -57,6 +59,14 @@ void PhaserEngine::SetFeedback(float feedback)
     feedback_ = fclamp(feedback, 0.f, .75f);
 }
 
+void PhaserEngine::SetSampleRate(float sample_rate)
+{
+    const float ratio = sample_rate / sample_rate_;
+    sample_rate_      = sample_rate;
+    deltime_ *= ratio;
+    lfo_freq_ = fclamp(lfo_freq_ / ratio, -.25f, .25f);
+}
+
 float PhaserEngine::ProcessLfo()
 {
     lfo_phase_ += lfo_freq_;
@@ -86,6 +96,7 @@ void Phaser::Init(float sample_rate)
 
     poles_     = 4;
     gain_frac_ = .5f;
+    silence_.Init(PhaserEngine::kDelayLength);
 }
 
 float Phaser::Process(float in)
@@ -100,6 +111,20 @@ float Phaser::Process(float in)
     return sig;
 }
 
+bool Phaser::ProcessBlock(const float* in, float* out, size_t size)
+{
+    const bool in_silent = IsSilentBlock(in, size);
+    if(in_silent && silence_.IsAsleep())
+    {
+        ClearBlock(out, size);
+        return true;
+    }
+    for(size_t i = 0; i < size; i++)
+        out[i] = Process(in[i]);
+    silence_.Update(in_silent && IsSilentBlock(out, size), size);
+    return false;
+}
+
 void Phaser::SetPoles(int poles)
 {
     poles_ = DSY_CLAMP(poles, 1, 8);
@@ -136,3 +161,11 @@ void Phaser::SetFeedback(float feedback)
         engines_[i].SetFeedback(feedback);
     }
 }
+
+void Phaser::SetSampleRate(float sample_rate)
+{
+    for(int i = 0; i < kMaxPoles; i++)
+    {
+        engines_[i].SetSampleRate(sample_rate);
+    }
+}
@@ -12,7 +12,9 @@ https://opensource.org/licenses/MIT.
 #ifdef __cplusplus
 
 #include <stdint.h>
+#include <stddef.h>
 #include "Utility/delayline.h"
+#include "Utility/silence.h"
 
 /** @file phaser.h */
 
@@ -25,6 +27,9 @@ namespace daisysp
 class PhaserEngine
 {
   public:
+    static constexpr int32_t kDelayLength
+        = 2400; // 50 ms at 48kHz = .05 * 48000
+
     PhaserEngine() {}
     ~PhaserEngine() {}
 
@@ -58,10 +63,13 @@ class PhaserEngine
     */
     void SetFeedback(float feedback);
 
+    /** Changes the sample rate without clearing the allpass state, and
+        rescales the delay time and lfo for the new rate.
+    */
+    void SetSampleRate(float sample_rate);
+
   private:
-    float                    sample_rate_;
-    static constexpr int32_t kDelayLength
-        = 2400; // 50 ms at 48kHz = .05 * 48000
+    float sample_rate_;
 
     //triangle lfo
     float lfo_phase_;
@@ -103,6 +111,16 @@ class Phaser
     */
     float Process(float in);
 
+    /** Processes a block. Once the input and the tail have been silent
+        for the length of the delay line, silent input blocks aren't
+        processed, and the lfos pause until the input returns.
+        \param in input block
+        \param out output block, may be the same as in
+        \param size number of samples
+        \return true if the output block is all zeros
+    */
+    bool ProcessBlock(const float* in, float* out, size_t size);
+
     /** Number of allpass stages.
         \param poles Works 1 to 8.
     */
@@ -128,11 +146,15 @@ class Phaser
     */
     void SetFeedback(float feedback);
 
+    /** Changes the sample rate of all stages without clearing them */
+    void SetSampleRate(float sample_rate);
+
   private:
     static constexpr int kMaxPoles = 8;
     PhaserEngine         engines_[kMaxPoles];
     float                gain_frac_;
     int                  poles_;
+    SilenceTracker       silence_;
 };
 } //namespace daisysp
 #endif
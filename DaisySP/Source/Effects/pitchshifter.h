@@ -11,10 +11,8 @@ https://opensource.org/licenses/MIT.
 #define DSY_PITCHSHIFTER_H
 #include <stdint.h>
 #include <cmath>
-#ifdef USE_ARM_DSP
-#include "arm_math.h"
-#endif
 #include "Utility/dsp.h"
+#include "Utility/lut.h"
 #include "Utility/delayline.h"
 #include "Control/phasor.h"
 
@@ -73,7 +71,6 @@ class PitchShifter
         force_recalc_ = false;
         sr_           = sr;
         mod_freq_     = 5.0f;
-        SetSemitones();
         for(uint8_t i = 0; i < 2; i++)
         {
             gain_[i] = 0.0f;
@@ -119,13 +116,8 @@ class PitchShifter
         }
         mod_[0] = fade1 * (del_size_ - 1);
         mod_[1] = fade2 * (del_size_ - 1);
-#ifdef USE_ARM_DSP
-        gain_[0] = arm_sin_f32(fade1 * (float)M_PI);
-        gain_[1] = arm_sin_f32(fade2 * (float)M_PI);
-#else
-        gain_[0] = sinf(fade1 * PI_F);
-        gain_[1] = sinf(fade2 * PI_F);
-#endif
+        gain_[0] = lut_sine_window(fade1);
+        gain_[1] = lut_sine_window(fade2);
 
         // Handle Delay Writing
         d_[0].Write(in);
@@ -146,14 +138,11 @@ class PitchShifter
     */
     void SetTransposition(const float &transpose)
     {
-        float   ratio;
-        uint8_t idx;
+        float ratio;
         if(transpose_ != transpose || force_recalc_)
         {
             transpose_ = transpose;
-            idx        = (uint8_t)fabsf(transpose);
-            ratio      = semitone_ratios_[idx % 12];
-            ratio *= (uint8_t)(fabsf(transpose) / 12) + 1;
+            ratio      = lut_semitones_to_ratio(fabsf(transpose));
             if(transpose > 0.0f)
             {
                 shift_up_ = true;
@@ -190,13 +179,6 @@ class PitchShifter
     inline void SetFun(float f) { fun_ = f; }
 
   private:
-    inline void SetSemitones()
-    {
-        for(size_t i = 0; i < 12; i++)
-        {
-            semitone_ratios_[i] = powf(2.0f, (float)i / 12);
-        }
-    }
     typedef DelayLine<float, SHIFT_BUFFER_SIZE> ShiftDelay;
     ShiftDelay                                  d_[2];
     float                                       pitch_shift_, mod_freq_;
@@ -210,9 +192,6 @@ class PitchShifter
     float  gain_[2], mod_[2], transpose_;
     float  fun_, mod_a_amt_, mod_b_amt_, prev_phs_a_, prev_phs_b_;
     float  slewed_mod_[2], mod_coeff_[2];
-    /** pitch stuff
-*/
-    float semitone_ratios_[12];
 };
 } // namespace daisysp
 
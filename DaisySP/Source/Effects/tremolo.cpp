@@ -33,4 +33,10 @@ void Tremolo::SetDepth(float depth)
     depth *= .5f;
     osc_.SetAmp(depth);
     dc_os_ = 1.f - depth;
-}
\ No newline at end of file
+}
+
+void Tremolo::SetSampleRate(float sample_rate)
+{
+    sample_rate_ = sample_rate;
+    osc_.SetSampleRate(sample_rate_);
+}
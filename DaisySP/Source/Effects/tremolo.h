@@ -58,6 +58,8 @@ class Tremolo
     */
     void SetDepth(float depth);
 
+    /** Changes the sample rate without resetting the lfo phase */
+    void SetSampleRate(float sample_rate);
 
   private:
     float      sample_rate_, dc_os_;
@@ -0,0 +1,187 @@
+#include "vocoder.h"
+#include <math.h>
+#include <string.h>
+
+using namespace daisysp;
+
+namespace
+{
+// fasttan() in ResonatorSvf is accurate up to about a quarter of the
+// sample rate
+constexpr float kMaxNormalizedFreq = 0.24f;
+} // namespace
+
+void Vocoder::Init(float sample_rate, size_t num_bands)
+{
+    sample_rate_ = sample_rate;
+    num_bands_   = num_bands < kBandsPerBatch ? kBandsPerBatch : num_bands;
+    num_bands_   = num_bands_ > kMaxBands ? kMaxBands : num_bands_;
+    num_bands_   = num_bands_ / kBandsPerBatch * kBandsPerBatch;
+    num_batches_ = num_bands_ / kBandsPerBatch;
+
+    for(size_t i = 0; i < kMaxBatches; i++)
+    {
+        for(size_t j = 0; j < kStages; j++)
+        {
+            analysis_[i][j].Init();
+            synthesis_[i][j].Init();
+        }
+    }
+    memset(envelope_, 0, sizeof(envelope_));
+    memset(prev_envelope_, 0, sizeof(prev_envelope_));
+
+    low_       = 100.0f;
+    high_      = 8000.0f;
+    bandwidth_ = 1.0f;
+    shift_     = 1.0f;
+    UpdateBands();
+
+    attack_        = 0.005f;
+    release_       = 0.05f;
+    follower_size_ = 0;
+}
+
+void Vocoder::SetFreqRange(float low, float high)
+{
+    low_  = fmax(low, 10.0f);
+    high_ = fmax(high, low_ * 1.1f);
+    UpdateBands();
+}
+
+void Vocoder::SetBandwidth(float bandwidth)
+{
+    bandwidth_ = fclamp(bandwidth, 0.1f, 4.0f);
+    UpdateBands();
+}
+
+void Vocoder::SetFormantShift(float ratio)
+{
+    shift_ = fclamp(ratio, 0.25f, 4.0f);
+    UpdateBands();
+}
+
+void Vocoder::SetAttack(float attack)
+{
+    attack_        = fmax(attack, 0.0f);
+    follower_size_ = 0;
+}
+
+void Vocoder::SetRelease(float release)
+{
+    release_       = fmax(release, 0.0f);
+    follower_size_ = 0;
+}
+
+void Vocoder::UpdateBands()
+{
+    // bands are evenly spaced on a log scale, and a bandpass whose -3 dB
+    // points touch the neighbouring centers has a Q of sqrt(r) / (r - 1).
+    // Two cascaded stages have the same -3 dB points when each has
+    // sqrt(sqrt(2) - 1) of that Q.
+    const float ratio = powf(high_ / low_, 1.0f / (num_bands_ - 1));
+    const float q
+        = 0.6435943f * sqrtf(ratio) / ((ratio - 1.0f) * bandwidth_);
+    float       f = low_ / sample_rate_;
+    for(size_t i = 0; i < num_bands_; i++)
+    {
+        freq_[i]       = fmin(f, kMaxNormalizedFreq);
+        synth_freq_[i] = fmin(f * shift_, kMaxNormalizedFreq);
+        q_[i]          = q;
+        f *= ratio;
+    }
+}
+
+void Vocoder::UpdateFollower(size_t size)
+{
+    // the followers run once per block, so the coefficients depend on the
+    // block size
+    const float block_rate = sample_rate_ / size;
+    attack_coeff_          = attack_ > 0.0f
+                                 ? 1.0f - expf(-1.0f / (attack_ * block_rate))
+                                 : 1.0f;
+    release_coeff_         = release_ > 0.0f
+                                 ? 1.0f - expf(-1.0f / (release_ * block_rate))
+                                 : 1.0f;
+    follower_size_ = size;
+}
+
+void Vocoder::Process(const float* modulator,
+                      const float* carrier,
+                      float*       out,
+                      size_t       size)
+{
+    while(size > 0)
+    {
+        const size_t n = size < kMaxBlockSize ? size : kMaxBlockSize;
+        ProcessChunk(modulator, carrier, out, n);
+        modulator += n;
+        carrier += n;
+        out += n;
+        size -= n;
+    }
+}
+
+void Vocoder::ProcessChunk(const float* modulator,
+                           const float* carrier,
+                           float*       out,
+                           size_t       size)
+{
+    if(size != follower_size_)
+        UpdateFollower(size);
+
+    // both banks are two stages, the first one writes the band signals of
+    // a batch to `lanes`, which the second one filters again
+    float lanes[kMaxBlockSize * kBandsPerBatch];
+
+    // analysis, one pass over the block per batch and stage
+    memset(energy_, 0, num_bands_ * sizeof(float));
+    for(size_t b = 0; b < num_batches_; b++)
+    {
+        const size_t i = b * kBandsPerBatch;
+        analysis_[b][0].ProcessLanes<Bank::BAND_PASS_NORMALIZED>(
+            &freq_[i], &q_[i], modulator, lanes, size);
+        analysis_[b][1].Analyze<Bank::BAND_PASS_NORMALIZED, true>(
+            &freq_[i], &q_[i], lanes, &energy_[i], size);
+    }
+
+    // block envelope followers, the RMS of a sine is scaled to its peak
+    const float rms_to_peak = sqrtf(2.0f) / sqrtf(static_cast<float>(size));
+    for(size_t i = 0; i < num_bands_; i++)
+    {
+        const float level = sqrtf(energy_[i]) * rms_to_peak;
+        const float coeff
+            = level > envelope_[i] ? attack_coeff_ : release_coeff_;
+        prev_envelope_[i] = envelope_[i];
+        envelope_[i] += coeff * (level - envelope_[i]);
+        envelope_[i] = flush_denormal(envelope_[i]);
+    }
+
+    // synthesis, the band gains ramp from the previous envelope over the
+    // block. The first batch overwrites the output, the others add to it.
+    for(size_t b = 0; b < num_batches_; b++)
+    {
+        const size_t i = b * kBandsPerBatch;
+        synthesis_[b][0].ProcessLanes<Bank::BAND_PASS_NORMALIZED>(
+            &synth_freq_[i], &q_[i], carrier, lanes, size);
+        if(b == 0)
+            synthesis_[b][1]
+                .ProcessBlock<Bank::BAND_PASS_NORMALIZED, false, true>(
+                    &synth_freq_[i],
+                    &q_[i],
+                    &prev_envelope_[i],
+                    &envelope_[i],
+                    lanes,
+                    out,
+                    size);
+        else
+            synthesis_[b][1]
+                .ProcessBlock<Bank::BAND_PASS_NORMALIZED, true, true>(
+                    &synth_freq_[i],
+                    &q_[i],
+                    &prev_envelope_[i],
+                    &envelope_[i],
+                    lanes,
+                    out,
+                    size);
+    }
+}
@@ -0,0 +1,151 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_VOCODER_H
+#define DSY_VOCODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <type_traits>
+#include "PhysicalModeling/resonator.h"
+#ifdef __cplusplus
+
+/** @file vocoder.h */
+
+namespace daisysp
+{
+/**
+    @brief Channel vocoder.
+
+    The modulator (e.g. a voice) is split into log spaced bands by an
+    analysis filter bank. The level of each band is followed once per
+    block, and applied to the same band of the carrier (e.g. an
+    oscillator) in a synthesis filter bank.
+
+    Each band is two cascaded ResonatorSvf bandpass stages, for a 24 dB
+    per octave slope. The banks run four bands per lane batch, with the
+    coefficients computed once per block, and each stage is processed in
+    one pass over the block per batch. Blocks longer than kMaxBlockSize
+    are split, and the envelope followers run once per split block.
+
+    \code
+    vocoder.Init(sample_rate, 16);
+    ...
+    // any oscillator with a float Process() can be the carrier
+    vocoder.Process(in, saw, out, size);
+    \endcode
+*/
+class Vocoder
+{
+  public:
+    static constexpr size_t kBandsPerBatch = 4;
+    static constexpr size_t kMaxBands      = 32;
+    static constexpr size_t kMaxBatches    = kMaxBands / kBandsPerBatch;
+
+    /** Largest block processed at once */
+    static constexpr size_t kMaxBlockSize = 64;
+
+    Vocoder() {}
+    ~Vocoder() {}
+
+    /** Initializes the module.
+        \param sample_rate audio engine sample rate
+        \param num_bands number of bands, a multiple of 4 up to kMaxBands
+    */
+    void Init(float sample_rate, size_t num_bands = 16);
+
+    /** Processes a block.
+        \param modulator signal whose spectral envelope is imposed
+        \param carrier signal that is filtered, e.g. a saw or noise
+        \param out output, may be the same as the modulator
+        \param size number of samples
+    */
+    void Process(const float* modulator,
+                 const float* carrier,
+                 float*       out,
+                 size_t       size);
+
+    /** Processes a block with the carrier rendered from any oscillator
+        with a `float Process()` method.
+    */
+    template <typename Oscillator,
+              typename = typename std::enable_if<
+                  std::is_class<Oscillator>::value>::type>
+    void Process(const float* modulator,
+                 Oscillator&  carrier,
+                 float*       out,
+                 size_t       size)
+    {
+        float carrier_block[kMaxBlockSize];
+        while(size > 0)
+        {
+            const size_t n = size < kMaxBlockSize ? size : kMaxBlockSize;
+            for(size_t i = 0; i < n; i++)
+                carrier_block[i] = carrier.Process();
+            ProcessChunk(modulator, carrier_block, out, n);
+            modulator += n;
+            out += n;
+            size -= n;
+        }
+    }
+
+    /** Center frequencies of the lowest and highest band in Hz */
+    void SetFreqRange(float low, float high);
+
+    /** Bandwidth of the bands relative to their spacing. Below 1 the bands
+        are narrower and more resonant, 1 by default.
+    */
+    void SetBandwidth(float bandwidth);
+
+    /** Shifts the synthesis bands by a frequency ratio, which moves the
+        formants of the modulator up or down. 1 by default.
+    */
+    void SetFormantShift(float ratio);
+
+    /** Envelope follower attack time in seconds */
+    void SetAttack(float attack);
+
+    /** Envelope follower release time in seconds */
+    void SetRelease(float release);
+
+    /** Current level of a band, e.g. for metering */
+    inline float GetBandLevel(size_t band) const
+    {
+        return band < num_bands_ ? envelope_[band] : 0.0f;
+    }
+
+    inline size_t GetNumBands() const { return num_bands_; }
+
+  private:
+    void ProcessChunk(const float* modulator,
+                      const float* carrier,
+                      float*       out,
+                      size_t       size);
+    void UpdateBands();
+    void UpdateFollower(size_t size);
+
+    typedef ResonatorSvf<kBandsPerBatch> Bank;
+    static constexpr size_t              kStages = 2;
+
+    float  sample_rate_, low_, high_, bandwidth_, shift_;
+    float  attack_, release_, attack_coeff_, release_coeff_;
+    size_t num_bands_, num_batches_, follower_size_;
+
+    Bank  analysis_[kMaxBatches][kStages];
+    Bank  synthesis_[kMaxBatches][kStages];
+    float freq_[kMaxBands];       // normalized analysis frequencies
+    float synth_freq_[kMaxBands]; // normalized synthesis frequencies
+    float q_[kMaxBands];
+    float energy_[kMaxBands];
+    float envelope_[kMaxBands];
+    float prev_envelope_[kMaxBands];
+};
+} // namespace daisysp
+#endif
+#endif
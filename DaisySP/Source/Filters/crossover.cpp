@@ -0,0 +1,151 @@
+#include "crossover.h"
+#include "Utility/dsp.h"
+#include <math.h>
+#include <string.h>
+
+using namespace daisysp;
+
+namespace
+{
+// damping of a Butterworth section, 1 / Q
+constexpr float kDamping = 1.41421356f;
+
+constexpr float kDefaultFreq[Crossover::kMaxBands - 1][Crossover::kMaxSplits]
+    = {{1000.0f}, {200.0f, 2000.0f}, {120.0f, 1000.0f, 5000.0f}};
+} // namespace
+
+void Crossover::Init(float sample_rate, size_t num_bands)
+{
+    sample_rate_ = sample_rate;
+    num_bands_   = num_bands < 2 ? 2 : num_bands;
+    num_bands_   = num_bands_ > kMaxBands ? kMaxBands : num_bands_;
+
+    const size_t num_splits = num_bands_ - 1;
+    for(size_t s = 0; s < kMaxSplits; s++)
+    {
+        for(size_t j = 0; j < 2; j++)
+        {
+            Stage& stage = stages_[s][j];
+            memset(stage.ic1, 0, sizeof(stage.ic1));
+            memset(stage.ic2, 0, sizeof(stage.ic2));
+            for(size_t i = 0; i < kMaxBands; i++)
+            {
+                // the split's lowpass in lane s, its highpass in lane s + 1,
+                // and the allpass in the bands below
+                const bool lowpass  = i == s;
+                const bool highpass = i == s + 1;
+                stage.mix_x[i]      = lowpass ? 0.0f : 1.0f;
+                stage.mix_bp[i]     = lowpass ? 0.0f
+                                              : (highpass ? -kDamping
+                                                          : -2.0f * kDamping);
+                stage.mix_lp[i]
+                    = lowpass ? 1.0f : (highpass ? -1.0f : 0.0f);
+            }
+            // the allpass is only in the first stage
+            stage.lo = j == 0 ? 0 : s;
+            stage.hi = s + 2;
+        }
+        freq_[s] = s < num_splits ? kDefaultFreq[num_splits - 1][s] : 1000.0f;
+        UpdateCoefficients(s);
+    }
+}
+
+void Crossover::SetSampleRate(float sample_rate)
+{
+    sample_rate_ = sample_rate;
+    for(size_t s = 0; s < kMaxSplits; s++)
+        UpdateCoefficients(s);
+}
+
+void Crossover::SetFreq(size_t index, float freq)
+{
+    if(index >= kMaxSplits)
+        return;
+    freq_[index] = freq;
+    UpdateCoefficients(index);
+}
+
+void Crossover::UpdateCoefficients(size_t split)
+{
+    const float freq = fclamp(freq_[split], 10.0f, 0.49f * sample_rate_);
+    const float g    = tanf(PI_F * freq / sample_rate_);
+    a1_[split]       = 1.0f / (1.0f + g * (g + kDamping));
+    a2_[split]       = g * a1_[split];
+    a3_[split]       = g * a2_[split];
+}
+
+void Crossover::RunStage(Stage& stage, size_t split, float* lanes, size_t size)
+{
+    const float  a1 = a1_[split];
+    const float  a2 = a2_[split];
+    const float  a3 = a3_[split];
+    const size_t lo = stage.lo;
+    const size_t hi = stage.hi;
+
+    float ic1[kMaxBands], ic2[kMaxBands];
+    for(size_t i = lo; i < hi; i++)
+    {
+        ic1[i] = stage.ic1[i];
+        ic2[i] = stage.ic2[i];
+    }
+
+    for(size_t n = 0; n < size; n++)
+    {
+        float* x = lanes + n * kMaxBands;
+        for(size_t i = lo; i < hi; i++)
+        {
+            const float v3 = x[i] - ic2[i];
+            const float v1 = a1 * ic1[i] + a2 * v3;
+            const float v2 = ic2[i] + a2 * ic1[i] + a3 * v3;
+            ic1[i]         = 2.0f * v1 - ic1[i];
+            ic2[i]         = 2.0f * v2 - ic2[i];
+            x[i] = stage.mix_x[i] * x[i] + stage.mix_bp[i] * v1
+                   + stage.mix_lp[i] * v2;
+        }
+    }
+
+    for(size_t i = lo; i < hi; i++)
+    {
+        stage.ic1[i] = flush_denormal(ic1[i]);
+        stage.ic2[i] = flush_denormal(ic2[i]);
+    }
+}
+
+void Crossover::Process(const float* in, float* const* bands, size_t size)
+{
+    float* out[kMaxBands];
+    for(size_t b = 0; b < num_bands_; b++)
+        out[b] = bands[b];
+
+    while(size > 0)
+    {
+        const size_t n = size < kMaxBlockSize ? size : kMaxBlockSize;
+        ProcessChunk(in, out, n);
+        in += n;
+        for(size_t b = 0; b < num_bands_; b++)
+            out[b] += n;
+        size -= n;
+    }
+}
+
+void Crossover::ProcessChunk(const float* in, float* const* bands, size_t size)
+{
+    // lane b holds band b once its split is done, the highest lane in use
+    // holds what is left to split
+    float lanes[kMaxBlockSize * kMaxBands];
+    for(size_t n = 0; n < size; n++)
+        lanes[n * kMaxBands] = in[n];
+
+    for(size_t s = 0; s + 1 < num_bands_; s++)
+    {
+        // the lowpass and highpass of the split start from the same input
+        for(size_t n = 0; n < size; n++)
+            lanes[n * kMaxBands + s + 1] = lanes[n * kMaxBands + s];
+        RunStage(stages_[s][0], s, lanes, size);
+        RunStage(stages_[s][1], s, lanes, size);
+    }
+
+    for(size_t b = 0; b < num_bands_; b++)
+        for(size_t n = 0; n < size; n++)
+            bands[b][n] = lanes[n * kMaxBands + b];
+}
@@ -0,0 +1,118 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_CROSSOVER_H
+#define DSY_CROSSOVER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#ifdef __cplusplus
+
+/** @file crossover.h */
+
+namespace daisysp
+{
+/**
+    @brief Linkwitz-Riley crossover, splits a signal into 2 to 4 bands.
+
+    Each split is a 4th order Linkwitz-Riley lowpass/highpass pair (two
+    cascaded Butterworth sections), made of trapezoidal state variable
+    filters. The bands below a split go through the allpass that the pair
+    sums to, so the sum of all bands is an allpass: flat in magnitude, and
+    with the same phase in every band at every frequency.
+
+    The bands are kept as interleaved lanes while they are filtered. All
+    filters of a split share the same coefficients, and run as one pass
+    over the block per cascade stage, with the state of each lane in
+    separate arrays. Blocks longer than kMaxBlockSize are split.
+
+    \code
+    xover.Init(sample_rate, 3);
+    xover.SetFreq(0, 200.0f);
+    xover.SetFreq(1, 2000.0f);
+    ...
+    float* bands[3] = {low, mid, high};
+    xover.Process(in, bands, size);
+    \endcode
+*/
+class Crossover
+{
+  public:
+    static constexpr size_t kMaxBands  = 4;
+    static constexpr size_t kMaxSplits = kMaxBands - 1;
+
+    /** Largest block processed at once */
+    static constexpr size_t kMaxBlockSize = 64;
+
+    Crossover() {}
+    ~Crossover() {}
+
+    /** Initializes the crossover and clears its state.
+        \param sample_rate audio engine sample rate
+        \param num_bands number of bands, 2 to kMaxBands
+    */
+    void Init(float sample_rate, size_t num_bands = 3);
+
+    /** Changes the sample rate without clearing the filter state, and
+        recalculates the coefficients for the current frequencies.
+    */
+    void SetSampleRate(float sample_rate);
+
+    /** Sets the frequency of a split in Hz. Splits are counted from the
+        lowest one, and their frequencies should be increasing.
+        \param index 0 to GetNumBands() - 2
+        \param freq crossover frequency, clamped below Nyquist
+    */
+    void SetFreq(size_t index, float freq);
+
+    /** Frequency of a split in Hz */
+    inline float GetFreq(size_t index) const
+    {
+        return index < kMaxSplits ? freq_[index] : 0.0f;
+    }
+
+    inline size_t GetNumBands() const { return num_bands_; }
+
+    /** Splits a block.
+        \param in input
+        \param bands GetNumBands() outputs, lowest band first. They may
+               include the input.
+        \param size number of samples
+    */
+    void Process(const float* in, float* const* bands, size_t size);
+
+  private:
+    /** A set of state variable filters with the same coefficients, each
+        with its own state and output mix
+    */
+    struct Stage
+    {
+        float ic1[kMaxBands], ic2[kMaxBands];
+        // output = x * mix_x + bandpass * mix_bp + lowpass * mix_lp
+        float mix_x[kMaxBands], mix_bp[kMaxBands], mix_lp[kMaxBands];
+        // lanes run by this stage
+        size_t lo, hi;
+    };
+
+    void UpdateCoefficients(size_t split);
+    void RunStage(Stage& stage, size_t split, float* lanes, size_t size);
+    void ProcessChunk(const float* in, float* const* bands, size_t size);
+
+    float  sample_rate_;
+    size_t num_bands_;
+    float  freq_[kMaxSplits];
+    float  a1_[kMaxSplits], a2_[kMaxSplits], a3_[kMaxSplits];
+
+    // two stages per split, for the two sections of the Linkwitz-Riley
+    // filters
+    Stage stages_[kMaxSplits][2];
+};
+} // namespace daisysp
+#endif
+#endif
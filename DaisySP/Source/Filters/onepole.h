@@ -74,7 +74,7 @@ class OnePole
     {
         float lp;
         lp     = (g_ * in + state_) * gi_;
-        state_ = g_ * (in - lp) + lp;
+        state_ = flush_denormal(g_ * (in - lp) + lp);
 
         switch(mode_)
         {
@@ -47,6 +47,9 @@ void Svf::Process(float in)
     low_   = low_ + freq_ * band_;
     high_  = notch_ - low_;
     band_  = freq_ * high_ + band_ - drive_ * band_ * band_ * band_;
+    // keep the decaying states out of the subnormal range
+    low_  = flush_denormal(low_);
+    band_ = flush_denormal(band_);
     // average second pass outputs
     out_low_ += 0.5f * low_;
     out_high_ += 0.5f * high_;
@@ -68,6 +71,13 @@ void Svf::SetFreq(float f)
                 MIN(2.0f, 2.0f / freq_ - freq_ * 0.5f));
 }
 
+void Svf::SetSampleRate(float sample_rate)
+{
+    sr_     = sample_rate;
+    fc_max_ = sr_ / 3.f;
+    SetFreq(fc_);
+}
+
 void Svf::SetRes(float r)
 {
     float res = fclamp(r, 0.f, 1.f);
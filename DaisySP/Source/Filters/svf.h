@@ -54,6 +54,12 @@ class Svf
         affects the response of the resonance of the filter
     */
     void SetDrive(float d);
+
+    /** Changes the sample rate without clearing the filter state, and
+        recalculates the coefficients for the current cutoff.
+    */
+    void SetSampleRate(float sample_rate);
+
     /** lowpass output
         \return low pass output of the filter
     */
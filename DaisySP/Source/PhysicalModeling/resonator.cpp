@@ -1,4 +1,5 @@
 #include "resonator.h"
+#include "Utility/lut.h"
 #include <math.h>
 
 using namespace daisysp;
@@ -16,7 +17,7 @@ void Resonator::Init(float position, int resolution, float sample_rate)
 
     for(int i = 0; i < resolution; ++i)
     {
-        mode_amplitude_[i] = cos(position * TWOPI_F) * 0.25f;
+        mode_amplitude_[i] = lut_cos(position) * 0.25f;
     }
 
     for(int i = 0; i < kMaxNumModes / kModeBatchSize; ++i)
@@ -55,8 +56,7 @@ float Resonator::Process(const float in)
     float harmonic       = f0;
     float stretch_factor = 1.0f;
 
-    float input  = damping_ * 79.7f;
-    float q_sqrt = powf(2.f, input * ratiofrac_);
+    float q_sqrt = lut_semitones_to_ratio(damping_ * 79.7f);
 
     float q = 500.0f * q_sqrt * q_sqrt;
     brightness *= 1.0f - structure_ * 0.3f;
@@ -152,7 +152,7 @@ float Resonator::CalcStiff(float sig)
         sig -= .9f;
         sig *= 10; // div by .1
         sig *= sig;
-        sig = 1.5 - cos(sig * PI_F) * .5f;
+        sig = 1.5 - lut_cos(sig * 0.5f) * .5f;
     }
     return sig;
 }
@@ -106,7 +106,154 @@ class ResonatorSvf
         }
     }
 
+    /** Filters a block through all lanes and sums the lane outputs, with
+        the coefficients computed once per block. The lane gains ramp
+        linearly from `gain` to `gain_end` over the block.
+        With `lane_input`, `in` holds one interleaved input per lane,
+        in[n * batch_size + lane], as written by ProcessLanes().
+    */
+    template <FilterMode mode, bool add, bool lane_input = false>
+    void ProcessBlock(const float* f,
+                      const float* q,
+                      const float* gain,
+                      const float* gain_end,
+                      const float* in,
+                      float*       out,
+                      size_t       size)
+    {
+        Block block;
+        Prepare<mode>(f, q, block);
+        float gains[batch_size];
+        float gains_inc[batch_size];
+        for(int i = 0; i < batch_size; ++i)
+        {
+            gains[i]     = gain[i] * block.scale[i];
+            gains_inc[i] = size > 0 ? (gain_end[i] * block.scale[i] - gains[i])
+                                          / size
+                                    : 0.0f;
+        }
+
+        for(size_t n = 0; n < size; ++n)
+        {
+            float s_out = 0.0f;
+            for(int i = 0; i < batch_size; ++i)
+            {
+                const float x = lane_input ? in[n * batch_size + i] : in[n];
+                s_out += gains[i] * Tick<mode>(x, block, i);
+                gains[i] += gains_inc[i];
+            }
+            out[n] = add ? out[n] + s_out : s_out;
+        }
+        Store(block);
+    }
+
+    /** Filters a block through all lanes, and writes the lane outputs
+        interleaved to lanes[n * batch_size + lane], e.g. to cascade two
+        banks.
+    */
+    template <FilterMode mode, bool lane_input = false>
+    void ProcessLanes(const float* f,
+                      const float* q,
+                      const float* in,
+                      float*       lanes,
+                      size_t       size)
+    {
+        Block block;
+        Prepare<mode>(f, q, block);
+        for(size_t n = 0; n < size; ++n)
+        {
+            for(int i = 0; i < batch_size; ++i)
+            {
+                const float x = lane_input ? in[n * batch_size + i] : in[n];
+                const float y = Tick<mode>(x, block, i);
+                lanes[n * batch_size + i] = block.scale[i] * y;
+            }
+        }
+        Store(block);
+    }
+
+    /** Filters a block through all lanes and adds the sum of the squared
+        output of each lane to `energy`, e.g. for envelope followers.
+    */
+    template <FilterMode mode, bool lane_input = false>
+    void Analyze(const float* f,
+                 const float* q,
+                 const float* in,
+                 float*       energy,
+                 size_t       size)
+    {
+        Block block;
+        Prepare<mode>(f, q, block);
+        float sum[batch_size];
+        for(int i = 0; i < batch_size; ++i)
+            sum[i] = 0.0f;
+
+        for(size_t n = 0; n < size; ++n)
+        {
+            for(int i = 0; i < batch_size; ++i)
+            {
+                const float x = lane_input ? in[n * batch_size + i] : in[n];
+                const float y = Tick<mode>(x, block, i);
+                sum[i] += y * y;
+            }
+        }
+
+        for(int i = 0; i < batch_size; ++i)
+            energy[i] += sum[i] * block.scale[i] * block.scale[i];
+        Store(block);
+    }
+
   private:
+    /** Coefficients and state of all lanes for a block */
+    struct Block
+    {
+        float g[batch_size];
+        float r_plus_g[batch_size];
+        float h[batch_size];
+        float scale[batch_size];
+        float state_1[batch_size];
+        float state_2[batch_size];
+    };
+
+    template <FilterMode mode>
+    void Prepare(const float* f, const float* q, Block& block) const
+    {
+        for(int i = 0; i < batch_size; ++i)
+        {
+            const float r     = 1.0f / q[i];
+            const float g     = fasttan(f[i]);
+            block.g[i]        = g;
+            block.h[i]        = 1.0f / (1.0f + r * g + g * g);
+            block.r_plus_g[i] = r + g;
+            block.scale[i]    = mode == BAND_PASS_NORMALIZED ? r : 1.0f;
+            block.state_1[i]  = state_1_[i];
+            block.state_2[i]  = state_2_[i];
+        }
+    }
+
+    void Store(const Block& block)
+    {
+        for(int i = 0; i < batch_size; ++i)
+        {
+            state_1_[i] = flush_denormal(block.state_1[i]);
+            state_2_[i] = flush_denormal(block.state_2[i]);
+        }
+    }
+
+    template <FilterMode mode>
+    static inline float Tick(float in, Block& block, int i)
+    {
+        const float g  = block.g[i];
+        const float hp = (in - block.r_plus_g[i] * block.state_1[i]
+                          - block.state_2[i])
+                         * block.h[i];
+        const float bp   = g * hp + block.state_1[i];
+        block.state_1[i] = g * hp + bp;
+        const float lp   = g * bp + block.state_2[i];
+        block.state_2[i] = g * bp + lp;
+        return mode == LOW_PASS ? lp : (mode == HIGH_PASS ? hp : bp);
+    }
+
     static constexpr float kPiPow3 = PI_F * PI_F * PI_F;
     static constexpr float kPiPow5 = kPiPow3 * PI_F * PI_F;
     static inline float    fasttan(float f)
@@ -174,7 +321,6 @@ class Resonator
 
     static constexpr int   kMaxNumModes   = 24;
     static constexpr int   kModeBatchSize = 4;
-    static constexpr float ratiofrac_     = 1.f / 12.f;
     static constexpr float stiff_frac_    = 1.f / 64.f;
     static constexpr float stiff_frac_2   = 1.f / .6f;
 
@@ -1,4 +1,5 @@
 #include "granularplayer.h"
+#include "Utility/lut.h"
 
 using namespace daisysp;
 
@@ -15,11 +16,6 @@ void GranularPlayer::Init(float* sample, int size, float sample_rate)
     phsImp2_.Init(sample_rate_, 0, 0);
     /*calculate sample frequency*/
     sample_frequency_ = sample_rate_ / size_;
-    /*initialize half cosine envelope*/
-    for(int i = 0; i < 256; i++)
-    {
-        cosEnv_[i] = sinf((i / 256.0f) * M_PI);
-    }
 }
 
 uint32_t GranularPlayer::WrapIdx(uint32_t idx, uint32_t sz)
@@ -37,7 +33,7 @@ uint32_t GranularPlayer::WrapIdx(uint32_t idx, uint32_t sz)
 float GranularPlayer::CentsToRatio(float cents)
 {
     /*converts cents to  ratio*/
-    return powf(2.0f, cents / 1200.0f);
+    return lut_semitones_to_ratio(cents * 0.01f);
 }
 
 
@@ -73,7 +69,7 @@ float GranularPlayer::Process(float speed,
                    * MsToSamps(grain_size_, sample_rate_));
     idx_        = WrapIdx((uint32_t)(idxSpeed_ + idxTransp_), size_);
     idx2_       = WrapIdx((uint32_t)(idxSpeed2_ + idxTransp2_), size_);
-    sig_        = sample_[idx_] * cosEnv_[(uint32_t)(phs_.Process() * 256)];
-    sig2_       = sample_[idx2_] * cosEnv_[(uint32_t)(phs2_.Process() * 256)];
+    sig_        = sample_[idx_] * lut_sine_window(phs_.Process());
+    sig2_       = sample_[idx2_] * lut_sine_window(phs2_.Process());
     return (sig_ + sig2_) / 2;
 }
\ No newline at end of file
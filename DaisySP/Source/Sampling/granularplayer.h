@@ -72,7 +72,6 @@ class GranularPlayer
     float  speed_;         //processed playback speed.
     float  transposition_; //processed transpotion.
     float  sample_frequency_;
-    float  cosEnv_[256] = {0}; //cosine envelope for crossfading between grains
     float
         idxTransp_; // Adjusted Transposition value contribution to idx of first grain
     float
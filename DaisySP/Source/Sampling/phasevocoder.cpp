@@ -0,0 +1,327 @@
+#include "phasevocoder.h"
+#include "Utility/dsp.h"
+#include "Utility/lut.h"
+#include <math.h>
+#include <string.h>
+
+using namespace daisysp;
+
+namespace
+{
+// bins below this magnitude are not considered as peaks
+constexpr float kPeakFloor = 1.0e-9f;
+
+// wraps a phase in cycles to [-0.5, 0.5]
+inline float WrapPhase(float phase)
+{
+    return phase - floorf(phase + 0.5f);
+}
+} // namespace
+
+bool PhaseVocoder::Init(const float* sample,
+                        size_t       size,
+                        float*       buffer,
+                        size_t       fft_size)
+{
+    if(sample == nullptr || size == 0 || !fft_.Init(fft_size))
+        return false;
+
+    sample_   = sample;
+    size_     = size;
+    fft_size_ = fft_size;
+    hop_      = fft_size / kOverlap;
+    num_bins_ = fft_size / 2 + 1;
+    out_size_ = fft_size + hop_;
+
+    window_           = buffer;
+    frame_            = window_ + fft_size;
+    spectrum_         = frame_ + fft_size;
+    out_ring_         = spectrum_ + fft_size;
+    magnitude_        = out_ring_ + out_size_;
+    phase_            = magnitude_ + num_bins_;
+    prev_phase_       = phase_ + num_bins_;
+    synth_phase_      = prev_phase_ + num_bins_;
+    prev_synth_phase_ = synth_phase_ + num_bins_;
+
+    // periodic Hann window for analysis and synthesis, the squared window
+    // overlapped at fft_size / 4 sums to 1.5
+    for(size_t n = 0; n < fft_size; n++)
+        window_[n] = 0.5f - 0.5f * cosf(TWOPI_F * n / fft_size);
+    synth_gain_ = static_cast<float>(hop_) / (0.375f * fft_size);
+
+    memset(out_ring_, 0, out_size_ * sizeof(float));
+    memset(prev_phase_, 0, num_bins_ * sizeof(float));
+    memset(prev_synth_phase_, 0, num_bins_ * sizeof(float));
+
+    speed_           = 1.0f;
+    pitch_           = 1.0f;
+    transient_ratio_ = 2.0f;
+    position_        = 0.0f;
+    prev_energy_     = 0.0f;
+    next_hop_        = 0;
+    loop_            = true;
+    done_            = false;
+    reset_           = true;
+    out_pos_         = 0;
+    StartFrame();
+    return true;
+}
+
+void PhaseVocoder::SetTransposition(float cents)
+{
+    pitch_ = lut_semitones_to_ratio(fclamp(cents, -2400.0f, 2400.0f) * 0.01f);
+}
+
+void PhaseVocoder::SetPosition(float position)
+{
+    position_ = fclamp(position, 0.0f, static_cast<float>(size_));
+    next_hop_ = 0;
+    done_     = false;
+    reset_    = true;
+}
+
+void PhaseVocoder::Process(float* out, size_t size)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        out[i]              = out_ring_[out_pos_];
+        out_ring_[out_pos_] = 0.0f;
+        if(++out_pos_ >= out_size_)
+            out_pos_ = 0;
+
+        if(++since_frame_ >= hop_)
+        {
+            // the previous frame is due now, finish what's left of it
+            while(stage_ != STAGE_DONE)
+                RunStage();
+            StartFrame();
+        }
+    }
+
+    // spread the remaining stages evenly over the calls until the next
+    // frame is due, counting this one
+    if(stage_ != STAGE_DONE && size > 0)
+    {
+        const size_t remaining  = STAGE_DONE - stage_;
+        const size_t samples    = hop_ - since_frame_;
+        const size_t calls_left = (samples + size - 1) / size + 1;
+        size_t       num_stages = (remaining + calls_left - 1) / calls_left;
+        while(num_stages-- > 0)
+            RunStage();
+    }
+}
+
+void PhaseVocoder::StartFrame()
+{
+    frame_start_ = static_cast<int32_t>(floorf(position_)) - fft_size_ / 2;
+    frame_hop_   = next_hop_;
+
+    // the position of the next frame
+    const float next = position_ + speed_ * hop_;
+    next_hop_ = static_cast<int32_t>(floorf(next))
+                - static_cast<int32_t>(floorf(position_));
+    position_ = next;
+    const float end = static_cast<float>(size_);
+    if(loop_)
+    {
+        while(position_ >= end)
+            position_ -= end;
+        while(position_ < 0.0f)
+            position_ += end;
+    }
+    else if(position_ >= end || position_ < 0.0f)
+    {
+        position_ = fclamp(position_, 0.0f, end);
+        done_     = true;
+    }
+
+    // the frame is overlap-added one hop from now, see Stft
+    frame_origin_ = out_pos_ + hop_;
+    if(frame_origin_ >= out_size_)
+        frame_origin_ -= out_size_;
+    since_frame_ = 0;
+    stage_       = STAGE_ANALYSIS;
+}
+
+void PhaseVocoder::RunStage()
+{
+    switch(stage_)
+    {
+        case STAGE_ANALYSIS: Analyze(); break;
+        case STAGE_POLAR: ToPolar(); break;
+        case STAGE_LOCK: Lock(); break;
+        case STAGE_INVERSE: fft_.Inverse(spectrum_, frame_); break;
+        case STAGE_OVERLAP_ADD: OverlapAdd(); break;
+        default: break;
+    }
+    stage_ = static_cast<Stage>(stage_ + 1);
+}
+
+float PhaseVocoder::Read(int32_t index) const
+{
+    const int32_t size = static_cast<int32_t>(size_);
+    if(loop_)
+    {
+        index %= size;
+        if(index < 0)
+            index += size;
+        return sample_[index];
+    }
+    return index >= 0 && index < size ? sample_[index] : 0.0f;
+}
+
+void PhaseVocoder::Analyze()
+{
+    if(done_)
+    {
+        memset(frame_, 0, fft_size_ * sizeof(float));
+    }
+    else
+    {
+        for(size_t n = 0; n < fft_size_; n++)
+            frame_[n] = Read(frame_start_ + static_cast<int32_t>(n))
+                        * window_[n];
+    }
+    fft_.Forward(frame_, spectrum_);
+}
+
+void PhaseVocoder::ToPolar()
+{
+    const size_t nyquist = num_bins_ - 1;
+    energy_              = 0.0f;
+    for(size_t k = 0; k < num_bins_; k++)
+    {
+        // bins 0 and N / 2 are real, and packed into the first two floats
+        const bool  real = k == 0 || k == nyquist;
+        const float re   = k == 0 ? spectrum_[0]
+                                  : (real ? spectrum_[1] : spectrum_[2 * k]);
+        const float im   = real ? 0.0f : spectrum_[2 * k + 1];
+        magnitude_[k]    = sqrtf(re * re + im * im);
+        phase_[k]        = atan2f(im, re) * (0.5f / PI_F);
+        energy_ += magnitude_[k];
+    }
+}
+
+void PhaseVocoder::Lock()
+{
+    // the threshold is for one hop of the sample, frames that are closer
+    // together in the sample need less of a rise
+    const float hops      = fabsf(static_cast<float>(frame_hop_)) / hop_;
+    const float threshold = powf(transient_ratio_, hops) * prev_energy_;
+    const bool  transient
+        = transient_ratio_ >= 1.0f && frame_hop_ != 0 && energy_ > threshold;
+    const bool reset = reset_ || transient;
+
+    memset(spectrum_, 0, fft_size_ * sizeof(float));
+    memset(synth_phase_, 0, num_bins_ * sizeof(float));
+
+    // each bin belongs to the region of the nearest peak
+    const float* mag       = magnitude_;
+    const size_t last      = num_bins_ - 1;
+    size_t       region_lo = 0;
+    size_t       prev_peak = 0;
+    bool         have_peak = false;
+    for(size_t k = 1; k < last; k++)
+    {
+        if(mag[k] <= kPeakFloor || mag[k] <= mag[k - 1] || mag[k] < mag[k + 1]
+           || (k >= 2 && mag[k] <= mag[k - 2])
+           || (k + 2 <= last && mag[k] < mag[k + 2]))
+            continue;
+        if(have_peak)
+        {
+            const size_t region_hi = (prev_peak + k) / 2;
+            ShiftRegion(prev_peak, region_lo, region_hi, reset);
+            region_lo = region_hi + 1;
+        }
+        prev_peak = k;
+        have_peak = true;
+    }
+    if(have_peak)
+        ShiftRegion(prev_peak, region_lo, last, reset);
+
+    // the analysis and synthesis phases of this frame are the previous
+    // ones of the next frame
+    float* tmp        = prev_phase_;
+    prev_phase_       = phase_;
+    phase_            = tmp;
+    tmp               = prev_synth_phase_;
+    prev_synth_phase_ = synth_phase_;
+    synth_phase_      = tmp;
+    prev_energy_      = energy_;
+    reset_            = false;
+}
+
+void PhaseVocoder::ShiftRegion(size_t peak, size_t lo, size_t hi, bool reset)
+{
+    const int32_t target = static_cast<int32_t>(peak * pitch_ + 0.5f);
+    const int32_t shift  = target - static_cast<int32_t>(peak);
+    const int32_t last   = static_cast<int32_t>(num_bins_) - 1;
+    if(target > last)
+        return;
+
+    // rotating the whole region by the phase advance of its peak keeps the
+    // phase relations within the region, and the partial coherent
+    float rotation = 0.0f;
+    if(!reset)
+    {
+        // frequency of the peak in cycles per sample, from its phase advance
+        float freq = static_cast<float>(peak) / fft_size_;
+        if(frame_hop_ != 0)
+        {
+            const float expected = freq * frame_hop_;
+            freq += WrapPhase(phase_[peak] - prev_phase_[peak] - expected)
+                    / frame_hop_;
+        }
+        else
+        {
+            // a frozen frame has no phase advance, interpolate the peak of
+            // the log magnitudes instead
+            const float a     = logf(magnitude_[peak - 1] + kPeakFloor);
+            const float b     = logf(magnitude_[peak]);
+            const float c     = logf(magnitude_[peak + 1] + kPeakFloor);
+            const float curve = a - 2.0f * b + c;
+            // a flat peak, flattened further by the floor of its
+            // neighbours, stays at the centre of its bin
+            if(curve < -1e-6f)
+            {
+                const float offset = 0.5f * (a - c) / curve;
+                freq += fclamp(offset, -0.5f, 0.5f) / fft_size_;
+            }
+        }
+        // the output phases are kept per analysis bin, as the shifted
+        // regions of neighbouring peaks may overlap
+        const float advance = freq * pitch_ * hop_;
+        rotation = WrapPhase(prev_synth_phase_[peak] + advance - phase_[peak]);
+    }
+
+    for(size_t k = lo; k <= hi; k++)
+    {
+        const int32_t t = static_cast<int32_t>(k) + shift;
+        if(t < 0 || t > last)
+            continue;
+        const float phase = WrapPhase(phase_[k] + rotation);
+        const float re    = magnitude_[k] * lut_cos(phase);
+        const float im    = magnitude_[k] * lut_sin(phase);
+        synth_phase_[k]   = phase;
+        if(t == 0)
+            spectrum_[0] += re;
+        else if(t == last)
+            spectrum_[1] += re;
+        else
+        {
+            spectrum_[2 * t] += re;
+            spectrum_[2 * t + 1] += im;
+        }
+    }
+}
+
+void PhaseVocoder::OverlapAdd()
+{
+    size_t pos = frame_origin_;
+    for(size_t n = 0; n < fft_size_; n++)
+    {
+        out_ring_[pos] += frame_[n] * window_[n] * synth_gain_;
+        if(++pos >= out_size_)
+            pos = 0;
+    }
+}
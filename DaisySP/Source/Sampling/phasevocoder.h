@@ -0,0 +1,160 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_PHASEVOCODER_H
+#define DSY_PHASEVOCODER_H
+#include <stdint.h>
+#include <stddef.h>
+#include "Spectral/fft.h"
+#ifdef __cplusplus
+
+namespace daisysp
+{
+/** Phase vocoder sample player with independent time stretching and
+    pitch shifting.
+
+    Like GranularPlayer, it plays a sample from memory, e.g. SDRAM, but
+    instead of crossfading grains it resynthesizes overlapping FFT frames,
+    which avoids the grainy sound at large stretch factors.
+
+    - Phases are locked to the nearest spectral peak (identity phase
+      locking), which keeps partials coherent and reduces phasiness.
+    - Pitch shifting moves the region around each peak in the spectrum,
+      so no resampling is needed and the formants move with the pitch.
+    - A sudden rise in the frame energy is treated as a transient, and the
+      phases are reset to the ones of the sample, which keeps attacks sharp.
+
+    A frame is processed every hop of fft_size / 4 samples. Its work is
+    split into stages that are spread over the Process() calls of a hop,
+    so the cost per audio block stays about constant.
+
+    \code
+    float DSY_SDRAM_BSS pv_mem[PhaseVocoder::GetBufferSize(2048)];
+    pv.Init(sample, sample_size, pv_mem, 2048);
+    pv.SetSpeed(0.5f);
+    pv.SetTransposition(700.0f);
+    \endcode
+*/
+class PhaseVocoder
+{
+  public:
+    /** Frames overlap by this factor, the hop is fft_size / kOverlap */
+    static constexpr size_t kOverlap = 4;
+
+    PhaseVocoder() {}
+    ~PhaseVocoder() {}
+
+    /** Returns the number of floats Init() needs */
+    static constexpr size_t GetBufferSize(size_t fft_size)
+    {
+        // window, frame, spectrum, output ring, five arrays of bins
+        return 4 * fft_size + fft_size / kOverlap + 5 * (fft_size / 2 + 1);
+    }
+
+    /** Initializes the player.
+        \param sample pointer to the sample to be played
+        \param size number of elements in the sample array
+        \param buffer memory of at least GetBufferSize(fft_size) floats
+        \param fft_size power of two from RealFft::kMinSize to RealFft::kMaxSize
+        \return false if the sample is empty or the FFT size is not
+        supported
+    */
+    bool Init(const float* sample,
+              size_t       size,
+              float*       buffer,
+              size_t       fft_size);
+
+    /** Renders a block of output */
+    void Process(float* out, size_t size);
+
+    /** Playback speed. 1 is normal speed, 0.5 half speed, 0 freezes the
+        sound and negative values play the sample backwards.
+    */
+    inline void SetSpeed(float speed) { speed_ = speed; }
+
+    /** Transposition in cents, -2400 to 2400 */
+    void SetTransposition(float cents);
+
+    /** Loops the sample when true, otherwise playback stops at the ends */
+    inline void SetLoop(bool loop) { loop_ = loop; }
+
+    /** Moves the playback position, in samples */
+    void SetPosition(float position);
+
+    /** Energy ratio between consecutive frames above which a frame is
+        treated as a transient. Values below 1 disable the detection.
+    */
+    inline void SetTransientThreshold(float ratio)
+    {
+        transient_ratio_ = ratio;
+    }
+
+    /** Current playback position in samples, of the next frame */
+    inline float GetPosition() const { return position_; }
+
+    /** True when playback reached the end of the sample without looping */
+    inline bool IsDone() const { return done_; }
+
+    /** Delay from the playback position to the output, in samples */
+    inline size_t GetLatency() const { return hop_ + fft_size_ / 2; }
+
+    inline size_t GetFftSize() const { return fft_size_; }
+    inline size_t GetHop() const { return hop_; }
+
+  private:
+    enum Stage
+    {
+        STAGE_ANALYSIS,
+        STAGE_POLAR,
+        STAGE_LOCK,
+        STAGE_INVERSE,
+        STAGE_OVERLAP_ADD,
+        STAGE_DONE,
+    };
+
+    void  StartFrame();
+    void  RunStage();
+    void  Analyze();
+    void  ToPolar();
+    void  Lock();
+    void  ShiftRegion(size_t peak, size_t lo, size_t hi, bool reset);
+    void  OverlapAdd();
+    float Read(int32_t index) const;
+
+    RealFft      fft_;
+    const float* sample_;
+    size_t       size_;
+    size_t       fft_size_, hop_, num_bins_, out_size_;
+    float        synth_gain_;
+
+    float* window_;
+    float* frame_;
+    float* spectrum_;
+    float* out_ring_;
+    float* magnitude_;
+    float* phase_;       // analysis phases in cycles
+    float* prev_phase_;  // of the previous frame
+    float* synth_phase_; // output phases of the analysis bins, in cycles
+    float* prev_synth_phase_;
+
+    float   speed_, pitch_, transient_ratio_;
+    float   position_;
+    float   energy_, prev_energy_;
+    int32_t frame_start_; // first sample of the frame being processed
+    int32_t frame_hop_;   // analysis hop to the frame being processed
+    int32_t next_hop_;
+    bool    loop_, done_, reset_;
+
+    size_t out_pos_, since_frame_, frame_origin_;
+    Stage  stage_;
+};
+
+} // namespace daisysp
+#endif
+#endif
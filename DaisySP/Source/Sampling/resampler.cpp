@@ -0,0 +1,219 @@
+#include <string.h>
+#include "resampler.h"
+#include "Utility/lut.h"
+#if(defined(USE_ARM_DSP) && defined(__arm__))
+#include <arm_math.h>
+#endif
+
+using namespace daisysp;
+
+namespace
+{
+/** Kernel of N taps at 2^kBits phases per sample. Row p holds the taps
+    for an output at p / 2^kBits samples after the center of the window,
+    the extra last row ends the interpolation between the phases, and a
+    zero pads the end of the kernel.
+*/
+template <size_t N, size_t kBits>
+struct SincTable
+{
+    static constexpr size_t kTaps   = N;
+    static constexpr size_t kPhases = size_t(1) << kBits;
+    static constexpr size_t kSize   = (kPhases + 1) * N + 1;
+
+    float data[kSize];
+};
+
+constexpr double BesselI0(double x)
+{
+    double term = 1.0, sum = 1.0;
+    for(int k = 1; k < 40; k++)
+    {
+        const double t = x / (2.0 * k);
+        term *= t * t;
+        sum += term;
+    }
+    return sum;
+}
+
+/** Sinc with its first zero at 1 / cutoff, Kaiser window over the taps.
+    Each phase is normalized to a gain of 1 at DC.
+*/
+template <size_t N, size_t kBits>
+constexpr SincTable<N, kBits> MakeSincTable(double cutoff, double beta)
+{
+    typedef SincTable<N, kBits> Table;
+    Table        table{};
+    const double half = 0.5 * N;
+    for(size_t p = 0; p <= Table::kPhases; p++)
+    {
+        double row[N]{};
+        double sum = 0.0;
+        for(size_t k = 0; k < N; k++)
+        {
+            const double t = k - half + 1.0 - double(p) / Table::kPhases;
+            const double x = t / half;
+            if(x <= -1.0 || x >= 1.0)
+                continue;
+            const double arg  = lut_math::kPi * cutoff * t;
+            const double sinc = t == 0.0 ? 1.0 : lut_math::Sin(arg) / arg;
+            const double window
+                = BesselI0(beta * lut_math::Sqrt(1.0 - x * x)) / BesselI0(beta);
+            row[k] = cutoff * sinc * window;
+            sum += row[k];
+        }
+        for(size_t k = 0; k < N; k++)
+            table.data[p * N + k] = static_cast<float>(row[k] / sum);
+    }
+    return table;
+}
+
+constexpr SincTable<8, 5>  kFastTable = MakeSincTable<8, 5>(0.80, 5.0);
+constexpr SincTable<24, 7> kStandardTable
+    = MakeSincTable<24, 7>(0.90, 8.0);
+constexpr SincTable<48, 7> kHighTable = MakeSincTable<48, 7>(0.93, 10.0);
+
+/** Point u of a kernel of n taps at 2^bits points per tap, which is tap
+    u >> bits of the phase 2^bits - (u & mask)
+*/
+inline float KernelAt(const float* table, size_t n, size_t bits, size_t u)
+{
+    const size_t phases = size_t(1) << bits;
+    return table[(phases - (u & (phases - 1))) * n + (u >> bits)];
+}
+
+/** Inner product of n samples, n a multiple of 4 */
+inline float Dot(const float* a, const float* b, size_t n)
+{
+#if(defined(USE_ARM_DSP) && defined(__arm__))
+    float result;
+    arm_dot_prod_f32(const_cast<float*>(a), const_cast<float*>(b), n, &result);
+    return result;
+#else
+    // independent sums let the compiler use vector instructions
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+    for(size_t i = 0; i < n; i += 4)
+    {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    return (s0 + s1) + (s2 + s3);
+#endif
+}
+} // namespace
+
+void Resampler::Init(Quality quality, float max_ratio)
+{
+    quality_ = quality;
+    switch(quality)
+    {
+        case Quality::FAST:
+            table_      = kFastTable.data;
+            num_taps_   = kFastTable.kTaps;
+            phase_bits_ = 5;
+            break;
+        case Quality::HIGH:
+            table_      = kHighTable.data;
+            num_taps_   = kHighTable.kTaps;
+            phase_bits_ = 7;
+            break;
+        default:
+            table_      = kStandardTable.data;
+            num_taps_   = kStandardTable.kTaps;
+            phase_bits_ = 7;
+            break;
+    }
+
+    max_ratio_ = max_ratio < 1.0f ? 1.0f : max_ratio;
+    max_ratio_ = max_ratio_ > kMaxRatio ? kMaxRatio : max_ratio_;
+
+    // the window is centered at a fixed delay, so that the longer kernels
+    // of higher ratios still fit before the newest sample
+    const size_t half = static_cast<size_t>(num_taps_ * max_ratio_) / 2;
+    length_           = 2 * half;
+    latency_          = half;
+
+    Reset();
+    SetRatio(1.0f);
+}
+
+void Resampler::Reset()
+{
+    memset(line_, 0, sizeof(line_));
+    write_ = 0;
+    frac_  = 0;
+}
+
+void Resampler::SetRatio(float ratio)
+{
+    ratio  = ratio < kMinRatio ? kMinRatio : ratio;
+    ratio  = ratio > kMaxRatio ? kMaxRatio : ratio;
+    ratio_ = ratio;
+    step_  = static_cast<uint64_t>(double(ratio) * 4294967296.0 + 0.5);
+
+    if(ratio > 1.0f)
+    {
+        const float stretch = ratio < max_ratio_ ? ratio : max_ratio_;
+        stretched_taps_     = 2 * static_cast<size_t>(num_taps_ * stretch / 2);
+        scale_              = 1.0f / stretch;
+    }
+    else
+    {
+        stretched_taps_ = 0;
+        scale_          = 1.0f;
+    }
+}
+
+void Resampler::Process(const float* in, float* out, size_t size)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        out[i] = Convolve(&line_[write_ + length_ - 1]);
+
+        const uint64_t pos = frac_ + step_;
+        frac_              = static_cast<uint32_t>(pos);
+        for(uint32_t n = static_cast<uint32_t>(pos >> 32); n > 0; n--)
+            Write(*in++);
+    }
+}
+
+float Resampler::Convolve(const float* newest) const
+{
+    const size_t n     = num_taps_;
+    const size_t shift = 32 - phase_bits_;
+
+    if(stretched_taps_ == 0)
+    {
+        // the two phases around the position, and the weight between them
+        const float* x     = newest - latency_ - n / 2 + 1;
+        const float* row   = &table_[(frac_ >> shift) * n];
+        const float  alpha = static_cast<float>(frac_ & ((1u << shift) - 1))
+                            * (1.0f / static_cast<float>(1u << shift));
+        const float a = Dot(x, row, n);
+        const float b = Dot(x, row + n, n);
+        return a + (b - a) * alpha;
+    }
+
+    // The kernel stretched by 1 / scale_, read at its own resolution of
+    // 2^phase_bits_ points per tap. The zero after the last row ends it.
+    const size_t m     = stretched_taps_;
+    const float  steps = static_cast<float>(size_t(1) << phase_bits_);
+    const float  f     = static_cast<float>(frac_ >> 8) * (1.0f / 16777216.0f);
+    const float  du    = scale_ * steps;
+    float        u     = (0.5f * n - (0.5f * m - 1.0f + f) * scale_) * steps;
+    u                  = u > 0.0f ? u : 0.0f;
+
+    const float* x   = newest - latency_ - m / 2 + 1;
+    float        sum = 0.0f;
+    for(size_t j = 0; j < m; j++, u += du)
+    {
+        const size_t ui    = static_cast<size_t>(u);
+        const float  alpha = u - static_cast<float>(ui);
+        const float  a     = KernelAt(table_, n, phase_bits_, ui);
+        const float  b     = KernelAt(table_, n, phase_bits_, ui + 1);
+        sum += x[j] * (a + (b - a) * alpha);
+    }
+    return sum * scale_;
+}
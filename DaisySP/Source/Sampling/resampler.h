@@ -0,0 +1,152 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_RESAMPLER_H
+#define DSY_RESAMPLER_H
+#include <stdint.h>
+#include <stddef.h>
+#ifdef __cplusplus
+
+namespace daisysp
+{
+/** Polyphase windowed sinc sample rate converter for one channel.
+
+    Converts a stream at any ratio of input to output samples, e.g. a
+    44.1 kHz file played on a 48 kHz engine, or a sample played at another
+    pitch. The ratio can change on every block without clicks.
+
+    The Kaiser windowed sinc kernels are built at compile time (see lut.h)
+    as a table of phases, with the taps of each phase next to each other.
+    An output sample is the inner product of the input with the two phases
+    around its position, interpolated linearly, so the inner loops are
+    plain dot products, done by CMSIS-DSP arm_dot_prod_f32 when
+    USE_ARM_DSP is defined. When the ratio is above 1, the kernel is
+    stretched to lower its cutoff below the output Nyquist frequency, and
+    gets longer in proportion, up to the max ratio given to Init().
+
+    The presets trade the kernel length, and so the CPU, for the distortion
+    and the rejection of aliases:
+    - FAST: 8 taps, for modulated playback of many voices
+    - STANDARD: 24 taps, for most file playback
+    - HIGH: 48 taps, for offline or critical conversions
+
+    Process() reads exactly GetInputNeeded() input samples for a block, so
+    the caller pulls that many from its source:
+    \code
+    Resampler rs;
+    rs.Init(Resampler::Quality::STANDARD);
+    rs.SetRates(44100.0f, 48000.0f);
+
+    void AudioCallback(...)
+    {
+        float  in[Resampler::kMaxInput];
+        size_t needed = rs.GetInputNeeded(size);
+        source.Read(in, needed);
+        rs.Process(in, out, size);
+    }
+    \endcode
+    Channels of a multichannel stream are converted by one Resampler each,
+    with the same ratio, they stay in sync.
+*/
+class Resampler
+{
+  public:
+    enum class Quality
+    {
+        FAST,
+        STANDARD,
+        HIGH,
+    };
+
+    /** Highest ratio of input to output samples */
+    static constexpr float kMaxRatio = 4.0f;
+    /** Lowest ratio of input to output samples */
+    static constexpr float kMinRatio = 1.0f / 64.0f;
+    /** Longest stretched kernel, HIGH at kMaxRatio */
+    static constexpr size_t kMaxTaps = 48 * 4;
+    /** Most input samples read by a 48 sample block, at kMaxRatio */
+    static constexpr size_t kMaxInput = 48 * 4 + 1;
+
+    Resampler() {}
+    ~Resampler() {}
+
+    /** Initializes the converter with a ratio of 1.
+        \param quality length of the kernel
+        \param max_ratio highest ratio that SetRatio() will be called with,
+        from 1 to kMaxRatio. Above it the kernel is not stretched further,
+        and the output aliases. The latency grows with it.
+    */
+    void Init(Quality quality = Quality::STANDARD, float max_ratio = 2.0f);
+
+    /** Clears the history and the phase, keeps the ratio */
+    void Reset();
+
+    /** Sets the number of input samples per output sample, e.g. 0.5 to
+        play at half speed. Takes effect at the next Process().
+        \param ratio from kMinRatio to kMaxRatio
+    */
+    void SetRatio(float ratio);
+
+    /** Sets the ratio from the rate of the input and of the output */
+    inline void SetRates(float in_rate, float out_rate)
+    {
+        SetRatio(in_rate / out_rate);
+    }
+
+    inline float GetRatio() const { return ratio_; }
+
+    /** \return the number of input samples that Process() reads for size
+        output samples at the current ratio and phase
+    */
+    inline size_t GetInputNeeded(size_t size) const
+    {
+        return static_cast<size_t>((frac_ + step_ * size) >> 32);
+    }
+
+    /** Converts a block.
+        \param in GetInputNeeded(size) input samples
+        \param out size output samples
+    */
+    void Process(const float* in, float* out, size_t size);
+
+    /** \return the delay of the output, in input samples */
+    inline size_t GetLatency() const { return latency_; }
+
+    inline Quality GetQuality() const { return quality_; }
+
+  private:
+    inline void Write(float in)
+    {
+        line_[write_]           = in;
+        line_[write_ + length_] = in;
+        write_                  = write_ + 1 < length_ ? write_ + 1 : 0;
+    }
+
+    float Convolve(const float* newest) const;
+
+    Quality      quality_;
+    const float* table_;
+    size_t       num_taps_, phase_bits_;
+    size_t       length_, latency_, write_;
+
+    float    ratio_, max_ratio_;
+    uint64_t step_;
+    uint32_t frac_;
+
+    // taps and scale of the kernel for ratios above 1
+    size_t stretched_taps_;
+    float  scale_;
+
+    // the history is written twice, so the window is always contiguous
+    float line_[2 * kMaxTaps];
+};
+
+} // namespace daisysp
+#endif
+#endif
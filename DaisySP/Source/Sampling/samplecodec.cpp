@@ -0,0 +1,282 @@
+#include <string.h>
+#include "samplecodec.h"
+
+using namespace daisysp;
+
+namespace
+{
+constexpr size_t kBlockSize = SampleCodec::kBlockSize;
+constexpr size_t kHeader    = SampleCodec::kHeaderBytes;
+
+/** Largest block shift, quieter blocks lose resolution */
+constexpr int kMaxShift = 15;
+
+/** IMA ADPCM step sizes and step index changes */
+const int16_t kAdpcmSteps[89]
+    = {7,     8,     9,     10,    11,    12,    13,    14,    16,    17,
+       19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+       50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+       130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+       337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+       876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+       2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+       5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+       15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+
+const int8_t kAdpcmIndex[16] = {-1, -1, -1, -1, 2, 4, 6, 8,
+                                -1, -1, -1, -1, 2, 4, 6, 8};
+
+struct AdpcmState
+{
+    int32_t predictor;
+    int32_t index;
+
+    /** Applies a code, returns the new predictor */
+    inline int32_t Decode(uint8_t code)
+    {
+        const int32_t step = kAdpcmSteps[index];
+        int32_t       diff = step >> 3;
+        if(code & 4)
+            diff += step;
+        if(code & 2)
+            diff += step >> 1;
+        if(code & 1)
+            diff += step >> 2;
+        predictor += code & 8 ? -diff : diff;
+        predictor = predictor > 32767 ? 32767 : predictor;
+        predictor = predictor < -32768 ? -32768 : predictor;
+        index += kAdpcmIndex[code];
+        index = index < 0 ? 0 : (index > 88 ? 88 : index);
+        return predictor;
+    }
+
+    /** Finds the code closest to sample, and applies it */
+    inline uint8_t Encode(int32_t sample)
+    {
+        int32_t diff = sample - predictor;
+        uint8_t code = 0;
+        if(diff < 0)
+        {
+            code = 8;
+            diff = -diff;
+        }
+        int32_t step = kAdpcmSteps[index];
+        for(uint8_t bit = 4; bit > 0; bit >>= 1, step >>= 1)
+        {
+            if(diff >= step)
+            {
+                code |= bit;
+                diff -= step;
+            }
+        }
+        Decode(code);
+        return code;
+    }
+};
+
+inline int32_t ToInt(float x, float scale, int32_t limit)
+{
+    const float   y = x * scale;
+    const int32_t i = static_cast<int32_t>(y < 0.0f ? y - 0.5f : y + 0.5f);
+    return i > limit ? limit : (i < -limit ? -limit : i);
+}
+
+/** Shift that brings the peak of a block closest to full scale */
+int BlockShift(const float* in)
+{
+    float peak = 0.0f;
+    for(size_t i = 0; i < kBlockSize; i++)
+    {
+        const float a = in[i] < 0.0f ? -in[i] : in[i];
+        peak          = a > peak ? a : peak;
+    }
+    int shift = 0;
+    while(shift < kMaxShift && peak * (2 << shift) <= 1.0f)
+        shift++;
+    return shift;
+}
+
+/** Multiplier of the mantissas of a block, 2^-shift / limit */
+inline float BlockScale(int shift, int32_t limit)
+{
+    return 1.0f / (static_cast<float>(1 << shift) * limit);
+}
+
+void EncodeAdpcm(const float* in, uint8_t* out, AdpcmState& state)
+{
+    out[0] = static_cast<uint8_t>(state.predictor);
+    out[1] = static_cast<uint8_t>(state.predictor >> 8);
+    out[2] = static_cast<uint8_t>(state.index);
+    out[3] = 0;
+    for(size_t i = 0; i < kBlockSize; i += 2)
+    {
+        const uint8_t lo = state.Encode(ToInt(in[i], 32768.0f, 32767));
+        const uint8_t hi = state.Encode(ToInt(in[i + 1], 32768.0f, 32767));
+        out[kHeader + i / 2] = lo | hi << 4;
+    }
+}
+
+void DecodeAdpcm(const uint8_t* block, float* out)
+{
+    AdpcmState state;
+    state.predictor = static_cast<int16_t>(block[0] | block[1] << 8);
+    state.index     = block[2] > 88 ? 88 : block[2];
+    const uint8_t* codes = block + kHeader;
+    for(size_t i = 0; i < kBlockSize; i += 2)
+    {
+        const uint8_t c = codes[i / 2];
+        out[i]          = state.Decode(c & 15) * (1.0f / 32768.0f);
+        out[i + 1]      = state.Decode(c >> 4) * (1.0f / 32768.0f);
+    }
+}
+
+void EncodeBfp8(const float* in, uint8_t* out)
+{
+    const int   shift = BlockShift(in);
+    const float scale = static_cast<float>(1 << shift) * 127.0f;
+    memset(out, 0, kHeader);
+    out[0] = static_cast<uint8_t>(shift);
+    for(size_t i = 0; i < kBlockSize; i++)
+        out[kHeader + i] = static_cast<uint8_t>(ToInt(in[i], scale, 127));
+}
+
+void DecodeBfp8(const uint8_t* block, float* out)
+{
+    const float   scale = BlockScale(block[0] & kMaxShift, 127);
+    const int8_t* q     = reinterpret_cast<const int8_t*>(block + kHeader);
+    for(size_t i = 0; i < kBlockSize; i++)
+        out[i] = q[i] * scale;
+}
+
+void EncodeBfp12(const float* in, uint8_t* out)
+{
+    const int   shift = BlockShift(in);
+    const float scale = static_cast<float>(1 << shift) * 2047.0f;
+    memset(out, 0, kHeader);
+    out[0] = static_cast<uint8_t>(shift);
+
+    // two samples in three bytes, little endian
+    uint8_t* p = out + kHeader;
+    for(size_t i = 0; i < kBlockSize; i += 2, p += 3)
+    {
+        const uint32_t a = ToInt(in[i], scale, 2047) & 0xfff;
+        const uint32_t b = ToInt(in[i + 1], scale, 2047) & 0xfff;
+        p[0]             = static_cast<uint8_t>(a);
+        p[1]             = static_cast<uint8_t>(a >> 8 | b << 4);
+        p[2]             = static_cast<uint8_t>(b >> 4);
+    }
+}
+
+void DecodeBfp12(const uint8_t* block, float* out)
+{
+    const float    scale = BlockScale(block[0] & kMaxShift, 2047);
+    const uint8_t* p     = block + kHeader;
+    for(size_t i = 0; i < kBlockSize; i += 2, p += 3)
+    {
+        // each 12 bit value goes to the top of an int16, which keeps the sign
+        const int16_t a = static_cast<int16_t>(p[0] << 4 | p[1] << 12);
+        const int16_t b = static_cast<int16_t>((p[1] & 0xf0) | p[2] << 8);
+        out[i]          = (a >> 4) * scale;
+        out[i + 1]      = (b >> 4) * scale;
+    }
+}
+} // namespace
+
+size_t SampleCodec::GetBlockBytes(Format format)
+{
+    switch(format)
+    {
+        case Format::ADPCM4: return kHeader + kBlockSize / 2;
+        case Format::BFP8: return kHeader + kBlockSize;
+        case Format::BFP12: return kHeader + kBlockSize * 3 / 2;
+        default: return kBlockSize * sizeof(float);
+    }
+}
+
+void SampleCodec::Encode(Format       format,
+                         const float* in,
+                         size_t       num_samples,
+                         uint8_t*     out)
+{
+    const size_t bytes = GetBlockBytes(format);
+    AdpcmState   state = {0, 0};
+    for(size_t pos = 0; pos < num_samples; pos += kBlockSize, out += bytes)
+    {
+        // the last block is padded with zeros
+        float        block[kBlockSize] = {};
+        const size_t left              = num_samples - pos;
+        const size_t count = left < kBlockSize ? left : kBlockSize;
+        memcpy(block, in + pos, count * sizeof(float));
+
+        switch(format)
+        {
+            case Format::ADPCM4: EncodeAdpcm(block, out, state); break;
+            case Format::BFP8: EncodeBfp8(block, out); break;
+            case Format::BFP12: EncodeBfp12(block, out); break;
+            default: memcpy(out, block, sizeof(block)); break;
+        }
+    }
+}
+
+void SampleCodec::DecodeBlock(Format format, const uint8_t* block, float* out)
+{
+    switch(format)
+    {
+        case Format::ADPCM4: DecodeAdpcm(block, out); break;
+        case Format::BFP8: DecodeBfp8(block, out); break;
+        case Format::BFP12: DecodeBfp12(block, out); break;
+        default: memcpy(out, block, kBlockSize * sizeof(float)); break;
+    }
+}
+
+void SampleReader::Init(const void*         data,
+                        size_t              num_samples,
+                        SampleCodec::Format format)
+{
+    data_         = static_cast<const uint8_t*>(data);
+    num_samples_  = num_samples;
+    format_       = format;
+    block_bytes_  = SampleCodec::GetBlockBytes(format);
+    cached_block_ = SIZE_MAX;
+}
+
+float SampleReader::Get(size_t pos)
+{
+    if(pos >= num_samples_)
+        return 0.0f;
+    const size_t idx = pos / kBlockSize;
+    if(idx != cached_block_)
+    {
+        SampleCodec::DecodeBlock(format_, Block(idx), cache_);
+        cached_block_ = idx;
+    }
+    return cache_[pos % kBlockSize];
+}
+
+size_t SampleReader::Read(size_t pos, float* out, size_t size)
+{
+    const size_t end   = pos + size < num_samples_ ? pos + size : num_samples_;
+    const size_t valid = pos < end ? end - pos : 0;
+
+    size_t i = 0;
+    while(pos + i < end)
+    {
+        const size_t p      = pos + i;
+        const size_t offset = p % kBlockSize;
+        size_t       count  = kBlockSize - offset;
+        count               = count < end - p ? count : end - p;
+        if(offset == 0 && count == kBlockSize)
+        {
+            // whole blocks go straight to the output
+            SampleCodec::DecodeBlock(format_, Block(p / kBlockSize), &out[i]);
+        }
+        else
+        {
+            Get(p);
+            memcpy(&out[i], &cache_[offset], count * sizeof(float));
+        }
+        i += count;
+    }
+    memset(&out[valid], 0, (size - valid) * sizeof(float));
+    return valid;
+}
@@ -0,0 +1,143 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_SAMPLECODEC_H
+#define DSY_SAMPLECODEC_H
+#include <stdint.h>
+#include <stddef.h>
+#ifdef __cplusplus
+
+namespace daisysp
+{
+/** Compact formats for samples kept in memory.
+
+    Samples are stored in blocks of kBlockSize samples. Every block of a
+    format has the same size and starts with a 4 byte header holding all
+    the state needed to decode it, so the block of any sample position is
+    found by a division and decoded on its own. The blocks stay word
+    aligned, e.g. in memory mapped QSPI flash.
+
+    Size of a block, and signal to error ratio of a tone:
+    - FLOAT32: 256 bytes, 32 bits per sample, lossless
+    - BFP12: 100 bytes, 12.5 bits per sample, 2.6x smaller, about 70 dB
+    - BFP8: 68 bytes, 8.5 bits per sample, 3.8x smaller, about 48 dB
+    - ADPCM4: 36 bytes, 4.5 bits per sample, 7.1x smaller, about 36 dB,
+      less on noisy material
+
+    The block floating point formats (BFP) store a shift per block and 8
+    or 12 bit mantissas, quiet passages keep their resolution. Their
+    decoders have no dependency between samples, and are written so the
+    compiler can vectorize them. ADPCM4 is IMA ADPCM with the predictor and
+    the step index of the block in its header. It has the most compression
+    but each sample depends on the previous one, so it decodes serially.
+
+    Encoding is meant for the host or for loading time, decoding for the
+    audio callback. See SampleReader to play an encoded buffer.
+*/
+class SampleCodec
+{
+  public:
+    enum class Format : uint8_t
+    {
+        FLOAT32,
+        ADPCM4,
+        BFP8,
+        BFP12,
+    };
+
+    /** Samples per block, in all formats */
+    static constexpr size_t kBlockSize = 64;
+
+    /** Size of the header at the start of each block */
+    static constexpr size_t kHeaderBytes = 4;
+
+    /** \return the size of an encoded block */
+    static size_t GetBlockBytes(Format format);
+
+    /** \return the number of blocks for num_samples samples */
+    static inline size_t GetNumBlocks(size_t num_samples)
+    {
+        return (num_samples + kBlockSize - 1) / kBlockSize;
+    }
+
+    /** \return the number of bytes Encode() writes for num_samples samples */
+    static inline size_t GetEncodedSize(Format format, size_t num_samples)
+    {
+        return GetNumBlocks(num_samples) * GetBlockBytes(format);
+    }
+
+    /** Encodes samples in [-1, 1]. The last block is padded with zeros.
+        \param out GetEncodedSize(format, num_samples) bytes
+    */
+    static void Encode(Format       format,
+                       const float* in,
+                       size_t       num_samples,
+                       uint8_t*     out);
+
+    /** Decodes a whole block to kBlockSize samples.
+        \param block start of the block, 4 byte aligned
+    */
+    static void DecodeBlock(Format format, const uint8_t* block, float* out);
+};
+
+/** Random access reader of a sample encoded by SampleCodec.
+
+    The last decoded block is cached, so reading a sample sequentially
+    decodes each block once. Read() decodes the whole blocks of a range
+    straight into the destination.
+
+    \code
+    SampleReader reader;
+    reader.Init(data, num_samples, SampleCodec::Format::ADPCM4);
+    reader.Read(position, block, size);
+    \endcode
+*/
+class SampleReader
+{
+  public:
+    SampleReader() {}
+    ~SampleReader() {}
+
+    /** \param data encoded blocks, 4 byte aligned
+        \param num_samples length of the sample before encoding
+        \param format format of the blocks
+    */
+    void Init(const void* data, size_t num_samples, SampleCodec::Format format);
+
+    /** \return sample at pos, 0 past the end */
+    float Get(size_t pos);
+
+    /** Decodes size samples from pos. Samples past the end are 0.
+        \return the number of samples before the end
+    */
+    size_t Read(size_t pos, float* out, size_t size);
+
+    inline size_t GetNumSamples() const { return num_samples_; }
+
+    inline SampleCodec::Format GetFormat() const { return format_; }
+
+    inline const uint8_t* GetData() const { return data_; }
+
+  private:
+    const uint8_t* Block(size_t idx) const
+    {
+        return data_ + idx * block_bytes_;
+    }
+
+    const uint8_t*      data_;
+    size_t              num_samples_, block_bytes_;
+    SampleCodec::Format format_;
+
+    size_t cached_block_;
+    float  cache_[SampleCodec::kBlockSize];
+};
+
+} // namespace daisysp
+#endif
+#endif
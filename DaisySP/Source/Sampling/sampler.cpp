@@ -0,0 +1,297 @@
+#include <math.h>
+#include <string.h>
+#include "sampler.h"
+
+using namespace daisysp;
+
+namespace
+{
+constexpr double kFixedOne = 4294967296.0;
+
+/** 4 point, 3rd order Hermite between x1 and x2 */
+inline float Hermite(float x0, float x1, float x2, float x3, float t)
+{
+    const float c1 = 0.5f * (x2 - x0);
+    const float c2 = x0 - 2.5f * x1 + 2.0f * x2 - 0.5f * x3;
+    const float c3 = 0.5f * (x3 - x0) + 1.5f * (x1 - x2);
+    return ((c3 * t + c2) * t + c1) * t + x1;
+}
+
+inline bool IsLooping(const SamplerZone& zone)
+{
+    return zone.loop_end > zone.loop_start;
+}
+} // namespace
+
+void Sampler::Init(float              sample_rate,
+                   const SamplerZone* zones,
+                   size_t             num_zones)
+{
+    sample_rate_   = sample_rate;
+    zones_         = zones;
+    num_zones_     = num_zones;
+    interpolation_ = Interpolation::CUBIC;
+    for(size_t i = 0; i < kMaxSincVoices; i++)
+        resamplers_[i].Init(Resampler::Quality::STANDARD, kMaxRatio);
+    SetRelease(0.05f);
+    Reset();
+}
+
+void Sampler::PrepareZone(SamplerZone& zone, float* crossfade_buffer)
+{
+    size_t length = 0;
+    if(IsLooping(zone))
+    {
+        length = zone.crossfade;
+        length = length < zone.loop_start ? length : zone.loop_start;
+        const size_t loop = zone.loop_end - zone.loop_start;
+        length            = length < loop ? length : loop;
+    }
+    zone.crossfade      = static_cast<uint32_t>(length);
+    zone.crossfade_data = length > 0 ? crossfade_buffer : nullptr;
+
+    // equal power, from the end of the loop to the frames leading to its
+    // start, so the last frame is followed by the loop start
+    constexpr size_t kBlock = 64;
+    float            tail[kBlock], lead[kBlock];
+    for(size_t pos = 0; pos < length; pos += kBlock)
+    {
+        const size_t n = length - pos < kBlock ? length - pos : kBlock;
+        zone.source->Read(zone.loop_end - length + pos, tail, n);
+        zone.source->Read(zone.loop_start - length + pos, lead, n);
+        for(size_t i = 0; i < n; i++)
+        {
+            const float t = (pos + i + 0.5f) / length * 1.5707963f;
+            crossfade_buffer[pos + i] = tail[i] * cosf(t) + lead[i] * sinf(t);
+        }
+    }
+    if(IsLooping(zone))
+        zone.source->SetLoop(zone.loop_start, zone.loop_end);
+}
+
+void Sampler::SetRelease(float seconds)
+{
+    const float samples = seconds * sample_rate_;
+    release_step_       = samples > 1.0f ? 1.0f / samples : 1.0f;
+}
+
+void Sampler::Reset()
+{
+    num_active_ = 0;
+    num_free_   = kMaxVoices;
+    for(size_t i = 0; i < kMaxVoices; i++)
+        free_[i] = static_cast<uint8_t>(kMaxVoices - 1 - i);
+    for(size_t i = 0; i < kMaxSincVoices; i++)
+        resampler_busy_[i] = false;
+}
+
+size_t Sampler::NoteOn(uint8_t note, uint8_t velocity)
+{
+    size_t started = 0;
+    for(size_t z = 0; z < num_zones_; z++)
+    {
+        const SamplerZone& zone = zones_[z];
+        if(note >= zone.key_lo && note <= zone.key_hi
+           && velocity >= zone.vel_lo && velocity <= zone.vel_hi)
+            started += StartVoice(z, note, velocity);
+    }
+    return started;
+}
+
+void Sampler::NoteOff(uint8_t note)
+{
+    for(size_t i = 0; i < num_active_; i++)
+    {
+        Voice& v = voices_[active_[i]];
+        if(v.note == note)
+            v.released = true;
+    }
+}
+
+bool Sampler::StartVoice(size_t zone, uint8_t note, uint8_t velocity)
+{
+    // a streamed source loads ahead of one reader, so a new note takes
+    // over the voice that plays it
+    const SampleSource* source = zones_[zone].source;
+    if(source->GetType() == SampleSource::Type::STREAM)
+    {
+        for(size_t i = 0; i < num_active_; i++)
+        {
+            if(zones_[voices_[active_[i]].zone].source == source)
+            {
+                StopVoice(i);
+                break;
+            }
+        }
+    }
+    if(num_free_ == 0)
+        StopVoice(0);
+
+    const uint8_t idx    = free_[--num_free_];
+    active_[num_active_++] = idx;
+
+    const SamplerZone& z     = zones_[zone];
+    float              ratio = z.sample_rate / sample_rate_
+                  * powf(2.0f, (note - int(z.root_note)) / 12.0f);
+    ratio = ratio < kMaxRatio ? ratio : kMaxRatio;
+
+    Voice& v        = voices_[idx];
+    v.position      = 0;
+    v.step          = static_cast<uint64_t>(ratio * kFixedOne);
+    v.gain          = z.gain * velocity / 127.0f;
+    v.envelope      = 1.0f;
+    v.zone          = static_cast<uint16_t>(zone);
+    v.note          = note;
+    v.released      = false;
+    v.resampler     = kNoResampler;
+    v.interpolation = interpolation_;
+    if(v.interpolation == Interpolation::SINC)
+    {
+        for(size_t r = 0; r < kMaxSincVoices; r++)
+        {
+            if(!resampler_busy_[r])
+            {
+                resampler_busy_[r] = true;
+                resamplers_[r].Reset();
+                resamplers_[r].SetRatio(ratio);
+                v.resampler = static_cast<uint8_t>(r);
+                break;
+            }
+        }
+        if(v.resampler == kNoResampler)
+            v.interpolation = Interpolation::CUBIC;
+    }
+    return true;
+}
+
+void Sampler::StopVoice(size_t i)
+{
+    const uint8_t idx = active_[i];
+    if(voices_[idx].resampler != kNoResampler)
+        resampler_busy_[voices_[idx].resampler] = false;
+    memmove(&active_[i], &active_[i + 1], num_active_ - i - 1);
+    num_active_--;
+    free_[num_free_++] = idx;
+}
+
+void Sampler::Process(float* out, size_t size)
+{
+    memset(out, 0, size * sizeof(float));
+    for(size_t pos = 0; pos < size; pos += kChunk)
+    {
+        const size_t n = size - pos < kChunk ? size - pos : kChunk;
+        for(size_t i = 0; i < num_active_;)
+        {
+            if(Render(voices_[active_[i]], out + pos, n))
+                i++;
+            else
+                StopVoice(i);
+        }
+    }
+}
+
+bool Sampler::Render(Voice& v, float* out, size_t size)
+{
+    const SamplerZone& zone = zones_[v.zone];
+    const uint64_t     one  = uint64_t(1) << 32;
+    size_t             end  = zone.source->GetLength();
+    const float*       x;
+    float*             y = frames_ + kMaxFrames;
+
+    if(v.interpolation == Interpolation::SINC)
+    {
+        Resampler&   rs     = resamplers_[v.resampler];
+        const size_t needed = rs.GetInputNeeded(size);
+        Fetch(zone, v.position >> 32, frames_, needed);
+        rs.Process(frames_, y, size);
+        v.position += needed * one;
+        // the tail of the kernel plays after the last frame
+        end += rs.GetLatency();
+    }
+    else
+    {
+        // one frame before the first position and two after the last
+        const int64_t first = static_cast<int64_t>(v.position >> 32) - 1;
+        const int64_t last
+            = static_cast<int64_t>((v.position + v.step * (size - 1)) >> 32)
+              + 2;
+        Fetch(zone, first, frames_, static_cast<size_t>(last - first + 1));
+
+        for(size_t i = 0; i < size; i++, v.position += v.step)
+        {
+            x             = &frames_[(v.position >> 32) - first - 1];
+            const float t = static_cast<uint32_t>(v.position)
+                            * (1.0f / 4294967296.0f);
+            y[i] = v.interpolation == Interpolation::LINEAR
+                       ? x[1] + (x[2] - x[1]) * t
+                       : Hermite(x[0], x[1], x[2], x[3], t);
+        }
+    }
+
+    if(IsLooping(zone))
+    {
+        const uint64_t loop_end = uint64_t(zone.loop_end) << 32;
+        const uint64_t length = uint64_t(zone.loop_end - zone.loop_start)
+                                << 32;
+        while(v.position >= loop_end)
+            v.position -= length;
+    }
+
+    for(size_t i = 0; i < size; i++)
+    {
+        out[i] += y[i] * v.gain * v.envelope;
+        if(v.released)
+        {
+            v.envelope -= release_step_;
+            if(v.envelope <= 0.0f)
+                return false;
+        }
+    }
+    return IsLooping(zone) || (v.position >> 32) < end;
+}
+
+void Sampler::Fetch(const SamplerZone& zone,
+                    int64_t            first,
+                    float*             out,
+                    size_t             size)
+{
+    const bool   looping = IsLooping(zone);
+    const size_t fade    = zone.crossfade_data ? zone.crossfade : 0;
+    const size_t loop    = zone.loop_end - zone.loop_start;
+    while(size > 0)
+    {
+        size_t run;
+        if(first < 0)
+        {
+            // before the start, e.g. the frame before the first one
+            run = static_cast<size_t>(-first);
+            run = run < size ? run : size;
+            memset(out, 0, run * sizeof(float));
+        }
+        else
+        {
+            size_t frame = static_cast<size_t>(first);
+            if(looping && frame >= zone.loop_end)
+                frame = zone.loop_start + (frame - zone.loop_end) % loop;
+
+            if(looping && frame >= zone.loop_end - fade)
+            {
+                run = zone.loop_end - frame < size ? zone.loop_end - frame
+                                                   : size;
+                const size_t offset = frame - (zone.loop_end - fade);
+                memcpy(out, zone.crossfade_data + offset, run * sizeof(float));
+            }
+            else
+            {
+                const size_t limit
+                    = looping ? zone.loop_end - fade : zone.source->GetLength();
+                run = frame < limit && limit - frame < size ? limit - frame
+                                                            : size;
+                zone.source->Read(frame, out, run);
+            }
+        }
+        out += run;
+        first += run;
+        size -= run;
+    }
+}
@@ -0,0 +1,204 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_SAMPLER_H
+#define DSY_SAMPLER_H
+#include <stdint.h>
+#include <stddef.h>
+#include "resampler.h"
+#include "samplesource.h"
+#ifdef __cplusplus
+
+namespace daisysp
+{
+/** A sample mapped to a range of notes and velocities.
+
+    The loop points are frames, the end is the frame after the loop, as
+    read from a `smpl` chunk by WavReader. Call Sampler::PrepareZone() once
+    the fields are set.
+*/
+struct SamplerZone
+{
+    SampleSource* source;
+    /** Rate the sample was recorded at */
+    float sample_rate;
+    /** Note played at the recorded pitch */
+    uint8_t root_note;
+    /** Notes and velocities of the zone, inclusive */
+    uint8_t key_lo, key_hi, vel_lo, vel_hi;
+    /** Sustain loop, no loop when loop_end is 0 */
+    uint32_t loop_start, loop_end;
+    /** Length of the crossfade at the end of the loop, in frames */
+    uint32_t crossfade;
+    /** Gain at full velocity */
+    float gain;
+
+    /** The end of the loop blended with the frames before its start, set
+        by Sampler::PrepareZone()
+    */
+    const float* crossfade_data;
+};
+
+/** Multi-sample player with key and velocity zones.
+
+    Each note starts a voice for every zone that contains its key and
+    velocity, so zones can be split or layered. A voice plays its zone
+    from the first frame, repeats the sustain loop while it lasts, and
+    fades out over the release time after NoteOff().
+
+    Voices are a pool of kMaxVoices states of 32 bytes, with no allocation.
+    When all are busy, the oldest voice is taken. Process() renders the
+    active voices only, a block at a time, so the cost follows the number
+    of notes playing.
+
+    A streamed source loads ahead of a single reader, so it plays one
+    voice at a time: a new note of its zones takes over the voice of the
+    previous one. Use memory or encoded sources for polyphonic zones.
+
+    Interpolation between the frames:
+    - LINEAR: cheapest, some aliasing and high frequency loss
+    - CUBIC: 4 point Hermite, a good default
+    - SINC: a Resampler per voice, from a pool of kMaxSincVoices. Voices
+      beyond it use CUBIC. The output is delayed by the latency of the
+      Resampler, 48 frames of the sample.
+
+    A loop is smoothed by a crossfade computed ahead of time: the last
+    frames of the loop are blended with the frames before its start, so
+    they lead into the start with no click, and the voice just reads them
+    instead of the sample.
+
+    \code
+    SamplerZone zone = {};
+    zone.source      = &source;
+    zone.sample_rate = 44100.0f;
+    zone.root_note   = 60;
+    zone.key_hi = zone.vel_hi = 127;
+    zone.loop_start  = loop.start;
+    zone.loop_end    = loop.end;
+    zone.crossfade   = 512;
+    zone.gain        = 1.0f;
+    Sampler::PrepareZone(zone, crossfade_buffer);
+    sampler.Init(48000.0f, &zone, 1);
+    sampler.NoteOn(60, 100);
+    \endcode
+*/
+class Sampler
+{
+  public:
+    enum class Interpolation : uint8_t
+    {
+        LINEAR,
+        CUBIC,
+        SINC,
+    };
+
+    static constexpr size_t kMaxVoices     = 16;
+    static constexpr size_t kMaxSincVoices = 4;
+    /** Highest ratio of sample frames to output samples. Notes above it
+        play at this pitch.
+    */
+    static constexpr float kMaxRatio = 4.0f;
+
+    Sampler() {}
+    ~Sampler() {}
+
+    /** \param sample_rate of the output
+        \param zones zones that stay valid while the sampler plays
+        \param num_zones number of zones
+    */
+    void Init(float sample_rate, const SamplerZone* zones, size_t num_zones);
+
+    /** Computes the crossfade of a zone, and gives its loop to the source.
+        The frames of the loop must be readable, for a streamed source too.
+        \param crossfade_buffer zone.crossfade floats. The crossfade is
+        shortened to the frames before the loop start and to the length of
+        the loop.
+    */
+    static void PrepareZone(SamplerZone& zone, float* crossfade_buffer);
+
+    /** Interpolation of the voices started from now on */
+    inline void SetInterpolation(Interpolation interpolation)
+    {
+        interpolation_ = interpolation;
+    }
+
+    /** Time to fade out after NoteOff(), in seconds */
+    void SetRelease(float seconds);
+
+    /** Starts a voice for each zone of the note and velocity.
+        \return the number of voices started
+    */
+    size_t NoteOn(uint8_t note, uint8_t velocity);
+
+    /** Releases the voices of a note */
+    void NoteOff(uint8_t note);
+
+    /** Stops all voices at once */
+    void Reset();
+
+    /** Renders the active voices, mixed.
+        \param out size samples, overwritten
+    */
+    void Process(float* out, size_t size);
+
+    /** \return voices playing or releasing */
+    inline size_t GetNumActiveVoices() const { return num_active_; }
+
+  private:
+    /** Frames rendered at a time, and the frames they can read */
+    static constexpr size_t kChunk = 48;
+    static constexpr size_t kMaxFrames
+        = static_cast<size_t>(kChunk * kMaxRatio) + 4;
+    static constexpr uint8_t kNoResampler = 0xff;
+    static_assert(Resampler::kMaxInput <= kMaxFrames, "SINC input");
+
+    struct Voice
+    {
+        /** Position in the sample, 32.32 fixed point. Inside the loop once
+            it was reached, the start of the next input for SINC.
+        */
+        uint64_t position;
+        /** Frames per output sample, 32.32 */
+        uint64_t step;
+        float    gain, envelope;
+        uint16_t zone;
+        uint8_t  note;
+        uint8_t  resampler;
+        Interpolation interpolation;
+        bool          released;
+        uint8_t       reserved[2];
+    };
+
+    bool StartVoice(size_t zone, uint8_t note, uint8_t velocity);
+    void StopVoice(size_t idx);
+    /** Renders size samples of a voice, and returns false once it ended */
+    bool Render(Voice& v, float* out, size_t size);
+    /** Reads frames of the played stream: the sample, then the loop */
+    void Fetch(const SamplerZone& zone, int64_t first, float* out, size_t size);
+
+    float              sample_rate_, release_step_;
+    const SamplerZone* zones_;
+    size_t             num_zones_;
+    Interpolation      interpolation_;
+
+    Voice   voices_[kMaxVoices];
+    uint8_t active_[kMaxVoices]; // oldest first
+    uint8_t free_[kMaxVoices];
+    size_t  num_active_, num_free_;
+
+    Resampler resamplers_[kMaxSincVoices];
+    bool      resampler_busy_[kMaxSincVoices];
+
+    /** Frames read by a voice, then the samples it renders */
+    float frames_[kMaxFrames + kChunk];
+};
+
+} // namespace daisysp
+#endif
+#endif
@@ -0,0 +1,148 @@
+#include <string.h>
+#include <atomic>
+#include "samplesource.h"
+
+using namespace daisysp;
+
+void SampleSource::Init(const float* data, size_t length)
+{
+    type_   = Type::MEMORY;
+    data_   = data;
+    length_ = length;
+}
+
+void SampleSource::Init(const void*         data,
+                        size_t              length,
+                        SampleCodec::Format format)
+{
+    type_   = Type::ENCODED;
+    length_ = length;
+    reader_.Init(data, length, format);
+}
+
+void SampleSource::InitStream(float*    buffer,
+                              uint32_t* tags,
+                              size_t    num_chunks,
+                              size_t    length)
+{
+    type_       = Type::STREAM;
+    length_     = length;
+    buffer_     = buffer;
+    tags_       = tags;
+    num_chunks_ = num_chunks;
+    cursor_     = 0;
+    underruns_  = 0;
+    loop_start_ = 0;
+    loop_end_   = 0;
+    for(size_t i = 0; i < num_chunks; i++)
+        tags_[i] = kNoChunk;
+}
+
+size_t SampleSource::Read(size_t pos, float* out, size_t size)
+{
+    switch(type_)
+    {
+        case Type::ENCODED: return reader_.Read(pos, out, size);
+        case Type::STREAM: return ReadStream(pos, out, size);
+        default: break;
+    }
+    const size_t valid = pos < length_ ? (length_ - pos < size ? length_ - pos
+                                                               : size)
+                                       : 0;
+    memcpy(out, data_ + pos, valid * sizeof(float));
+    memset(out + valid, 0, (size - valid) * sizeof(float));
+    return valid;
+}
+
+size_t SampleSource::ReadStream(size_t pos, float* out, size_t size)
+{
+    const size_t valid = pos < length_ ? (length_ - pos < size ? length_ - pos
+                                                               : size)
+                                       : 0;
+    size_t i = 0;
+    while(i < valid)
+    {
+        const size_t p      = pos + i;
+        const size_t chunk  = p / kStreamChunk;
+        const size_t offset = p % kStreamChunk;
+        size_t       count  = kStreamChunk - offset;
+        count               = count < valid - i ? count : valid - i;
+        const size_t slot   = chunk % num_chunks_;
+        if(tags_[slot] == chunk)
+        {
+            memcpy(&out[i],
+                   &buffer_[slot * kStreamChunk + offset],
+                   count * sizeof(float));
+        }
+        else
+        {
+            memset(&out[i], 0, count * sizeof(float));
+            underruns_ += count;
+        }
+        i += count;
+    }
+    memset(out + valid, 0, (size - valid) * sizeof(float));
+    cursor_ = pos;
+    return valid;
+}
+
+void SampleSource::SetLoop(size_t loop_start, size_t loop_end)
+{
+    loop_start_ = loop_start;
+    loop_end_   = loop_end;
+    cursor_     = 0;
+}
+
+size_t SampleSource::NextChunk(size_t chunk) const
+{
+    const bool looping = loop_end_ > loop_start_;
+    if(looping && chunk == (loop_end_ - 1) / kStreamChunk)
+        return loop_start_ / kStreamChunk;
+    return (chunk + 1) * kStreamChunk < length_ ? chunk + 1 : kNoChunk;
+}
+
+bool SampleSource::GetStreamRequest(size_t& frame) const
+{
+    if(type_ != Type::STREAM)
+        return false;
+
+    // The chunks that the reader will need next, in order. The walk
+    // stops before a chunk that would evict one needed sooner, and leaves
+    // the slot before the reader alone, since interpolation reads back.
+    size_t chunk = cursor_ / kStreamChunk;
+    for(size_t i = 0; i + 1 < num_chunks_ && chunk != kNoChunk; i++)
+    {
+        const size_t slot  = chunk % num_chunks_;
+        size_t       prior = cursor_ / kStreamChunk;
+        for(size_t j = 0; j < i; j++, prior = NextChunk(prior))
+        {
+            if(prior != chunk && prior % num_chunks_ == slot)
+                return false;
+        }
+        if(tags_[slot] != chunk)
+        {
+            frame = chunk * kStreamChunk;
+            return true;
+        }
+        chunk = NextChunk(chunk);
+    }
+    return false;
+}
+
+void SampleSource::WriteStream(size_t frame, const float* data, size_t size)
+{
+    if(type_ != Type::STREAM)
+        return;
+    const size_t chunk = frame / kStreamChunk;
+    const size_t slot  = chunk % num_chunks_;
+    size               = size < kStreamChunk ? size : kStreamChunk;
+
+    // the reader never sees a chunk that is half written
+    tags_[slot] = kNoChunk;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    float* dst = &buffer_[slot * kStreamChunk];
+    memcpy(dst, data, size * sizeof(float));
+    memset(dst + size, 0, (kStreamChunk - size) * sizeof(float));
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    tags_[slot] = static_cast<uint32_t>(chunk);
+}
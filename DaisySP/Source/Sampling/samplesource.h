@@ -0,0 +1,139 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_SAMPLESOURCE_H
+#define DSY_SAMPLESOURCE_H
+#include <stdint.h>
+#include <stddef.h>
+#include "samplecodec.h"
+#ifdef __cplusplus
+
+namespace daisysp
+{
+/** One channel of a sample, wherever it is stored.
+
+    The Sampler reads every sample through this class, so its voices don't
+    depend on where the data lives:
+    - Memory: floats in any memory, e.g. a sample loaded to SDRAM.
+    - Encoded: blocks of a SampleCodec format, e.g. from a sample catalog
+      in memory mapped QSPI flash, decoded as they are read.
+    - Stream: a cache of chunks of kStreamChunk frames, filled from a slow
+      medium like an SD card by the main loop while the sample plays.
+
+    A streamed source follows a single reader: the Sampler plays it with
+    one voice at a time. GetStreamRequest() gives the next chunk to load
+    ahead of the last frame read, jumping back to the loop start at the
+    loop end, and WriteStream() stores it:
+    \code
+    // main loop
+    size_t frame;
+    while(source.GetStreamRequest(frame))
+    {
+        float chunk[SampleSource::kStreamChunk];
+        wav.Seek(frame);
+        wav.Read(chunk, SampleSource::kStreamChunk);
+        source.WriteStream(frame, chunk, SampleSource::kStreamChunk);
+    }
+    \endcode
+    Frames that aren't loaded when they are read are silent, and counted
+    by GetUnderruns(). Write the first chunks before playing, so the start
+    of the sample is there when a note starts. WriteStream() must not be
+    called from an interrupt that interrupts Read().
+*/
+class SampleSource
+{
+  public:
+    enum class Type : uint8_t
+    {
+        MEMORY,
+        ENCODED,
+        STREAM,
+    };
+
+    /** Frames per chunk of a streamed source */
+    static constexpr size_t kStreamChunk = 256;
+
+    SampleSource() {}
+    ~SampleSource() {}
+
+    /** Plays floats from memory.
+        \param data length floats
+    */
+    void Init(const float* data, size_t length);
+
+    /** Plays blocks encoded by SampleCodec::Encode().
+        \param data encoded blocks, 4 byte aligned
+        \param length frames before encoding
+    */
+    void Init(const void* data, size_t length, SampleCodec::Format format);
+
+    /** Plays a sample streamed by the application.
+        \param buffer num_chunks * kStreamChunk floats
+        \param tags num_chunks values, the frames held by the chunks
+        \param num_chunks chunks of the cache, at least 2
+        \param length frames of the whole sample
+    */
+    void InitStream(float*    buffer,
+                    uint32_t* tags,
+                    size_t    num_chunks,
+                    size_t    length);
+
+    /** Reads size frames from pos. Frames past the end, and frames of a
+        stream that aren't loaded, are 0.
+        \return the number of frames before the end
+    */
+    size_t Read(size_t pos, float* out, size_t size);
+
+    /** Sets the loop that a streamed source loads ahead of the reader, and
+        moves the reader back to the start of the sample.
+        Sampler::PrepareZone() sets it from the zone.
+    */
+    void SetLoop(size_t loop_start, size_t loop_end);
+
+    /** Finds the first chunk ahead of the reader that isn't loaded.
+        \param frame set to the first frame of the chunk
+        \return false if all chunks ahead are loaded
+    */
+    bool GetStreamRequest(size_t& frame) const;
+
+    /** Stores a chunk of a streamed source.
+        \param frame first frame of the chunk, from GetStreamRequest()
+        \param data up to kStreamChunk frames, the rest of the chunk is 0
+    */
+    void WriteStream(size_t frame, const float* data, size_t size);
+
+    /** \return reads of streamed frames that weren't loaded */
+    inline size_t GetUnderruns() const { return underruns_; }
+
+    inline size_t GetLength() const { return length_; }
+
+    inline Type GetType() const { return type_; }
+
+  private:
+    size_t ReadStream(size_t pos, float* out, size_t size);
+    size_t NextChunk(size_t chunk) const;
+
+    static constexpr uint32_t kNoChunk = 0xffffffff;
+
+    Type   type_;
+    size_t length_;
+
+    const float* data_;
+    SampleReader reader_;
+
+    // streaming
+    float*    buffer_;
+    uint32_t* tags_;
+    size_t    num_chunks_, cursor_, underruns_;
+    size_t    loop_start_, loop_end_;
+};
+
+} // namespace daisysp
+#endif
+#endif
@@ -0,0 +1,169 @@
+#include "fft.h"
+#include <math.h>
+#include <string.h>
+
+using namespace daisysp;
+
+bool RealFft::Init(size_t size)
+{
+    if(size < kMinSize || size > kMaxSize || (size & (size - 1)) != 0)
+        return false;
+    size_ = size;
+#if(defined(USE_ARM_DSP) && defined(__arm__))
+    return arm_rfft_fast_init_f32(&instance_, size) == ARM_MATH_SUCCESS;
+#else
+    return true;
+#endif
+}
+
+#if(defined(USE_ARM_DSP) && defined(__arm__))
+
+void RealFft::Forward(float* in, float* out)
+{
+    arm_rfft_fast_f32(&instance_, in, out, 0);
+}
+
+void RealFft::Inverse(float* in, float* out)
+{
+    arm_rfft_fast_f32(&instance_, in, out, 1);
+}
+
+#else
+
+void RealFft::Forward(float* in, float* out)
+{
+    // the even/odd samples form a complex signal of half the size, which
+    // is transformed and then split into the real spectrum
+    memcpy(out, in, size_ * sizeof(float));
+    ComplexFft(out, false);
+    Split(out, false);
+}
+
+void RealFft::Inverse(float* in, float* out)
+{
+    Split(in, true);
+    ComplexFft(in, true);
+    memcpy(out, in, size_ * sizeof(float));
+}
+
+void RealFft::ComplexFft(float* data, bool inverse)
+{
+    const size_t n = size_ / 2;
+
+    // bit reversal permutation
+    for(size_t i = 1, j = 0; i < n; i++)
+    {
+        size_t bit = n >> 1;
+        for(; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if(i < j)
+        {
+            float t         = data[2 * i];
+            data[2 * i]     = data[2 * j];
+            data[2 * j]     = t;
+            t               = data[2 * i + 1];
+            data[2 * i + 1] = data[2 * j + 1];
+            data[2 * j + 1] = t;
+        }
+    }
+
+    // twiddles are computed by recurrence in double precision, which is
+    // accurate enough and avoids a table per size
+    for(size_t len = 2; len <= n; len <<= 1)
+    {
+        const double angle = (inverse ? 2.0 : -2.0) * M_PI / len;
+        const double w_re  = cos(angle);
+        const double w_im  = sin(angle);
+        for(size_t i = 0; i < n; i += len)
+        {
+            double t_re = 1.0, t_im = 0.0;
+            for(size_t k = 0; k < len / 2; k++)
+            {
+                float*      a    = data + 2 * (i + k);
+                float*      b    = data + 2 * (i + k + len / 2);
+                const float b_re = b[0] * t_re - b[1] * t_im;
+                const float b_im = b[0] * t_im + b[1] * t_re;
+                b[0]             = a[0] - b_re;
+                b[1]             = a[1] - b_im;
+                a[0] += b_re;
+                a[1] += b_im;
+                const double next = t_re * w_re - t_im * w_im;
+                t_im              = t_re * w_im + t_im * w_re;
+                t_re              = next;
+            }
+        }
+    }
+
+    if(inverse)
+    {
+        const float scale = 1.0f / n;
+        for(size_t i = 0; i < 2 * n; i++)
+            data[i] *= scale;
+    }
+}
+
+void RealFft::Split(float* data, bool inverse)
+{
+    const size_t n     = size_ / 2;
+    const double angle = -2.0 * M_PI / size_;
+    const double w_re  = cos(angle);
+    const double w_im  = sin(angle);
+    double       t_re  = w_re;
+    double       t_im  = w_im;
+
+    if(inverse)
+    {
+        const float dc      = data[0];
+        const float nyquist = data[1];
+        data[0]             = 0.5f * (dc + nyquist);
+        data[1]             = 0.5f * (dc - nyquist);
+    }
+    else
+    {
+        const float re = data[0];
+        const float im = data[1];
+        data[0]        = re + im;
+        data[1]        = re - im;
+    }
+
+    for(size_t k = 1; k <= n / 2; k++)
+    {
+        float* a = data + 2 * k;
+        float* b = data + 2 * (n - k);
+        // sum and difference of bin k and the conjugate of bin n - k
+        const float s_re = 0.5f * (a[0] + b[0]);
+        const float s_im = 0.5f * (a[1] - b[1]);
+        const float d_re = 0.5f * (a[0] - b[0]);
+        const float d_im = 0.5f * (a[1] + b[1]);
+        const float c    = static_cast<float>(t_re);
+        const float s    = static_cast<float>(t_im);
+        if(inverse)
+        {
+            // odd part = conj(w^k) * d, z[k] = even + i * odd
+            const float o_re = d_re * c + d_im * s;
+            const float o_im = d_im * c - d_re * s;
+            a[0]             = s_re - o_im;
+            a[1]             = s_im + o_re;
+            b[0]             = s_re + o_im;
+            b[1]             = o_re - s_im;
+        }
+        else
+        {
+            // odd part = -i * d, x[k] = even + w^k * odd
+            const float o_re = d_im;
+            const float o_im = -d_re;
+            const float p_re = o_re * c - o_im * s;
+            const float p_im = o_re * s + o_im * c;
+            a[0]             = s_re + p_re;
+            a[1]             = s_im + p_im;
+            b[0]             = s_re - p_re;
+            b[1]             = p_im - s_im;
+        }
+        const double next = t_re * w_re - t_im * w_im;
+        t_im              = t_re * w_im + t_im * w_re;
+        t_re              = next;
+    }
+}
+
+#endif
@@ -0,0 +1,76 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_FFT_H
+#define DSY_FFT_H
+#include <stdint.h>
+#include <stddef.h>
+#if(defined(USE_ARM_DSP) && defined(__arm__))
+#include <arm_math.h> // required for platform-optimized version
+#endif
+#ifdef __cplusplus
+
+namespace daisysp
+{
+/** Real FFT, with the CMSIS-DSP arm_rfft_fast_f32 on ARM when USE_ARM_DSP
+    is defined, and a portable radix-2 implementation otherwise.
+
+    Both backends use the CMSIS packed spectrum format for a size N
+    transform, N floats in total:
+    - spectrum[0]: real part of bin 0 (DC)
+    - spectrum[1]: real part of bin N / 2 (Nyquist)
+    - spectrum[2k], spectrum[2k + 1]: real and imaginary part of bin k,
+      for 0 < k < N / 2
+
+    The forward transform is unscaled, the inverse is scaled by 1 / N, so
+    Inverse(Forward(x)) == x. Like arm_rfft_fast_f32, both transforms
+    overwrite their input buffer.
+*/
+class RealFft
+{
+  public:
+    static constexpr size_t kMinSize = 32;
+    static constexpr size_t kMaxSize = 4096;
+
+    RealFft() {}
+    ~RealFft() {}
+
+    /** Initializes the transform.
+        \param size FFT size, a power of two from kMinSize to kMaxSize
+        \return false if the size is not supported
+    */
+    bool Init(size_t size);
+
+    /** Transforms `size` real samples into the packed spectrum.
+        \param in time domain samples, overwritten
+        \param out packed spectrum
+    */
+    void Forward(float* in, float* out);
+
+    /** Transforms a packed spectrum back into `size` real samples.
+        \param in packed spectrum, overwritten
+        \param out time domain samples
+    */
+    void Inverse(float* in, float* out);
+
+    inline size_t GetSize() const { return size_; }
+
+  private:
+#if(defined(USE_ARM_DSP) && defined(__arm__))
+    arm_rfft_fast_instance_f32 instance_;
+#else
+    void ComplexFft(float* data, bool inverse);
+    void Split(float* data, bool inverse);
+#endif
+    size_t size_;
+};
+
+} // namespace daisysp
+#endif
+#endif
@@ -0,0 +1,60 @@
+#include "spectralfreeze.h"
+#include "Utility/dsp.h"
+#include "Utility/lut.h"
+#include <math.h>
+#include <string.h>
+
+using namespace daisysp;
+
+void SpectralFreeze::Init(float* buffer, size_t fft_size, size_t hop)
+{
+    num_bins_   = fft_size / 2 + 1;
+    phase_inc_  = static_cast<float>(hop) / fft_size;
+    magnitudes_ = buffer;
+    phases_     = buffer + num_bins_;
+    memset(buffer, 0, 2 * num_bins_ * sizeof(float));
+    freeze_     = false;
+    was_frozen_ = false;
+    SetBlur(0.0f);
+}
+
+void SpectralFreeze::SetBlur(float blur)
+{
+    blur_coeff_ = 1.0f - fclamp(blur, 0.0f, 0.999f);
+}
+
+void SpectralFreeze::Process(float* spectrum)
+{
+    const size_t nyquist = num_bins_ - 1;
+    const bool   freeze  = freeze_;
+
+    for(size_t k = 0; k < num_bins_; k++)
+    {
+        // bins 0 and N / 2 are real, and packed into the first two floats
+        float* re = k == 0 ? &spectrum[0]
+                           : (k == nyquist ? &spectrum[1] : &spectrum[2 * k]);
+        float* im = (k == 0 || k == nyquist) ? nullptr : &spectrum[2 * k + 1];
+        const float in_im = im ? *im : 0.0f;
+
+        if(!freeze)
+        {
+            const float mag = sqrtf(*re * *re + in_im * in_im);
+            magnitudes_[k] += blur_coeff_ * (mag - magnitudes_[k]);
+            const float scale = mag > 1.0e-20f ? magnitudes_[k] / mag : 0.0f;
+            *re *= scale;
+            if(im)
+                *im *= scale;
+            continue;
+        }
+
+        if(!was_frozen_)
+            phases_[k] = atan2f(in_im, *re) * (0.5f / PI_F);
+        else
+            phases_[k] = fastmod1f(phases_[k] + k * phase_inc_);
+
+        *re = magnitudes_[k] * lut_cos(phases_[k]);
+        if(im)
+            *im = magnitudes_[k] * lut_sin(phases_[k]);
+    }
+    was_frozen_ = freeze;
+}
@@ -0,0 +1,81 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_SPECTRALFREEZE_H
+#define DSY_SPECTRALFREEZE_H
+#include <stdint.h>
+#include <stddef.h>
+#ifdef __cplusplus
+
+namespace daisysp
+{
+/** Spectral freeze and blur, an example operator for Stft.
+
+    Blur smooths the magnitude of every bin over time, which smears
+    transients into a wash. Freeze holds the current magnitudes and keeps
+    resynthesizing them with phases that advance at the bin frequencies,
+    which sustains the sound indefinitely.
+
+    \code
+    float DSY_SDRAM_BSS freeze_mem[SpectralFreeze::GetBufferSize(2048)];
+    freeze.Init(freeze_mem, 2048, 512);
+    stft.SetOperator(SpectralFreeze::Operator, &freeze);
+    \endcode
+*/
+class SpectralFreeze
+{
+  public:
+    SpectralFreeze() {}
+    ~SpectralFreeze() {}
+
+    /** Returns the number of floats Init() needs */
+    static constexpr size_t GetBufferSize(size_t fft_size)
+    {
+        return fft_size + 2;
+    }
+
+    /** Initializes the module.
+        \param buffer memory of at least GetBufferSize(fft_size) floats
+        \param fft_size FFT size of the Stft
+        \param hop hop size of the Stft
+    */
+    void Init(float* buffer, size_t fft_size, size_t hop);
+
+    /** Processes one packed spectrum in place */
+    void Process(float* spectrum);
+
+    /** Stft::Operator callback, context is the SpectralFreeze */
+    static void Operator(float* spectrum, size_t, void* context)
+    {
+        static_cast<SpectralFreeze*>(context)->Process(spectrum);
+    }
+
+    /** Holds the current spectrum while true */
+    inline void SetFreeze(bool freeze) { freeze_ = freeze; }
+
+    /** Amount of magnitude smoothing over time.
+        \param blur 0 (none) to 1 (infinite)
+    */
+    void SetBlur(float blur);
+
+    inline bool IsFrozen() const { return freeze_; }
+
+  private:
+    size_t        num_bins_;
+    float         phase_inc_;
+    float         blur_coeff_;
+    float*        magnitudes_;
+    float*        phases_; // in cycles
+    volatile bool freeze_;
+    bool          was_frozen_;
+};
+
+} // namespace daisysp
+#endif
+#endif
@@ -0,0 +1,132 @@
+#include "stft.h"
+#include <math.h>
+#include <string.h>
+
+using namespace daisysp;
+
+bool Stft::Init(float* buffer, size_t fft_size, size_t hop, Window window)
+{
+    if(!fft_.Init(fft_size) || hop == 0 || hop > fft_size / 2
+       || fft_size % hop != 0)
+        return false;
+
+    fft_size_    = fft_size;
+    hop_         = hop;
+    out_size_    = fft_size + hop;
+    window_type_ = window;
+    op_          = nullptr;
+    op_context_  = nullptr;
+
+    window_   = buffer;
+    in_ring_  = window_ + fft_size;
+    out_ring_ = in_ring_ + fft_size;
+    frame_    = out_ring_ + out_size_;
+    spectrum_ = frame_ + fft_size;
+
+    // periodic windows, whose overlapping products sum to fft_size / (2 * hop)
+    const float gain = 2.0f * hop / fft_size;
+    for(size_t n = 0; n < fft_size; n++)
+    {
+        const float phase = static_cast<float>(M_PI) * n / fft_size;
+        window_[n]        = window == Window::HANN ? sinf(phase) * sinf(phase)
+                                                   : sinf(phase);
+    }
+    // the gain is applied once, on the analysis side
+    for(size_t n = 0; n < fft_size; n++)
+        window_[n] *= gain;
+    gain_ = 1.0f / gain;
+
+    memset(in_ring_, 0, fft_size * sizeof(float));
+    memset(out_ring_, 0, out_size_ * sizeof(float));
+    in_pos_       = 0;
+    out_pos_      = 0;
+    since_frame_  = 0;
+    frame_origin_ = 0;
+    stage_        = STAGE_DONE;
+    return true;
+}
+
+void Stft::SetOperator(Operator op, void* context)
+{
+    op_         = op;
+    op_context_ = context;
+}
+
+void Stft::Process(const float* in, float* out, size_t size)
+{
+    const size_t mask = fft_size_ - 1;
+    for(size_t i = 0; i < size; i++)
+    {
+        in_ring_[in_pos_] = in[i];
+        in_pos_           = (in_pos_ + 1) & mask;
+
+        out[i]              = out_ring_[out_pos_];
+        out_ring_[out_pos_] = 0.0f;
+        if(++out_pos_ >= out_size_)
+            out_pos_ = 0;
+
+        if(++since_frame_ >= hop_)
+        {
+            // the previous frame is due now, finish what's left of it
+            while(stage_ != STAGE_DONE)
+                RunStage();
+            StartFrame();
+        }
+    }
+
+    // spread the remaining stages evenly over the calls until the next
+    // frame is due, counting this one
+    if(stage_ != STAGE_DONE)
+    {
+        const size_t remaining  = STAGE_DONE - stage_;
+        const size_t samples    = hop_ - since_frame_;
+        const size_t calls_left = (samples + size - 1) / size + 1;
+        size_t       num_stages = (remaining + calls_left - 1) / calls_left;
+        while(num_stages-- > 0)
+            RunStage();
+    }
+}
+
+void Stft::StartFrame()
+{
+    // oldest sample first
+    for(size_t n = 0; n < fft_size_; n++)
+        frame_[n] = in_ring_[(in_pos_ + n) & (fft_size_ - 1)] * window_[n];
+
+    // the frame covers the last fft_size input samples, which leave the
+    // output fft_size + hop samples later
+    frame_origin_ = out_pos_ + hop_;
+    if(frame_origin_ >= out_size_)
+        frame_origin_ -= out_size_;
+    since_frame_ = 0;
+    stage_       = STAGE_FORWARD;
+}
+
+void Stft::RunStage()
+{
+    switch(stage_)
+    {
+        case STAGE_FORWARD: fft_.Forward(frame_, spectrum_); break;
+        case STAGE_OPERATOR:
+            if(op_ != nullptr)
+                op_(spectrum_, fft_size_, op_context_);
+            break;
+        case STAGE_INVERSE: fft_.Inverse(spectrum_, frame_); break;
+        case STAGE_OVERLAP_ADD:
+        {
+            size_t pos = frame_origin_;
+            for(size_t n = 0; n < fft_size_; n++)
+            {
+                float sample = frame_[n];
+                if(window_type_ == Window::SQRT_HANN)
+                    sample *= window_[n] * gain_;
+                out_ring_[pos] += sample;
+                if(++pos >= out_size_)
+                    pos = 0;
+            }
+        }
+        break;
+        default: break;
+    }
+    stage_ = static_cast<Stage>(stage_ + 1);
+}
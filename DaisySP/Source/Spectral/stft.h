@@ -0,0 +1,128 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_STFT_H
+#define DSY_STFT_H
+#include <stdint.h>
+#include <stddef.h>
+#include "Spectral/fft.h"
+#ifdef __cplusplus
+
+namespace daisysp
+{
+/** Streaming short-time Fourier transform with overlap-add resynthesis.
+
+    Every `hop` samples, the last `fft_size` input samples are windowed and
+    transformed, passed to a spectral operator, transformed back and
+    overlap-added into the output.
+
+    The work for a frame is split into stages (forward FFT, operator,
+    inverse FFT, overlap-add), which are spread over the Process() calls
+    until the next frame is due. With a hop of several blocks, each block
+    runs about one stage instead of all of them, so the cost per block
+    stays flat. This adds one hop to the latency, see GetLatency().
+
+    The memory is provided by the caller, e.g. in SDRAM:
+    \code
+    float DSY_SDRAM_BSS stft_mem[Stft::GetBufferSize(2048, 512)];
+    stft.Init(stft_mem, 2048, 512, Stft::Window::SQRT_HANN);
+    stft.SetOperator(MyOperator, &my_data);
+    \endcode
+
+    The spectrum passed to the operator uses the packed format of RealFft.
+*/
+class Stft
+{
+  public:
+    enum class Window
+    {
+        /** Hann analysis window, no synthesis window. For operators that
+            only change magnitudes slightly. Requires hop <= fft_size / 2.
+        */
+        HANN,
+        /** Square root Hann for analysis and synthesis, which hides
+            discontinuities introduced by the operator. Requires
+            hop <= fft_size / 2.
+        */
+        SQRT_HANN,
+    };
+
+    /** Called once per frame with the spectrum of the windowed input.
+        The spectrum can be modified in place.
+        \param spectrum packed spectrum, see RealFft
+        \param fft_size number of floats in spectrum
+        \param context pointer passed to SetOperator()
+    */
+    typedef void (*Operator)(float* spectrum, size_t fft_size, void* context);
+
+    Stft() {}
+    ~Stft() {}
+
+    /** Returns the number of floats Init() needs for the given sizes */
+    static constexpr size_t GetBufferSize(size_t fft_size, size_t hop)
+    {
+        return 5 * fft_size + hop;
+    }
+
+    /** Initializes the engine.
+        \param buffer memory of at least GetBufferSize(fft_size, hop) floats
+        \param fft_size power of two from RealFft::kMinSize to RealFft::kMaxSize
+        \param hop number of samples between frames, a divisor of fft_size
+        \param window analysis/synthesis window
+        \return false if the sizes are not supported
+    */
+    bool Init(float* buffer, size_t fft_size, size_t hop, Window window);
+
+    /** Sets the spectral operator, or nullptr to pass the spectrum through */
+    void SetOperator(Operator op, void* context);
+
+    /** Processes a block of samples. `in` and `out` may be the same. */
+    void Process(const float* in, float* out, size_t size);
+
+    /** Delay between the input and output in samples */
+    inline size_t GetLatency() const { return fft_size_ + hop_; }
+
+    inline size_t GetFftSize() const { return fft_size_; }
+    inline size_t GetHop() const { return hop_; }
+
+  private:
+    enum Stage
+    {
+        STAGE_FORWARD,
+        STAGE_OPERATOR,
+        STAGE_INVERSE,
+        STAGE_OVERLAP_ADD,
+        STAGE_DONE,
+    };
+
+    void StartFrame();
+    void RunStage();
+
+    RealFft  fft_;
+    Operator op_;
+    void*    op_context_;
+    Window   window_type_;
+    size_t   fft_size_, hop_, out_size_;
+    float    gain_; // removes the analysis gain from the synthesis window
+
+    float* window_;   // analysis window, scaled for unity gain
+    float* in_ring_;  // last fft_size input samples
+    float* out_ring_; // overlap-add accumulator, fft_size + hop samples
+    float* frame_;    // time domain frame
+    float* spectrum_; // packed spectrum
+
+    size_t in_pos_, out_pos_;
+    size_t since_frame_;  // samples since the last frame was started
+    size_t frame_origin_; // out_ring position of the frame's first sample
+    Stage  stage_;
+};
+
+} // namespace daisysp
+#endif
+#endif
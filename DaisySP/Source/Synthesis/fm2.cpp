@@ -63,3 +63,9 @@ void Fm2::Reset()
     car_.Reset();
     mod_.Reset();
 }
+
+void Fm2::SetSampleRate(float sample_rate)
+{
+    car_.SetSampleRate(sample_rate);
+    mod_.SetSampleRate(sample_rate);
+}
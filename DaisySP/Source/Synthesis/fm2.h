@@ -60,6 +60,9 @@ class Fm2
     /** Resets both oscillators */
     void Reset();
 
+    /** Changes the sample rate of both oscillators without resetting them */
+    void SetSampleRate(float sample_rate);
+
   private:
     static constexpr float kIdxScalar      = 0.2f;
     static constexpr float kIdxScalarRecip = 1.f / kIdxScalar;
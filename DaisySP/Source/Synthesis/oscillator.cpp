@@ -1,5 +1,6 @@
 #include "dsp.h"
 #include "oscillator.h"
+#include "silence.h"
 
 using namespace daisysp;
 static inline float Polyblep(float phase_inc, float t);
@@ -58,6 +59,24 @@ float Oscillator::Process()
     return out * amp_;
 }
 
+bool Oscillator::ProcessBlock(float* out, const float* vca, size_t size)
+{
+    if(IsSilentBlock(vca, size))
+    {
+        // the phase moves on as if the samples had been computed, so a
+        // voice that wakes up is still in phase with its other oscillators
+        const float phase = phase_ + phase_inc_ * size;
+        phase_            = fastmod1f(phase);
+        eoc_              = phase > 1.0f;
+        eor_              = false;
+        ClearBlock(out, size);
+        return true;
+    }
+    for(size_t i = 0; i < size; i++)
+        out[i] = Process() * vca[i];
+    return false;
+}
+
 float Oscillator::CalcPhaseInc(float f)
 {
     return f * sr_recip_;
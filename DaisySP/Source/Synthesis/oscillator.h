@@ -10,6 +10,7 @@ https://opensource.org/licenses/MIT.
 #ifndef DSY_OSCILLATOR_H
 #define DSY_OSCILLATOR_H
 #include <stdint.h>
+#include <stddef.h>
 #include "Utility/dsp.h"
 #ifdef __cplusplus
 
@@ -59,9 +60,20 @@ class Oscillator
         waveform_  = WAVE_SIN;
         eoc_       = true;
         eor_       = true;
+        last_out_  = 0.0f;
     }
 
 
+    /** Changes the sample rate without resetting the phase, and recalculates
+        the phase increment for the current frequency.
+    */
+    void SetSampleRate(float sample_rate)
+    {
+        sr_        = sample_rate;
+        sr_recip_  = 1.0f / sample_rate;
+        phase_inc_ = CalcPhaseInc(freq_);
+    }
+
     /** Changes the frequency of the Oscillator, and recalculates phase increment.
     */
     inline void SetFreq(const float f)
@@ -104,6 +116,17 @@ class Oscillator
     */
     float Process();
 
+    /** Processes a block through a VCA, out[i] = Process() * vca[i].
+        When the whole vca block is below kSilenceThreshold, e.g. from an
+        idle envelope, the waveform isn't computed: the phase only moves on
+        by the block and the output is zeros.
+        \param out output block
+        \param vca gain of each sample, may be the same as out
+        \param size number of samples
+        \return true if the output block is all zeros
+    */
+    bool ProcessBlock(float* out, const float* vca, size_t size);
+
 
     /** Adds a value 0.0-1.0 (equivalent to 0.0-TWO_PI) to the current phase. Useful for PM and "FM" synthesis.
     */
@@ -1,5 +1,6 @@
 #include <math.h>
 #include "dcblock.h"
+#include "dsp.h"
 
 using namespace daisysp;
 
@@ -14,7 +15,7 @@ float DcBlock::Process(float in)
 {
     float out;
     out     = in - input_ + (gain_ * output_);
-    output_ = out;
+    output_ = flush_denormal(out);
     input_  = in;
     return out;
 }
@@ -11,6 +11,7 @@ https://opensource.org/licenses/MIT.
 #define DSY_DELAY_H
 #include <stdlib.h>
 #include <stdint.h>
+#include "dsp.h"
 namespace daisysp
 {
 /** Simple Delay line.
@@ -34,15 +35,16 @@ class DelayLine
     */
     void Init() { Reset(); }
     /** clears buffer, sets write ptr to 0, and delay to 1 sample.
+
+        The buffer isn't touched, so this takes the same time for any size.
+        Samples that haven't been written since the reset read as zero,
+        exactly as if the buffer had been cleared.
     */
     void Reset()
     {
-        for(size_t i = 0; i < max_size; i++)
-        {
-            line_[i] = T(0);
-        }
         write_ptr_ = 0;
         delay_     = 1;
+        valid_     = 0;
     }
 
     /** sets the delay time in samples
@@ -71,14 +73,16 @@ class DelayLine
     {
         line_[write_ptr_] = sample;
         write_ptr_        = (write_ptr_ - 1 + max_size) % max_size;
+        if(valid_ < max_size)
+            valid_++;
     }
 
     /** returns the next sample of type T in the delay line, interpolated if necessary.
     */
     inline const T Read() const
     {
-        T a = line_[(write_ptr_ + delay_) % max_size];
-        T b = line_[(write_ptr_ + delay_ + 1) % max_size];
+        T a = Tap(delay_);
+        T b = Tap(delay_ + 1);
         return a + (b - a) * frac_;
     }
 
@@ -87,8 +91,8 @@ class DelayLine
     {
         int32_t delay_integral   = static_cast<int32_t>(delay);
         float   delay_fractional = delay - static_cast<float>(delay_integral);
-        const T a = line_[(write_ptr_ + delay_integral) % max_size];
-        const T b = line_[(write_ptr_ + delay_integral + 1) % max_size];
+        const T a = Tap(delay_integral);
+        const T b = Tap(delay_integral + 1);
         return a + (b - a) * delay_fractional;
     }
 
@@ -97,11 +101,11 @@ class DelayLine
         int32_t delay_integral   = static_cast<int32_t>(delay);
         float   delay_fractional = delay - static_cast<float>(delay_integral);
 
-        int32_t     t     = (write_ptr_ + delay_integral + max_size);
-        const T     xm1   = line_[(t - 1) % max_size];
-        const T     x0    = line_[(t) % max_size];
-        const T     x1    = line_[(t + 1) % max_size];
-        const T     x2    = line_[(t + 2) % max_size];
+        size_t      t     = delay_integral + max_size;
+        const T     xm1   = Tap(t - 1);
+        const T     x0    = Tap(t);
+        const T     x1    = Tap(t + 1);
+        const T     x2    = Tap(t + 2);
         const float c     = (x1 - xm1) * 0.5f;
         const float v     = x0 - x1;
         const float w     = c + v;
@@ -113,16 +117,28 @@ class DelayLine
 
     inline const T Allpass(const T sample, size_t delay, const T coefficient)
     {
-        T read  = line_[(write_ptr_ + delay) % max_size];
-        T write = sample + coefficient * read;
+        T read  = Tap(delay);
+        T write = flush_denormal(sample + coefficient * read);
         Write(write);
         return -write * coefficient + read;
     }
 
   private:
+    /** Returns the sample `offset` positions behind the write pointer, i.e.
+        written `offset` samples ago, or zero if it hasn't been written since
+        Reset().
+    */
+    inline const T Tap(size_t offset) const
+    {
+        if(valid_ < max_size && (offset + max_size - 1) % max_size >= valid_)
+            return T(0);
+        return line_[(write_ptr_ + offset) % max_size];
+    }
+
     float  frac_;
     size_t write_ptr_;
     size_t delay_;
+    size_t valid_; /**< number of samples written since Reset(), up to max_size */
     T      line_[max_size];
 };
 } // namespace daisysp
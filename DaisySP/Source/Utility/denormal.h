@@ -0,0 +1,99 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_DENORMAL_H
+#define DSY_DENORMAL_H
+#include <stdint.h>
+#if defined(__SSE__) || defined(__x86_64__) || defined(_M_X64)
+#include <xmmintrin.h>
+#endif
+#ifdef __cplusplus
+
+namespace daisysp
+{
+/** Puts the FPU into flush-to-zero mode for the lifetime of the object,
+    and restores the previous mode afterwards.
+
+    With flush-to-zero, subnormal results (and on x86 also subnormal
+    inputs) are replaced by zero, so decaying filter and feedback states
+    don't slow down processing during silence. Create one at the start of
+    the audio callback or render loop:
+
+    void AudioCallback(...)
+    {
+        FtzScope ftz;
+        ...
+    }
+
+    - Cortex-M7 / ARMv7: sets FPSCR.FZ
+    - AArch64: sets FPCR.FZ
+    - x86: sets the MXCSR FTZ and DAZ bits
+    - other platforms: does nothing
+
+    Modules with recursive state also use flush_denormal() from dsp.h, so
+    they stay fast when this isn't used.
+*/
+class FtzScope
+{
+  public:
+    FtzScope()
+    {
+        saved_ = GetState();
+        SetState(saved_ | kFlushBits);
+    }
+    ~FtzScope() { SetState(saved_); }
+
+  private:
+#if defined(__arm__) && defined(__VFP_FP__) && !defined(__SOFTFP__)
+    typedef uint32_t       State;
+    static constexpr State kFlushBits = State(1) << 24; // FPSCR.FZ
+    static inline State    GetState()
+    {
+        State state;
+        asm volatile("vmrs %0, fpscr" : "=r"(state));
+        return state;
+    }
+    static inline void SetState(State state)
+    {
+        asm volatile("vmsr fpscr, %0" : : "r"(state));
+    }
+#elif defined(__aarch64__)
+    typedef uint64_t       State;
+    static constexpr State kFlushBits = State(1) << 24; // FPCR.FZ
+    static inline State    GetState()
+    {
+        State state;
+        asm volatile("mrs %0, fpcr" : "=r"(state));
+        return state;
+    }
+    static inline void SetState(State state)
+    {
+        asm volatile("msr fpcr, %0" : : "r"(state));
+    }
+#elif defined(__SSE__) || defined(__x86_64__) || defined(_M_X64)
+    typedef unsigned int   State;
+    static constexpr State kFlushBits = 0x8040; // MXCSR FTZ | DAZ
+    static inline State    GetState() { return _mm_getcsr(); }
+    static inline void     SetState(State state) { _mm_setcsr(state); }
+#else
+    typedef uint32_t       State;
+    static constexpr State kFlushBits = 0;
+    static inline State    GetState() { return 0; }
+    static inline void     SetState(State) {}
+#endif
+
+    State saved_;
+
+    FtzScope(const FtzScope&) = delete;
+    FtzScope& operator=(const FtzScope&) = delete;
+};
+
+} // namespace daisysp
+#endif
+#endif
@@ -267,6 +267,26 @@ inline void TestFloat(float &x, float y = 0.f)
     }
 }
 
+/** Values below this magnitude (about -300 dB) are flushed to zero by
+ ** flush_denormal(), well before they reach the subnormal range. */
+static constexpr float kDenormalThreshold = 1.0e-15f;
+
+/** Flushes tiny values to zero.
+ ** Use this on the state of recursive structures (filter states, feedback
+ ** paths) so that decaying states never become subnormal, which is very
+ ** slow when the FPU isn't in flush-to-zero mode.
+ ** Values of other types than float are returned unchanged. */
+inline float flush_denormal(float x)
+{
+    return (x > -kDenormalThreshold && x < kDenormalThreshold) ? 0.0f : x;
+}
+
+template <typename T>
+inline T flush_denormal(T x)
+{
+    return x;
+}
+
 /** Based on soft saturate from:
 [musicdsp.org](musicdsp.org/en/latest/Effects/42-soft-saturation.html)
 Bram de Jong (2002-01-17)
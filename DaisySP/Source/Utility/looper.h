@@ -7,7 +7,6 @@ https://opensource.org/licenses/MIT.
 */
 
 #pragma once
-#include <algorithm>
 #include "dsp.h"
 
 namespace daisysp
@@ -46,12 +45,16 @@ class Looper
         FRIPPERTRONICS,
     };
 
+    /** Initializes the looper with a buffer of `size` samples.
+     ** The buffer doesn't need to be cleared, every part of the loop is
+     ** recorded before it is played back. So this returns immediately,
+     ** even for large SDRAM buffers.
+     */
     void Init(float *mem, size_t size)
     {
         buffer_size_ = size;
         buff_        = mem;
 
-        InitBuff();
         state_      = State::EMPTY;
         mode_       = Mode::NORMAL;
         half_speed_ = false;
@@ -77,6 +80,11 @@ class Looper
             case State::REC_FIRST:
                 sig = 0.f;
                 Write(pos_, input * win_);
+                // The buffer isn't cleared on Init, so keep the sample after
+                // the recording silent. It is played once when the
+                // recording stops.
+                if(pos_ + 1 < buffer_size_)
+                    Write(pos_ + 1, 0.f);
                 if(win_idx_ < kWindowSamps - 1)
                     win_idx_ += 1;
                 recsize_ = pos_;
@@ -248,9 +256,6 @@ class Looper
         return reverse_ ? -inc : inc;
     }
 
-    /** Initialize the buffer */
-    void InitBuff() { std::fill(&buff_[0], &buff_[buffer_size_ - 1], 0); }
-
     /** Get a floating point sample from the buffer */
     inline const float Read(size_t pos) const { return buff_[pos]; }
 
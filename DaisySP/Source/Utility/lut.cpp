@@ -0,0 +1,40 @@
+#include "lut.h"
+
+using namespace daisysp;
+
+namespace
+{
+constexpr double SineCycle(double x)
+{
+    return lut_math::Sin(2.0 * lut_math::kPi * x);
+}
+
+constexpr double SemitonesToRatio(double x)
+{
+    return lut_math::Exp2(x / 12.0);
+}
+
+constexpr double DbToGain(double x)
+{
+    // 10^(x / 20) = e^(x * ln(10) / 20)
+    return lut_math::Exp(x * 0.11512925464970228420);
+}
+} // namespace
+
+namespace daisysp
+{
+constexpr Lut<kLutSineSize + 1> lut_sine
+    = MakeLut<kLutSineSize + 1>(SineCycle, 0.0, 1.0);
+
+constexpr Lut<kLutRatioHighSize + 1> lut_pitch_ratio_high
+    = MakeLut<kLutRatioHighSize + 1>(SemitonesToRatio, -128.0, 128.0);
+
+constexpr Lut<kLutRatioLowSize + 1> lut_pitch_ratio_low
+    = MakeLut<kLutRatioLowSize + 1>(SemitonesToRatio, 0.0, 1.0);
+
+constexpr Lut<kLutTanhSize + 1> lut_tanh_table
+    = MakeLut<kLutTanhSize + 1>(lut_math::Tanh, -kLutTanhRange, kLutTanhRange);
+
+constexpr Lut<kLutDbSize + 1> lut_db_gain
+    = MakeLut<kLutDbSize + 1>(DbToGain, kLutDbMin, kLutDbMax);
+} // namespace daisysp
@@ -0,0 +1,220 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+/** Lookup tables shared by all modules, with interpolated accessors.
+
+    The tables are generated by the compiler (see MakeLut()) and stored as
+    const data, so on the Daisy they live in flash and cost no RAM or
+    Init() time. Use them instead of per-instance tables or libm calls in
+    the audio path.
+*/
+#pragma once
+#ifndef DSY_LUT_H
+#define DSY_LUT_H
+#include <stddef.h>
+#include <stdint.h>
+#ifdef __cplusplus
+
+namespace daisysp
+{
+/** A fixed size table of floats that can be built at compile time */
+template <size_t N>
+struct Lut
+{
+    static constexpr size_t kSize = N;
+
+    constexpr float operator[](size_t i) const { return data[i]; }
+
+    float data[N];
+};
+
+/** constexpr versions of the libm functions used to generate the tables.
+    They are computed in double precision, and are too slow to use at
+    runtime.
+*/
+namespace lut_math
+{
+static constexpr double kPi = 3.14159265358979323846;
+
+constexpr double Sin(double x)
+{
+    const double two_pi = 2.0 * kPi;
+    x -= static_cast<long>(x / two_pi) * two_pi;
+    if(x > kPi)
+        x -= two_pi;
+    else if(x < -kPi)
+        x += two_pi;
+
+    double term = x, sum = x;
+    for(int i = 1; i < 14; i++)
+    {
+        term *= -x * x / ((2 * i) * (2 * i + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double Exp(double x)
+{
+    // e^x = (e^(x / 2^k))^(2^k), with the series evaluated for |x| <= 0.5
+    int k = 0;
+    while(x > 0.5 || x < -0.5)
+    {
+        x *= 0.5;
+        k++;
+    }
+    double term = 1.0, sum = 1.0;
+    for(int i = 1; i < 18; i++)
+    {
+        term *= x / i;
+        sum += term;
+    }
+    while(k-- > 0)
+        sum *= sum;
+    return sum;
+}
+
+constexpr double Exp2(double x)
+{
+    return Exp(x * 0.69314718055994530942);
+}
+
+constexpr double Tanh(double x)
+{
+    const double e = Exp(2.0 * x);
+    return (e - 1.0) / (e + 1.0);
+}
+
+constexpr double Sqrt(double x)
+{
+    if(x <= 0.0)
+        return 0.0;
+    double y = x > 1.0 ? x : 1.0;
+    for(int i = 0; i < 64; i++)
+        y = 0.5 * (y + x / y);
+    return y;
+}
+} // namespace lut_math
+
+/** Builds a table with N points of fn, evenly spaced over [x0, x1].
+    fn has to be a constexpr function for the table to be built at compile
+    time, e.g.
+
+    constexpr double MySquare(double x) { return x * x; }
+    constexpr Lut<65> kSquares = MakeLut<65>(MySquare, 0.0, 1.0);
+*/
+template <size_t N>
+constexpr Lut<N> MakeLut(double (*fn)(double), double x0, double x1)
+{
+    Lut<N> lut{};
+    for(size_t i = 0; i < N; i++)
+        lut.data[i] = static_cast<float>(fn(x0 + (x1 - x0) * i / (N - 1)));
+    return lut;
+}
+
+/** Number of segments in the tables below. Each table has one extra
+    guard point so the interpolation never wraps.
+*/
+static constexpr size_t kLutSineSize      = 1024;
+static constexpr size_t kLutRatioHighSize = 256;
+static constexpr size_t kLutRatioLowSize  = 256;
+static constexpr size_t kLutTanhSize      = 1024;
+static constexpr size_t kLutDbSize        = 288;
+
+/** Range of the tanh and dB tables. Inputs outside are clamped. */
+static constexpr float kLutTanhRange = 8.0f;
+static constexpr float kLutDbMin     = -120.0f;
+static constexpr float kLutDbMax     = 24.0f;
+
+/** sin(2 * pi * x) for x in [0, 1] */
+extern const Lut<kLutSineSize + 1> lut_sine;
+/** 2^(n / 12) for n in [-128, 128] semitones */
+extern const Lut<kLutRatioHighSize + 1> lut_pitch_ratio_high;
+/** 2^(x / 12) for x in [0, 1] semitone */
+extern const Lut<kLutRatioLowSize + 1> lut_pitch_ratio_low;
+/** tanh(x) for x in [-kLutTanhRange, kLutTanhRange] */
+extern const Lut<kLutTanhSize + 1> lut_tanh_table;
+/** 10^(x / 20) for x in [kLutDbMin, kLutDbMax] dB */
+extern const Lut<kLutDbSize + 1> lut_db_gain;
+
+/** Linear interpolation in a table, `index` has to be in [0, N - 1] */
+template <size_t N>
+inline float lut_interpolate(const Lut<N>& lut, float index)
+{
+    const int32_t i    = static_cast<int32_t>(index);
+    const float   frac = index - static_cast<float>(i);
+    const float   a    = lut.data[i];
+    const float   b    = lut.data[i + 1 < int32_t(N) ? i + 1 : i];
+    return a + (b - a) * frac;
+}
+
+/** Sine of a phase in cycles, i.e. sin(2 * pi * phase). Any phase is
+    accepted. Max error is about 5e-6.
+*/
+inline float lut_sin(float phase)
+{
+    phase -= static_cast<float>(static_cast<int32_t>(phase));
+    if(phase < 0.0f)
+        phase += 1.0f;
+    return lut_interpolate(lut_sine, phase * kLutSineSize);
+}
+
+/** Cosine of a phase in cycles, i.e. cos(2 * pi * phase) */
+inline float lut_cos(float phase)
+{
+    return lut_sin(phase + 0.25f);
+}
+
+/** Half sine window, sin(pi * x) for x in [0, 1], as used to crossfade
+    grains and delay taps. x is clamped to [0, 1].
+*/
+inline float lut_sine_window(float x)
+{
+    x = x < 0.0f ? 0.0f : (x > 1.0f ? 1.0f : x);
+    return lut_interpolate(lut_sine, x * (kLutSineSize / 2));
+}
+
+/** Frequency ratio of an interval in semitones, 2^(semitones / 12).
+    Valid for [-128, 128] semitones, relative error is below 1e-6.
+*/
+inline float lut_semitones_to_ratio(float semitones)
+{
+    float pitch = semitones + 128.0f;
+    pitch       = pitch < 0.0f ? 0.0f : (pitch > 255.999f ? 255.999f : pitch);
+    const int32_t integral = static_cast<int32_t>(pitch);
+    const float   frac     = pitch - static_cast<float>(integral);
+    return lut_pitch_ratio_high.data[integral]
+           * lut_interpolate(lut_pitch_ratio_low, frac * kLutRatioLowSize);
+}
+
+/** tanh(x), clamped to tanh(+/-kLutTanhRange) outside of the table range */
+inline float lut_tanh(float x)
+{
+    x = x < -kLutTanhRange ? -kLutTanhRange
+                           : (x > kLutTanhRange ? kLutTanhRange : x);
+    return lut_interpolate(lut_tanh_table,
+                           (x + kLutTanhRange)
+                               * (kLutTanhSize / (2.0f * kLutTanhRange)));
+}
+
+/** Converts decibels to a linear gain, 10^(db / 20). The input is clamped
+    to [kLutDbMin, kLutDbMax], below kLutDbMin the gain is 0.
+*/
+inline float lut_db_to_gain(float db)
+{
+    if(db <= kLutDbMin)
+        return 0.0f;
+    db = db > kLutDbMax ? kLutDbMax : db;
+    return lut_interpolate(lut_db_gain,
+                           (db - kLutDbMin)
+                               * (kLutDbSize / (kLutDbMax - kLutDbMin)));
+}
+
+} // namespace daisysp
+#endif
+#endif
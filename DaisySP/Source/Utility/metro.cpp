@@ -23,6 +23,12 @@ uint8_t Metro::Process()
     return 0;
 }
 
+void Metro::SetSampleRate(float sample_rate)
+{
+    sample_rate_ = sample_rate;
+    SetFreq(freq_);
+}
+
 void Metro::SetFreq(float freq)
 {
     freq_    = freq;
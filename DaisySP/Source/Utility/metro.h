@@ -45,6 +45,9 @@ class Metro
     */
     inline float GetFreq() { return freq_; }
 
+    /** Changes the sample rate without resetting the phase */
+    void SetSampleRate(float sample_rate);
+
   private:
     float freq_;
     float phs_, sample_rate_, phs_inc_;
@@ -0,0 +1,239 @@
+#include "pitchdetector.h"
+#include "dsp.h"
+#include <math.h>
+#include <string.h>
+
+using namespace daisysp;
+
+namespace
+{
+// the first NSDF peak above this fraction of the highest one is chosen,
+// lower values prefer longer periods and risk octave errors below
+constexpr float kPeakCutoff = 0.9f;
+} // namespace
+
+float PitchDetector::Biquad::Process(float in)
+{
+    const float out = b0 * in + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+    x2              = x1;
+    x1              = in;
+    y2              = y1;
+    y1              = flush_denormal(out);
+    return out;
+}
+
+size_t PitchDetector::GetWindowSize(float  sample_rate,
+                                    size_t decimation,
+                                    float  min_freq)
+{
+    // two periods of the lowest pitch
+    const float periods = 2.0f * sample_rate / (decimation * min_freq);
+    for(size_t window = kMinWindow; window <= kMaxWindow; window *= 2)
+        if(window >= periods)
+            return window;
+    return 0;
+}
+
+bool PitchDetector::Init(float* buffer,
+                         float  sample_rate,
+                         size_t window,
+                         size_t decimation)
+{
+    if(window < kMinWindow || window > kMaxWindow || (window & (window - 1))
+       || !(decimation == 1 || decimation == 2 || decimation == 4
+            || decimation == 8)
+       || !fft_.Init(2 * window))
+        return false;
+
+    window_         = window;
+    hop_            = window / 4;
+    decimation_     = decimation;
+    decimated_rate_ = sample_rate / decimation;
+    ring_mask_      = 2 * window - 1;
+    ring_           = buffer;
+    frame_          = ring_ + 2 * window;
+    spectrum_       = frame_ + 2 * window;
+
+    // 4th order Butterworth lowpass at 80% of the decimated Nyquist
+    const float w0     = TWOPI_F * 0.4f / decimation;
+    const float cos_w0 = cosf(w0);
+    const float q[2]   = {0.5411961f, 1.3065630f};
+    for(size_t i = 0; i < 2; i++)
+    {
+        Biquad&     f     = lowpass_[i];
+        const float alpha = sinf(w0) / (2.0f * q[i]);
+        const float a0    = 1.0f + alpha;
+        f.b0              = 0.5f * (1.0f - cos_w0) / a0;
+        f.b1              = (1.0f - cos_w0) / a0;
+        f.b2              = f.b0;
+        f.a1              = -2.0f * cos_w0 / a0;
+        f.a2              = (1.0f - alpha) / a0;
+        f.x1 = f.x2 = f.y1 = f.y2 = 0.0f;
+    }
+
+    threshold_     = 0.8f;
+    silence_level_ = 0.001f;
+    frequency_     = 0.0f;
+    confidence_    = 0.0f;
+    memset(ring_, 0, 2 * window * sizeof(float));
+    ring_pos_    = 0;
+    phase_       = 0;
+    since_frame_ = 0;
+    stage_       = STAGE_DONE;
+    return true;
+}
+
+void PitchDetector::Process(const float* in, size_t size)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        float sample = in[i];
+        if(decimation_ > 1)
+        {
+            sample = lowpass_[1].Process(lowpass_[0].Process(sample));
+            if(++phase_ < decimation_)
+                continue;
+            phase_ = 0;
+        }
+
+        ring_[ring_pos_] = sample;
+        ring_pos_        = (ring_pos_ + 1) & ring_mask_;
+        if(++since_frame_ >= hop_)
+        {
+            // the previous estimate is due now, finish what's left of it
+            while(stage_ != STAGE_DONE)
+                RunStage();
+            StartFrame();
+        }
+    }
+
+    // spread the remaining stages evenly over the calls until the next
+    // frame is due, counting this one
+    if(stage_ != STAGE_DONE && size > 0)
+    {
+        const size_t remaining  = STAGE_DONE - stage_;
+        const size_t samples    = (hop_ - since_frame_) * decimation_;
+        const size_t calls_left = (samples + size - 1) / size + 1;
+        size_t       num_stages = (remaining + calls_left - 1) / calls_left;
+        while(num_stages-- > 0)
+            RunStage();
+    }
+}
+
+void PitchDetector::StartFrame()
+{
+    // the ring holds twice the window, so the frame stays intact while
+    // the next hop is written
+    frame_start_ = (ring_pos_ - window_) & ring_mask_;
+    since_frame_ = 0;
+    stage_       = STAGE_FORWARD;
+}
+
+float PitchDetector::Sample(size_t n) const
+{
+    return ring_[(frame_start_ + n) & ring_mask_];
+}
+
+void PitchDetector::RunStage()
+{
+    switch(stage_)
+    {
+        case STAGE_FORWARD:
+            // zero padding to twice the size avoids circular wrap around
+            for(size_t n = 0; n < window_; n++)
+                frame_[n] = Sample(n);
+            memset(frame_ + window_, 0, window_ * sizeof(float));
+            fft_.Forward(frame_, spectrum_);
+            break;
+        case STAGE_POWER:
+            spectrum_[0] *= spectrum_[0];
+            spectrum_[1] *= spectrum_[1];
+            for(size_t k = 1; k < window_; k++)
+            {
+                const float re       = spectrum_[2 * k];
+                const float im       = spectrum_[2 * k + 1];
+                spectrum_[2 * k]     = re * re + im * im;
+                spectrum_[2 * k + 1] = 0.0f;
+            }
+            break;
+        case STAGE_INVERSE: fft_.Inverse(spectrum_, frame_); break;
+        case STAGE_PEAK: Peak(); break;
+        default: break;
+    }
+    stage_ = static_cast<Stage>(stage_ + 1);
+}
+
+void PitchDetector::Peak()
+{
+    // frame_ holds the autocorrelation r(tau), turned into the NSDF
+    // n(tau) = 2 r(tau) / m(tau) in place, with
+    // m(tau) = sum of x[j]^2 + x[j + tau]^2 over the overlap
+    const size_t max_lag = window_ / 2 + 1;
+    float        m       = 2.0f * frame_[0];
+    if(frame_[0] < silence_level_ * silence_level_ * window_)
+    {
+        confidence_ = 0.0f;
+        return;
+    }
+    frame_[0] = 1.0f;
+    for(size_t tau = 1; tau <= max_lag; tau++)
+    {
+        const float a = Sample(tau - 1);
+        const float b = Sample(window_ - tau);
+        m -= a * a + b * b;
+        frame_[tau] = m > 0.0f ? 2.0f * frame_[tau] / m : 0.0f;
+    }
+
+    // key maxima are the highest points between a positive going zero
+    // crossing and the next negative going one, after the lobe at 0
+    float highest = 0.0f;
+    for(int pass = 0; pass < 2; pass++)
+    {
+        const float cutoff   = kPeakCutoff * highest;
+        bool        positive = false, started = false;
+        size_t      best     = 0;
+        for(size_t tau = 1; tau < max_lag; tau++)
+        {
+            const float n = frame_[tau];
+            if(!started)
+            {
+                started = n < 0.0f;
+                continue;
+            }
+            if(n > 0.0f)
+            {
+                positive = true;
+                if(best == 0 || n > frame_[best])
+                    best = tau;
+            }
+            if((n <= 0.0f || tau == max_lag - 1) && positive)
+            {
+                positive = false;
+                if(pass == 0)
+                {
+                    highest = fmaxf(highest, frame_[best]);
+                }
+                else if(frame_[best] >= cutoff)
+                {
+                    // parabolic interpolation of the peak
+                    const float l     = frame_[best - 1];
+                    const float c     = frame_[best];
+                    const float r     = frame_[best + 1];
+                    const float denom = l - 2.0f * c + r;
+                    float       delta = denom < 0.0f ? 0.5f * (l - r) / denom
+                                                     : 0.0f;
+                    delta             = fclamp(delta, -0.5f, 0.5f);
+                    const float height = c - 0.25f * (l - r) * delta;
+                    confidence_        = fclamp(height, 0.0f, 1.0f);
+                    if(confidence_ >= threshold_)
+                        frequency_ = decimated_rate_ / (best + delta);
+                    return;
+                }
+                best = 0;
+            }
+        }
+        if(highest <= 0.0f)
+            break;
+    }
+    confidence_ = 0.0f;
+}
@@ -0,0 +1,149 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_PITCHDETECTOR_H
+#define DSY_PITCHDETECTOR_H
+#include <stdint.h>
+#include <stddef.h>
+#include "Spectral/fft.h"
+#ifdef __cplusplus
+
+namespace daisysp
+{
+/** Monophonic pitch tracker based on the McLeod Pitch Method (MPM).
+
+    The input is lowpass filtered and decimated, then the normalized square
+    difference function (NSDF) of the last `window` decimated samples is
+    computed from an FFT autocorrelation. The first peak of the NSDF close
+    to its highest peak gives the period, and its height the confidence.
+
+    Latency and accuracy are set by Init():
+    - `window` is the analysis length in decimated samples. It has to hold
+      two periods of the lowest pitch, see GetWindowSize().
+    - `decimation` lowers the cost and the highest trackable pitch.
+
+    A new estimate is made every window / 4 decimated samples. The work is
+    split into stages that are spread over the Process() calls in between,
+    so the cost per block stays bounded.
+
+    \code
+    // down to 60 Hz, at a quarter of the sample rate
+    const size_t window = PitchDetector::GetWindowSize(48000.0f, 4, 60.0f);
+    float DSY_SDRAM_BSS pd_mem[PitchDetector::GetBufferSize(1024)];
+    pd.Init(pd_mem, 48000.0f, window, 4);
+    ...
+    pd.Process(in, size);
+    if(pd.IsVoiced())
+        osc.SetFreq(pd.GetFrequency());
+    \endcode
+*/
+class PitchDetector
+{
+  public:
+    /** Largest window, the autocorrelation uses an FFT of twice the size */
+    static constexpr size_t kMaxWindow = RealFft::kMaxSize / 2;
+    static constexpr size_t kMinWindow = RealFft::kMinSize / 2;
+
+    PitchDetector() {}
+    ~PitchDetector() {}
+
+    /** Returns the number of floats Init() needs */
+    static constexpr size_t GetBufferSize(size_t window)
+    {
+        // input ring, FFT frame and spectrum, each twice the window
+        return 6 * window;
+    }
+
+    /** Returns the smallest supported window for a lowest pitch, or 0 if
+        the pitch is too low for kMaxWindow.
+    */
+    static size_t
+    GetWindowSize(float sample_rate, size_t decimation, float min_freq);
+
+    /** Initializes the detector.
+        \param buffer memory of at least GetBufferSize(window) floats
+        \param sample_rate audio engine sample rate
+        \param window power of two from kMinWindow to kMaxWindow
+        \param decimation 1, 2, 4 or 8
+        \return false if the sizes are not supported
+    */
+    bool
+    Init(float* buffer, float sample_rate, size_t window, size_t decimation);
+
+    /** Feeds a block of input */
+    void Process(const float* in, size_t size);
+
+    /** Last detected frequency in Hz, kept while the input is unvoiced */
+    inline float GetFrequency() const { return frequency_; }
+
+    /** Confidence of the last estimate, 0 to 1 */
+    inline float GetConfidence() const { return confidence_; }
+
+    /** True when the confidence of the last estimate is above the threshold */
+    inline bool IsVoiced() const { return confidence_ >= threshold_; }
+
+    /** Confidence required for IsVoiced(), defaults to 0.8 */
+    inline void SetThreshold(float threshold) { threshold_ = threshold; }
+
+    /** RMS level below which the input is treated as silence, defaults to
+        -60 dBFS
+    */
+    inline void SetSilenceLevel(float rms) { silence_level_ = rms; }
+
+    /** Delay from the input to an estimate, in samples */
+    inline size_t GetLatency() const
+    {
+        return (window_ + window_ / 4) * decimation_;
+    }
+
+    /** Lowest detectable frequency in Hz */
+    inline float GetMinFrequency() const
+    {
+        return 2.0f * decimated_rate_ / window_;
+    }
+
+  private:
+    enum Stage
+    {
+        STAGE_FORWARD,
+        STAGE_POWER,
+        STAGE_INVERSE,
+        STAGE_PEAK,
+        STAGE_DONE,
+    };
+
+    struct Biquad
+    {
+        float b0, b1, b2, a1, a2;
+        float x1, x2, y1, y2;
+        float Process(float in);
+    };
+
+    void  StartFrame();
+    void  RunStage();
+    void  Peak();
+    float Sample(size_t n) const;
+
+    RealFft fft_;
+    Biquad  lowpass_[2];
+    float   decimated_rate_, threshold_, silence_level_;
+    float   frequency_, confidence_;
+    size_t  window_, hop_, decimation_, ring_mask_;
+
+    float* ring_;     // decimated input, twice the window
+    float* frame_;    // zero padded window, then the autocorrelation
+    float* spectrum_; // packed spectrum
+
+    size_t ring_pos_, phase_, since_frame_, frame_start_;
+    Stage  stage_;
+};
+
+} // namespace daisysp
+#endif
+#endif
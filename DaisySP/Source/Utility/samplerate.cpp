@@ -0,0 +1,67 @@
+#include "samplerate.h"
+
+using namespace daisysp;
+
+void SampleRateRegistry::Init(float sample_rate)
+{
+    num_subscribers_ = 0;
+    next_            = 0;
+    requested_rate_  = sample_rate;
+    rate_            = sample_rate;
+    request_         = 0;
+    applied_request_ = 0;
+}
+
+bool SampleRateRegistry::Subscribe(void* context, Callback callback)
+{
+    if(num_subscribers_ >= kMaxSubscribers || callback == nullptr)
+        return false;
+    // without a pending change, a new subscriber is expected to be
+    // initialized with the current rate and isn't updated. During an
+    // update it is updated as well.
+    const bool idle = !IsUpdating();
+    subscribers_[num_subscribers_++] = {context, callback};
+    if(idle)
+        next_ = num_subscribers_;
+    return true;
+}
+
+void SampleRateRegistry::Unsubscribe(void* context)
+{
+    size_t j = 0;
+    for(size_t i = 0; i < num_subscribers_; i++)
+    {
+        if(subscribers_[i].context == context)
+        {
+            if(i < next_)
+                next_--;
+            continue;
+        }
+        subscribers_[j++] = subscribers_[i];
+    }
+    num_subscribers_ = j;
+}
+
+void SampleRateRegistry::SetSampleRate(float sample_rate)
+{
+    requested_rate_ = sample_rate;
+    request_        = request_ + 1;
+}
+
+size_t SampleRateRegistry::Process(size_t max_updates)
+{
+    const uint32_t request = request_;
+    if(request != applied_request_)
+    {
+        applied_request_ = request;
+        rate_            = requested_rate_;
+        next_            = 0;
+    }
+
+    for(size_t i = 0; i < max_updates && next_ < num_subscribers_; i++)
+    {
+        const Subscriber& s = subscribers_[next_++];
+        s.callback(s.context, rate_);
+    }
+    return num_subscribers_ - next_;
+}
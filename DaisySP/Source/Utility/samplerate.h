@@ -0,0 +1,139 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_SAMPLERATE_H
+#define DSY_SAMPLERATE_H
+#include <stdint.h>
+#include <stddef.h>
+#ifdef __cplusplus
+
+namespace daisysp
+{
+/** Propagates sample rate changes to modules without re-initializing them.
+
+    Modules with a SetSampleRate(float) function recompute their
+    coefficients for the new rate and keep their state (phases, filter
+    states, delay line contents, envelope stages). Instead of calling it
+    on every module at once, the registry spreads the updates over several
+    audio blocks, so a rate change doesn't cause a single long callback.
+
+    Usage:
+    \code
+    SampleRateRegistry rates;
+    Oscillator         osc;
+    Svf                filt;
+
+    rates.Init(hw.AudioSampleRate());
+    osc.Init(rates.GetSampleRate());
+    filt.Init(rates.GetSampleRate());
+    rates.Subscribe(osc);
+    rates.Subscribe(filt);
+
+    void AudioCallback(...)
+    {
+        rates.Process(); // updates a few modules per block if needed
+        ...
+    }
+
+    // later, e.g. from the main loop
+    hw.SetAudioSampleRate(SaiHandle::Config::SampleRate::SAI_96KHZ);
+    rates.SetSampleRate(hw.AudioSampleRate());
+    \endcode
+
+    SetSampleRate() may be called from another context than Process(),
+    e.g. the main loop while Process() runs in the audio callback.
+    Subscribe() and Unsubscribe() should not be called while Process()
+    can run.
+*/
+class SampleRateRegistry
+{
+  public:
+    /** Called with the new sample rate. `context` is the pointer passed to
+        Subscribe(), usually the module.
+    */
+    typedef void (*Callback)(void* context, float sample_rate);
+
+    static constexpr size_t kMaxSubscribers = 64;
+
+    /** Default number of modules updated per Process() call */
+    static constexpr size_t kDefaultUpdatesPerBlock = 4;
+
+    SampleRateRegistry() {}
+    ~SampleRateRegistry() {}
+
+    /** Initializes the registry with the current sample rate and removes
+        all subscribers.
+    */
+    void Init(float sample_rate);
+
+    /** Adds a callback. Returns false if the registry is full. */
+    bool Subscribe(void* context, Callback callback);
+
+    /** Adds a module with a SetSampleRate(float) function.
+        Returns false if the registry is full.
+    */
+    template <typename T>
+    bool Subscribe(T& module)
+    {
+        return Subscribe(&module, [](void* context, float sample_rate) {
+            static_cast<T*>(context)->SetSampleRate(sample_rate);
+        });
+    }
+
+    /** Removes all callbacks with the given context */
+    void Unsubscribe(void* context);
+
+    /** Requests a new sample rate. The subscribers are updated by the
+        following calls to Process(). A new request while an update is
+        running restarts the update with the new rate.
+    */
+    void SetSampleRate(float sample_rate);
+
+    /** Updates up to `max_updates` subscribers if a sample rate change is
+        pending. Call this at the start of every audio block.
+        \return number of subscribers still waiting for the update
+    */
+    size_t Process(size_t max_updates = kDefaultUpdatesPerBlock);
+
+    /** Updates all pending subscribers at once */
+    void UpdateAll() { Process(kMaxSubscribers); }
+
+    /** Returns true while subscribers still wait for a rate change */
+    inline bool IsUpdating() const
+    {
+        return request_ != applied_request_ || next_ < num_subscribers_;
+    }
+
+    /** Returns the most recently requested sample rate */
+    inline float GetSampleRate() const { return requested_rate_; }
+
+    inline size_t GetNumSubscribers() const { return num_subscribers_; }
+
+  private:
+    struct Subscriber
+    {
+        void*    context;
+        Callback callback;
+    };
+
+    Subscriber subscribers_[kMaxSubscribers];
+    size_t     num_subscribers_;
+    size_t     next_;
+
+    // written by SetSampleRate(), read by Process()
+    volatile float    requested_rate_;
+    volatile uint32_t request_;
+
+    float    rate_;
+    uint32_t applied_request_;
+};
+
+} // namespace daisysp
+#endif
+#endif
@@ -0,0 +1,107 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_SILENCE_H
+#define DSY_SILENCE_H
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#ifdef __cplusplus
+
+/** @file silence.h */
+
+namespace daisysp
+{
+/** Level below which a block counts as silent, -100 dBFS */
+constexpr float kSilenceThreshold = 1.0e-5f;
+
+/** Returns true if no sample of the block is above the threshold */
+inline bool IsSilentBlock(const float* x,
+                          size_t       size,
+                          float        threshold = kSilenceThreshold)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        if(fabsf(x[i]) > threshold)
+            return false;
+    }
+    return true;
+}
+
+/** Writes a block of zeros */
+inline void ClearBlock(float* x, size_t size)
+{
+    memset(x, 0, size * sizeof(float));
+}
+
+/**
+    @brief Tells when a module with a tail can stop processing.
+
+    The block methods of the modules with memory (delays, reverbs,
+    envelopes...) return true when their output block is all zeros, so the
+    modules after them can skip their work too. A module with a tail uses
+    this to know when that is: once its input and output have stayed below
+    the threshold for the length of its longest delay, everything left in
+    its state is below the threshold as well. From then on, it only writes
+    zeros for silent input blocks, and picks up where it left off when the
+    input returns.
+
+    \code
+    bool Effect::ProcessBlock(const float* in, float* out, size_t size)
+    {
+        const bool in_silent = IsSilentBlock(in, size);
+        if(in_silent && silence_.IsAsleep())
+        {
+            ClearBlock(out, size);
+            return true;
+        }
+        ...
+        silence_.Update(in_silent && IsSilentBlock(out, size), size);
+        return false;
+    }
+    \endcode
+*/
+class SilenceTracker
+{
+  public:
+    SilenceTracker() {}
+    ~SilenceTracker() {}
+
+    /** \param tail samples of quiet input and output before sleeping */
+    void Init(size_t tail)
+    {
+        tail_  = tail;
+        quiet_ = 0;
+    }
+
+    /** Records a processed block.
+        \param quiet true if the input and output of the block were below
+        the threshold
+        \param size number of samples in the block
+    */
+    inline void Update(bool quiet, size_t size)
+    {
+        if(!quiet)
+            quiet_ = 0;
+        else if(quiet_ < tail_)
+            quiet_ += size;
+    }
+
+    /** Forces the module to process its next blocks */
+    inline void Wake() { quiet_ = 0; }
+
+    /** True if a silent input block only produces silence */
+    inline bool IsAsleep() const { return quiet_ >= tail_; }
+
+  private:
+    size_t tail_, quiet_;
+};
+} // namespace daisysp
+#endif
+#endif
@@ -30,6 +30,7 @@
 /** Dynamics Modules */
 #include "Dynamics/crossfade.h"
 #include "Dynamics/limiter.h"
+#include "Dynamics/gate.h"
 
 /** Effects Modules */
 #include "Effects/autowah.h"
@@ -41,6 +42,7 @@
 #include "Effects/phaser.h"
 #include "Effects/sampleratereducer.h"
 #include "Effects/tremolo.h"
+#include "Effects/vocoder.h"
 #include "Effects/wavefolder.h"
 
 /** Filter Modules */
@@ -48,6 +50,7 @@
 #include "Filters/svf.h"
 #include "Filters/fir.h"
 #include "Filters/soap.h"
+#include "Filters/crossover.h"
 
 /** Noise Modules */
 #include "Noise/clockednoise.h"
@@ -66,6 +69,16 @@
 
 /** Sampling Modules */
 #include "Sampling/granularplayer.h"
+#include "Sampling/phasevocoder.h"
+#include "Sampling/resampler.h"
+#include "Sampling/samplecodec.h"
+#include "Sampling/samplesource.h"
+#include "Sampling/sampler.h"
+
+/** Spectral Modules */
+#include "Spectral/fft.h"
+#include "Spectral/spectralfreeze.h"
+#include "Spectral/stft.h"
 
 /** Synthesis Modules */
 #include "Synthesis/fm2.h"
@@ -81,11 +94,16 @@
 /** Utility Modules */
 #include "Utility/dcblock.h"
 #include "Utility/delayline.h"
+#include "Utility/denormal.h"
 #include "Utility/dsp.h"
 #include "Utility/looper.h"
+#include "Utility/lut.h"
 #include "Utility/maytrig.h"
 #include "Utility/metro.h"
+#include "Utility/pitchdetector.h"
+#include "Utility/samplerate.h"
 #include "Utility/samplehold.h"
+#include "Utility/silence.h"
 #include "Utility/smooth_random.h"
 
 /** LGPL Modules */
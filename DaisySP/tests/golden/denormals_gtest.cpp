@@ -0,0 +1,112 @@
+#include "daisysp.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <functional>
+
+using namespace daisysp;
+
+namespace
+{
+constexpr float  kSampleRate    = 48000.0f;
+constexpr size_t kExciteSamples = 4800;
+constexpr size_t kTailSamples   = 10 * 48000;
+
+/** Excites a module with noise, then feeds it silence for ten seconds
+ *  without flush-to-zero mode. Checks that the output never becomes
+ *  subnormal and that the tail ends in exact silence.
+ */
+void ExpectCleanSilenceTail(std::function<float(float)> process)
+{
+    WhiteNoise noise;
+    noise.Init();
+    for(size_t i = 0; i < kExciteSamples; i++)
+        process(noise.Process());
+
+    size_t num_subnormal = 0;
+    float  out           = 0.0f;
+    for(size_t i = 0; i < kTailSamples; i++)
+    {
+        out = process(0.0f);
+        if(std::fpclassify(out) == FP_SUBNORMAL)
+            num_subnormal++;
+    }
+    EXPECT_EQ(num_subnormal, 0u);
+    EXPECT_EQ(out, 0.0f);
+}
+} // namespace
+
+TEST(Denormals, flushDenormal)
+{
+    EXPECT_EQ(flush_denormal(1.0e-20f), 0.0f);
+    EXPECT_EQ(flush_denormal(-1.0e-20f), 0.0f);
+    EXPECT_EQ(flush_denormal(1.0e-39f), 0.0f);
+    EXPECT_EQ(flush_denormal(1.0e-6f), 1.0e-6f);
+    EXPECT_EQ(flush_denormal(-0.5f), -0.5f);
+    EXPECT_EQ(flush_denormal(3), 3);
+}
+
+TEST(Denormals, ftzScope)
+{
+    volatile float tiny = 1.0e-30f;
+    {
+        FtzScope ftz;
+        // on platforms with flush-to-zero support, the subnormal result is
+        // replaced by zero
+        const float result = tiny * 1.0e-10f;
+        EXPECT_NE(std::fpclassify(result), FP_SUBNORMAL);
+    }
+    // the previous mode is restored
+    const float result = tiny * 1.0e-10f;
+    EXPECT_EQ(std::fpclassify(result), FP_SUBNORMAL);
+}
+
+TEST(Denormals, svf)
+{
+    Svf svf;
+    svf.Init(kSampleRate);
+    svf.SetFreq(200.0f);
+    svf.SetRes(0.9f);
+    ExpectCleanSilenceTail([&](float in) {
+        svf.Process(in);
+        return svf.Low();
+    });
+}
+
+TEST(Denormals, onePole)
+{
+    OnePole filter;
+    filter.Init();
+    filter.SetFrequency(0.0001f);
+    ExpectCleanSilenceTail([&](float in) { return filter.Process(in); });
+}
+
+TEST(Denormals, dcBlock)
+{
+    DcBlock block;
+    block.Init(kSampleRate);
+    ExpectCleanSilenceTail([&](float in) { return block.Process(in); });
+}
+
+TEST(Denormals, chorus)
+{
+    Chorus chorus;
+    chorus.Init(kSampleRate);
+    chorus.SetFeedback(0.9f);
+    ExpectCleanSilenceTail([&](float in) { return chorus.Process(in); });
+}
+
+TEST(Denormals, flanger)
+{
+    Flanger flanger;
+    flanger.Init(kSampleRate);
+    flanger.SetFeedback(0.9f);
+    ExpectCleanSilenceTail([&](float in) { return flanger.Process(in); });
+}
+
+TEST(Denormals, phaser)
+{
+    Phaser phaser;
+    phaser.Init(kSampleRate);
+    phaser.SetFeedback(0.9f);
+    ExpectCleanSilenceTail([&](float in) { return phaser.Process(in); });
+}
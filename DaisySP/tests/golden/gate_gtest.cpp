@@ -0,0 +1,286 @@
+#include "daisysp.h"
+#include "golden.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace daisysp;
+using namespace daisysp::golden;
+
+namespace
+{
+constexpr float  kSampleRate = 48000.0f;
+constexpr size_t kBlockSize  = 48;
+constexpr size_t kWindow     = 37;
+constexpr size_t kLookahead  = 96;
+constexpr size_t kMaxWindow  = 480;
+
+std::vector<float> gate_mem(Gate::GetBufferSize(Gate::kMaxChannels,
+                                                kLookahead,
+                                                kMaxWindow));
+
+/** A gate that opens and closes on the same sample as its level */
+void InitInstant(Gate& gate, size_t num_channels)
+{
+    gate.Init(gate_mem.data(), kSampleRate, num_channels, kLookahead, kWindow);
+    gate.SetHysteresis(0.0f);
+    gate.SetHold(0.0f);
+    gate.SetAttack(0.0f);
+    gate.SetRelease(0.0f);
+}
+
+std::vector<float> Sine(float freq, float amp, size_t length)
+{
+    std::vector<float> x(length);
+    for(size_t i = 0; i < length; i++)
+        x[i] = amp * sinf(TWOPI_F * freq * i / kSampleRate);
+    return x;
+}
+
+/** Random bursts with levels spread around -40 dBFS */
+std::vector<float> Bursts(size_t length)
+{
+    std::vector<float> x(length);
+    uint32_t           seed  = 7;
+    float              level = 0.0f;
+    for(size_t i = 0; i < length; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        if(i % 50 == 0)
+            level = powf(10.0f, -(20.0f + (seed >> 8) % 40) / 20.0f);
+        x[i] = level * (static_cast<float>(seed >> 8) / 8388608.0f - 1.0f);
+    }
+    return x;
+}
+
+bool Process(Gate& gate, std::vector<float>& x)
+{
+    bool all_silent = true;
+    for(size_t i = 0; i < x.size(); i += kBlockSize)
+    {
+        const size_t n     = std::min(kBlockSize, x.size() - i);
+        float*       ch[1] = {&x[i]};
+        all_silent         = gate.ProcessBlock(ch, ch, n) && all_silent;
+    }
+    return all_silent;
+}
+} // namespace
+
+TEST(Gate, peakDetectorIsTheWindowMaximum)
+{
+    Gate gate;
+    InitInstant(gate, 1);
+    gate.SetThreshold(-40.0f);
+    const float threshold = powf(10.0f, -2.0f);
+
+    const auto x = Bursts(4000);
+    for(size_t i = 0; i < x.size(); i++)
+    {
+        float        y     = x[i];
+        const float* in[1] = {&x[i]};
+        float*       out[1] = {&y};
+        gate.ProcessBlock(in, out, 1);
+
+        float        peak  = 0.0f;
+        const size_t first = i + 1 >= kWindow ? i + 1 - kWindow : 0;
+        for(size_t j = first; j <= i; j++)
+            peak = std::max(peak, fabsf(x[j]));
+        if(fabsf(peak - threshold) > 1e-6f)
+        {
+            ASSERT_EQ(gate.IsOpen(), peak >= threshold) << i;
+        }
+    }
+}
+
+TEST(Gate, rmsDetectorIsTheWindowRms)
+{
+    Gate gate;
+    InitInstant(gate, 1);
+    gate.SetDetector(Gate::Detector::RMS);
+    gate.SetThreshold(-46.0f);
+    const float threshold = powf(10.0f, -46.0f / 20.0f);
+
+    const auto x = Bursts(4000);
+    for(size_t i = 0; i < x.size(); i++)
+    {
+        float        y      = x[i];
+        const float* in[1]  = {&x[i]};
+        float*       out[1] = {&y};
+        gate.ProcessBlock(in, out, 1);
+
+        double       sum   = 0.0;
+        const size_t first = i + 1 >= kWindow ? i + 1 - kWindow : 0;
+        for(size_t j = first; j <= i; j++)
+            sum += x[j] * x[j];
+        const float rms = sqrt(sum / kWindow);
+        if(fabsf(rms / threshold - 1.0f) > 1e-3f)
+        {
+            ASSERT_EQ(gate.IsOpen(), rms >= threshold) << i;
+        }
+    }
+}
+
+TEST(Gate, holdAndHysteresis)
+{
+    Gate gate;
+    InitInstant(gate, 1);
+    gate.SetThreshold(-20.0f);
+    gate.SetHysteresis(10.0f);
+    gate.SetHold(0.01f);
+
+    // opens at -20 dB, stays open at -25 dB
+    auto loud = Sine(1000.0f, 0.2f, 960);
+    Process(gate, loud);
+    EXPECT_TRUE(gate.IsOpen());
+    auto between = Sine(1000.0f, 0.056f, 4800);
+    Process(gate, between);
+    EXPECT_TRUE(gate.IsOpen());
+
+    // below -30 dB, it closes once the last peak has left the window and
+    // the hold time has passed
+    auto quiet = Sine(1000.0f, 0.01f, 470);
+    Process(gate, quiet);
+    EXPECT_TRUE(gate.IsOpen());
+    quiet = Sine(1000.0f, 0.01f, kWindow + 10);
+    Process(gate, quiet);
+    EXPECT_FALSE(gate.IsOpen());
+}
+
+TEST(Gate, lookaheadPassesTheOnset)
+{
+    for(size_t lookahead : {size_t(0), kLookahead})
+    {
+        Gate gate;
+        gate.Init(gate_mem.data(), kSampleRate, 1, kLookahead, kWindow);
+        gate.SetAttack(0.0005f);
+        gate.SetLookahead(lookahead);
+
+        // silence, then a tone burst
+        std::vector<float> x(4800, 0.0f);
+        const auto         tone = Sine(1000.0f, 0.5f, 2400);
+        std::copy(tone.begin(), tone.end(), x.begin() + 2400);
+        auto y = x;
+        Process(gate, y);
+
+        // the first cycle of the burst, at the output
+        float worst = 0.0f;
+        for(size_t i = 0; i < 48; i++)
+            worst = std::max(worst,
+                             fabsf(y[2400 + lookahead + i] - x[2400 + i]));
+        if(lookahead > 0)
+        {
+            EXPECT_LT(worst, 0.02f);
+        }
+        else
+        {
+            EXPECT_GT(worst, 0.1f);
+        }
+    }
+}
+
+TEST(Gate, linkedChannelsOpenTogether)
+{
+    Gate gate;
+    InitInstant(gate, 2);
+    gate.SetThreshold(-30.0f);
+
+    // a loud left channel opens the quiet right one
+    auto       left   = Sine(440.0f, 0.5f, 960);
+    auto       right  = Sine(440.0f, 0.001f, 960);
+    const auto ref    = right;
+    float*     ch[2]  = {left.data(), right.data()};
+    const bool silent = gate.ProcessBlock(ch, ch, 960);
+    EXPECT_FALSE(silent);
+
+    // the gate opens on the second sample of the left channel
+    for(size_t i = 2; i < right.size(); i++)
+        ASSERT_EQ(right[i], ref[i]) << i;
+}
+
+TEST(Gate, externalKeyAndSidechainFilter)
+{
+    Gate gate;
+    InitInstant(gate, 1);
+    gate.SetThreshold(-30.0f);
+
+    // a loud rumble opens the gate, unless the key is highpassed
+    const auto rumble = Sine(40.0f, 0.3f, 9600);
+    auto       x      = Sine(3000.0f, 0.001f, 9600);
+    float*     ch[1]  = {x.data()};
+    gate.ProcessBlock(ch, ch, rumble.data(), 9600);
+    EXPECT_TRUE(gate.IsOpen());
+
+    gate.SetSidechainFilter(1000.0f, 20000.0f);
+    gate.ProcessBlock(ch, ch, rumble.data(), 9600);
+    EXPECT_FALSE(gate.IsOpen());
+}
+
+TEST(Gate, silentBlocks)
+{
+    Gate gate;
+    gate.Init(gate_mem.data(), kSampleRate, 1, kLookahead, kWindow);
+    gate.SetThreshold(-40.0f);
+    gate.SetRelease(0.02f);
+
+    // closed from the start
+    auto hiss = Sine(5000.0f, 0.001f, 480);
+    EXPECT_TRUE(Process(gate, hiss));
+    EXPECT_TRUE(gate.IsSilent());
+    for(float s : hiss)
+        EXPECT_EQ(s, 0.0f);
+
+    // open, then silent again once the release has decayed
+    auto tone = Sine(440.0f, 0.5f, 480);
+    EXPECT_FALSE(Process(gate, tone));
+    hiss = Sine(5000.0f, 0.001f, 48000);
+    Process(gate, hiss);
+    EXPECT_TRUE(gate.IsSilent());
+
+    // a range above silence is never silent
+    gate.SetRange(-40.0f);
+    hiss = Sine(5000.0f, 0.001f, 48000);
+    EXPECT_FALSE(Process(gate, hiss));
+}
+
+TEST(Gate, expanderRatio)
+{
+    Gate gate;
+    gate.Init(gate_mem.data(), kSampleRate, 1, kLookahead, kMaxWindow);
+    gate.SetThreshold(-20.0f);
+    gate.SetRatio(2.0f);
+    gate.SetRange(-60.0f);
+
+    // a steady tone 10 dB below the threshold is another 10 dB lower
+    const float amp = powf(10.0f, -30.0f / 20.0f);
+    auto        x   = Sine(1000.0f, amp, 9600);
+    Process(gate, x);
+    EXPECT_NEAR(20.0f * log10f(gate.GetGain()), -10.0f, 0.2f);
+}
+
+TEST(golden_Dynamics, gate)
+{
+    Gate gate;
+    gate.Init(gate_mem.data(), kSampleRate, 1, kLookahead, 240);
+    gate.SetThreshold(-35.0f);
+    gate.SetLookahead(48);
+    gate.SetAttack(0.0005f);
+    gate.SetRelease(0.02f);
+    gate.SetSidechainFilter(100.0f, 8000.0f);
+
+    // plucked notes over hiss
+    FtzScope   ftz;
+    WhiteNoise noise;
+    noise.Init();
+    noise.SetAmp(0.003f);
+    std::vector<float> x(19200);
+    for(size_t i = 0; i < x.size(); i++)
+    {
+        const size_t t = i % 4800;
+        x[i] = noise.Process()
+               + 0.5f * expf(-(t / 600.0f))
+                     * sinf(TWOPI_F * 220.0f * i / kSampleRate);
+    }
+    Process(gate, x);
+    ExpectMatchesGolden("gate", x);
+}
@@ -0,0 +1,221 @@
+#include "golden.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace daisysp
+{
+namespace golden
+{
+namespace
+{
+constexpr char     kMagic[4]      = {'D', 'S', 'P', 'G'};
+constexpr uint32_t kFileVersion   = 1;
+constexpr size_t   kFrameSize     = 512;
+constexpr size_t   kHopSize       = kFrameSize / 2;
+constexpr double   kPowerFloor    = 1.0e-12;
+constexpr double   kPi            = 3.14159265358979323846;
+constexpr float    kInfiniteSnrDb = std::numeric_limits<float>::infinity();
+
+/** In place radix-2 FFT, only used to compare spectra */
+void Fft(std::vector<std::complex<double>>& x)
+{
+    const size_t n = x.size();
+    for(size_t i = 1, j = 0; i < n; i++)
+    {
+        size_t bit = n >> 1;
+        for(; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if(i < j)
+            std::swap(x[i], x[j]);
+    }
+    for(size_t len = 2; len <= n; len <<= 1)
+    {
+        const std::complex<double> w = std::polar(1.0, -2.0 * kPi / len);
+        for(size_t i = 0; i < n; i += len)
+        {
+            std::complex<double> wn(1.0, 0.0);
+            for(size_t k = 0; k < len / 2; k++)
+            {
+                const auto a       = x[i + k];
+                const auto b       = x[i + k + len / 2] * wn;
+                x[i + k]           = a + b;
+                x[i + k + len / 2] = a - b;
+                wn *= w;
+            }
+        }
+    }
+}
+
+void PowerSpectrum(const std::vector<float>& in,
+                   size_t                    start,
+                   std::vector<double>&      power)
+{
+    std::vector<std::complex<double>> frame(kFrameSize);
+    for(size_t i = 0; i < kFrameSize; i++)
+    {
+        const double w = 0.5 - 0.5 * std::cos(2.0 * kPi * i / kFrameSize);
+        frame[i]       = in[start + i] * w;
+    }
+    Fft(frame);
+    power.resize(kFrameSize / 2 + 1);
+    for(size_t k = 0; k < power.size(); k++)
+        power[k] = std::max(std::norm(frame[k]), kPowerFloor);
+}
+
+/** Mean log-spectral distance over all analysis frames in dB */
+float SpectralDistance(const std::vector<float>& reference,
+                       const std::vector<float>& test)
+{
+    if(reference.size() < kFrameSize)
+        return 0.0f;
+
+    std::vector<double> ref_power, test_power;
+    double              sum    = 0.0;
+    size_t              frames = 0;
+    for(size_t start = 0; start + kFrameSize <= reference.size();
+        start += kHopSize)
+    {
+        PowerSpectrum(reference, start, ref_power);
+        PowerSpectrum(test, start, test_power);
+        double frame_sum = 0.0;
+        for(size_t k = 0; k < ref_power.size(); k++)
+        {
+            const double d = 10.0 * std::log10(ref_power[k] / test_power[k]);
+            frame_sum += d * d;
+        }
+        sum += std::sqrt(frame_sum / ref_power.size());
+        frames++;
+    }
+    return static_cast<float>(sum / frames);
+}
+} // namespace
+
+Metrics Compare(const std::vector<float>& reference,
+                const std::vector<float>& test)
+{
+    Metrics m;
+    m.max_abs_error = 0.0f;
+
+    double       signal_energy = 0.0;
+    double       error_energy  = 0.0;
+    const size_t n             = std::min(reference.size(), test.size());
+    for(size_t i = 0; i < n; i++)
+    {
+        const double err = double(test[i]) - double(reference[i]);
+        m.max_abs_error  = std::max(m.max_abs_error, float(std::fabs(err)));
+        signal_energy += double(reference[i]) * reference[i];
+        error_energy += err * err;
+        if(std::isnan(test[i]) != std::isnan(reference[i]))
+            m.max_abs_error = std::numeric_limits<float>::infinity();
+    }
+
+    if(error_energy == 0.0)
+        m.snr_db = kInfiniteSnrDb;
+    else if(signal_energy == 0.0)
+        m.snr_db = -kInfiniteSnrDb;
+    else
+        m.snr_db = float(10.0 * std::log10(signal_energy / error_energy));
+
+    m.spectral_distance_db = SpectralDistance(reference, test);
+    return m;
+}
+
+bool IsWithin(const Metrics& metrics, const Tolerance& tolerance)
+{
+    return metrics.max_abs_error <= tolerance.max_abs_error
+           && metrics.snr_db >= tolerance.min_snr_db
+           && metrics.spectral_distance_db
+                  <= tolerance.max_spectral_distance_db;
+}
+
+bool SaveRender(const std::string& path, const std::vector<float>& samples)
+{
+    std::ofstream file(path, std::ios::binary);
+    if(!file)
+        return false;
+    const uint32_t num_samples = static_cast<uint32_t>(samples.size());
+    file.write(kMagic, sizeof(kMagic));
+    file.write(reinterpret_cast<const char*>(&kFileVersion),
+               sizeof(kFileVersion));
+    file.write(reinterpret_cast<const char*>(&num_samples),
+               sizeof(num_samples));
+    file.write(reinterpret_cast<const char*>(samples.data()),
+               samples.size() * sizeof(float));
+    return bool(file);
+}
+
+bool LoadRender(const std::string& path, std::vector<float>& samples)
+{
+    std::ifstream file(path, std::ios::binary);
+    if(!file)
+        return false;
+    char     magic[4];
+    uint32_t version, num_samples;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&num_samples), sizeof(num_samples));
+    if(!file || memcmp(magic, kMagic, sizeof(kMagic)) != 0
+       || version != kFileVersion)
+        return false;
+    samples.resize(num_samples);
+    file.read(reinterpret_cast<char*>(samples.data()),
+              num_samples * sizeof(float));
+    return bool(file);
+}
+
+std::string GetGoldenPath(const std::string& name)
+{
+    return std::string(DAISYSP_GOLDEN_DIR) + "/" + name + ".f32";
+}
+
+bool IsUpdateMode()
+{
+    const char* env = std::getenv("DAISYSP_UPDATE_GOLDEN");
+    return env != nullptr && env[0] != '\0' && env[0] != '0';
+}
+
+void ExpectMatchesGolden(const std::string&        name,
+                         const std::vector<float>& render,
+                         const Tolerance&          tolerance)
+{
+    const std::string path = GetGoldenPath(name);
+    if(IsUpdateMode())
+    {
+        EXPECT_TRUE(SaveRender(path, render)) << "could not write " << path;
+        return;
+    }
+
+    std::vector<float> reference;
+    if(!LoadRender(path, reference))
+    {
+        ADD_FAILURE() << "missing reference " << path
+                      << " (run with DAISYSP_UPDATE_GOLDEN=1 to create it)";
+        return;
+    }
+    ASSERT_EQ(reference.size(), render.size()) << name;
+    ExpectRendersMatch(reference, render, tolerance);
+}
+
+void ExpectRendersMatch(const std::vector<float>& reference,
+                        const std::vector<float>& test,
+                        const Tolerance&          tolerance)
+{
+    ASSERT_EQ(reference.size(), test.size());
+    const Metrics m = Compare(reference, test);
+    EXPECT_TRUE(IsWithin(m, tolerance))
+        << "max abs error " << m.max_abs_error << " (limit "
+        << tolerance.max_abs_error << "), SNR " << m.snr_db << " dB (limit "
+        << tolerance.min_snr_db << " dB), spectral distance "
+        << m.spectral_distance_db << " dB (limit "
+        << tolerance.max_spectral_distance_db << " dB)";
+}
+
+} // namespace golden
+} // namespace daisysp
@@ -0,0 +1,102 @@
+#pragma once
+#ifndef DSY_TEST_GOLDEN_H
+#define DSY_TEST_GOLDEN_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "denormal.h"
+
+/** @brief Golden render regression helpers for running DaisySP modules on the host
+ *
+ *  Each test renders a module with a fixed seed and a fixed parameter script,
+ *  and compares the result to a reference render stored in `golden/data`.
+ *  The same comparison can be used to check an optimized (block/SIMD)
+ *  implementation against the scalar reference with `ExpectRendersMatch()`.
+ *
+ *  To (re)generate the reference files, run the tests with the environment
+ *  variable `DAISYSP_UPDATE_GOLDEN=1` set.
+ */
+namespace daisysp
+{
+namespace golden
+{
+/** Acceptance limits for a render compared to its reference */
+struct Tolerance
+{
+    /** Largest allowed absolute difference of any single sample */
+    float max_abs_error = 1.0e-3f;
+    /** Smallest allowed signal to error ratio in dB */
+    float min_snr_db = 60.0f;
+    /** Largest allowed log-spectral distance in dB */
+    float max_spectral_distance_db = 1.0f;
+};
+
+/** Differences between a render and its reference */
+struct Metrics
+{
+    float max_abs_error;
+    float snr_db;
+    float spectral_distance_db;
+};
+
+/** Computes the difference metrics between two signals of equal length.
+ *  The signal to error ratio is reported as +inf for identical signals.
+ */
+Metrics Compare(const std::vector<float>& reference,
+                const std::vector<float>& test);
+
+/** Returns true if all metrics are within the tolerance */
+bool IsWithin(const Metrics& metrics, const Tolerance& tolerance);
+
+/** Writes a render to a compact binary file (header + float32 samples) */
+bool SaveRender(const std::string& path, const std::vector<float>& samples);
+
+/** Reads a render written by `SaveRender()` */
+bool LoadRender(const std::string& path, std::vector<float>& samples);
+
+/** Returns the path of the reference file for a test case */
+std::string GetGoldenPath(const std::string& name);
+
+/** Returns true if the tests should overwrite the reference files */
+bool IsUpdateMode();
+
+/** Renders `length` samples. `control(block_index)` is called at the start
+ *  of every block of `block_size` samples to apply the parameter script,
+ *  `process()` is called for every sample and returns the output.
+ *  Like an audio callback, the render runs in flush-to-zero mode.
+ */
+template <typename ControlFn, typename ProcessFn>
+std::vector<float>
+Render(size_t length, size_t block_size, ControlFn control, ProcessFn process)
+{
+    FtzScope           ftz;
+    std::vector<float> out(length);
+    for(size_t i = 0; i < length; i++)
+    {
+        if(i % block_size == 0)
+            control(i / block_size);
+        out[i] = process();
+    }
+    return out;
+}
+
+/** Compares a render to the stored reference named `name` and reports a
+ *  test failure if it's out of tolerance. In update mode, the reference is
+ *  written instead.
+ */
+void ExpectMatchesGolden(const std::string&        name,
+                         const std::vector<float>& render,
+                         const Tolerance&          tolerance = Tolerance());
+
+/** Compares two renders, e.g. an optimized implementation against the
+ *  scalar reference, and reports a test failure if they differ.
+ */
+void ExpectRendersMatch(const std::vector<float>& reference,
+                        const std::vector<float>& test,
+                        const Tolerance&          tolerance = Tolerance());
+
+} // namespace golden
+} // namespace daisysp
+
+#endif
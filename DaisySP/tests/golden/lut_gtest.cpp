@@ -0,0 +1,68 @@
+#include "daisysp.h"
+#include <gtest/gtest.h>
+#include <cmath>
+
+using namespace daisysp;
+
+namespace
+{
+constexpr double Identity(double x)
+{
+    return x;
+}
+} // namespace
+
+TEST(Lut, tablesAreConstexpr)
+{
+    constexpr Lut<5> ramp = MakeLut<5>(Identity, 0.0, 1.0);
+    static_assert(ramp[0] == 0.0f && ramp[4] == 1.0f, "");
+    static_assert(ramp[2] == 0.5f, "");
+    static_assert(decltype(lut_sine)::kSize == kLutSineSize + 1, "");
+}
+
+TEST(Lut, sine)
+{
+    for(float phase = -3.0f; phase <= 3.0f; phase += 0.00123f)
+    {
+        EXPECT_NEAR(lut_sin(phase), sinf(TWOPI_F * phase), 1.0e-5f);
+        EXPECT_NEAR(lut_cos(phase), cosf(TWOPI_F * phase), 1.0e-5f);
+    }
+}
+
+TEST(Lut, sineWindow)
+{
+    for(float x = 0.0f; x <= 1.0f; x += 0.001f)
+        EXPECT_NEAR(lut_sine_window(x), sinf(PI_F * x), 1.0e-5f);
+    EXPECT_EQ(lut_sine_window(-0.5f), 0.0f);
+    EXPECT_NEAR(lut_sine_window(1.5f), 0.0f, 1.0e-6f);
+}
+
+TEST(Lut, semitonesToRatio)
+{
+    for(float st = -127.9f; st <= 127.9f; st += 0.137f)
+    {
+        const float expected = powf(2.0f, st / 12.0f);
+        EXPECT_NEAR(lut_semitones_to_ratio(st) / expected, 1.0f, 2.0e-6f);
+    }
+    EXPECT_EQ(lut_semitones_to_ratio(0.0f), 1.0f);
+    EXPECT_FLOAT_EQ(lut_semitones_to_ratio(12.0f), 2.0f);
+    EXPECT_FLOAT_EQ(lut_semitones_to_ratio(-24.0f), 0.25f);
+}
+
+TEST(Lut, tanh)
+{
+    for(float x = -10.0f; x <= 10.0f; x += 0.0117f)
+        EXPECT_NEAR(lut_tanh(x), tanhf(x), 5.0e-5f);
+}
+
+TEST(Lut, dbToGain)
+{
+    for(float db = -119.5f; db <= 24.0f; db += 0.0731f)
+    {
+        const float expected = powf(10.0f, db / 20.0f);
+        EXPECT_NEAR(lut_db_to_gain(db) / expected, 1.0f, 5.0e-4f);
+    }
+    EXPECT_FLOAT_EQ(lut_db_to_gain(0.0f), 1.0f);
+    EXPECT_EQ(lut_db_to_gain(-200.0f), 0.0f);
+    EXPECT_FLOAT_EQ(lut_db_to_gain(40.0f), lut_db_to_gain(kLutDbMax));
+}
@@ -0,0 +1,503 @@
+#include "daisysp.h"
+#include "golden.h"
+#include <gtest/gtest.h>
+
+using namespace daisysp;
+using namespace daisysp::golden;
+
+namespace
+{
+constexpr float  kSampleRate = 48000.0f;
+constexpr size_t kBlockSize  = 64;
+constexpr size_t kShort      = 2048;
+constexpr size_t kLong       = 4096;
+
+/** Deterministic test input, the same for every run */
+struct Noise
+{
+    Noise()
+    {
+        noise.Init();
+        noise.SetAmp(0.5f);
+    }
+    float      operator()() { return noise.Process(); }
+    WhiteNoise noise;
+};
+
+/** Deterministic harmonically rich test input */
+struct Saw
+{
+    Saw(float freq = 110.0f)
+    {
+        osc.Init(kSampleRate);
+        osc.SetWaveform(Oscillator::WAVE_POLYBLEP_SAW);
+        osc.SetFreq(freq);
+        osc.SetAmp(0.5f);
+    }
+    float      operator()() { return osc.Process(); }
+    Oscillator osc;
+};
+
+/** Exponential sweep from `lo` to `hi` over `num_blocks` blocks */
+float Sweep(size_t block, size_t num_blocks, float lo, float hi)
+{
+    return lo * powf(hi / lo, float(block) / float(num_blocks));
+}
+} // namespace
+
+// ==================== Synthesis ====================
+
+TEST(golden_Synthesis, a_oscillatorWaveforms)
+{
+    Oscillator osc;
+    osc.Init(kSampleRate);
+    auto render = Render(
+        kLong,
+        kBlockSize,
+        [&](size_t b) {
+            osc.SetWaveform((b / 8) % Oscillator::WAVE_LAST);
+            osc.SetFreq(Sweep(b, kLong / kBlockSize, 50.0f, 8000.0f));
+            osc.SetPw(0.1f + 0.8f * float(b % 8) / 8.0f);
+        },
+        [&]() { return osc.Process(); });
+    ExpectMatchesGolden("oscillator_waveforms", render);
+}
+
+TEST(golden_Synthesis, b_fm2)
+{
+    Fm2 fm;
+    fm.Init(kSampleRate);
+    auto render = Render(
+        kShort,
+        kBlockSize,
+        [&](size_t b) {
+            fm.SetFrequency(220.0f);
+            fm.SetRatio(1.0f + float(b % 4) * 0.5f);
+            fm.SetIndex(float(b) / float(kShort / kBlockSize) * 4.0f);
+        },
+        [&]() { return fm.Process(); });
+    ExpectMatchesGolden("fm2", render);
+}
+
+TEST(golden_Synthesis, c_variableSawOsc)
+{
+    VariableSawOscillator osc;
+    osc.Init(kSampleRate);
+    auto render = Render(
+        kShort,
+        kBlockSize,
+        [&](size_t b) {
+            const float t = float(b) / float(kShort / kBlockSize);
+            osc.SetFreq(Sweep(b, kShort / kBlockSize, 100.0f, 3000.0f));
+            osc.SetPW(-1.0f + 2.0f * t);
+            osc.SetWaveshape(t);
+        },
+        [&]() { return osc.Process(); });
+    ExpectMatchesGolden("variable_saw_osc", render);
+}
+
+TEST(golden_Synthesis, d_variableShapeOsc)
+{
+    VariableShapeOscillator osc;
+    osc.Init(kSampleRate);
+    auto render = Render(
+        kShort,
+        kBlockSize,
+        [&](size_t b) {
+            const float t = float(b) / float(kShort / kBlockSize);
+            osc.SetFreq(Sweep(b, kShort / kBlockSize, 100.0f, 3000.0f));
+            osc.SetSync(b >= kShort / kBlockSize / 2);
+            osc.SetSyncFreq(330.0f);
+            osc.SetPW(t);
+            osc.SetWaveshape(1.0f - t);
+        },
+        [&]() { return osc.Process(); });
+    ExpectMatchesGolden("variable_shape_osc", render);
+}
+
+TEST(golden_Synthesis, e_zOscillator)
+{
+    ZOscillator osc;
+    osc.Init(kSampleRate);
+    auto render = Render(
+        kShort,
+        kBlockSize,
+        [&](size_t b) {
+            const float t = float(b) / float(kShort / kBlockSize);
+            osc.SetFreq(220.0f);
+            osc.SetFormantFreq(Sweep(b, kShort / kBlockSize, 300.0f, 3000.0f));
+            osc.SetShape(t);
+            osc.SetMode(-1.0f + 2.0f * t);
+        },
+        [&]() { return osc.Process(); });
+    ExpectMatchesGolden("z_oscillator", render);
+}
+
+TEST(golden_Synthesis, f_formantOscAndVosim)
+{
+    FormantOscillator formant;
+    VosimOscillator   vosim;
+    formant.Init(kSampleRate);
+    vosim.Init(kSampleRate);
+    auto render = Render(
+        kShort,
+        kBlockSize,
+        [&](size_t b) {
+            const float t = float(b) / float(kShort / kBlockSize);
+            formant.SetCarrierFreq(110.0f);
+            formant.SetFormantFreq(
+                Sweep(b, kShort / kBlockSize, 200.0f, 4000.0f));
+            formant.SetPhaseShift(t);
+            vosim.SetFreq(165.0f);
+            vosim.SetForm1Freq(Sweep(b, kShort / kBlockSize, 300.0f, 1500.0f));
+            vosim.SetForm2Freq(1200.0f);
+            vosim.SetShape(-1.0f + 2.0f * t);
+        },
+        [&]() { return 0.5f * (formant.Process() + vosim.Process()); });
+    ExpectMatchesGolden("formant_osc_vosim", render);
+}
+
+// ==================== Filters ====================
+
+TEST(golden_Filters, a_svfSweep)
+{
+    Svf   svf;
+    Noise in;
+    svf.Init(kSampleRate);
+    auto render = Render(
+        kLong,
+        kBlockSize,
+        [&](size_t b) {
+            svf.SetFreq(Sweep(b, kLong / kBlockSize, 100.0f, 12000.0f));
+            svf.SetRes(0.2f + 0.7f * float(b % 16) / 16.0f);
+            svf.SetDrive(0.3f);
+        },
+        [&]() {
+            svf.Process(in());
+            return svf.Low() + svf.Band() - 0.5f * svf.High();
+        });
+    ExpectMatchesGolden("svf_sweep", render);
+}
+
+TEST(golden_Filters, b_onePole)
+{
+    OnePole lp, hp;
+    Noise   in;
+    lp.Init();
+    hp.Init();
+    hp.SetFilterMode(OnePole::FILTER_MODE_HIGH_PASS);
+    auto render = Render(
+        kShort,
+        kBlockSize,
+        [&](size_t b) {
+            lp.SetFrequency(Sweep(b, kShort / kBlockSize, 0.001f, 0.4f));
+            hp.SetFrequency(Sweep(b, kShort / kBlockSize, 0.4f, 0.001f));
+        },
+        [&]() {
+            const float x = in();
+            return lp.Process(x) + hp.Process(x);
+        });
+    ExpectMatchesGolden("one_pole", render);
+}
+
+TEST(golden_Filters, c_soap)
+{
+    Soap  soap;
+    Noise in;
+    soap.Init(kSampleRate);
+    auto render = Render(
+        kShort,
+        kBlockSize,
+        [&](size_t b) {
+            soap.SetCenterFreq(Sweep(b, kShort / kBlockSize, 200.0f, 8000.0f));
+            soap.SetFilterBandwidth(100.0f + 10.0f * float(b));
+        },
+        [&]() {
+            soap.Process(in());
+            return soap.Bandpass() - 0.25f * soap.Bandreject();
+        });
+    ExpectMatchesGolden("soap", render);
+}
+
+TEST(golden_Filters, d_dcBlock)
+{
+    DcBlock dc;
+    Saw     in;
+    dc.Init(kSampleRate);
+    auto render = Render(
+        kShort,
+        kBlockSize,
+        [](size_t) {},
+        [&]() { return dc.Process(in() + 0.3f); });
+    ExpectMatchesGolden("dc_block", render);
+}
+
+// ==================== Control ====================
+
+TEST(golden_Control, a_adsr)
+{
+    Adsr env;
+    env.Init(kSampleRate);
+    bool gate = false;
+    auto render = Render(
+        kLong,
+        kBlockSize,
+        [&](size_t b) {
+            // gate on for 24 blocks, off for 8, with varying times
+            gate = (b % 32) < 24;
+            if(b % 32 == 0)
+            {
+                env.SetAttackTime(0.002f * float(1 + b / 32));
+                env.SetDecayTime(0.01f);
+                env.SetSustainLevel(0.25f * float(1 + b / 32));
+                env.SetReleaseTime(0.004f);
+            }
+        },
+        [&]() { return env.Process(gate); });
+    ExpectMatchesGolden("adsr", render);
+}
+
+TEST(golden_Control, b_adEnv)
+{
+    AdEnv env;
+    env.Init(kSampleRate);
+    auto render = Render(
+        kLong,
+        kBlockSize,
+        [&](size_t b) {
+            if(b % 16 == 0)
+            {
+                env.SetTime(ADENV_SEG_ATTACK, 0.001f);
+                env.SetTime(ADENV_SEG_DECAY, 0.005f * float(1 + b / 16));
+                env.SetCurve(-10.0f + float(b / 16) * 5.0f);
+                env.Trigger();
+            }
+        },
+        [&]() { return env.Process(); });
+    ExpectMatchesGolden("ad_env", render);
+}
+
+// ==================== Effects ====================
+
+TEST(golden_Effects, a_chorus)
+{
+    Chorus fx;
+    Saw    in;
+    fx.Init(kSampleRate);
+    auto render = Render(
+        kLong,
+        kBlockSize,
+        [&](size_t b) {
+            fx.SetLfoFreq(2.0f + float(b % 8));
+            fx.SetLfoDepth(0.8f);
+            fx.SetDelayMs(5.0f);
+            fx.SetFeedback(0.3f);
+        },
+        [&]() {
+            fx.Process(in());
+            return fx.GetLeft() - fx.GetRight();
+        });
+    ExpectMatchesGolden("chorus", render);
+}
+
+TEST(golden_Effects, b_flangerAndPhaser)
+{
+    Flanger flanger;
+    Phaser  phaser;
+    Saw     in;
+    flanger.Init(kSampleRate);
+    phaser.Init(kSampleRate);
+    auto render = Render(
+        kLong,
+        kBlockSize,
+        [&](size_t b) {
+            flanger.SetLfoFreq(3.0f);
+            flanger.SetLfoDepth(0.9f);
+            flanger.SetFeedback(0.5f);
+            phaser.SetPoles(1 + int(b % 8));
+            phaser.SetLfoFreq(2.0f);
+            phaser.SetLfoDepth(0.8f);
+            phaser.SetFreq(800.0f);
+            phaser.SetFeedback(0.4f);
+        },
+        [&]() { return phaser.Process(flanger.Process(in())); });
+    ExpectMatchesGolden("flanger_phaser", render);
+}
+
+TEST(golden_Effects, c_tremolo)
+{
+    Tremolo fx;
+    Saw     in;
+    fx.Init(kSampleRate);
+    auto render = Render(
+        kShort,
+        kBlockSize,
+        [&](size_t b) {
+            fx.SetWaveform((b / 8) % Oscillator::WAVE_LAST);
+            fx.SetFreq(20.0f);
+            fx.SetDepth(0.75f);
+        },
+        [&]() { return fx.Process(in()); });
+    ExpectMatchesGolden("tremolo", render);
+}
+
+TEST(golden_Effects, d_distortion)
+{
+    Overdrive  drive;
+    Wavefolder folder;
+    Decimator  decimator;
+    Saw        in(220.0f);
+    drive.Init();
+    folder.Init();
+    decimator.Init();
+    auto render = Render(
+        kShort,
+        kBlockSize,
+        [&](size_t b) {
+            const float t = float(b) / float(kShort / kBlockSize);
+            drive.SetDrive(t);
+            folder.SetGain(1.0f + 4.0f * t);
+            folder.SetOffset(0.1f);
+            decimator.SetDownsampleFactor(t * 0.5f);
+            decimator.SetBitcrushFactor(t * 0.5f);
+        },
+        [&]() {
+            const float x = in();
+            return drive.Process(x) + 0.25f * folder.Process(x)
+                   + 0.25f * decimator.Process(x);
+        });
+    ExpectMatchesGolden("distortion", render);
+}
+
+TEST(golden_Effects, e_autowah)
+{
+    Autowah fx;
+    Saw     in;
+    fx.Init(kSampleRate);
+    auto render = Render(
+        kShort,
+        kBlockSize,
+        [&](size_t b) {
+            fx.SetWah(float(b % 16) / 16.0f);
+            fx.SetDryWet(100.0f);
+            fx.SetLevel(0.5f);
+        },
+        [&]() { return fx.Process(in()); });
+    ExpectMatchesGolden("autowah", render);
+}
+
+// ==================== Physical modeling / drums ====================
+
+TEST(golden_PhysicalModeling, a_modalVoice)
+{
+    ModalVoice voice;
+    voice.Init(kSampleRate);
+    bool trig   = false;
+    auto render = Render(
+        kLong,
+        kBlockSize,
+        [&](size_t b) {
+            trig = (b % 16) == 0;
+            voice.SetFreq(110.0f * float(1 + b / 16));
+            voice.SetStructure(0.3f);
+            voice.SetBrightness(0.5f);
+            voice.SetDamping(0.6f);
+            voice.SetAccent(0.8f);
+        },
+        [&]() {
+            const float out = voice.Process(trig);
+            trig            = false;
+            return out;
+        });
+    ExpectMatchesGolden("modal_voice", render);
+}
+
+TEST(golden_Drums, a_analogBassDrum)
+{
+    AnalogBassDrum drum;
+    drum.Init(kSampleRate);
+    bool trig   = false;
+    auto render = Render(
+        kLong,
+        kBlockSize,
+        [&](size_t b) {
+            trig = (b % 32) == 0;
+            drum.SetFreq(50.0f + 10.0f * float(b / 32));
+            drum.SetTone(0.5f);
+            drum.SetDecay(0.4f);
+            drum.SetAttackFmAmount(0.3f);
+            drum.SetSelfFmAmount(0.2f);
+            drum.SetAccent(0.7f);
+        },
+        [&]() {
+            const float out = drum.Process(trig);
+            trig            = false;
+            return out;
+        });
+    ExpectMatchesGolden("analog_bass_drum", render);
+}
+
+// ==================== Utility / dynamics ====================
+
+TEST(golden_Utility, a_delayLine)
+{
+    static DelayLine<float, 1024> del;
+    Saw                           in;
+    del.Init();
+    float delay  = 0.0f;
+    auto  render = Render(
+        kShort,
+        kBlockSize,
+        [&](size_t b) { delay = 10.0f + 900.0f * float(b % 8) / 8.0f; },
+        [&]() {
+            const float out = del.ReadHermite(delay);
+            del.Write(in() + 0.5f * out);
+            return out;
+        });
+    ExpectMatchesGolden("delay_line", render);
+}
+
+TEST(golden_Dynamics, a_limiter)
+{
+    Limiter lim;
+    Saw     in;
+    lim.Init();
+    std::vector<float> render(kShort);
+    for(size_t i = 0; i < kShort; i += kBlockSize)
+    {
+        for(size_t j = 0; j < kBlockSize; j++)
+            render[i + j] = in();
+        lim.ProcessBlock(&render[i], kBlockSize, 1.0f + float(i / kBlockSize));
+    }
+    ExpectMatchesGolden("limiter", render);
+}
+
+// ==================== Harness ====================
+
+TEST(golden_Harness, a_metrics)
+{
+    Saw                ref_src;
+    std::vector<float> ref(kShort);
+    for(auto& s : ref)
+        s = ref_src();
+
+    // identical renders
+    auto m = Compare(ref, ref);
+    EXPECT_EQ(m.max_abs_error, 0.0f);
+    EXPECT_TRUE(std::isinf(m.snr_db));
+    EXPECT_EQ(m.spectral_distance_db, 0.0f);
+
+    // a small amount of error
+    auto test = ref;
+    for(size_t i = 0; i < test.size(); i++)
+        test[i] += (i % 2 ? 1.0e-5f : -1.0e-5f);
+    m = Compare(ref, test);
+    EXPECT_NEAR(m.max_abs_error, 1.0e-5f, 1.0e-6f);
+    EXPECT_GT(m.snr_db, 80.0f);
+    EXPECT_TRUE(IsWithin(m, Tolerance()));
+
+    // a gross error
+    test[100] += 0.5f;
+    m = Compare(ref, test);
+    EXPECT_FALSE(IsWithin(m, Tolerance()));
+}
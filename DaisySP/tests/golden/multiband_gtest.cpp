@@ -0,0 +1,289 @@
+#include "daisysp.h"
+#include "compressor.h"
+#include "multibandcompressor.h"
+#include "golden.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+using namespace daisysp;
+using namespace daisysp::golden;
+
+namespace
+{
+constexpr float  kSampleRate = 48000.0f;
+constexpr size_t kBlockSize  = 48;
+
+std::vector<float> Sine(float freq, float amp, size_t length)
+{
+    std::vector<float> x(length);
+    for(size_t i = 0; i < length; i++)
+        x[i] = amp * sinf(TWOPI_F * freq * i / kSampleRate);
+    return x;
+}
+
+/** RMS of the second half of x, after the filters have settled */
+float SettledRms(const std::vector<float>& x)
+{
+    double sum = 0.0;
+    for(size_t i = x.size() / 2; i < x.size(); i++)
+        sum += x[i] * x[i];
+    return sqrt(sum / (x.size() - x.size() / 2));
+}
+
+float ToDb(float gain)
+{
+    return 20.0f * log10f(gain);
+}
+
+/** Splits x with a crossover, returns each band and their sum */
+std::vector<std::vector<float>> Split(Crossover&                xover,
+                                      const std::vector<float>& x)
+{
+    const size_t                    num_bands = xover.GetNumBands();
+    std::vector<std::vector<float>> bands(num_bands + 1,
+                                          std::vector<float>(x.size()));
+    for(size_t i = 0; i < x.size(); i += kBlockSize)
+    {
+        float* out[Crossover::kMaxBands];
+        for(size_t b = 0; b < num_bands; b++)
+            out[b] = &bands[b][i];
+        xover.Process(&x[i], out, kBlockSize);
+    }
+    for(size_t i = 0; i < x.size(); i++)
+        for(size_t b = 0; b < num_bands; b++)
+            bands[num_bands][i] += bands[b][i];
+    return bands;
+}
+
+/** Runs a stereo block through the multiband compressor */
+void Process(MultibandCompressor& mbc,
+             std::vector<float>&  left,
+             std::vector<float>&  right)
+{
+    for(size_t i = 0; i < left.size(); i += kBlockSize)
+    {
+        float* ch[2] = {&left[i], &right[i]};
+        mbc.ProcessBlock(ch, ch, kBlockSize);
+    }
+}
+} // namespace
+
+TEST(Crossover, sumIsFlat)
+{
+    for(size_t num_bands = 2; num_bands <= Crossover::kMaxBands; num_bands++)
+    {
+        for(float freq : {50.0f, 120.0f, 700.0f, 1000.0f, 4000.0f, 12000.0f})
+        {
+            Crossover xover;
+            xover.Init(kSampleRate, num_bands);
+            const auto x     = Sine(freq, 0.5f, 9600);
+            const auto bands = Split(xover, x);
+            const float gain = SettledRms(bands[num_bands]) / SettledRms(x);
+            EXPECT_NEAR(ToDb(gain), 0.0f, 0.01f)
+                << num_bands << " bands at " << freq << " Hz";
+        }
+    }
+}
+
+TEST(Crossover, bandsAreSixDbDownAtTheSplit)
+{
+    Crossover xover;
+    xover.Init(kSampleRate, 4);
+    for(size_t s = 0; s < 3; s++)
+    {
+        xover.Init(kSampleRate, 4);
+        const auto x     = Sine(xover.GetFreq(s), 0.5f, 19200);
+        const auto bands = Split(xover, x);
+        const float low  = SettledRms(bands[s]) / SettledRms(x);
+        const float high = SettledRms(bands[s + 1]) / SettledRms(x);
+        // the neighbouring splits are far enough to barely add to this
+        EXPECT_NEAR(ToDb(low), -6.02f, 0.3f) << "split " << s;
+        EXPECT_NEAR(ToDb(high), -6.02f, 0.3f) << "split " << s;
+    }
+}
+
+TEST(Crossover, stopBandsRollOff)
+{
+    Crossover xover;
+    xover.Init(kSampleRate, 2);
+    xover.SetFreq(0, 1000.0f);
+
+    // 24 dB per octave, two octaves away
+    const auto low  = Split(xover, Sine(250.0f, 0.5f, 9600));
+    const auto high = Split(xover, Sine(4000.0f, 0.5f, 9600));
+    EXPECT_LT(ToDb(SettledRms(low[1]) / SettledRms(low[0])), -45.0f);
+    EXPECT_LT(ToDb(SettledRms(high[0]) / SettledRms(high[1])), -45.0f);
+}
+
+TEST(Compressor, gainIntervalOfOneMatchesProcess)
+{
+    Compressor a, b;
+    a.Init(kSampleRate);
+    b.Init(kSampleRate);
+    a.SetThreshold(-20.0f);
+    b.SetThreshold(-20.0f);
+    a.SetRatio(4.0f);
+    b.SetRatio(4.0f);
+
+    auto x = Sine(220.0f, 0.8f, 4800);
+    std::vector<float> y(x.size());
+    for(size_t i = 0; i < x.size(); i++)
+        y[i] = a.Process(x[i]);
+    for(size_t i = 0; i < x.size(); i += kBlockSize)
+        b.ProcessBlock(&x[i], &x[i], kBlockSize);
+    for(size_t i = 0; i < x.size(); i++)
+        ASSERT_EQ(x[i], y[i]) << i;
+}
+
+TEST(Compressor, gainIntervalKeepsTheCurve)
+{
+    for(size_t interval : {8, 16, 48})
+    {
+        Compressor a, b;
+        a.Init(kSampleRate);
+        b.Init(kSampleRate);
+        b.SetGainInterval(interval);
+        for(Compressor* c : {&a, &b})
+        {
+            c->SetThreshold(-20.0f);
+            c->SetRatio(4.0f);
+            c->SetAttack(0.005f);
+            c->SetRelease(0.05f);
+        }
+
+        // a loud and a quiet burst, to go through attack and release
+        auto x = Sine(220.0f, 0.8f, 24000);
+        for(size_t i = 12000; i < x.size(); i++)
+            x[i] *= 0.1f;
+        auto y = x;
+        for(size_t i = 0; i < x.size(); i += kBlockSize)
+        {
+            a.ProcessBlock(&x[i], &x[i], kBlockSize);
+            b.ProcessBlock(&y[i], &y[i], kBlockSize);
+        }
+        float worst = 0.0f;
+        for(size_t i = 0; i < x.size(); i += 480)
+        {
+            const std::vector<float> xa(x.begin() + i, x.begin() + i + 480);
+            const std::vector<float> ya(y.begin() + i, y.begin() + i + 480);
+            worst = fmaxf(worst, fabsf(ToDb(SettledRms(ya) / SettledRms(xa))));
+        }
+        EXPECT_LT(worst, 0.5f) << interval;
+        EXPECT_NEAR(a.GetGain(), b.GetGain(), 0.05f) << interval;
+    }
+}
+
+TEST(MultibandCompressor, quietInputIsOnlyPhaseShifted)
+{
+    MultibandCompressor mbc;
+    mbc.Init(kSampleRate, 4, 2);
+    for(float freq : {80.0f, 500.0f, 3000.0f, 9000.0f})
+    {
+        auto left  = Sine(freq, 0.05f, 9600);
+        auto right = left;
+        Process(mbc, left, right);
+        const auto x = Sine(freq, 0.05f, 9600);
+        EXPECT_NEAR(ToDb(SettledRms(left) / SettledRms(x)), 0.0f, 0.01f);
+        EXPECT_EQ(left, right);
+    }
+}
+
+TEST(MultibandCompressor, onlyTheLoudBandIsCompressed)
+{
+    MultibandCompressor mbc;
+    mbc.Init(kSampleRate, 3, 1);
+    for(size_t b = 0; b < 3; b++)
+    {
+        mbc.SetThreshold(b, -20.0f);
+        mbc.SetRatio(b, 8.0f);
+    }
+
+    // a loud bass and a quiet treble, the treble keeps its level
+    const auto bass   = Sine(60.0f, 0.8f, 24000);
+    const auto treble = Sine(6000.0f, 0.05f, 24000);
+    std::vector<float> x(bass.size());
+    for(size_t i = 0; i < x.size(); i++)
+        x[i] = bass[i] + treble[i];
+    for(size_t i = 0; i < x.size(); i += kBlockSize)
+    {
+        float* ch[1] = {&x[i]};
+        mbc.ProcessBlock(ch, ch, kBlockSize);
+    }
+
+    EXPECT_LT(mbc.GetGain(0), -10.0f);
+    EXPECT_NEAR(mbc.GetGain(2), 0.0f, 0.1f);
+
+    Crossover xover;
+    xover.Init(kSampleRate, 3);
+    const auto bands = Split(xover, x);
+    EXPECT_NEAR(SettledRms(bands[2]) / SettledRms(treble), 1.0f, 0.02f);
+    EXPECT_LT(SettledRms(bands[0]) / SettledRms(bass), 0.4f);
+}
+
+TEST(MultibandCompressor, stereoLink)
+{
+    for(float link : {0.0f, 1.0f})
+    {
+        MultibandCompressor mbc;
+        mbc.Init(kSampleRate, 2, 2);
+        mbc.SetStereoLink(link);
+        for(size_t b = 0; b < 2; b++)
+        {
+            mbc.SetThreshold(b, -20.0f);
+            mbc.SetRatio(b, 8.0f);
+        }
+
+        // a loud left and a quiet right channel
+        auto left  = Sine(100.0f, 0.8f, 24000);
+        auto right = Sine(100.0f, 0.05f, 24000);
+        Process(mbc, left, right);
+        const float right_gain
+            = SettledRms(right) / SettledRms(Sine(100.0f, 0.05f, 24000));
+        const float left_gain
+            = SettledRms(left) / SettledRms(Sine(100.0f, 0.8f, 24000));
+        if(link == 1.0f)
+        {
+            EXPECT_NEAR(ToDb(right_gain), ToDb(left_gain), 0.01f);
+        }
+        else
+        {
+            EXPECT_NEAR(ToDb(right_gain), 0.0f, 0.05f);
+        }
+        EXPECT_LT(ToDb(left_gain), -10.0f);
+    }
+}
+
+TEST(golden_Dynamics, multibandCompressor)
+{
+    MultibandCompressor mbc;
+    mbc.Init(kSampleRate, 4, 1);
+    for(size_t b = 0; b < 4; b++)
+    {
+        mbc.SetThreshold(b, -24.0f);
+        mbc.SetRatio(b, 3.0f);
+        mbc.SetAttack(b, 0.002f);
+        mbc.SetRelease(b, 0.05f);
+    }
+
+    // noise bursts and a sweeping saw
+    WhiteNoise noise;
+    noise.Init();
+    Oscillator osc;
+    osc.Init(kSampleRate);
+    osc.SetWaveform(Oscillator::WAVE_POLYBLEP_SAW);
+    FtzScope           ftz;
+    std::vector<float> x(19200);
+    for(size_t i = 0; i < x.size(); i++)
+    {
+        osc.SetFreq(50.0f + 2000.0f * i / x.size());
+        x[i] = 0.4f * osc.Process()
+               + ((i / 2400) % 2 ? 0.5f * noise.Process() : 0.0f);
+    }
+    for(size_t i = 0; i < x.size(); i += kBlockSize)
+    {
+        float* ch[1] = {&x[i]};
+        mbc.ProcessBlock(ch, ch, kBlockSize);
+    }
+    ExpectMatchesGolden("multiband_compressor", x);
+}
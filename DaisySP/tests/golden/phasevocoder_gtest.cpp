@@ -0,0 +1,177 @@
+#include "daisysp.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace daisysp;
+
+namespace
+{
+constexpr float  kSampleRate = 48000.0f;
+constexpr size_t kBlockSize  = 48;
+
+std::vector<float> Sine(float freq, size_t size)
+{
+    std::vector<float> x(size);
+    for(size_t i = 0; i < size; i++)
+        x[i] = 0.5f * sinf(TWOPI_F * freq * i / kSampleRate);
+    return x;
+}
+
+std::vector<float> Render(PhaseVocoder& pv, size_t size)
+{
+    std::vector<float> y(size);
+    for(size_t i = 0; i + kBlockSize <= size; i += kBlockSize)
+        pv.Process(&y[i], kBlockSize);
+    return y;
+}
+
+/** Frequency from the rising zero crossings of y[start:] */
+float ZeroCrossingFreq(const std::vector<float>& y, size_t start)
+{
+    size_t first = 0, last = 0, crossings = 0;
+    for(size_t i = start + 1; i < y.size(); i++)
+    {
+        if(y[i - 1] < 0.0f && y[i] >= 0.0f)
+        {
+            if(crossings == 0)
+                first = i;
+            last = i;
+            crossings++;
+        }
+    }
+    return crossings < 2 ? 0.0f
+                         : (crossings - 1) * kSampleRate / (last - first);
+}
+
+float Rms(const std::vector<float>& y, size_t start, size_t end)
+{
+    double sum = 0.0;
+    for(size_t i = start; i < end; i++)
+        sum += y[i] * y[i];
+    return std::sqrt(sum / (end - start));
+}
+} // namespace
+
+TEST(PhaseVocoder, unityIsTransparent)
+{
+    std::mt19937                          rng(5);
+    std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+    std::vector<float>                    sample(20000);
+    for(auto& s : sample)
+        s = dist(rng);
+
+    const size_t       fft_size = 1024;
+    std::vector<float> mem(PhaseVocoder::GetBufferSize(fft_size));
+    PhaseVocoder       pv;
+    ASSERT_TRUE(pv.Init(sample.data(), sample.size(), mem.data(), fft_size));
+
+    std::vector<float> y       = Render(pv, 48 * 600);
+    const size_t       latency = pv.GetLatency();
+    for(size_t i = latency + fft_size; i < y.size(); i++)
+    {
+        const size_t src = (i - latency) % sample.size();
+        ASSERT_NEAR(y[i], sample[src], 1e-3f) << "sample " << i;
+    }
+}
+
+TEST(PhaseVocoder, transposesWithoutChangingSpeed)
+{
+    std::vector<float> sample = Sine(500.0f, 48000);
+    std::vector<float> mem(PhaseVocoder::GetBufferSize(2048));
+    PhaseVocoder       pv;
+    ASSERT_TRUE(pv.Init(sample.data(), sample.size(), mem.data(), 2048));
+
+    for(float cents : {1200.0f, 700.0f, -1200.0f})
+    {
+        pv.SetPosition(0.0f);
+        pv.SetTransposition(cents);
+        std::vector<float> y = Render(pv, 24000);
+        const float expected = 500.0f * powf(2.0f, cents / 1200.0f);
+        EXPECT_NEAR(ZeroCrossingFreq(y, 4096), expected, expected * 0.01f)
+            << cents << " cents";
+        EXPECT_NEAR(Rms(y, 4096, y.size()), 0.5f / sqrtf(2.0f), 0.1f);
+        // one hop per frame at normal speed
+        EXPECT_NEAR(pv.GetPosition(), 24000.0f, 2048.0f);
+    }
+}
+
+TEST(PhaseVocoder, stretchesWithoutChangingPitch)
+{
+    std::vector<float> sample = Sine(440.0f, 48000);
+    std::vector<float> mem(PhaseVocoder::GetBufferSize(1024));
+    PhaseVocoder       pv;
+    ASSERT_TRUE(pv.Init(sample.data(), sample.size(), mem.data(), 1024));
+
+    for(float speed : {0.5f, 0.25f, 1.5f, -1.0f, 0.0f})
+    {
+        pv.SetPosition(24000.0f);
+        pv.SetSpeed(speed);
+        std::vector<float> y = Render(pv, 9600);
+        EXPECT_NEAR(ZeroCrossingFreq(y, 2048), 440.0f, 4.4f)
+            << "speed " << speed;
+        EXPECT_NEAR(pv.GetPosition(), 24000.0f + speed * 9600.0f, 256.0f)
+            << "speed " << speed;
+    }
+}
+
+TEST(PhaseVocoder, stopsAtTheEndWithoutLoop)
+{
+    std::vector<float> sample = Sine(440.0f, 9600);
+    std::vector<float> mem(PhaseVocoder::GetBufferSize(1024));
+    PhaseVocoder       pv;
+    ASSERT_TRUE(pv.Init(sample.data(), sample.size(), mem.data(), 1024));
+    pv.SetLoop(false);
+    pv.SetSpeed(2.0f);
+
+    std::vector<float> y = Render(pv, 9600);
+    EXPECT_TRUE(pv.IsDone());
+    EXPECT_GT(Rms(y, 1024, 3000), 0.2f);
+    EXPECT_LT(Rms(y, 7000, y.size()), 1e-6f);
+}
+
+TEST(PhaseVocoder, resetsPhasesOnlyOnTransients)
+{
+    auto render = [](const std::vector<float>& sample, float threshold) {
+        std::vector<float> mem(PhaseVocoder::GetBufferSize(2048));
+        PhaseVocoder       pv;
+        pv.Init(sample.data(), sample.size(), mem.data(), 2048);
+        pv.SetSpeed(0.25f);
+        pv.SetTransposition(300.0f);
+        pv.SetTransientThreshold(threshold);
+        return Render(pv, 48 * 1500);
+    };
+    auto peak = [](const std::vector<float>& y) {
+        float p = 0.0f;
+        for(float s : y)
+            p = std::max(p, fabsf(s));
+        return p;
+    };
+
+    // a steady tone never triggers the detection
+    std::vector<float> sine = Sine(440.0f, 48000);
+    EXPECT_EQ(render(sine, 2.0f), render(sine, 0.0f));
+
+    // a decaying click every 250 ms, whose attack is kept coherent
+    std::vector<float> clicks(48000, 0.0f);
+    for(size_t start = 6000; start < clicks.size(); start += 12000)
+        for(size_t i = 0; i < 2000; i++)
+            clicks[start + i] = expf(-(i / 200.0f)) * sinf(0.3f * i);
+    std::vector<float> with_reset    = render(clicks, 2.0f);
+    std::vector<float> without_reset = render(clicks, 0.0f);
+    EXPECT_NE(with_reset, without_reset);
+    EXPECT_GE(peak(with_reset), peak(without_reset));
+}
+
+TEST(PhaseVocoder, rejectsAnEmptySample)
+{
+    std::vector<float> sample(1000, 0.0f);
+    std::vector<float> mem(PhaseVocoder::GetBufferSize(1024));
+    PhaseVocoder       pv;
+    EXPECT_FALSE(pv.Init(sample.data(), 0, mem.data(), 1024));
+    EXPECT_FALSE(pv.Init(nullptr, sample.size(), mem.data(), 1024));
+    EXPECT_FALSE(pv.Init(sample.data(), sample.size(), mem.data(), 1000));
+    EXPECT_TRUE(pv.Init(sample.data(), sample.size(), mem.data(), 1024));
+}
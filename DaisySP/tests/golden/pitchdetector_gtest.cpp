@@ -0,0 +1,212 @@
+#include "daisysp.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+using namespace daisysp;
+
+namespace
+{
+constexpr float  kSampleRate = 48000.0f;
+constexpr size_t kBlockSize  = 48;
+
+struct Detector
+{
+    Detector(size_t decimation = 4, float min_freq = 60.0f)
+    {
+        const size_t window
+            = PitchDetector::GetWindowSize(kSampleRate, decimation, min_freq);
+        buffer.resize(PitchDetector::GetBufferSize(window));
+        ok = pd.Init(buffer.data(), kSampleRate, window, decimation);
+    }
+
+    /** Feeds `num_samples` samples of `source` in blocks */
+    void Feed(const std::function<float()>& source, size_t num_samples)
+    {
+        float block[kBlockSize];
+        for(size_t i = 0; i < num_samples; i += kBlockSize)
+        {
+            for(auto& s : block)
+                s = source();
+            pd.Process(block, kBlockSize);
+        }
+    }
+
+    PitchDetector      pd;
+    std::vector<float> buffer;
+    bool               ok;
+};
+
+/** Relative error in cents */
+float Cents(float freq, float expected)
+{
+    return 1200.0f * log2f(freq / expected);
+}
+
+/** Pitch of x[start:] from the first autocorrelation peak close to the
+    highest one, at the full sample rate, searched from 40 Hz up
+*/
+float ReferencePitch(const std::vector<float>& x, size_t start)
+{
+    const size_t        max_lag = size_t(kSampleRate / 40.0f);
+    const size_t        length  = x.size() - start - max_lag - 1;
+    std::vector<double> r(max_lag + 1);
+    double              highest = 0.0;
+    for(size_t lag = 1; lag <= max_lag; lag++)
+    {
+        for(size_t i = 0; i < length; i++)
+            r[lag] += x[start + i] * x[start + i + lag];
+        if(lag > 20)
+            highest = std::max(highest, r[lag]);
+    }
+    for(size_t lag = 21; lag < max_lag; lag++)
+    {
+        if(r[lag] > 0.9 * highest && r[lag] >= r[lag - 1]
+           && r[lag] >= r[lag + 1])
+        {
+            const double delta = 0.5 * (r[lag - 1] - r[lag + 1])
+                                 / (r[lag - 1] - 2.0 * r[lag] + r[lag + 1]);
+            return kSampleRate / (lag + delta);
+        }
+    }
+    return 0.0f;
+}
+
+std::function<float()> MakeOsc(Oscillator& osc, uint8_t waveform, float freq)
+{
+    osc.Init(kSampleRate);
+    osc.SetWaveform(waveform);
+    osc.SetFreq(freq);
+    osc.SetAmp(0.5f);
+    return [&osc] { return osc.Process(); };
+}
+} // namespace
+
+TEST(PitchDetector, tracksSinesOverTheGuitarRange)
+{
+    for(float freq : {82.4f, 110.0f, 196.0f, 329.6f, 659.3f, 1318.5f})
+    {
+        Detector   d;
+        Oscillator osc;
+        ASSERT_TRUE(d.ok);
+        d.Feed(MakeOsc(osc, Oscillator::WAVE_SIN, freq), 24000);
+        EXPECT_TRUE(d.pd.IsVoiced()) << freq << " Hz";
+        EXPECT_GT(d.pd.GetConfidence(), 0.95f) << freq << " Hz";
+        EXPECT_NEAR(Cents(d.pd.GetFrequency(), freq), 0.0f, 3.0f)
+            << freq << " Hz";
+    }
+}
+
+TEST(PitchDetector, noOctaveErrorsOnRichWaveforms)
+{
+    for(uint8_t waveform :
+        {Oscillator::WAVE_POLYBLEP_SAW, Oscillator::WAVE_POLYBLEP_SQUARE})
+    {
+        for(float freq : {73.4f, 146.8f, 440.0f, 987.8f})
+        {
+            Detector   d;
+            Oscillator osc;
+            d.Feed(MakeOsc(osc, waveform, freq), 24000);
+            EXPECT_TRUE(d.pd.IsVoiced()) << freq << " Hz";
+            EXPECT_NEAR(Cents(d.pd.GetFrequency(), freq), 0.0f, 5.0f)
+                << freq << " Hz, waveform " << int(waveform);
+        }
+    }
+}
+
+TEST(PitchDetector, toleratesNoise)
+{
+    Detector   d;
+    Oscillator osc;
+    WhiteNoise noise;
+    noise.Init();
+    noise.SetAmp(0.1f);
+    auto saw = MakeOsc(osc, Oscillator::WAVE_POLYBLEP_SAW, 220.0f);
+    d.Feed([&] { return saw() + noise.Process(); }, 24000);
+    EXPECT_TRUE(d.pd.IsVoiced());
+    EXPECT_NEAR(Cents(d.pd.GetFrequency(), 220.0f), 0.0f, 10.0f);
+}
+
+TEST(PitchDetector, noiseAndSilenceAreUnvoiced)
+{
+    Detector   d;
+    WhiteNoise noise;
+    noise.Init();
+    d.Feed([&] { return noise.Process(); }, 24000);
+    EXPECT_FALSE(d.pd.IsVoiced());
+    EXPECT_LT(d.pd.GetConfidence(), 0.5f);
+
+    // the last frequency is kept through silence
+    Oscillator osc;
+    d.Feed(MakeOsc(osc, Oscillator::WAVE_SIN, 440.0f), 24000);
+    d.Feed([] { return 0.0f; }, 24000);
+    EXPECT_FALSE(d.pd.IsVoiced());
+    EXPECT_EQ(d.pd.GetConfidence(), 0.0f);
+    EXPECT_NEAR(d.pd.GetFrequency(), 440.0f, 1.0f);
+}
+
+TEST(PitchDetector, followsNoteChangesWithinLatency)
+{
+    Detector   d;
+    Oscillator osc;
+    auto       sine = MakeOsc(osc, Oscillator::WAVE_SIN, 220.0f);
+    d.Feed(sine, 12000);
+    EXPECT_NEAR(Cents(d.pd.GetFrequency(), 220.0f), 0.0f, 3.0f);
+
+    osc.SetFreq(330.0f);
+    d.Feed(sine, d.pd.GetLatency() + kBlockSize);
+    EXPECT_NEAR(Cents(d.pd.GetFrequency(), 330.0f), 0.0f, 3.0f);
+}
+
+TEST(PitchDetector, tracksPluckedStrings)
+{
+    // physical models stand in for recorded guitar notes, with their
+    // inharmonic partials, noisy attack and decay. The models are not
+    // exactly in tune, so the reference is an offline estimate.
+    for(float freq : {82.4f, 146.8f, 246.9f, 392.0f})
+    {
+        StringVoice voice;
+        voice.Init(kSampleRate);
+        voice.SetFreq(freq);
+        voice.SetStructure(0.3f);
+        voice.SetBrightness(0.6f);
+        voice.SetDamping(0.4f);
+        voice.SetAccent(0.9f);
+        std::vector<float> note(12000);
+        bool               trig = true;
+        for(auto& s : note)
+        {
+            s    = voice.Process(trig);
+            trig = false;
+        }
+
+        Detector d;
+        size_t   pos = 0;
+        d.Feed([&] { return note[pos++]; }, note.size());
+        const float reference = ReferencePitch(note, note.size() - 4096);
+        EXPECT_NEAR(Cents(reference, freq), 0.0f, 50.0f) << freq << " Hz";
+        EXPECT_TRUE(d.pd.IsVoiced()) << freq << " Hz";
+        EXPECT_NEAR(Cents(d.pd.GetFrequency(), reference), 0.0f, 5.0f)
+            << freq << " Hz";
+    }
+}
+
+TEST(PitchDetector, windowSetsLatencyAndRange)
+{
+    EXPECT_EQ(PitchDetector::GetWindowSize(48000.0f, 4, 60.0f), 512u);
+    EXPECT_EQ(PitchDetector::GetWindowSize(48000.0f, 8, 60.0f), 256u);
+    EXPECT_EQ(PitchDetector::GetWindowSize(48000.0f, 1, 10.0f), 0u);
+
+    Detector fast(8, 100.0f), slow(2, 40.0f);
+    EXPECT_LT(fast.pd.GetLatency(), slow.pd.GetLatency());
+    EXPECT_LE(fast.pd.GetMinFrequency(), 100.0f);
+    EXPECT_LE(slow.pd.GetMinFrequency(), 40.0f);
+
+    PitchDetector      pd;
+    std::vector<float> buffer(PitchDetector::GetBufferSize(1024));
+    EXPECT_FALSE(pd.Init(buffer.data(), kSampleRate, 1000, 4));
+    EXPECT_FALSE(pd.Init(buffer.data(), kSampleRate, 1024, 3));
+    EXPECT_TRUE(pd.Init(buffer.data(), kSampleRate, 1024, 1));
+}
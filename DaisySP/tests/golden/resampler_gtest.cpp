@@ -0,0 +1,230 @@
+#include "daisysp.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+using namespace daisysp;
+
+namespace
+{
+constexpr size_t kBlockSize = 48;
+
+typedef Resampler::Quality Quality;
+
+std::vector<float> Sine(double freq, double rate, size_t length)
+{
+    std::vector<float> x(length);
+    for(size_t i = 0; i < length; i++)
+        x[i] = 0.5f * sin(2.0 * M_PI * freq * i / rate);
+    return x;
+}
+
+/** Converts x in blocks, pulling the input that each block needs. Zeros
+    are read past the end of x.
+*/
+std::vector<float>
+Convert(Resampler& rs, const std::vector<float>& x, size_t out_size)
+{
+    std::vector<float> out(out_size);
+    size_t             read = 0;
+    for(size_t i = 0; i < out_size; i += kBlockSize)
+    {
+        const size_t needed = rs.GetInputNeeded(kBlockSize);
+        float        in[Resampler::kMaxInput] = {};
+        for(size_t n = 0; n < needed && read + n < x.size(); n++)
+            in[n] = x[read + n];
+        read += needed;
+        rs.Process(in, &out[i], kBlockSize);
+    }
+    return out;
+}
+
+/** Ratio of everything but a sine at freq to the sine, in dB, over the
+    second half of y. The sine is fitted by least squares, so the delay of
+    the converter doesn't matter.
+*/
+double ThdN(const std::vector<float>& y, double freq)
+{
+    const size_t start = y.size() / 2;
+    double       ss = 0.0, sc = 0.0, cc = 0.0, ys = 0.0, yc = 0.0;
+    for(size_t i = start; i < y.size(); i++)
+    {
+        const double s = sin(2.0 * M_PI * freq * i);
+        const double c = cos(2.0 * M_PI * freq * i);
+        ss += s * s;
+        sc += s * c;
+        cc += c * c;
+        ys += y[i] * s;
+        yc += y[i] * c;
+    }
+    const double det = ss * cc - sc * sc;
+    const double a   = (ys * cc - yc * sc) / det;
+    const double b   = (yc * ss - ys * sc) / det;
+
+    double signal = 0.0, residual = 0.0;
+    for(size_t i = start; i < y.size(); i++)
+    {
+        const double fit = a * sin(2.0 * M_PI * freq * i)
+                           + b * cos(2.0 * M_PI * freq * i);
+        signal += fit * fit;
+        residual += (y[i] - fit) * (y[i] - fit);
+    }
+    return 10.0 * log10(residual / signal);
+}
+
+/** Level of the second half of y relative to a sine of amplitude 0.5 */
+double LevelDb(const std::vector<float>& y)
+{
+    double sum = 0.0;
+    for(size_t i = y.size() / 2; i < y.size(); i++)
+        sum += y[i] * y[i];
+    return 10.0 * log10(sum / (y.size() - y.size() / 2) / 0.125);
+}
+
+/** Frequency of a tone at the output, in cycles per sample. The ratio is
+    a float, so it is not exactly in_rate / out_rate.
+*/
+double OutputFreq(const Resampler& rs, double freq, double in_rate)
+{
+    return freq / in_rate * rs.GetRatio();
+}
+
+/** THD+N of a tone converted from 44.1 kHz to 48 kHz */
+double ThdN44To48(Quality quality, double freq)
+{
+    Resampler rs;
+    rs.Init(quality);
+    rs.SetRates(44100.0f, 48000.0f);
+    const auto x = Sine(freq, 44100.0, 44100);
+    return ThdN(Convert(rs, x, 38400), OutputFreq(rs, freq, 44100.0));
+}
+
+/** Level of a tone above the output Nyquist frequency, played from
+    96 kHz at 48 kHz
+*/
+double Alias96To48(Quality quality, double freq)
+{
+    Resampler rs;
+    rs.Init(quality);
+    rs.SetRates(96000.0f, 48000.0f);
+    const auto x = Sine(freq, 96000.0, 96000);
+    return LevelDb(Convert(rs, x, 38400));
+}
+} // namespace
+
+TEST(Resampler, thdnFrom44k1To48k)
+{
+    // distortion and noise of a 1 kHz tone, and of a tone near the top of
+    // the passband of each preset
+    EXPECT_LT(ThdN44To48(Quality::FAST, 1000.0), -58.0);
+    EXPECT_LT(ThdN44To48(Quality::STANDARD, 1000.0), -88.0);
+    EXPECT_LT(ThdN44To48(Quality::HIGH, 1000.0), -110.0);
+    EXPECT_LT(ThdN44To48(Quality::FAST, 6000.0), -52.0);
+    EXPECT_LT(ThdN44To48(Quality::STANDARD, 15000.0), -84.0);
+    EXPECT_LT(ThdN44To48(Quality::HIGH, 18000.0), -92.0);
+}
+
+TEST(Resampler, aliasRejectionFrom96kTo48k)
+{
+    // a 1 kHz tone passes, tones that would fold back into the audio band
+    // are attenuated
+    EXPECT_NEAR(Alias96To48(Quality::STANDARD, 1000.0), 0.0, 0.1);
+    EXPECT_LT(Alias96To48(Quality::FAST, 36000.0), -58.0);
+    EXPECT_LT(Alias96To48(Quality::STANDARD, 30000.0), -82.0);
+    EXPECT_LT(Alias96To48(Quality::HIGH, 28000.0), -100.0);
+}
+
+TEST(Resampler, imageRejectionFrom24kTo48k)
+{
+    // upsampling by 2: the image of a 10 kHz tone at 14 kHz is removed
+    Resampler rs;
+    rs.Init(Quality::STANDARD);
+    rs.SetRates(24000.0f, 48000.0f);
+    const auto x = Sine(10000.0, 24000.0, 24000);
+    EXPECT_LT(ThdN(Convert(rs, x, 38400), OutputFreq(rs, 10000.0, 24000.0)),
+              -75.0);
+}
+
+TEST(Resampler, blockSizeDoesNotChangeTheOutput)
+{
+    const auto x = Sine(440.0, 44100.0, 10000);
+    Resampler  a, b;
+    a.Init(Quality::STANDARD);
+    b.Init(Quality::STANDARD);
+    a.SetRatio(1.37f);
+    b.SetRatio(1.37f);
+
+    const auto ref = Convert(a, x, 4800);
+
+    // blocks of 1 to 7 samples
+    std::vector<float> out(ref.size());
+    size_t             read = 0;
+    for(size_t i = 0, size = 1; i < out.size(); i += size, size = size % 7 + 1)
+    {
+        size               = std::min(size, out.size() - i);
+        const size_t need  = b.GetInputNeeded(size);
+        float        in[8] = {};
+        for(size_t n = 0; n < need; n++)
+            in[n] = read + n < x.size() ? x[read + n] : 0.0f;
+        read += need;
+        b.Process(in, &out[i], size);
+    }
+    for(size_t i = 0; i < ref.size(); i++)
+        ASSERT_EQ(ref[i], out[i]) << i;
+}
+
+TEST(Resampler, inputNeededMatchesTheRatio)
+{
+    Resampler rs;
+    rs.Init(Quality::FAST, Resampler::kMaxRatio);
+    for(float ratio : {0.25f, 0.9187f, 1.0f, 2.0f, 3.999f})
+    {
+        rs.SetRatio(ratio);
+        size_t total = 0;
+        for(size_t i = 0; i < 1000; i++)
+        {
+            total += rs.GetInputNeeded(kBlockSize);
+            float in[Resampler::kMaxInput] = {}, out[kBlockSize];
+            rs.Process(in, out, kBlockSize);
+        }
+        EXPECT_NEAR(total, 1000.0 * kBlockSize * ratio, 1.0) << ratio;
+    }
+}
+
+TEST(Resampler, unityGainAtDc)
+{
+    for(float ratio : {0.3f, 1.0f, 1.5f, 3.0f})
+    {
+        Resampler rs;
+        rs.Init(Quality::STANDARD, Resampler::kMaxRatio);
+        rs.SetRatio(ratio);
+        const std::vector<float> x(4000, 0.5f);
+        const auto               y = Convert(rs, x, 960);
+        for(size_t i = 480; i < y.size(); i++)
+            ASSERT_NEAR(y[i], 0.5f, 1e-4f) << ratio;
+    }
+}
+
+TEST(Resampler, ratioGlideIsSmooth)
+{
+    // a 100 Hz tone swept from half to twice its speed, block by block,
+    // has no steps larger than the slope of the fastest tone
+    Resampler rs;
+    rs.Init(Quality::STANDARD);
+    const auto         x = Sine(100.0, 48000.0, 96000);
+    std::vector<float> out(48000);
+    size_t             read = 0;
+    for(size_t i = 0; i < out.size(); i += kBlockSize)
+    {
+        rs.SetRatio(0.5f * powf(4.0f, float(i) / out.size()));
+        const size_t needed                   = rs.GetInputNeeded(kBlockSize);
+        float        in[Resampler::kMaxInput] = {};
+        for(size_t n = 0; n < needed; n++)
+            in[n] = x[read + n];
+        read += needed;
+        rs.Process(in, &out[i], kBlockSize);
+    }
+    const float max_step = 1.05f * 0.5f * TWOPI_F * 200.0f / 48000.0f;
+    for(size_t i = 100; i < out.size(); i++)
+        ASSERT_LT(fabsf(out[i] - out[i - 1]), max_step) << i;
+}
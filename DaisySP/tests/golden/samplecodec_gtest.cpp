@@ -0,0 +1,130 @@
+#include "daisysp.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+using namespace daisysp;
+
+namespace
+{
+typedef SampleCodec::Format Format;
+
+constexpr Format kFormats[]
+    = {Format::FLOAT32, Format::ADPCM4, Format::BFP8, Format::BFP12};
+
+/** A 440 Hz tone at 48 kHz, fading from 0 dB to -60 dB */
+std::vector<float> Tone(size_t length)
+{
+    std::vector<float> x(length);
+    for(size_t i = 0; i < length; i++)
+        x[i] = powf(10.0f, -3.0f * i / length)
+               * sinf(TWOPI_F * 440.0f * i / 48000.0f);
+    return x;
+}
+
+std::vector<uint8_t> Encode(Format format, const std::vector<float>& x)
+{
+    std::vector<uint8_t> data(SampleCodec::GetEncodedSize(format, x.size()));
+    SampleCodec::Encode(format, x.data(), x.size(), data.data());
+    return data;
+}
+
+std::vector<float> Decode(Format format, const std::vector<uint8_t>& data)
+{
+    const size_t       bytes = SampleCodec::GetBlockBytes(format);
+    std::vector<float> y(data.size() / bytes * SampleCodec::kBlockSize);
+    for(size_t b = 0; b < data.size() / bytes; b++)
+        SampleCodec::DecodeBlock(
+            format, &data[b * bytes], &y[b * SampleCodec::kBlockSize]);
+    return y;
+}
+
+/** Signal to error ratio in dB over [start, end) */
+double Snr(const std::vector<float>& x,
+           const std::vector<float>& y,
+           size_t                    start,
+           size_t                    end)
+{
+    double signal = 0.0, error = 0.0;
+    for(size_t i = start; i < end; i++)
+    {
+        signal += x[i] * x[i];
+        error += (x[i] - y[i]) * (x[i] - y[i]);
+    }
+    return error > 0.0 ? 10.0 * log10(signal / error) : 200.0;
+}
+} // namespace
+
+TEST(SampleCodec, sizes)
+{
+    EXPECT_EQ(SampleCodec::GetBlockBytes(Format::FLOAT32), 256u);
+    EXPECT_EQ(SampleCodec::GetBlockBytes(Format::ADPCM4), 36u);
+    EXPECT_EQ(SampleCodec::GetBlockBytes(Format::BFP8), 68u);
+    EXPECT_EQ(SampleCodec::GetBlockBytes(Format::BFP12), 100u);
+    for(Format format : kFormats)
+    {
+        EXPECT_EQ(SampleCodec::GetBlockBytes(format) % 4, 0u);
+        EXPECT_EQ(SampleCodec::GetEncodedSize(format, 65),
+                  2 * SampleCodec::GetBlockBytes(format));
+    }
+}
+
+TEST(SampleCodec, signalToErrorRatio)
+{
+    // loud and quiet halves of a fading tone
+    const size_t length = 48000;
+    const auto   x      = Tone(length);
+    const double min_snr[][2]
+        = {{140.0, 140.0}, {32.0, 40.0}, {45.0, 45.0}, {68.0, 68.0}};
+    for(size_t f = 0; f < 4; f++)
+    {
+        const auto y = Decode(kFormats[f], Encode(kFormats[f], x));
+        EXPECT_GT(Snr(x, y, 0, length / 2), min_snr[f][0]) << f;
+        EXPECT_GT(Snr(x, y, length / 2, length), min_snr[f][1]) << f;
+    }
+}
+
+TEST(SampleCodec, silenceAndFullScale)
+{
+    std::vector<float> x(256, 0.0f);
+    for(size_t i = 128; i < 256; i++)
+        x[i] = i % 2 ? 1.0f : -1.0f;
+    for(Format format : kFormats)
+    {
+        const auto y = Decode(format, Encode(format, x));
+        for(size_t i = 0; i < 128; i++)
+            ASSERT_EQ(y[i], 0.0f) << int(format);
+        // nothing wraps around at full scale
+        for(size_t i = 192; i < 256; i++)
+            ASSERT_NEAR(y[i], x[i], 0.2f) << int(format) << " " << i;
+    }
+}
+
+TEST(SampleCodec, readerMatchesTheBlockDecoder)
+{
+    const auto x = Tone(1000);
+    for(Format format : kFormats)
+    {
+        const auto   data = Encode(format, x);
+        const auto   ref  = Decode(format, data);
+        SampleReader reader;
+        reader.Init(data.data(), x.size(), format);
+
+        // random access, backwards
+        for(size_t i = x.size(); i-- > 0;)
+            ASSERT_EQ(reader.Get(i), ref[i]) << i;
+        EXPECT_EQ(reader.Get(x.size()), 0.0f);
+
+        // ranges across block boundaries and past the end
+        std::vector<float> out(300);
+        for(size_t pos : {0u, 1u, 63u, 64u, 100u, 900u, 999u, 1000u})
+        {
+            const size_t valid = reader.Read(pos, out.data(), out.size());
+            EXPECT_EQ(valid,
+                      pos < 1000 ? std::min<size_t>(300, 1000 - pos) : 0);
+            for(size_t i = 0; i < out.size(); i++)
+                ASSERT_EQ(out[i], pos + i < x.size() ? ref[pos + i] : 0.0f)
+                    << pos << " " << i;
+        }
+    }
+}
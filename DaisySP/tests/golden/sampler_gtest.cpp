@@ -0,0 +1,336 @@
+#include "daisysp.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+using namespace daisysp;
+
+namespace
+{
+typedef Sampler::Interpolation Interpolation;
+
+constexpr float kSampleRate = 48000.0f;
+
+std::vector<float> Ramp(size_t length)
+{
+    std::vector<float> x(length);
+    for(size_t i = 0; i < length; i++)
+        x[i] = i * 0.001f;
+    return x;
+}
+
+std::vector<float> Sine(size_t length, float freq, float sample_rate)
+{
+    std::vector<float> x(length);
+    for(size_t i = 0; i < length; i++)
+        x[i] = sinf(TWOPI_F * freq * i / sample_rate);
+    return x;
+}
+
+SamplerZone Zone(SampleSource* source)
+{
+    SamplerZone zone = {};
+    zone.source      = source;
+    zone.sample_rate = kSampleRate;
+    zone.root_note   = 60;
+    zone.key_hi      = 127;
+    zone.vel_hi      = 127;
+    zone.gain        = 1.0f;
+    return zone;
+}
+
+std::vector<float>
+Render(Sampler& sampler, size_t length, size_t block = 48)
+{
+    std::vector<float> y(length);
+    for(size_t i = 0; i < length; i += block)
+        sampler.Process(&y[i], length - i < block ? length - i : block);
+    return y;
+}
+
+float MaxStep(const std::vector<float>& y, size_t start)
+{
+    float step = 0.0f;
+    for(size_t i = start + 1; i < y.size(); i++)
+        step = fmaxf(step, fabsf(y[i] - y[i - 1]));
+    return step;
+}
+} // namespace
+
+TEST(Sampler, zones)
+{
+    std::vector<float> x = Ramp(1000);
+    SampleSource       source;
+    source.Init(x.data(), x.size());
+
+    SamplerZone zones[3] = {Zone(&source), Zone(&source), Zone(&source)};
+    zones[0].key_hi      = 59;
+    zones[1].key_lo      = 60;
+    zones[2].key_lo      = 60;
+    zones[2].vel_lo      = 100;
+
+    Sampler sampler;
+    sampler.Init(kSampleRate, zones, 3);
+    EXPECT_EQ(sampler.NoteOn(40, 64), 1u);
+    EXPECT_EQ(sampler.NoteOn(70, 64), 1u);
+    EXPECT_EQ(sampler.NoteOn(70, 127), 2u);
+    EXPECT_EQ(sampler.GetNumActiveVoices(), 4u);
+    sampler.Reset();
+    EXPECT_EQ(sampler.GetNumActiveVoices(), 0u);
+}
+
+TEST(Sampler, plays_the_sample_at_its_pitch)
+{
+    std::vector<float> x = Ramp(1000);
+    SampleSource       source;
+    source.Init(x.data(), x.size());
+    SamplerZone zone = Zone(&source);
+
+    for(Interpolation interpolation :
+        {Interpolation::LINEAR, Interpolation::CUBIC})
+    {
+        Sampler sampler;
+        sampler.Init(kSampleRate, &zone, 1);
+        sampler.SetInterpolation(interpolation);
+
+        sampler.NoteOn(60, 127);
+        std::vector<float> y = Render(sampler, 480);
+        for(size_t i = 0; i < y.size(); i++)
+            ASSERT_EQ(y[i], x[i]) << i;
+
+        // an octave up reads every other frame
+        sampler.Reset();
+        sampler.NoteOn(72, 127);
+        y = Render(sampler, 480);
+        for(size_t i = 0; i < y.size(); i++)
+            ASSERT_EQ(y[i], x[2 * i]) << i;
+
+        // and ends with the sample
+        Render(sampler, 48);
+        EXPECT_EQ(sampler.GetNumActiveVoices(), 0u);
+    }
+}
+
+TEST(Sampler, crossfaded_loop_has_no_click)
+{
+    // 45.8 periods in the loop, so its end doesn't meet its start
+    std::vector<float> x = Sine(12000, 440.0f, kSampleRate);
+    SampleSource       source;
+    source.Init(x.data(), x.size());
+    SamplerZone zone = Zone(&source);
+    zone.loop_start  = 4000;
+    zone.loop_end    = 9000;
+
+    Sampler sampler;
+    sampler.Init(kSampleRate, &zone, 1);
+    sampler.NoteOn(60, 127);
+    const float click = MaxStep(Render(sampler, 48000), 0);
+
+    std::vector<float> crossfade(512);
+    zone.crossfade = 512;
+    Sampler::PrepareZone(zone, crossfade.data());
+    sampler.Init(kSampleRate, &zone, 1);
+    sampler.NoteOn(60, 127);
+    std::vector<float> y = Render(sampler, 48000);
+
+    // a sine of 440 Hz moves by 0.058 at most per sample, a bit more while
+    // the crossfade turns its phase
+    EXPECT_GT(click, 0.5f);
+    EXPECT_LT(MaxStep(y, 0), 0.08f);
+    EXPECT_EQ(sampler.GetNumActiveVoices(), 1u);
+
+    // the crossfade is limited to the frames before the loop
+    zone.loop_start = 100;
+    zone.crossfade  = 512;
+    Sampler::PrepareZone(zone, crossfade.data());
+    EXPECT_EQ(zone.crossfade, 100u);
+}
+
+TEST(Sampler, encoded_source_matches_memory)
+{
+    std::vector<float> x = Sine(24000, 440.0f, kSampleRate);
+    const SampleCodec::Format format = SampleCodec::Format::BFP12;
+    std::vector<uint8_t>      data(
+        SampleCodec::GetEncodedSize(format, x.size()));
+    SampleCodec::Encode(format, x.data(), x.size(), data.data());
+
+    SampleSource memory, encoded;
+    memory.Init(x.data(), x.size());
+    encoded.Init(data.data(), x.size(), format);
+    SamplerZone zones[2] = {Zone(&memory), Zone(&encoded)};
+
+    Sampler a, b;
+    a.Init(kSampleRate, &zones[0], 1);
+    b.Init(kSampleRate, &zones[1], 1);
+    a.NoteOn(67, 127);
+    b.NoteOn(67, 127);
+    std::vector<float> ya = Render(a, 9600), yb = Render(b, 9600);
+    for(size_t i = 0; i < ya.size(); i++)
+        ASSERT_NEAR(ya[i], yb[i], 2e-3f) << i;
+}
+
+TEST(Sampler, streamed_source_matches_memory)
+{
+    std::vector<float> x = Sine(12000, 440.0f, kSampleRate);
+    SampleSource       memory, stream;
+    memory.Init(x.data(), x.size());
+
+    constexpr size_t kChunks = 8;
+    std::vector<float> buffer(kChunks * SampleSource::kStreamChunk);
+    uint32_t           tags[kChunks];
+    stream.InitStream(buffer.data(), tags, kChunks, x.size());
+    auto load = [&](size_t frame) {
+        const size_t n = x.size() - frame < SampleSource::kStreamChunk
+                             ? x.size() - frame
+                             : SampleSource::kStreamChunk;
+        stream.WriteStream(frame, &x[frame], n);
+    };
+
+    SamplerZone zones[2] = {Zone(&memory), Zone(&stream)};
+    std::vector<float> crossfade[2];
+    for(size_t z = 0; z < 2; z++)
+    {
+        zones[z].loop_start = 4096;
+        zones[z].loop_end   = 9216;
+        zones[z].crossfade  = 256;
+        crossfade[z].resize(256);
+    }
+    Sampler::PrepareZone(zones[0], crossfade[0].data());
+    // the crossfade reads the chunks before the loop start and end
+    load(4096 - 256);
+    load(9216 - 256);
+    Sampler::PrepareZone(zones[1], crossfade[1].data());
+    ASSERT_EQ(crossfade[0], crossfade[1]);
+
+    Sampler a, b;
+    a.Init(kSampleRate, &zones[0], 1);
+    b.Init(kSampleRate, &zones[1], 1);
+    size_t frame;
+    while(stream.GetStreamRequest(frame))
+        load(frame);
+
+    a.NoteOn(62, 127);
+    b.NoteOn(62, 127);
+    float ya[48], yb[48];
+    for(size_t block = 0; block < 1000; block++)
+    {
+        a.Process(ya, 48);
+        b.Process(yb, 48);
+        for(size_t i = 0; i < 48; i++)
+            ASSERT_EQ(ya[i], yb[i]) << block << " " << i;
+        while(stream.GetStreamRequest(frame))
+            load(frame);
+    }
+    EXPECT_EQ(stream.GetUnderruns(), 0u);
+
+    // the stream has a single reader, the next note takes over its voice
+    EXPECT_EQ(a.NoteOn(64, 127), 1u);
+    EXPECT_EQ(b.NoteOn(64, 127), 1u);
+    EXPECT_EQ(a.GetNumActiveVoices(), 2u);
+    EXPECT_EQ(b.GetNumActiveVoices(), 1u);
+}
+
+TEST(Sampler, release_and_voice_stealing)
+{
+    std::vector<float> x(1000, 1.0f);
+    SampleSource       source;
+    source.Init(x.data(), x.size());
+    SamplerZone zone = Zone(&source);
+    zone.loop_start  = 100;
+    zone.loop_end    = 900;
+
+    Sampler sampler;
+    sampler.Init(kSampleRate, &zone, 1);
+    sampler.SetRelease(0.01f);
+    for(uint8_t note = 40; note < 40 + Sampler::kMaxVoices; note++)
+        sampler.NoteOn(note, 127);
+    EXPECT_EQ(sampler.GetNumActiveVoices(), size_t(Sampler::kMaxVoices));
+
+    // the oldest voice is taken
+    EXPECT_EQ(sampler.NoteOn(100, 127), 1u);
+    EXPECT_EQ(sampler.GetNumActiveVoices(), size_t(Sampler::kMaxVoices));
+    sampler.NoteOff(40);
+    Render(sampler, 960);
+    EXPECT_EQ(sampler.GetNumActiveVoices(), size_t(Sampler::kMaxVoices));
+
+    sampler.Reset();
+    sampler.NoteOn(60, 127);
+    Render(sampler, 48);
+    sampler.NoteOff(60);
+    std::vector<float> y = Render(sampler, 960);
+    EXPECT_NEAR(y[0], 1.0f, 1e-3f);
+    EXPECT_NEAR(y[240], 0.5f, 1e-2f);
+    EXPECT_EQ(y[959], 0.0f);
+    EXPECT_EQ(sampler.GetNumActiveVoices(), 0u);
+}
+
+TEST(Sampler, output_does_not_depend_on_block_size)
+{
+    std::vector<float> x = Sine(12000, 440.0f, kSampleRate);
+    SampleSource       source;
+    source.Init(x.data(), x.size());
+    SamplerZone zone = Zone(&source);
+    zone.loop_start  = 4000;
+    zone.loop_end    = 9000;
+    zone.crossfade   = 300;
+    std::vector<float> crossfade(300);
+    Sampler::PrepareZone(zone, crossfade.data());
+
+    for(Interpolation interpolation :
+        {Interpolation::LINEAR, Interpolation::CUBIC, Interpolation::SINC})
+    {
+        std::vector<float> y[3];
+        const size_t       blocks[3] = {48, 7, 20000};
+        for(size_t i = 0; i < 3; i++)
+        {
+            Sampler sampler;
+            sampler.Init(kSampleRate, &zone, 1);
+            sampler.SetInterpolation(interpolation);
+            sampler.NoteOn(65, 127);
+            sampler.NoteOn(53, 127);
+            y[i] = Render(sampler, 20000, blocks[i]);
+        }
+        EXPECT_EQ(y[0], y[1]);
+        EXPECT_EQ(y[0], y[2]);
+    }
+}
+
+TEST(Sampler, sinc_interpolation)
+{
+    // 1 kHz recorded at 72 kHz, played at 48 kHz
+    std::vector<float> x = Sine(72000, 1000.0f, 72000.0f);
+    SampleSource       source;
+    source.Init(x.data(), x.size());
+    SamplerZone zone = Zone(&source);
+    zone.sample_rate = 72000.0f;
+
+    Sampler sampler;
+    sampler.Init(kSampleRate, &zone, 1);
+    sampler.SetInterpolation(Interpolation::SINC);
+    sampler.NoteOn(60, 127);
+    std::vector<float> y = Render(sampler, 9600);
+
+    // fit a 1 kHz sine over 100 periods after the latency
+    const size_t start = 4800, n = 4800;
+    double       a = 0.0, b = 0.0;
+    for(size_t i = 0; i < n; i++)
+    {
+        const double w = TWOPI_F * 1000.0 * (start + i) / kSampleRate;
+        a += y[start + i] * sin(w) * 2.0 / n;
+        b += y[start + i] * cos(w) * 2.0 / n;
+    }
+    double error = 0.0;
+    for(size_t i = 0; i < n; i++)
+    {
+        const double w = TWOPI_F * 1000.0 * (start + i) / kSampleRate;
+        const double e = y[start + i] - a * sin(w) - b * cos(w);
+        error += e * e;
+    }
+    EXPECT_NEAR(sqrt(a * a + b * b), 1.0, 1e-2);
+    EXPECT_LT(sqrt(error / n), 1e-3);
+
+    // the pool is shared, further voices use cubic interpolation
+    for(size_t i = 0; i < Sampler::kMaxSincVoices + 2; i++)
+        sampler.NoteOn(60, 127);
+    EXPECT_EQ(sampler.GetNumActiveVoices(), Sampler::kMaxSincVoices + 3u);
+}
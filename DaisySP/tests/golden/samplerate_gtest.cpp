@@ -0,0 +1,154 @@
+#include "daisysp.h"
+#include <gtest/gtest.h>
+#include <cmath>
+
+using namespace daisysp;
+
+namespace
+{
+struct FakeModule
+{
+    void SetSampleRate(float sample_rate)
+    {
+        rate = sample_rate;
+        num_updates++;
+    }
+
+    float rate        = 48000.0f;
+    int   num_updates = 0;
+};
+
+/** Counts the cycles of an oscillator over `num_samples` samples */
+int CountCycles(Oscillator& osc, size_t num_samples)
+{
+    int cycles = 0;
+    for(size_t i = 0; i < num_samples; i++)
+    {
+        osc.Process();
+        if(osc.IsEOC())
+            cycles++;
+    }
+    return cycles;
+}
+} // namespace
+
+TEST(SampleRate, updatesAreSpreadOverBlocks)
+{
+    SampleRateRegistry rates;
+    FakeModule         modules[10];
+    rates.Init(48000.0f);
+    for(auto& m : modules)
+        EXPECT_TRUE(rates.Subscribe(m));
+    EXPECT_EQ(rates.GetNumSubscribers(), 10u);
+
+    // nothing to do without a change
+    EXPECT_FALSE(rates.IsUpdating());
+    EXPECT_EQ(rates.Process(), 0u);
+    EXPECT_EQ(modules[0].num_updates, 0);
+
+    rates.SetSampleRate(96000.0f);
+    EXPECT_TRUE(rates.IsUpdating());
+    EXPECT_EQ(rates.Process(4), 6u);
+    EXPECT_EQ(modules[3].rate, 96000.0f);
+    EXPECT_EQ(modules[4].rate, 48000.0f);
+    EXPECT_EQ(rates.Process(4), 2u);
+    EXPECT_EQ(rates.Process(4), 0u);
+    EXPECT_FALSE(rates.IsUpdating());
+    for(auto& m : modules)
+    {
+        EXPECT_EQ(m.rate, 96000.0f);
+        EXPECT_EQ(m.num_updates, 1);
+    }
+}
+
+TEST(SampleRate, newRequestRestartsUpdate)
+{
+    SampleRateRegistry rates;
+    FakeModule         modules[6];
+    rates.Init(48000.0f);
+    for(auto& m : modules)
+        rates.Subscribe(m);
+
+    rates.SetSampleRate(96000.0f);
+    rates.Process(4);
+    rates.SetSampleRate(32000.0f);
+    rates.UpdateAll();
+    for(auto& m : modules)
+        EXPECT_EQ(m.rate, 32000.0f);
+    EXPECT_EQ(modules[0].num_updates, 2);
+    EXPECT_EQ(modules[5].num_updates, 1);
+    EXPECT_EQ(rates.GetSampleRate(), 32000.0f);
+}
+
+TEST(SampleRate, unsubscribe)
+{
+    SampleRateRegistry rates;
+    FakeModule         a, b;
+    rates.Init(48000.0f);
+    rates.Subscribe(a);
+    rates.Subscribe(b);
+    rates.Unsubscribe(&a);
+    EXPECT_EQ(rates.GetNumSubscribers(), 1u);
+
+    rates.SetSampleRate(96000.0f);
+    rates.UpdateAll();
+    EXPECT_EQ(a.rate, 48000.0f);
+    EXPECT_EQ(b.rate, 96000.0f);
+}
+
+TEST(SampleRate, oscillatorKeepsPhaseAndPitch)
+{
+    Oscillator osc;
+    osc.Init(48000.0f);
+    osc.SetFreq(1000.0f);
+    EXPECT_NEAR(CountCycles(osc, 48000), 1000, 1);
+
+    // no jump at the switch
+    for(int i = 0; i < 10; i++)
+        osc.Process();
+    const float before = osc.Process();
+    osc.SetSampleRate(96000.0f);
+    const float after = osc.Process();
+    EXPECT_NEAR(after, before, 0.1f);
+
+    EXPECT_NEAR(CountCycles(osc, 96000), 1000, 1);
+}
+
+TEST(SampleRate, adsrKeepsLevel)
+{
+    Adsr env, reference;
+    for(auto* e : {&env, &reference})
+    {
+        e->Init(48000.0f);
+        e->SetAttackTime(0.1f);
+        e->SetDecayTime(0.1f);
+        e->SetSustainLevel(0.5f);
+    }
+
+    float level = 0.0f;
+    for(int i = 0; i < 1200; i++)
+    {
+        level = env.Process(true);
+        reference.Process(true);
+    }
+    ASSERT_GT(level, 0.05f);
+    ASSERT_LT(level, 0.95f);
+
+    env.SetSampleRate(24000.0f);
+    const float next = env.Process(true);
+    EXPECT_GT(next, level);
+    EXPECT_NEAR(next, level, 0.05f);
+
+    // the rest of the attack takes half the samples at 24kHz
+    auto samples_to_peak = [](Adsr& e) {
+        size_t n = 0;
+        while(e.GetCurrentSegment() == ADSR_SEG_ATTACK && n < 48000)
+        {
+            e.Process(true);
+            n++;
+        }
+        return float(n);
+    };
+    const float expected = samples_to_peak(reference) * 0.5f;
+    EXPECT_NEAR(samples_to_peak(env), expected, expected * 0.1f);
+}
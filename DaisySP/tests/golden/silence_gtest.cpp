@@ -0,0 +1,228 @@
+#include "daisysp.h"
+#include "reverbsc.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+using namespace daisysp;
+
+namespace
+{
+constexpr float  kSampleRate = 48000.0f;
+constexpr size_t kBlockSize  = 48;
+
+/** A 440 Hz burst of length samples, then silence up to total */
+std::vector<float> Burst(size_t length, size_t total)
+{
+    std::vector<float> x(total, 0.0f);
+    for(size_t i = 0; i < length; i++)
+        x[i] = 0.5f * sinf(TWOPI_F * 440.0f * i / kSampleRate);
+    return x;
+}
+
+/** Largest difference between two renders */
+float MaxError(const std::vector<float>& a, const std::vector<float>& b)
+{
+    float worst = 0.0f;
+    for(size_t i = 0; i < a.size(); i++)
+        worst = fmaxf(worst, fabsf(a[i] - b[i]));
+    return worst;
+}
+
+/** Runs a mono effect per sample and per block over x. Checks that both
+    renders match to the silence threshold, that the effect falls asleep
+    in the silence after the burst, and wakes up when the input returns.
+*/
+template <typename T>
+void ExpectSleepsAndWakes(const std::vector<float>& x)
+{
+    T a, b;
+    a.Init(kSampleRate);
+    b.Init(kSampleRate);
+
+    std::vector<float> ref(x.size()), out(x.size());
+    for(size_t i = 0; i < x.size(); i++)
+        ref[i] = a.Process(x[i]);
+    size_t silent_blocks = 0;
+    for(size_t i = 0; i < x.size(); i += kBlockSize)
+        silent_blocks += b.ProcessBlock(&x[i], &out[i], kBlockSize);
+    EXPECT_LT(MaxError(ref, out), 2.0f * kSilenceThreshold);
+    EXPECT_GT(silent_blocks, 0u);
+
+    // awake for the next burst
+    const auto burst = Burst(kBlockSize, kBlockSize);
+    float      y[kBlockSize];
+    EXPECT_FALSE(b.ProcessBlock(burst.data(), y, kBlockSize));
+    EXPECT_FALSE(IsSilentBlock(y, kBlockSize));
+}
+} // namespace
+
+TEST(Silence, isSilentBlock)
+{
+    std::vector<float> x(kBlockSize, 0.0f);
+    EXPECT_TRUE(IsSilentBlock(x.data(), x.size()));
+    x[17] = -0.5f * kSilenceThreshold;
+    EXPECT_TRUE(IsSilentBlock(x.data(), x.size()));
+    x[17] = -2.0f * kSilenceThreshold;
+    EXPECT_FALSE(IsSilentBlock(x.data(), x.size()));
+    EXPECT_TRUE(IsSilentBlock(x.data(), x.size(), 1.0f));
+}
+
+TEST(Silence, trackerSleepsAfterTheTail)
+{
+    SilenceTracker tracker;
+    tracker.Init(100);
+    EXPECT_FALSE(tracker.IsAsleep());
+    tracker.Update(true, 96);
+    EXPECT_FALSE(tracker.IsAsleep());
+    tracker.Update(true, 48);
+    EXPECT_TRUE(tracker.IsAsleep());
+    tracker.Update(true, 48);
+    EXPECT_TRUE(tracker.IsAsleep());
+
+    tracker.Update(false, 48);
+    EXPECT_FALSE(tracker.IsAsleep());
+    tracker.Update(true, 144);
+    tracker.Wake();
+    EXPECT_FALSE(tracker.IsAsleep());
+}
+
+TEST(Silence, adsrBlockMatchesProcess)
+{
+    Adsr a, b;
+    a.Init(kSampleRate);
+    b.Init(kSampleRate);
+    for(Adsr* env : {&a, &b})
+    {
+        env->SetAttackTime(0.005f);
+        env->SetDecayTime(0.01f);
+        env->SetReleaseTime(0.01f);
+    }
+
+    float  block[kBlockSize];
+    size_t silent_blocks = 0;
+    for(size_t i = 0; i < 200; i++)
+    {
+        const bool gate   = i >= 10 && i < 30;
+        const bool silent = b.ProcessBlock(block, kBlockSize, gate);
+        silent_blocks += silent;
+        for(size_t n = 0; n < kBlockSize; n++)
+            ASSERT_EQ(block[n], a.Process(gate)) << i;
+        if(silent)
+        {
+            EXPECT_TRUE(IsSilentBlock(block, kBlockSize, 0.0f));
+        }
+    }
+    // idle before the note, and once the release is over
+    EXPECT_GT(silent_blocks, 120u);
+    EXPECT_FALSE(b.IsRunning());
+}
+
+TEST(Silence, oscillatorSkipsTheSilentVca)
+{
+    Oscillator a, b;
+    a.Init(kSampleRate);
+    b.Init(kSampleRate);
+    a.SetFreq(220.0f);
+    b.SetFreq(220.0f);
+
+    // a note, a silent block and another note
+    std::vector<float> vca(3 * kBlockSize, 1.0f);
+    for(size_t i = kBlockSize; i < 2 * kBlockSize; i++)
+        vca[i] = 0.0f;
+    std::vector<float> out(vca.size());
+    for(size_t i = 0; i < vca.size(); i += kBlockSize)
+    {
+        const bool silent = b.ProcessBlock(&out[i], &vca[i], kBlockSize);
+        EXPECT_EQ(silent, i == kBlockSize);
+    }
+    for(size_t i = 0; i < vca.size(); i++)
+        ASSERT_NEAR(out[i], a.Process() * vca[i], 1e-4f) << i;
+}
+
+TEST(Silence, flangerSleepsAndWakes)
+{
+    ExpectSleepsAndWakes<Flanger>(Burst(4800, 48000));
+}
+
+TEST(Silence, phaserSleepsAndWakes)
+{
+    ExpectSleepsAndWakes<Phaser>(Burst(4800, 48000));
+}
+
+TEST(Silence, chorusSleepsAndWakes)
+{
+    Chorus a, b;
+    a.Init(kSampleRate);
+    b.Init(kSampleRate);
+
+    const auto         x = Burst(4800, 48000);
+    std::vector<float> ref_l(x.size()), ref_r(x.size());
+    std::vector<float> left(x.size()), right(x.size());
+    for(size_t i = 0; i < x.size(); i++)
+    {
+        ref_l[i] = a.Process(x[i]);
+        ref_r[i] = a.GetRight();
+    }
+    size_t silent_blocks = 0;
+    for(size_t i = 0; i < x.size(); i += kBlockSize)
+        silent_blocks
+            += b.ProcessBlock(&x[i], &left[i], &right[i], kBlockSize);
+    EXPECT_LT(MaxError(ref_l, left), 2.0f * kSilenceThreshold);
+    EXPECT_LT(MaxError(ref_r, right), 2.0f * kSilenceThreshold);
+    EXPECT_GT(silent_blocks, 0u);
+
+    const auto burst = Burst(kBlockSize, kBlockSize);
+    float      l[kBlockSize], r[kBlockSize];
+    EXPECT_FALSE(b.ProcessBlock(burst.data(), l, r, kBlockSize));
+    EXPECT_FALSE(IsSilentBlock(r, kBlockSize));
+}
+
+TEST(Silence, reverbSleepsOnceTheTailHasDied)
+{
+    std::unique_ptr<ReverbSc> a(new ReverbSc), b(new ReverbSc);
+    for(ReverbSc* verb : {a.get(), b.get()})
+    {
+        verb->Init(kSampleRate);
+        verb->SetFeedback(0.7f);
+        verb->SetLpFreq(8000.0f);
+    }
+
+    FtzScope           ftz;
+    const auto         x = Burst(4800, 10 * 48000);
+    std::vector<float> ref(x.size()), out(x.size()), out2(x.size());
+    size_t             first_silent = 0;
+    for(size_t i = 0; i < x.size(); i++)
+    {
+        float r;
+        a->Process(x[i], x[i], &ref[i], &r);
+    }
+    for(size_t i = 0; i < x.size(); i += kBlockSize)
+    {
+        const bool silent = b->ProcessBlock(
+            &x[i], &x[i], &out[i], &out2[i], kBlockSize);
+        if(silent && first_silent == 0)
+            first_silent = i;
+        if(!silent)
+        {
+            EXPECT_EQ(first_silent, 0u) << "woke up at " << i;
+        }
+    }
+    EXPECT_GT(first_silent, 0u);
+    EXPECT_LT(MaxError(ref, out), 2.0f * kSilenceThreshold);
+
+    // and the tail of a new note comes back
+    const auto burst = Burst(kBlockSize, kBlockSize);
+    float      l[kBlockSize], r[kBlockSize];
+    EXPECT_FALSE(
+        b->ProcessBlock(burst.data(), burst.data(), l, r, kBlockSize));
+    std::vector<float> silence(kBlockSize * 200, 0.0f);
+    bool               tail = false;
+    for(size_t i = 0; i < silence.size(); i += kBlockSize)
+    {
+        b->ProcessBlock(&silence[i], &silence[i], l, r, kBlockSize);
+        tail = tail || !IsSilentBlock(l, kBlockSize);
+    }
+    EXPECT_TRUE(tail);
+}
@@ -0,0 +1,197 @@
+#include "daisysp.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <complex>
+#include <random>
+#include <vector>
+
+using namespace daisysp;
+
+namespace
+{
+/** Reference DFT of a real signal, in the packed RealFft format */
+std::vector<float> NaiveDft(const std::vector<float>& x)
+{
+    const size_t       n = x.size();
+    std::vector<float> out(n);
+    for(size_t k = 0; k <= n / 2; k++)
+    {
+        std::complex<double> sum = 0.0;
+        for(size_t i = 0; i < n; i++)
+            sum += static_cast<double>(x[i])
+                   * std::polar(1.0, -2.0 * M_PI * k * i / n);
+        if(k == 0)
+            out[0] = sum.real();
+        else if(k == n / 2)
+            out[1] = sum.real();
+        else
+        {
+            out[2 * k]     = sum.real();
+            out[2 * k + 1] = sum.imag();
+        }
+    }
+    return out;
+}
+
+std::vector<float> Noise(size_t size, unsigned seed)
+{
+    std::mt19937                          rng(seed);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float>                    x(size);
+    for(auto& s : x)
+        s = dist(rng);
+    return x;
+}
+
+struct CountingOperator
+{
+    static void Callback(float*, size_t, void* context)
+    {
+        static_cast<CountingOperator*>(context)->calls++;
+    }
+    int calls = 0;
+};
+} // namespace
+
+TEST(RealFft, matchesNaiveDft)
+{
+    for(size_t n = RealFft::kMinSize; n <= 1024; n *= 2)
+    {
+        RealFft fft;
+        ASSERT_TRUE(fft.Init(n));
+        std::vector<float> x   = Noise(n, n);
+        std::vector<float> ref = NaiveDft(x);
+        std::vector<float> out(n);
+        fft.Forward(x.data(), out.data());
+        for(size_t i = 0; i < n; i++)
+            EXPECT_NEAR(out[i], ref[i], 1e-3f * std::sqrt(float(n)))
+                << "size " << n << ", index " << i;
+    }
+}
+
+TEST(RealFft, inverseRestoresInput)
+{
+    for(size_t n = RealFft::kMinSize; n <= RealFft::kMaxSize; n *= 2)
+    {
+        RealFft fft;
+        ASSERT_TRUE(fft.Init(n));
+        std::vector<float> x = Noise(n, 7);
+        std::vector<float> tmp(x), spectrum(n), out(n);
+        fft.Forward(tmp.data(), spectrum.data());
+        fft.Inverse(spectrum.data(), out.data());
+        for(size_t i = 0; i < n; i++)
+            ASSERT_NEAR(out[i], x[i], 1e-4f) << "size " << n;
+    }
+}
+
+TEST(RealFft, rejectsUnsupportedSizes)
+{
+    RealFft fft;
+    EXPECT_FALSE(fft.Init(16));
+    EXPECT_FALSE(fft.Init(1000));
+    EXPECT_FALSE(fft.Init(8192));
+}
+
+TEST(Stft, passesSignalThroughWithLatency)
+{
+    const size_t       fft_size = 256;
+    const size_t       block    = 48;
+    std::vector<float> x        = Noise(block * 170, 3);
+
+    for(auto window : {Stft::Window::HANN, Stft::Window::SQRT_HANN})
+    {
+        for(size_t hop : {fft_size / 2, fft_size / 4})
+        {
+            std::vector<float> mem(Stft::GetBufferSize(fft_size, hop));
+            Stft               stft;
+            ASSERT_TRUE(stft.Init(mem.data(), fft_size, hop, window));
+
+            std::vector<float> y(x.size());
+            for(size_t i = 0; i < x.size(); i += block)
+                stft.Process(&x[i], &y[i], block);
+
+            // the first frames are only partially overlapped
+            const size_t latency = stft.GetLatency();
+            for(size_t i = latency + fft_size; i < x.size(); i++)
+                ASSERT_NEAR(y[i], x[i - latency], 1e-4f)
+                    << "hop " << hop << ", sample " << i;
+        }
+    }
+}
+
+TEST(Stft, callsOperatorOncePerHop)
+{
+    const size_t       fft_size = 512, hop = 128;
+    std::vector<float> mem(Stft::GetBufferSize(fft_size, hop));
+    Stft               stft;
+    CountingOperator   op;
+    ASSERT_TRUE(stft.Init(mem.data(), fft_size, hop, Stft::Window::HANN));
+    stft.SetOperator(CountingOperator::Callback, &op);
+
+    // blocks that don't line up with the hop
+    std::vector<float> buf(30, 0.0f);
+    for(size_t i = 0; i < 1280 / 10; i++)
+        stft.Process(buf.data(), buf.data(), 30);
+    // 3840 samples are 30 frames, the last one may still be in progress
+    EXPECT_GE(op.calls, 29);
+    EXPECT_LE(op.calls, 30);
+}
+
+TEST(Stft, rejectsUnsupportedHops)
+{
+    std::vector<float> mem(Stft::GetBufferSize(256, 256));
+    Stft               stft;
+    EXPECT_FALSE(stft.Init(mem.data(), 256, 256, Stft::Window::HANN));
+    EXPECT_FALSE(stft.Init(mem.data(), 256, 96, Stft::Window::HANN));
+    EXPECT_TRUE(stft.Init(mem.data(), 256, 64, Stft::Window::HANN));
+}
+
+TEST(SpectralFreeze, sustainsSoundAfterInputStops)
+{
+    const size_t       fft_size = 1024, hop = 256, block = 64;
+    std::vector<float> stft_mem(Stft::GetBufferSize(fft_size, hop));
+    std::vector<float> freeze_mem(SpectralFreeze::GetBufferSize(fft_size));
+    Stft               stft;
+    SpectralFreeze     freeze;
+    ASSERT_TRUE(stft.Init(
+        stft_mem.data(), fft_size, hop, Stft::Window::SQRT_HANN));
+    freeze.Init(freeze_mem.data(), fft_size, hop);
+    stft.SetOperator(SpectralFreeze::Operator, &freeze);
+
+    auto rms = [](const std::vector<float>& buf) {
+        double sum = 0.0;
+        for(float s : buf)
+            sum += s * s;
+        return std::sqrt(sum / buf.size());
+    };
+
+    // a sine centered on a bin, so that its phase advance is exact
+    std::vector<float> buf(block);
+    size_t             t = 0;
+    for(int b = 0; b < 200; b++)
+    {
+        for(auto& s : buf)
+            s = 0.5f * sinf(TWOPI_F * 32.0f * t++ / fft_size);
+        stft.Process(buf.data(), buf.data(), block);
+    }
+    const float rms_in = rms(buf);
+    EXPECT_GT(rms_in, 0.3f);
+
+    freeze.SetFreeze(true);
+    EXPECT_TRUE(freeze.IsFrozen());
+    for(int b = 0; b < 400; b++)
+    {
+        std::fill(buf.begin(), buf.end(), 0.0f);
+        stft.Process(buf.data(), buf.data(), block);
+    }
+    EXPECT_NEAR(rms(buf), rms_in, 0.1f * rms_in);
+
+    // released, the silent input comes through again
+    freeze.SetFreeze(false);
+    for(int b = 0; b < 100; b++)
+    {
+        std::fill(buf.begin(), buf.end(), 0.0f);
+        stft.Process(buf.data(), buf.data(), block);
+    }
+    EXPECT_LT(rms(buf), 1e-4f);
+}
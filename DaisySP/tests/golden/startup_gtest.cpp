@@ -0,0 +1,88 @@
+#include "daisysp.h"
+#include "reverbsc.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstring>
+#include <new>
+
+using namespace daisysp;
+
+namespace
+{
+/** Constructs T in memory filled with NaNs, like uninitialized SDRAM */
+template <typename T>
+T* ConstructInDirtyMemory(void* mem)
+{
+    float* f = static_cast<float*>(mem);
+    for(size_t i = 0; i < sizeof(T) / sizeof(float); i++)
+        f[i] = NAN;
+    return new(mem) T;
+}
+
+alignas(DelayLine<float, 64>) unsigned char delay_mem[sizeof(DelayLine<float, 64>)];
+alignas(ReverbSc) unsigned char reverb_mem[sizeof(ReverbSc)];
+float looper_buffer[1000];
+} // namespace
+
+TEST(Startup, delayLineReadsZeroUntilWritten)
+{
+    auto& del = *ConstructInDirtyMemory<DelayLine<float, 64>>(delay_mem);
+    del.Init();
+    del.SetDelay(10.5f);
+    for(int i = 0; i < 200; i++)
+    {
+        const float expected = i < 10 ? 0.0f : (i == 10 ? 0.5f : 1.0f);
+        EXPECT_EQ(del.Read(), expected) << "sample " << i;
+        EXPECT_FALSE(std::isnan(del.ReadHermite(30.5f))) << "sample " << i;
+        del.Write(1.0f);
+    }
+
+    // a reset makes the whole line read as zero again
+    del.Reset();
+    EXPECT_EQ(del.Read(63.0f), 0.0f);
+    del.Write(2.0f);
+    EXPECT_EQ(del.Read(1.0f), 2.0f);
+    EXPECT_EQ(del.Read(2.0f), 0.0f);
+    EXPECT_EQ(del.Allpass(0.0f, 2, 0.5f), 0.0f);
+}
+
+TEST(Startup, looperPlaysOnlyRecordedSamples)
+{
+    for(auto& s : looper_buffer)
+        s = NAN;
+    Looper looper;
+    looper.Init(looper_buffer, 1000);
+    looper.TrigRecord();
+    for(int i = 0; i < 500; i++)
+        looper.Process(0.5f);
+    looper.TrigRecord();
+    for(int i = 0; i < 2000; i++)
+        EXPECT_FALSE(std::isnan(looper.Process(0.0f))) << "sample " << i;
+}
+
+TEST(Startup, reverbClearsInTheBackground)
+{
+    auto& reverb = *ConstructInDirtyMemory<ReverbSc>(reverb_mem);
+    reverb.Init(48000.0f);
+
+    float  left, right;
+    size_t num_calls = 0;
+    while(!reverb.IsReady())
+    {
+        reverb.Process(1.0f, 1.0f, &left, &right);
+        EXPECT_EQ(left, 0.0f);
+        EXPECT_EQ(right, 0.0f);
+        ASSERT_LT(++num_calls, 1000u);
+    }
+    // about 8 ms at 48kHz
+    EXPECT_GT(num_calls, 300u);
+
+    float energy = 0.0f;
+    for(int i = 0; i < 48000; i++)
+    {
+        reverb.Process(i == 0 ? 1.0f : 0.0f, 0.0f, &left, &right);
+        ASSERT_FALSE(std::isnan(left) || std::isnan(right));
+        energy += left * left + right * right;
+    }
+    EXPECT_GT(energy, 0.0f);
+}
@@ -0,0 +1,217 @@
+#include "daisysp.h"
+#include "golden.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+using namespace daisysp;
+using namespace daisysp::golden;
+
+namespace
+{
+constexpr float  kSampleRate = 48000.0f;
+constexpr size_t kBlockSize  = 48;
+constexpr size_t kLength     = 9600;
+
+typedef ResonatorSvf<4> Bank;
+
+const float kFreq[4] = {0.002f, 0.01f, 0.05f, 0.2f};
+const float kQ[4]    = {0.7f, 2.0f, 8.0f, 30.0f};
+const float kGain[4] = {1.0f, 0.5f, 0.25f, 0.125f};
+
+std::vector<float> NoiseInput(size_t length)
+{
+    WhiteNoise noise;
+    noise.Init();
+    noise.SetAmp(0.5f);
+    std::vector<float> x(length);
+    for(auto& s : x)
+        s = noise.Process();
+    return x;
+}
+
+/** Level of the frequency `freq` in x, by correlation with a sine/cosine */
+float Level(const std::vector<float>& x, float freq)
+{
+    double re = 0.0, im = 0.0;
+    for(size_t i = 0; i < x.size(); i++)
+    {
+        re += x[i] * cos(TWOPI_F * freq * i / kSampleRate);
+        im += x[i] * sin(TWOPI_F * freq * i / kSampleRate);
+    }
+    return 2.0f * sqrt(re * re + im * im) / x.size();
+}
+
+struct Carrier
+{
+    Carrier()
+    {
+        osc.Init(kSampleRate);
+        osc.SetWaveform(Oscillator::WAVE_POLYBLEP_SAW);
+        osc.SetFreq(110.0f);
+        osc.SetAmp(0.5f);
+    }
+    Oscillator osc;
+};
+
+/** Gain the vocoder applies to the carrier at `freq` */
+float Transfer(const std::vector<float>& out, float freq)
+{
+    Carrier            carrier;
+    std::vector<float> x(out.size());
+    for(auto& s : x)
+        s = carrier.osc.Process();
+    return Level(out, freq) / Level(x, freq);
+}
+
+/** Vocodes a sine modulator at `freq` with a 110 Hz saw */
+std::vector<float> Vocode(Vocoder& vocoder, float freq)
+{
+    Carrier            carrier;
+    std::vector<float> mod(kLength), out(kLength);
+    for(size_t i = 0; i < kLength; i++)
+        mod[i] = 0.5f * sinf(TWOPI_F * freq * i / kSampleRate);
+    for(size_t i = 0; i < kLength; i += kBlockSize)
+        vocoder.Process(&mod[i], carrier.osc, &out[i], kBlockSize);
+    return std::vector<float>(out.begin() + kLength / 2, out.end());
+}
+} // namespace
+
+TEST(ResonatorSvf, blockMatchesPerSample)
+{
+    const std::vector<float> x = NoiseInput(kLength);
+
+    Bank reference;
+    reference.Init();
+    std::vector<float> expected(kLength);
+    for(size_t i = 0; i < kLength; i++)
+        reference.Process<Bank::BAND_PASS, false>(
+            kFreq, kQ, kGain, x[i], &expected[i]);
+
+    Bank block;
+    block.Init();
+    std::vector<float> out(kLength);
+    for(size_t i = 0; i < kLength; i += kBlockSize)
+        block.ProcessBlock<Bank::BAND_PASS, false>(
+            kFreq, kQ, kGain, kGain, &x[i], &out[i], kBlockSize);
+
+    ExpectRendersMatch(expected, out);
+}
+
+TEST(ResonatorSvf, analyzeSumsSquaredLanes)
+{
+    const std::vector<float> x = NoiseInput(kLength);
+
+    // one lane at a time through the per sample reference
+    float expected[4] = {};
+    for(int lane = 0; lane < 4; lane++)
+    {
+        float gain[4] = {};
+        gain[lane]    = 1.0f;
+        Bank reference;
+        reference.Init();
+        for(size_t i = 0; i < kLength; i++)
+        {
+            float y;
+            reference.Process<Bank::BAND_PASS, false>(
+                kFreq, kQ, gain, x[i], &y);
+            expected[lane] += y * y;
+        }
+    }
+
+    Bank bank;
+    bank.Init();
+    float energy[4] = {};
+    for(size_t i = 0; i < kLength; i += kBlockSize)
+        bank.Analyze<Bank::BAND_PASS>(kFreq, kQ, &x[i], energy, kBlockSize);
+    for(int lane = 0; lane < 4; lane++)
+        EXPECT_NEAR(energy[lane], expected[lane], 1e-3f * expected[lane]);
+}
+
+TEST(Vocoder, followsModulatorSpectrum)
+{
+    Vocoder vocoder;
+    vocoder.Init(kSampleRate, 16);
+
+    // the modulator picks the carrier harmonics around its own frequency
+    for(float freq : {330.0f, 1320.0f})
+    {
+        vocoder.Init(kSampleRate, 16);
+        std::vector<float> out = Vocode(vocoder, freq);
+        const float        other = freq < 1000.0f ? 1320.0f : 330.0f;
+        EXPECT_GT(Transfer(out, freq), 10.0f * Transfer(out, other)) << freq;
+
+        // the loudest band is the one closest to the modulator
+        size_t loudest = 0;
+        for(size_t b = 1; b < vocoder.GetNumBands(); b++)
+            if(vocoder.GetBandLevel(b) > vocoder.GetBandLevel(loudest))
+                loudest = b;
+        const float center = 100.0f * powf(80.0f, loudest / 15.0f);
+        EXPECT_LT(fabsf(log2f(center / freq)), 0.25f) << freq;
+    }
+}
+
+TEST(Vocoder, formantShiftMovesBands)
+{
+    Vocoder vocoder;
+    vocoder.Init(kSampleRate, 32);
+    vocoder.SetFormantShift(2.0f);
+    std::vector<float> out = Vocode(vocoder, 660.0f);
+    EXPECT_GT(Transfer(out, 1320.0f), 5.0f * Transfer(out, 660.0f));
+}
+
+TEST(Vocoder, silentModulatorIsSilent)
+{
+    Vocoder vocoder;
+    vocoder.Init(kSampleRate, 16);
+    Carrier            carrier;
+    std::vector<float> mod(kLength, 0.0f), out(kLength);
+    for(size_t i = 0; i < kLength; i += kBlockSize)
+        vocoder.Process(&mod[i], carrier.osc, &out[i], kBlockSize);
+    for(float s : out)
+        ASSERT_EQ(s, 0.0f);
+}
+
+TEST(Vocoder, oscillatorCarrierMatchesBuffer)
+{
+    const std::vector<float> mod = NoiseInput(kLength);
+    Vocoder                  a, b;
+    a.Init(kSampleRate, 24);
+    b.Init(kSampleRate, 24);
+    Carrier            osc_a, osc_b;
+    std::vector<float> out_a(kLength), out_b(kLength), carrier(kLength);
+    for(auto& s : carrier)
+        s = osc_b.osc.Process();
+
+    // blocks larger than kMaxBlockSize are split
+    const size_t block = 96, first = Vocoder::kMaxBlockSize;
+    for(size_t i = 0; i < kLength; i += block)
+    {
+        a.Process(&mod[i], osc_a.osc, &out_a[i], block);
+        b.Process(&mod[i], &carrier[i], &out_b[i], first);
+        b.Process(&mod[i + first],
+                  &carrier[i + first],
+                  &out_b[i + first],
+                  block - first);
+    }
+    ExpectRendersMatch(out_b, out_a);
+}
+
+TEST(golden_Effects, vocoder)
+{
+    Vocoder vocoder;
+    vocoder.Init(kSampleRate, 16);
+    vocoder.SetFreqRange(150.0f, 6000.0f);
+    vocoder.SetRelease(0.02f);
+    Carrier            carrier;
+    std::vector<float> mod = NoiseInput(kLength);
+    // a noise burst every 50 ms as the modulator
+    for(size_t i = 0; i < kLength; i++)
+        mod[i] *= (i % 2400) < 800 ? 1.0f : 0.0f;
+
+    FtzScope           ftz;
+    std::vector<float> out(kLength);
+    for(size_t i = 0; i < kLength; i += kBlockSize)
+        vocoder.Process(&mod[i], carrier.osc, &out[i], kBlockSize);
+    ExpectMatchesGolden("vocoder", out);
+}
@@ -0,0 +1,262 @@
+#include "daisysp.h"
+#include "allpass.h"
+#include "atone.h"
+#include "comb.h"
+#include "moogladder.h"
+#include "reverbsc.h"
+#include "tone.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+/** Measures the processing cost of recursive modules during a silence tail.
+ *
+ *  Every module is excited with noise, then fed silence. The cost per sample
+ *  is reported for the excitation and for each second of the tail, once in
+ *  the default FPU mode and once inside a FtzScope. With the denormal guards
+ *  in place, both should stay flat. The "unguarded" row is a plain one pole
+ *  filter without a guard, to show the slowdown on the machine running the
+ *  benchmark.
+ *
+ *  Usage: daisysp_denormal_bench [--seconds N]
+ */
+
+using namespace daisysp;
+
+namespace
+{
+typedef std::chrono::steady_clock Clock;
+typedef std::function<float(float)> ProcessFn;
+
+constexpr float  kSampleRate   = 48000.0f;
+constexpr size_t kBlockSize    = 48;
+constexpr size_t kExciteBlocks = 100;
+
+volatile float sink;
+
+/** A one pole lowpass without any denormal guard, as a reference */
+class UnguardedOnePole
+{
+  public:
+    float Process(float in)
+    {
+        state_ = 0.9995f * state_ + 0.0005f * in;
+        return state_;
+    }
+
+  private:
+    float state_ = 0.0f;
+};
+
+struct Result
+{
+    double              excite_ns;
+    std::vector<double> tail_ns;
+};
+
+/** Returns the average ns per sample over `num_blocks` blocks */
+double RunBlocks(ProcessFn& process, size_t num_blocks, WhiteNoise* noise)
+{
+    const auto start = Clock::now();
+    for(size_t b = 0; b < num_blocks; b++)
+        for(size_t i = 0; i < kBlockSize; i++)
+            sink = process(noise ? noise->Process() : 0.0f);
+    const auto end = Clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count()
+           / (num_blocks * kBlockSize);
+}
+
+Result Measure(ProcessFn process, size_t tail_seconds)
+{
+    const size_t blocks_per_second = size_t(kSampleRate) / kBlockSize;
+    WhiteNoise   noise;
+    noise.Init();
+
+    Result result;
+    result.excite_ns = RunBlocks(process, kExciteBlocks, &noise);
+    for(size_t s = 0; s < tail_seconds; s++)
+        result.tail_ns.push_back(
+            RunBlocks(process, blocks_per_second, nullptr));
+    return result;
+}
+
+void Print(const char* name, const char* mode, const Result& result)
+{
+    double worst = 0.0;
+    printf("%-16s %-8s %8.1f |", name, mode, result.excite_ns);
+    for(auto ns : result.tail_ns)
+    {
+        printf(" %7.1f", ns);
+        worst = ns > worst ? ns : worst;
+    }
+    printf(" | x%.1f\n", worst / result.excite_ns);
+}
+
+/** Runs a module twice, in the default FPU mode and with flush-to-zero.
+ *  `make` creates a freshly initialized module and returns its process
+ *  function.
+ */
+void Bench(const char*                name,
+           std::function<ProcessFn()> make,
+           size_t                     tail_seconds)
+{
+    Print(name, "default", Measure(make(), tail_seconds));
+    FtzScope ftz;
+    Print(name, "ftz", Measure(make(), tail_seconds));
+}
+
+Svf              svf;
+OnePole          one_pole;
+DcBlock          dc_block;
+Chorus           chorus;
+Flanger          flanger;
+Phaser           phaser;
+Tone             tone;
+ATone            atone;
+MoogLadder       moog;
+ReverbSc         reverb;
+Comb             comb;
+Allpass          allpass;
+UnguardedOnePole unguarded;
+float            comb_buffer[4800];
+float            allpass_buffer[4800];
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t tail_seconds = 5;
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "--seconds") && i + 1 < argc)
+            tail_seconds = strtoul(argv[++i], nullptr, 10);
+        else
+        {
+            printf("usage: daisysp_denormal_bench [--seconds N]\n");
+            return 2;
+        }
+    }
+
+    printf("ns per sample: excitation | each second of silence | worst "
+           "tail / excitation\n");
+
+    Bench(
+        "Unguarded",
+        [] {
+            unguarded = UnguardedOnePole();
+            return ProcessFn([](float in) { return unguarded.Process(in); });
+        },
+        tail_seconds);
+    Bench(
+        "Svf",
+        [] {
+            svf.Init(kSampleRate);
+            svf.SetFreq(200.0f);
+            svf.SetRes(0.9f);
+            return ProcessFn([](float in) {
+                svf.Process(in);
+                return svf.Low();
+            });
+        },
+        tail_seconds);
+    Bench(
+        "OnePole",
+        [] {
+            one_pole.Init();
+            one_pole.SetFrequency(0.0001f);
+            return ProcessFn([](float in) { return one_pole.Process(in); });
+        },
+        tail_seconds);
+    Bench(
+        "DcBlock",
+        [] {
+            dc_block.Init(kSampleRate);
+            return ProcessFn([](float in) { return dc_block.Process(in); });
+        },
+        tail_seconds);
+    Bench(
+        "Chorus",
+        [] {
+            chorus.Init(kSampleRate);
+            chorus.SetFeedback(0.9f);
+            return ProcessFn([](float in) { return chorus.Process(in); });
+        },
+        tail_seconds);
+    Bench(
+        "Flanger",
+        [] {
+            flanger.Init(kSampleRate);
+            flanger.SetFeedback(0.9f);
+            return ProcessFn([](float in) { return flanger.Process(in); });
+        },
+        tail_seconds);
+    Bench(
+        "Phaser",
+        [] {
+            phaser.Init(kSampleRate);
+            phaser.SetFeedback(0.9f);
+            return ProcessFn([](float in) { return phaser.Process(in); });
+        },
+        tail_seconds);
+    Bench(
+        "Tone",
+        [] {
+            tone.Init(kSampleRate);
+            tone.SetFreq(100.0f);
+            return ProcessFn([](float in) { return tone.Process(in); });
+        },
+        tail_seconds);
+    Bench(
+        "ATone",
+        [] {
+            float freq = 100.0f;
+            atone.Init(kSampleRate);
+            atone.SetFreq(freq);
+            return ProcessFn([](float in) { return atone.Process(in); });
+        },
+        tail_seconds);
+    Bench(
+        "MoogLadder",
+        [] {
+            moog.Init(kSampleRate);
+            moog.SetFreq(500.0f);
+            moog.SetRes(0.7f);
+            return ProcessFn([](float in) { return moog.Process(in); });
+        },
+        tail_seconds);
+    Bench(
+        "ReverbSc",
+        [] {
+            reverb.Init(kSampleRate);
+            reverb.SetFeedback(0.9f);
+            reverb.SetLpFreq(10000.0f);
+            return ProcessFn([](float in) {
+                float left, right;
+                reverb.Process(in, in, &left, &right);
+                return left + right;
+            });
+        },
+        tail_seconds);
+    Bench(
+        "Comb",
+        [] {
+            comb.Init(kSampleRate, comb_buffer, 4800);
+            comb.SetPeriod(0.01f);
+            comb.SetRevTime(3.0f);
+            return ProcessFn([](float in) { return comb.Process(in); });
+        },
+        tail_seconds);
+    Bench(
+        "Allpass",
+        [] {
+            allpass.Init(kSampleRate, allpass_buffer, 4800);
+            allpass.SetFreq(0.01f);
+            allpass.SetRevTime(3.0f);
+            return ProcessFn([](float in) { return allpass.Process(in); });
+        },
+        tail_seconds);
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include "daisysp.h"
+#include "multibandcompressor.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/** Measures the cost of the MultibandCompressor per audio block.
+ *
+ *  Ten seconds of stereo noise and tones are compressed with 48 sample
+ *  blocks, for 2 to 4 bands and for gain intervals of 1 (a gain per
+ *  sample, like Compressor::Process()) and 16 samples. The load is relative
+ *  to the 1 ms period of a block at 48 kHz.
+ *
+ *  Absolute numbers are from the host, the ratios are what matters.
+ *
+ *  Usage: daisysp_multiband_bench [--seconds N]
+ */
+
+using namespace daisysp;
+
+namespace
+{
+typedef std::chrono::steady_clock Clock;
+
+constexpr float  kSampleRate = 48000.0f;
+constexpr size_t kBlockSize  = 48;
+constexpr size_t kPasses     = 3;
+
+volatile float sink;
+
+void Run(const std::vector<float>& left,
+         const std::vector<float>& right,
+         size_t                    num_bands,
+         size_t                    interval)
+{
+    const size_t        num_blocks = left.size() / kBlockSize;
+    std::vector<double> block_us(num_blocks, 1e30);
+    float               out[2][kBlockSize];
+    MultibandCompressor mbc;
+
+    // the work per block is the same in every pass, so the fastest of
+    // the passes removes most of the noise of the host scheduler
+    for(size_t pass = 0; pass < kPasses; pass++)
+    {
+        mbc.Init(kSampleRate, num_bands, 2);
+        mbc.SetGainInterval(interval);
+        for(size_t b = 0; b < num_bands; b++)
+        {
+            mbc.SetThreshold(b, -24.0f);
+            mbc.SetRatio(b, 4.0f);
+        }
+        for(size_t b = 0; b < num_blocks; b++)
+        {
+            memcpy(out[0], &left[b * kBlockSize], sizeof(out[0]));
+            memcpy(out[1], &right[b * kBlockSize], sizeof(out[1]));
+            float*     ch[2] = {out[0], out[1]};
+            const auto start = Clock::now();
+            mbc.ProcessBlock(ch, ch, kBlockSize);
+            const auto   end = Clock::now();
+            const double us
+                = std::chrono::duration<double, std::micro>(end - start)
+                      .count();
+            block_us[b] = std::min(block_us[b], us);
+            sink        = out[0][0];
+        }
+    }
+
+    double total = 0.0, worst = 0.0;
+    for(size_t b = 0; b < num_blocks; b++)
+    {
+        total += block_us[b];
+        worst = std::max(worst, block_us[b]);
+    }
+
+    const double period_us = 1e6 * kBlockSize / kSampleRate;
+    const double average   = total / num_blocks;
+    printf("%8zu %8zu %10.2f %10.2f %9.2f%% %9.2f%%\n",
+           num_bands,
+           interval,
+           average,
+           worst,
+           100.0 * average / period_us,
+           100.0 * worst / period_us);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t seconds = 10;
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "--seconds") && i + 1 < argc)
+            seconds = strtoul(argv[++i], nullptr, 10);
+        else
+        {
+            printf("usage: daisysp_multiband_bench [--seconds N]\n");
+            return 2;
+        }
+    }
+    seconds = seconds > 0 ? seconds : 1;
+
+    // noise bursts over a bass line, different in each channel
+    const size_t       length = seconds * size_t(kSampleRate);
+    std::vector<float> left(length), right(length);
+    uint32_t           seed = 1;
+    for(size_t i = 0; i < length; i++)
+    {
+        seed             = seed * 1664525u + 1013904223u;
+        const float n    = static_cast<float>(seed >> 8) / 8388608.0f - 1.0f;
+        const float gate = (i / 12000) % 2 ? 0.3f : 0.02f;
+        const float bass = 0.5f * sinf(TWOPI_F * 55.0f * i / kSampleRate);
+        left[i]          = bass + gate * n;
+        right[i]         = 0.5f * bass - gate * n;
+    }
+
+    printf("%8s %8s %10s %10s %10s %10s\n",
+           "bands",
+           "interval",
+           "avg us",
+           "worst us",
+           "avg",
+           "worst");
+    for(size_t num_bands : {2, 3, 4})
+        for(size_t interval : {1, 16})
+            Run(left, right, num_bands, interval);
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include "daisysp.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/** Measures the cost of the PhaseVocoder per audio block.
+ *
+ *  A ten second chord is stretched and transposed with 48 sample blocks at
+ *  FFT sizes 1024 and 2048. For each size, the average and worst block are
+ *  reported, along with the work of a whole frame, which is what the worst
+ *  block would cost if a frame were processed at once instead of being
+ *  spread over the blocks of a hop. The load is relative to the 1 ms
+ *  period of a block at 48 kHz.
+ *
+ *  Absolute numbers are from the host, the ratios are what matters.
+ *
+ *  Usage: daisysp_phasevocoder_bench [--seconds N]
+ */
+
+using namespace daisysp;
+
+namespace
+{
+typedef std::chrono::steady_clock Clock;
+
+constexpr float  kSampleRate = 48000.0f;
+constexpr size_t kBlockSize  = 48;
+constexpr size_t kPasses     = 3;
+
+volatile float sink;
+
+void Run(const std::vector<float>& sample, size_t fft_size, size_t seconds)
+{
+    std::vector<float> mem(PhaseVocoder::GetBufferSize(fft_size));
+    PhaseVocoder       pv;
+    const size_t num_blocks = seconds * size_t(kSampleRate) / kBlockSize;
+    std::vector<double> block_us(num_blocks, 1e30);
+    float               out[kBlockSize];
+
+    // the work per block is the same in every pass, so the fastest of
+    // the passes removes most of the noise of the host scheduler
+    for(size_t pass = 0; pass < kPasses; pass++)
+    {
+        pv.Init(sample.data(), sample.size(), mem.data(), fft_size);
+        pv.SetSpeed(0.75f);
+        pv.SetTransposition(700.0f);
+        for(size_t b = 0; b < num_blocks; b++)
+        {
+            const auto start = Clock::now();
+            pv.Process(out, kBlockSize);
+            const auto   end = Clock::now();
+            const double us
+                = std::chrono::duration<double, std::micro>(end - start)
+                      .count();
+            block_us[b] = std::min(block_us[b], us);
+            sink        = out[0];
+        }
+    }
+
+    const size_t blocks_per_hop = pv.GetHop() / kBlockSize;
+    double       total = 0.0, worst = 0.0, hop_sum = 0.0, frame = 0.0;
+    for(size_t b = 0; b < num_blocks; b++)
+    {
+        total += block_us[b];
+        worst = std::max(worst, block_us[b]);
+        hop_sum += block_us[b];
+        if((b + 1) % blocks_per_hop == 0)
+        {
+            frame   = std::max(frame, hop_sum);
+            hop_sum = 0.0;
+        }
+    }
+
+    const double period_us = 1e6 * kBlockSize / kSampleRate;
+    const double average   = total / num_blocks;
+    printf("%8zu %8zu %10.2f %10.2f %10.2f %9.1f%% %9.1f%%\n",
+           fft_size,
+           pv.GetHop(),
+           average,
+           worst,
+           frame,
+           100.0 * worst / period_us,
+           100.0 * frame / period_us);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t seconds = 10;
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "--seconds") && i + 1 < argc)
+            seconds = strtoul(argv[++i], nullptr, 10);
+        else
+        {
+            printf("usage: daisysp_phasevocoder_bench [--seconds N]\n");
+            return 2;
+        }
+    }
+    seconds = seconds > 0 ? seconds : 1;
+
+    // a two second chord with a bit of noise, looped
+    std::vector<float> sample(2 * size_t(kSampleRate));
+    uint32_t           seed = 1;
+    for(size_t i = 0; i < sample.size(); i++)
+    {
+        seed      = seed * 1664525u + 1013904223u;
+        float sum = 0.01f * (static_cast<float>(seed >> 8) / 8388608.0f - 1.0f);
+        for(float freq : {220.0f, 277.2f, 329.6f, 440.0f})
+            sum += 0.2f * sinf(TWOPI_F * freq * i / kSampleRate);
+        sample[i] = sum;
+    }
+
+    printf("%8s %8s %10s %10s %10s %10s %10s\n",
+           "fft",
+           "hop",
+           "avg us",
+           "worst us",
+           "frame us",
+           "worst",
+           "frame");
+    for(size_t fft_size : {1024, 2048})
+        Run(sample, fft_size, seconds);
+    return 0;
+}
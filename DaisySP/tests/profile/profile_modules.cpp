@@ -0,0 +1,808 @@
+#include "daisysp.h"
+#include "wcet.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/** Runs every DaisySP module under the adversarial schedules from wcet.h and
+ *  prints the per call latency distributions.
+ *
+ *  Usage: daisysp_wcet_profile [options]
+ *    --blocks N         blocks per schedule (default 1000)
+ *    --block-size N     samples per block (default 48)
+ *    --budget F         setter budget as a fraction of one block (default 0.25)
+ *    --budget-ns NS     absolute setter budget in ns
+ *    --filter NAME      only profile modules whose name contains NAME
+ *    --csv FILE         also write the results to FILE
+ *    --strict           exit with an error if a setter is over budget
+ */
+
+using namespace daisysp;
+using namespace daisysp::profile;
+
+namespace
+{
+constexpr float kFreqMin = 1.0f;
+constexpr float kFreqMax = 20000.0f;
+
+const Range kUnit{0.0f, 1.0f};
+const Range kBipolar{-1.0f, 1.0f};
+const Range kAudioFreq{kFreqMin, kFreqMax, true};
+const Range kLfoFreq{0.01f, 20.0f, true};
+const Range kTime{0.0001f, 10.0f, true};
+
+/** Large modules and buffers are kept out of the stack */
+PitchShifter            pitch_shifter;
+DelayLine<float, 48000> delay_line;
+float                   looper_buffer[48000];
+float                   granular_buffer[48000];
+
+class Runner
+{
+  public:
+    Runner(const Config& config, const std::string& filter)
+    : config_(config), filter_(filter)
+    {
+    }
+
+    /** Profiles one module if it matches the filter. `setup` registers the
+     *  setters and the process function on the ModuleProfile.
+     */
+    template <typename SetupFn>
+    void Profile(const std::string& name, SetupFn setup)
+    {
+        if(!filter_.empty() && name.find(filter_) == std::string::npos)
+            return;
+        ModuleProfile profile(name, config_);
+        setup(profile);
+        const auto stats = profile.Run();
+        results_.insert(results_.end(), stats.begin(), stats.end());
+    }
+
+    const std::vector<Stats>& GetResults() const { return results_; }
+
+  private:
+    Config             config_;
+    std::string        filter_;
+    std::vector<Stats> results_;
+};
+
+void ProfileControl(Runner& run, float sr)
+{
+    run.Profile("Adsr", [sr](ModuleProfile& p) {
+        static Adsr env;
+        static bool gate;
+        env.Init(sr);
+        gate = false;
+        p.AddSetter("SetAttackTime", kTime, [](float v) {
+            env.SetAttackTime(v);
+        });
+        p.AddSetter("SetDecayTime", kTime, [](float v) { env.SetDecayTime(v); });
+        p.AddSetter("SetReleaseTime", kTime, [](float v) {
+            env.SetReleaseTime(v);
+        });
+        p.AddSetter("SetSustainLevel", kUnit, [](float v) {
+            env.SetSustainLevel(v);
+        });
+        p.SetProcess([](float, bool trig) {
+            gate = trig ? !gate : gate;
+            return env.Process(gate);
+        });
+    });
+    run.Profile("AdEnv", [sr](ModuleProfile& p) {
+        static AdEnv env;
+        env.Init(sr);
+        p.AddSetter("SetTime(attack)", kTime, [](float v) {
+            env.SetTime(ADENV_SEG_ATTACK, v);
+        });
+        p.AddSetter("SetTime(decay)", kTime, [](float v) {
+            env.SetTime(ADENV_SEG_DECAY, v);
+        });
+        p.AddSetter("SetCurve", Range{-50.0f, 50.0f}, [](float v) {
+            env.SetCurve(v);
+        });
+        p.SetProcess([](float, bool trig) {
+            if(trig)
+                env.Trigger();
+            return env.Process();
+        });
+    });
+    run.Profile("Phasor", [sr](ModuleProfile& p) {
+        static Phasor phs;
+        phs.Init(sr);
+        p.AddSetter("SetFreq", kAudioFreq, [](float v) { phs.SetFreq(v); });
+        p.SetProcess([](float, bool) { return phs.Process(); });
+    });
+}
+
+void ProfileDrums(Runner& run, float sr)
+{
+    run.Profile("AnalogBassDrum", [sr](ModuleProfile& p) {
+        static AnalogBassDrum drum;
+        drum.Init(sr);
+        p.AddSetter("SetFreq", Range{20.0f, 200.0f, true}, [](float v) {
+            drum.SetFreq(v);
+        });
+        p.AddSetter("SetTone", kUnit, [](float v) { drum.SetTone(v); });
+        p.AddSetter("SetDecay", kUnit, [](float v) { drum.SetDecay(v); });
+        p.AddSetter("SetAccent", kUnit, [](float v) { drum.SetAccent(v); });
+        p.AddSetter("SetAttackFmAmount", kUnit, [](float v) {
+            drum.SetAttackFmAmount(v);
+        });
+        p.AddSetter("SetSelfFmAmount", kUnit, [](float v) {
+            drum.SetSelfFmAmount(v);
+        });
+        p.SetProcess([](float, bool trig) { return drum.Process(trig); });
+    });
+    run.Profile("AnalogSnareDrum", [sr](ModuleProfile& p) {
+        static AnalogSnareDrum drum;
+        drum.Init(sr);
+        p.AddSetter("SetFreq", Range{100.0f, 400.0f, true}, [](float v) {
+            drum.SetFreq(v);
+        });
+        p.AddSetter("SetTone", kUnit, [](float v) { drum.SetTone(v); });
+        p.AddSetter("SetDecay", kUnit, [](float v) { drum.SetDecay(v); });
+        p.AddSetter("SetSnappy", kUnit, [](float v) { drum.SetSnappy(v); });
+        p.AddSetter("SetAccent", kUnit, [](float v) { drum.SetAccent(v); });
+        p.SetProcess([](float, bool trig) { return drum.Process(trig); });
+    });
+    run.Profile("HiHat", [sr](ModuleProfile& p) {
+        static HiHat<> drum;
+        drum.Init(sr);
+        p.AddSetter("SetFreq", Range{1000.0f, 10000.0f, true}, [](float v) {
+            drum.SetFreq(v);
+        });
+        p.AddSetter("SetTone", kUnit, [](float v) { drum.SetTone(v); });
+        p.AddSetter("SetDecay", kUnit, [](float v) { drum.SetDecay(v); });
+        p.AddSetter("SetNoisiness", kUnit, [](float v) {
+            drum.SetNoisiness(v);
+        });
+        p.AddSetter("SetAccent", kUnit, [](float v) { drum.SetAccent(v); });
+        p.SetProcess([](float, bool trig) { return drum.Process(trig); });
+    });
+    run.Profile("SyntheticBassDrum", [sr](ModuleProfile& p) {
+        static SyntheticBassDrum drum;
+        drum.Init(sr);
+        p.AddSetter("SetFreq", Range{20.0f, 200.0f, true}, [](float v) {
+            drum.SetFreq(v);
+        });
+        p.AddSetter("SetTone", kUnit, [](float v) { drum.SetTone(v); });
+        p.AddSetter("SetDecay", kUnit, [](float v) { drum.SetDecay(v); });
+        p.AddSetter("SetDirtiness", kUnit, [](float v) {
+            drum.SetDirtiness(v);
+        });
+        p.AddSetter("SetFmEnvelopeAmount", kUnit, [](float v) {
+            drum.SetFmEnvelopeAmount(v);
+        });
+        p.AddSetter("SetFmEnvelopeDecay", kUnit, [](float v) {
+            drum.SetFmEnvelopeDecay(v);
+        });
+        p.SetProcess([](float, bool trig) { return drum.Process(trig); });
+    });
+    run.Profile("SyntheticSnareDrum", [sr](ModuleProfile& p) {
+        static SyntheticSnareDrum drum;
+        drum.Init(sr);
+        p.AddSetter("SetFreq", Range{100.0f, 400.0f, true}, [](float v) {
+            drum.SetFreq(v);
+        });
+        p.AddSetter("SetFmAmount", kUnit, [](float v) { drum.SetFmAmount(v); });
+        p.AddSetter("SetDecay", kUnit, [](float v) { drum.SetDecay(v); });
+        p.AddSetter("SetSnappy", kUnit, [](float v) { drum.SetSnappy(v); });
+        p.SetProcess([](float, bool trig) { return drum.Process(trig); });
+    });
+}
+
+void ProfileDynamics(Runner& run, float sr)
+{
+    run.Profile("CrossFade", [](ModuleProfile& p) {
+        static CrossFade fade;
+        fade.Init(CROSSFADE_CPOW);
+        p.AddSetter("SetPos", kUnit, [](float v) { fade.SetPos(v); });
+        p.SetProcess([](float in, bool) {
+            float inverted = -in;
+            return fade.Process(in, inverted);
+        });
+    });
+    run.Profile("Limiter", [](ModuleProfile& p) {
+        static Limiter limiter;
+        static float   pre_gain;
+        limiter.Init();
+        pre_gain = 1.0f;
+        p.AddSetter("pre_gain", Range{0.1f, 10.0f, true}, [](float v) {
+            pre_gain = v;
+        });
+        p.SetProcess([](float in, bool) {
+            limiter.ProcessBlock(&in, 1, pre_gain);
+            return in;
+        });
+    });
+    run.Profile("Gate", [sr](ModuleProfile& p) {
+        static Gate  gate;
+        static float buffer[Gate::GetBufferSize(1, 96, 480)];
+        gate.Init(buffer, sr, 1, 96, 480);
+        gate.SetLookahead(96);
+        p.AddSetter("SetThreshold", Range{-80.0f, 0.0f}, [](float v) {
+            gate.SetThreshold(v);
+        });
+        p.AddSetter("SetRelease", kTime, [](float v) { gate.SetRelease(v); });
+        p.AddSetter("SetSidechainFilter", kAudioFreq, [](float v) {
+            gate.SetSidechainFilter(v, 10000.0f);
+        });
+        p.SetProcess([](float in, bool) {
+            float* ch[1] = {&in};
+            gate.ProcessBlock(ch, ch, 1);
+            return in;
+        });
+    });
+}
+
+void ProfileEffects(Runner& run, float sr)
+{
+    run.Profile("Autowah", [sr](ModuleProfile& p) {
+        static Autowah wah;
+        wah.Init(sr);
+        p.AddSetter("SetWah", kUnit, [](float v) { wah.SetWah(v); });
+        p.AddSetter("SetDryWet", Range{0.0f, 100.0f}, [](float v) {
+            wah.SetDryWet(v);
+        });
+        p.AddSetter("SetLevel", kUnit, [](float v) { wah.SetLevel(v); });
+        p.SetProcess([](float in, bool) { return wah.Process(in); });
+    });
+    run.Profile("Chorus", [sr](ModuleProfile& p) {
+        static Chorus chorus;
+        chorus.Init(sr);
+        p.AddSetter("SetLfoDepth", kUnit, [](float v) {
+            chorus.SetLfoDepth(v);
+        });
+        p.AddSetter("SetLfoFreq", kLfoFreq, [](float v) {
+            chorus.SetLfoFreq(v);
+        });
+        p.AddSetter("SetDelay", kUnit, [](float v) { chorus.SetDelay(v); });
+        p.AddSetter("SetFeedback", kUnit, [](float v) {
+            chorus.SetFeedback(v);
+        });
+        p.SetProcess([](float in, bool) { return chorus.Process(in); });
+    });
+    run.Profile("Decimator", [](ModuleProfile& p) {
+        static Decimator decimator;
+        decimator.Init();
+        p.AddSetter("SetDownsampleFactor", kUnit, [](float v) {
+            decimator.SetDownsampleFactor(v);
+        });
+        p.AddSetter("SetBitcrushFactor", kUnit, [](float v) {
+            decimator.SetBitcrushFactor(v);
+        });
+        p.SetProcess([](float in, bool) { return decimator.Process(in); });
+    });
+    run.Profile("Flanger", [sr](ModuleProfile& p) {
+        static Flanger flanger;
+        flanger.Init(sr);
+        p.AddSetter("SetFeedback", kUnit, [](float v) {
+            flanger.SetFeedback(v);
+        });
+        p.AddSetter("SetLfoDepth", kUnit, [](float v) {
+            flanger.SetLfoDepth(v);
+        });
+        p.AddSetter("SetLfoFreq", kLfoFreq, [](float v) {
+            flanger.SetLfoFreq(v);
+        });
+        p.AddSetter("SetDelay", kUnit, [](float v) { flanger.SetDelay(v); });
+        p.SetProcess([](float in, bool) { return flanger.Process(in); });
+    });
+    run.Profile("Overdrive", [](ModuleProfile& p) {
+        static Overdrive drive;
+        drive.Init();
+        p.AddSetter("SetDrive", kUnit, [](float v) { drive.SetDrive(v); });
+        p.SetProcess([](float in, bool) { return drive.Process(in); });
+    });
+    run.Profile("Phaser", [sr](ModuleProfile& p) {
+        static Phaser phaser;
+        phaser.Init(sr);
+        p.AddSetter("SetPoles", Range{1.0f, 8.0f}, [](float v) {
+            phaser.SetPoles(static_cast<int>(v));
+        });
+        p.AddSetter("SetLfoDepth", kUnit, [](float v) {
+            phaser.SetLfoDepth(v);
+        });
+        p.AddSetter("SetLfoFreq", kLfoFreq, [](float v) {
+            phaser.SetLfoFreq(v);
+        });
+        p.AddSetter("SetFreq", kAudioFreq, [](float v) { phaser.SetFreq(v); });
+        p.AddSetter("SetFeedback", kUnit, [](float v) {
+            phaser.SetFeedback(v);
+        });
+        p.SetProcess([](float in, bool) { return phaser.Process(in); });
+    });
+    run.Profile("PitchShifter", [sr](ModuleProfile& p) {
+        pitch_shifter.Init(sr);
+        p.AddSetter("SetTransposition", Range{-24.0f, 24.0f}, [](float v) {
+            pitch_shifter.SetTransposition(v);
+        });
+        p.AddSetter("SetFun", kUnit, [](float v) { pitch_shifter.SetFun(v); });
+        p.SetProcess([](float in, bool) { return pitch_shifter.Process(in); });
+    });
+    run.Profile("SampleRateReducer", [](ModuleProfile& p) {
+        static SampleRateReducer reducer;
+        reducer.Init();
+        p.AddSetter("SetFreq", kUnit, [](float v) { reducer.SetFreq(v); });
+        p.SetProcess([](float in, bool) { return reducer.Process(in); });
+    });
+    run.Profile("Tremolo", [sr](ModuleProfile& p) {
+        static Tremolo tremolo;
+        tremolo.Init(sr);
+        p.AddSetter("SetFreq", kLfoFreq, [](float v) { tremolo.SetFreq(v); });
+        p.AddSetter("SetWaveform", Range{0.0f, 4.0f}, [](float v) {
+            tremolo.SetWaveform(static_cast<int>(v));
+        });
+        p.AddSetter("SetDepth", kUnit, [](float v) { tremolo.SetDepth(v); });
+        p.SetProcess([](float in, bool) { return tremolo.Process(in); });
+    });
+    run.Profile("Wavefolder", [](ModuleProfile& p) {
+        static Wavefolder folder;
+        folder.Init();
+        p.AddSetter("SetGain", Range{0.0f, 10.0f}, [](float v) {
+            folder.SetGain(v);
+        });
+        p.AddSetter("SetOffset", kBipolar, [](float v) {
+            folder.SetOffset(v);
+        });
+        p.SetProcess([](float in, bool) { return folder.Process(in); });
+    });
+}
+
+void ProfileFilters(Runner& run, float sr)
+{
+    run.Profile("OnePole", [](ModuleProfile& p) {
+        static OnePole filter;
+        filter.Init();
+        p.AddSetter("SetFrequency", Range{0.0f, 0.497f}, [](float v) {
+            filter.SetFrequency(v);
+        });
+        p.SetProcess([](float in, bool) { return filter.Process(in); });
+    });
+    run.Profile("Svf", [sr](ModuleProfile& p) {
+        static Svf filter;
+        filter.Init(sr);
+        p.AddSetter("SetFreq", kAudioFreq, [](float v) { filter.SetFreq(v); });
+        p.AddSetter("SetRes", kUnit, [](float v) { filter.SetRes(v); });
+        p.AddSetter("SetDrive", kUnit, [](float v) { filter.SetDrive(v); });
+        p.SetProcess([](float in, bool) {
+            filter.Process(in);
+            return filter.Low();
+        });
+    });
+    run.Profile("Soap", [sr](ModuleProfile& p) {
+        static Soap filter;
+        filter.Init(sr);
+        p.AddSetter("SetCenterFreq", kAudioFreq, [](float v) {
+            filter.SetCenterFreq(v);
+        });
+        p.AddSetter("SetFilterBandwidth", kAudioFreq, [](float v) {
+            filter.SetFilterBandwidth(v);
+        });
+        p.SetProcess([](float in, bool) {
+            filter.Process(in);
+            return filter.Bandpass();
+        });
+    });
+    run.Profile("FIR(64)", [](ModuleProfile& p) {
+        static FIR<64, 1> filter;
+        float             ir[64];
+        for(size_t i = 0; i < 64; i++)
+            ir[i] = 1.0f / 64.0f;
+        filter.Init(ir, 64, false);
+        p.SetProcess([](float in, bool) { return filter.Process(in); });
+    });
+}
+
+void ProfileNoise(Runner& run, float sr)
+{
+    run.Profile("ClockedNoise", [sr](ModuleProfile& p) {
+        static ClockedNoise noise;
+        noise.Init(sr);
+        p.AddSetter("SetFreq", Range{1.0f, 48000.0f, true}, [](float v) {
+            noise.SetFreq(v);
+        });
+        p.SetProcess([](float, bool) { return noise.Process(); });
+    });
+    run.Profile("Dust", [](ModuleProfile& p) {
+        static Dust dust;
+        dust.Init();
+        p.AddSetter("SetDensity", kUnit, [](float v) { dust.SetDensity(v); });
+        p.SetProcess([](float, bool) { return dust.Process(); });
+    });
+    run.Profile("FractalRandomGenerator", [sr](ModuleProfile& p) {
+        static FractalRandomGenerator<ClockedNoise, 5> noise;
+        noise.Init(sr);
+        p.AddSetter("SetFreq", kAudioFreq, [](float v) { noise.SetFreq(v); });
+        p.AddSetter("SetColor", kUnit, [](float v) { noise.SetColor(v); });
+        p.SetProcess([](float, bool) { return noise.Process(); });
+    });
+    run.Profile("GrainletOscillator", [sr](ModuleProfile& p) {
+        static GrainletOscillator osc;
+        osc.Init(sr);
+        p.AddSetter("SetFreq", kAudioFreq, [](float v) { osc.SetFreq(v); });
+        p.AddSetter("SetFormantFreq", kAudioFreq, [](float v) {
+            osc.SetFormantFreq(v);
+        });
+        p.AddSetter("SetShape", Range{0.0f, 3.0f}, [](float v) {
+            osc.SetShape(v);
+        });
+        p.AddSetter("SetBleed", kUnit, [](float v) { osc.SetBleed(v); });
+        p.SetProcess([](float, bool) { return osc.Process(); });
+    });
+    run.Profile("Particle", [sr](ModuleProfile& p) {
+        static Particle particle;
+        particle.Init(sr);
+        p.AddSetter("SetFreq", kAudioFreq, [](float v) {
+            particle.SetFreq(v);
+        });
+        p.AddSetter("SetResonance", kUnit, [](float v) {
+            particle.SetResonance(v);
+        });
+        p.AddSetter("SetRandomFreq", kAudioFreq, [](float v) {
+            particle.SetRandomFreq(v);
+        });
+        p.AddSetter("SetDensity", kUnit, [](float v) {
+            particle.SetDensity(v);
+        });
+        p.AddSetter("SetGain", kUnit, [](float v) { particle.SetGain(v); });
+        p.AddSetter("SetSpread", kUnit, [](float v) {
+            particle.SetSpread(v);
+        });
+        p.SetProcess([](float, bool) { return particle.Process(); });
+    });
+    run.Profile("WhiteNoise", [](ModuleProfile& p) {
+        static WhiteNoise noise;
+        noise.Init();
+        p.AddSetter("SetAmp", kUnit, [](float v) { noise.SetAmp(v); });
+        p.SetProcess([](float, bool) { return noise.Process(); });
+    });
+}
+
+void ProfilePhysicalModeling(Runner& run, float sr)
+{
+    const Range kStringFreq{20.0f, 4000.0f, true};
+    run.Profile("Drip", [sr](ModuleProfile& p) {
+        static Drip drip;
+        drip.Init(sr, 0.01f);
+        p.SetProcess([](float, bool trig) { return drip.Process(trig); });
+    });
+    run.Profile("String", [sr, kStringFreq](ModuleProfile& p) {
+        static String string;
+        string.Init(sr);
+        p.AddSetter("SetFreq", kStringFreq, [](float v) { string.SetFreq(v); });
+        p.AddSetter("SetNonLinearity", kBipolar, [](float v) {
+            string.SetNonLinearity(v);
+        });
+        p.AddSetter("SetBrightness", kUnit, [](float v) {
+            string.SetBrightness(v);
+        });
+        p.AddSetter("SetDamping", kUnit, [](float v) {
+            string.SetDamping(v);
+        });
+        p.SetProcess([](float in, bool) { return string.Process(in); });
+    });
+    run.Profile("ModalVoice", [sr, kStringFreq](ModuleProfile& p) {
+        static ModalVoice voice;
+        voice.Init(sr);
+        p.AddSetter("SetFreq", kStringFreq, [](float v) { voice.SetFreq(v); });
+        p.AddSetter("SetAccent", kUnit, [](float v) { voice.SetAccent(v); });
+        p.AddSetter("SetStructure", kUnit, [](float v) {
+            voice.SetStructure(v);
+        });
+        p.AddSetter("SetBrightness", kUnit, [](float v) {
+            voice.SetBrightness(v);
+        });
+        p.AddSetter("SetDamping", kUnit, [](float v) { voice.SetDamping(v); });
+        p.SetProcess([](float, bool trig) { return voice.Process(trig); });
+    });
+    run.Profile("Resonator", [sr, kStringFreq](ModuleProfile& p) {
+        static Resonator resonator;
+        resonator.Init(0.015f, 24, sr);
+        p.AddSetter("SetFreq", kStringFreq, [](float v) {
+            resonator.SetFreq(v);
+        });
+        p.AddSetter("SetStructure", kUnit, [](float v) {
+            resonator.SetStructure(v);
+        });
+        p.AddSetter("SetBrightness", kUnit, [](float v) {
+            resonator.SetBrightness(v);
+        });
+        p.AddSetter("SetDamping", kUnit, [](float v) {
+            resonator.SetDamping(v);
+        });
+        p.SetProcess([](float in, bool) { return resonator.Process(in); });
+    });
+    run.Profile("StringVoice", [sr, kStringFreq](ModuleProfile& p) {
+        static StringVoice voice;
+        voice.Init(sr);
+        p.AddSetter("SetFreq", kStringFreq, [](float v) { voice.SetFreq(v); });
+        p.AddSetter("SetAccent", kUnit, [](float v) { voice.SetAccent(v); });
+        p.AddSetter("SetStructure", kUnit, [](float v) {
+            voice.SetStructure(v);
+        });
+        p.AddSetter("SetBrightness", kUnit, [](float v) {
+            voice.SetBrightness(v);
+        });
+        p.AddSetter("SetDamping", kUnit, [](float v) { voice.SetDamping(v); });
+        p.SetProcess([](float, bool trig) { return voice.Process(trig); });
+    });
+}
+
+void ProfileSampling(Runner& run, float sr)
+{
+    run.Profile("GranularPlayer", [sr](ModuleProfile& p) {
+        static GranularPlayer player;
+        static float          speed, transposition, grain_size;
+        for(size_t i = 0; i < 48000; i++)
+            granular_buffer[i] = sinf(i * 0.01f);
+        player.Init(granular_buffer, 48000, sr);
+        speed         = 1.0f;
+        transposition = 0.0f;
+        grain_size    = 100.0f;
+        p.AddSetter("speed", Range{-2.0f, 2.0f}, [](float v) { speed = v; });
+        p.AddSetter("transposition", Range{-2400.0f, 2400.0f}, [](float v) {
+            transposition = v;
+        });
+        p.AddSetter("grain_size", Range{1.0f, 1000.0f, true}, [](float v) {
+            grain_size = v;
+        });
+        p.SetProcess([](float, bool) {
+            return player.Process(speed, transposition, grain_size);
+        });
+    });
+}
+
+void ProfileSynthesis(Runner& run, float sr)
+{
+    run.Profile("Fm2", [sr](ModuleProfile& p) {
+        static Fm2 fm;
+        fm.Init(sr);
+        p.AddSetter("SetFrequency", kAudioFreq, [](float v) {
+            fm.SetFrequency(v);
+        });
+        p.AddSetter("SetRatio", Range{0.1f, 10.0f, true}, [](float v) {
+            fm.SetRatio(v);
+        });
+        p.AddSetter("SetIndex", Range{0.0f, 10.0f}, [](float v) {
+            fm.SetIndex(v);
+        });
+        p.SetProcess([](float, bool) { return fm.Process(); });
+    });
+    run.Profile("FormantOscillator", [sr](ModuleProfile& p) {
+        static FormantOscillator osc;
+        osc.Init(sr);
+        p.AddSetter("SetFormantFreq", kAudioFreq, [](float v) {
+            osc.SetFormantFreq(v);
+        });
+        p.AddSetter("SetCarrierFreq", kAudioFreq, [](float v) {
+            osc.SetCarrierFreq(v);
+        });
+        p.AddSetter("SetPhaseShift", kUnit, [](float v) {
+            osc.SetPhaseShift(v);
+        });
+        p.SetProcess([](float, bool) { return osc.Process(); });
+    });
+    run.Profile("HarmonicOscillator", [sr](ModuleProfile& p) {
+        static HarmonicOscillator<16> osc;
+        osc.Init(sr);
+        p.AddSetter("SetFreq", kAudioFreq, [](float v) { osc.SetFreq(v); });
+        p.AddSetter("SetFirstHarmIdx", Range{1.0f, 8.0f}, [](float v) {
+            osc.SetFirstHarmIdx(static_cast<int>(v));
+        });
+        p.AddSetter("SetSingleAmp", kUnit, [](float v) {
+            osc.SetSingleAmp(v, 3);
+        });
+        p.SetProcess([](float, bool) { return osc.Process(); });
+    });
+    run.Profile("Oscillator", [sr](ModuleProfile& p) {
+        static Oscillator osc;
+        osc.Init(sr);
+        p.AddSetter("SetFreq", kAudioFreq, [](float v) { osc.SetFreq(v); });
+        p.AddSetter("SetAmp", kUnit, [](float v) { osc.SetAmp(v); });
+        p.AddSetter("SetPw", kUnit, [](float v) { osc.SetPw(v); });
+        p.AddSetter(
+            "SetWaveform",
+            Range{0.0f, float(Oscillator::WAVE_LAST - 1)},
+            [](float v) { osc.SetWaveform(static_cast<uint8_t>(v)); });
+        p.SetProcess([](float, bool) { return osc.Process(); });
+    });
+    run.Profile("OscillatorBank", [sr](ModuleProfile& p) {
+        static OscillatorBank osc;
+        osc.Init(sr);
+        p.AddSetter("SetFreq", kAudioFreq, [](float v) { osc.SetFreq(v); });
+        p.AddSetter("SetGain", kUnit, [](float v) { osc.SetGain(v); });
+        p.AddSetter("SetSingleAmp", kUnit, [](float v) {
+            osc.SetSingleAmp(v, 2);
+        });
+        p.SetProcess([](float, bool) { return osc.Process(); });
+    });
+    run.Profile("VariableSawOscillator", [sr](ModuleProfile& p) {
+        static VariableSawOscillator osc;
+        osc.Init(sr);
+        p.AddSetter("SetFreq", kAudioFreq, [](float v) { osc.SetFreq(v); });
+        p.AddSetter("SetPW", kBipolar, [](float v) { osc.SetPW(v); });
+        p.AddSetter("SetWaveshape", kUnit, [](float v) {
+            osc.SetWaveshape(v);
+        });
+        p.SetProcess([](float, bool) { return osc.Process(); });
+    });
+    run.Profile("VariableShapeOscillator", [sr](ModuleProfile& p) {
+        static VariableShapeOscillator osc;
+        osc.Init(sr);
+        p.AddSetter("SetFreq", kAudioFreq, [](float v) { osc.SetFreq(v); });
+        p.AddSetter("SetPW", kUnit, [](float v) { osc.SetPW(v); });
+        p.AddSetter("SetWaveshape", kUnit, [](float v) {
+            osc.SetWaveshape(v);
+        });
+        p.AddSetter("SetSyncFreq", kAudioFreq, [](float v) {
+            osc.SetSyncFreq(v);
+        });
+        p.SetProcess([](float, bool) { return osc.Process(); });
+    });
+    run.Profile("VosimOscillator", [sr](ModuleProfile& p) {
+        static VosimOscillator osc;
+        osc.Init(sr);
+        p.AddSetter("SetFreq", kAudioFreq, [](float v) { osc.SetFreq(v); });
+        p.AddSetter("SetForm1Freq", kAudioFreq, [](float v) {
+            osc.SetForm1Freq(v);
+        });
+        p.AddSetter("SetForm2Freq", kAudioFreq, [](float v) {
+            osc.SetForm2Freq(v);
+        });
+        p.AddSetter("SetShape", kBipolar, [](float v) { osc.SetShape(v); });
+        p.SetProcess([](float, bool) { return osc.Process(); });
+    });
+    run.Profile("ZOscillator", [sr](ModuleProfile& p) {
+        static ZOscillator osc;
+        osc.Init(sr);
+        p.AddSetter("SetFreq", kAudioFreq, [](float v) { osc.SetFreq(v); });
+        p.AddSetter("SetFormantFreq", kAudioFreq, [](float v) {
+            osc.SetFormantFreq(v);
+        });
+        p.AddSetter("SetShape", kUnit, [](float v) { osc.SetShape(v); });
+        p.AddSetter("SetMode", kBipolar, [](float v) { osc.SetMode(v); });
+        p.SetProcess([](float, bool) { return osc.Process(); });
+    });
+}
+
+void ProfileUtility(Runner& run, float sr)
+{
+    run.Profile("DcBlock", [sr](ModuleProfile& p) {
+        static DcBlock block;
+        block.Init(sr);
+        p.SetProcess([](float in, bool) { return block.Process(in); });
+    });
+    run.Profile("DelayLine", [](ModuleProfile& p) {
+        delay_line.Init();
+        p.AddSetter("SetDelay", Range{1.0f, 47999.0f}, [](float v) {
+            delay_line.SetDelay(v);
+        });
+        p.SetProcess([](float in, bool) {
+            delay_line.Write(in);
+            return delay_line.Read();
+        });
+    });
+    run.Profile("Looper", [](ModuleProfile& p) {
+        static Looper looper;
+        looper.Init(looper_buffer, 48000);
+        p.SetProcess([](float in, bool trig) {
+            if(trig)
+                looper.TrigRecord();
+            return looper.Process(in);
+        });
+    });
+    run.Profile("Maytrig", [](ModuleProfile& p) {
+        static Maytrig maytrig;
+        static float   prob;
+        prob = 0.5f;
+        p.AddSetter("prob", kUnit, [](float v) { prob = v; });
+        p.SetProcess([](float, bool) { return maytrig.Process(prob); });
+    });
+    run.Profile("Metro", [sr](ModuleProfile& p) {
+        static Metro metro;
+        metro.Init(2.0f, sr);
+        p.AddSetter("SetFreq", Range{0.1f, 1000.0f, true}, [](float v) {
+            metro.SetFreq(v);
+        });
+        p.SetProcess([](float, bool) { return float(metro.Process()); });
+    });
+    run.Profile("PitchDetector", [sr](ModuleProfile& p) {
+        static PitchDetector pd;
+        static float         buffer[PitchDetector::GetBufferSize(512)];
+        pd.Init(buffer, sr, 512, 4);
+        p.AddSetter("SetThreshold", kUnit, [](float v) { pd.SetThreshold(v); });
+        p.SetProcess([](float in, bool) {
+            pd.Process(&in, 1);
+            return pd.GetFrequency();
+        });
+    });
+    run.Profile("SampleHold", [](ModuleProfile& p) {
+        static SampleHold sh;
+        p.SetProcess([](float in, bool trig) { return sh.Process(trig, in); });
+    });
+    run.Profile("SmoothRandomGenerator", [sr](ModuleProfile& p) {
+        static SmoothRandomGenerator random;
+        random.Init(sr);
+        p.AddSetter("SetFreq", Range{0.01f, 1000.0f, true}, [](float v) {
+            random.SetFreq(v);
+        });
+        p.SetProcess([](float, bool) { return random.Process(); });
+    });
+}
+
+void PrintUsage()
+{
+    printf("usage: daisysp_wcet_profile [--blocks N] [--block-size N]\n"
+           "                            [--budget F] [--budget-ns NS]\n"
+           "                            [--filter NAME] [--csv FILE] "
+           "[--strict]\n");
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Config      config;
+    std::string filter, csv;
+    bool        strict = false;
+    for(int i = 1; i < argc; i++)
+    {
+        const bool has_value = i + 1 < argc;
+        if(!strcmp(argv[i], "--blocks") && has_value)
+            config.num_blocks = strtoul(argv[++i], nullptr, 10);
+        else if(!strcmp(argv[i], "--block-size") && has_value)
+            config.block_size = strtoul(argv[++i], nullptr, 10);
+        else if(!strcmp(argv[i], "--budget") && has_value)
+            config.setter_budget = strtof(argv[++i], nullptr);
+        else if(!strcmp(argv[i], "--budget-ns") && has_value)
+            config.setter_budget_ns = strtod(argv[++i], nullptr);
+        else if(!strcmp(argv[i], "--filter") && has_value)
+            filter = argv[++i];
+        else if(!strcmp(argv[i], "--csv") && has_value)
+            csv = argv[++i];
+        else if(!strcmp(argv[i], "--strict"))
+            strict = true;
+        else
+        {
+            PrintUsage();
+            return 2;
+        }
+    }
+    if(config.num_blocks == 0 || config.block_size == 0)
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    const float sr = config.sample_rate;
+    Runner      run(config, filter);
+    ProfileControl(run, sr);
+    ProfileDrums(run, sr);
+    ProfileDynamics(run, sr);
+    ProfileEffects(run, sr);
+    ProfileFilters(run, sr);
+    ProfileNoise(run, sr);
+    ProfilePhysicalModeling(run, sr);
+    ProfileSampling(run, sr);
+    ProfileSynthesis(run, sr);
+    ProfileUtility(run, sr);
+
+    PrintStats(run.GetResults());
+    printf("\ntimer overhead: %.1f ns (subtracted)\n", GetTimerOverheadNs());
+
+    if(!csv.empty() && !WriteCsv(csv, run.GetResults()))
+    {
+        fprintf(stderr, "could not write %s\n", csv.c_str());
+        return 1;
+    }
+
+    int num_over_budget = 0;
+    for(const auto& s : run.GetResults())
+        num_over_budget += s.over_budget ? 1 : 0;
+    if(num_over_budget > 0)
+        printf("%d setter(s) over budget\n", num_over_budget);
+    return strict && num_over_budget > 0 ? 1 : 0;
+}
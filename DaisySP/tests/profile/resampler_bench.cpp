@@ -0,0 +1,147 @@
+#include "daisysp.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/** Measures the cost of the Resampler per audio block.
+ *
+ *  A noise sample is converted with 48 sample blocks by each preset, from
+ *  44.1 kHz to 48 kHz, and at 1.5x and 2x speed, where the kernel is
+ *  stretched. Linear interpolation, as used by the looper and the granular
+ *  player, is the baseline. The load is relative to the 1 ms period of a
+ *  block at 48 kHz, for one channel.
+ *
+ *  Absolute numbers are from the host, the ratios are what matters.
+ *
+ *  Usage: daisysp_resampler_bench [--seconds N]
+ */
+
+using namespace daisysp;
+
+namespace
+{
+typedef std::chrono::steady_clock Clock;
+
+constexpr float  kSampleRate = 48000.0f;
+constexpr size_t kBlockSize  = 48;
+constexpr size_t kPasses     = 3;
+
+volatile float sink;
+
+void Report(const char* name, float ratio, double best, size_t num_blocks)
+{
+    const double period_us = 1e6 * kBlockSize / kSampleRate;
+    const double average   = best / num_blocks;
+    printf("%-10s %6.3f %10.3f %9.2f%%\n",
+           name,
+           ratio,
+           average,
+           100.0 * average / period_us);
+}
+
+void RunResampler(const char*               name,
+                  Resampler::Quality        quality,
+                  float                     ratio,
+                  const std::vector<float>& sample,
+                  size_t                    num_blocks)
+{
+    Resampler rs;
+    double    best = 1e30;
+    float     out[kBlockSize];
+    for(size_t pass = 0; pass < kPasses; pass++)
+    {
+        rs.Init(quality);
+        rs.SetRatio(ratio);
+        size_t     read  = 0;
+        const auto start = Clock::now();
+        for(size_t b = 0; b < num_blocks; b++)
+        {
+            const size_t needed = rs.GetInputNeeded(kBlockSize);
+            if(read + needed > sample.size())
+                read = 0;
+            rs.Process(&sample[read], out, kBlockSize);
+            read += needed;
+            sink = out[0];
+        }
+        const auto end = Clock::now();
+        best = std::min(
+            best,
+            std::chrono::duration<double, std::micro>(end - start).count());
+    }
+    Report(name, ratio, best, num_blocks);
+}
+
+void RunLinear(float ratio, const std::vector<float>& sample, size_t num_blocks)
+{
+    double best = 1e30;
+    float  out[kBlockSize];
+    for(size_t pass = 0; pass < kPasses; pass++)
+    {
+        double     pos   = 0.0;
+        const auto start = Clock::now();
+        for(size_t b = 0; b < num_blocks; b++)
+        {
+            for(size_t i = 0; i < kBlockSize; i++)
+            {
+                const size_t idx  = static_cast<size_t>(pos);
+                const float  frac = static_cast<float>(pos - idx);
+                out[i] = sample[idx] + (sample[idx + 1] - sample[idx]) * frac;
+                pos += ratio;
+                if(pos >= sample.size() - 1)
+                    pos = 0.0;
+            }
+            sink = out[0];
+        }
+        const auto end = Clock::now();
+        best = std::min(
+            best,
+            std::chrono::duration<double, std::micro>(end - start).count());
+    }
+    Report("linear", ratio, best, num_blocks);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t seconds = 10;
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "--seconds") && i + 1 < argc)
+            seconds = strtoul(argv[++i], nullptr, 10);
+        else
+        {
+            printf("usage: daisysp_resampler_bench [--seconds N]\n");
+            return 2;
+        }
+    }
+    seconds                 = seconds > 0 ? seconds : 1;
+    const size_t num_blocks = seconds * size_t(kSampleRate) / kBlockSize;
+
+    std::vector<float> sample(size_t(kSampleRate) * 4);
+    uint32_t           seed = 1;
+    for(float& s : sample)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        s    = static_cast<float>(seed >> 8) / 16777216.0f - 0.5f;
+    }
+
+    printf("%-10s %6s %10s %10s\n", "quality", "ratio", "avg us", "avg");
+    for(float ratio : {44100.0f / 48000.0f, 1.5f, 2.0f})
+    {
+        RunLinear(ratio, sample, num_blocks);
+        RunResampler(
+            "fast", Resampler::Quality::FAST, ratio, sample, num_blocks);
+        RunResampler("standard",
+                     Resampler::Quality::STANDARD,
+                     ratio,
+                     sample,
+                     num_blocks);
+        RunResampler(
+            "high", Resampler::Quality::HIGH, ratio, sample, num_blocks);
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include "daisysp.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/** Measures the cost of decoding compressed samples per voice.
+ *
+ *  Sixteen voices read a four second sample through a SampleReader, 48
+ *  samples per block, each from its own position. The sample is stored in
+ *  every SampleCodec format, FLOAT32 is the cost of a plain copy. The
+ *  load is the time per voice relative to the 1 ms period of a block at
+ *  48 kHz, along with the memory taken by one second of sample.
+ *
+ *  Absolute numbers are from the host, the ratios are what matters.
+ *
+ *  Usage: daisysp_samplecodec_bench [--seconds N]
+ */
+
+using namespace daisysp;
+
+namespace
+{
+typedef std::chrono::steady_clock Clock;
+typedef SampleCodec::Format       Format;
+
+constexpr float  kSampleRate = 48000.0f;
+constexpr size_t kBlockSize  = 48;
+constexpr size_t kNumVoices  = 16;
+constexpr size_t kPasses     = 3;
+
+volatile float sink;
+
+void Run(const char*               name,
+         Format                    format,
+         const std::vector<float>& sample,
+         size_t                    num_blocks)
+{
+    std::vector<uint8_t> data(
+        SampleCodec::GetEncodedSize(format, sample.size()));
+    SampleCodec::Encode(format, sample.data(), sample.size(), data.data());
+
+    SampleReader reader[kNumVoices];
+    size_t       pos[kNumVoices];
+    float        out[kBlockSize];
+    double       best = 1e30;
+    for(size_t pass = 0; pass < kPasses; pass++)
+    {
+        for(size_t v = 0; v < kNumVoices; v++)
+        {
+            reader[v].Init(data.data(), sample.size(), format);
+            pos[v] = v * sample.size() / kNumVoices;
+        }
+        const auto start = Clock::now();
+        for(size_t b = 0; b < num_blocks; b++)
+        {
+            for(size_t v = 0; v < kNumVoices; v++)
+            {
+                reader[v].Read(pos[v], out, kBlockSize);
+                pos[v] = (pos[v] + kBlockSize) % sample.size();
+                sink   = out[0];
+            }
+        }
+        const auto end = Clock::now();
+        best           = std::min(
+            best,
+            std::chrono::duration<double, std::micro>(end - start).count());
+    }
+
+    const double period_us = 1e6 * kBlockSize / kSampleRate;
+    const double per_voice = best / num_blocks / kNumVoices;
+    const double kb_per_s  = SampleCodec::GetEncodedSize(
+                                format, static_cast<size_t>(kSampleRate))
+                            / 1024.0;
+    printf("%-8s %12.3f %9.2f%% %10.1f\n",
+           name,
+           per_voice,
+           100.0 * per_voice / period_us,
+           kb_per_s);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t seconds = 10;
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "--seconds") && i + 1 < argc)
+            seconds = strtoul(argv[++i], nullptr, 10);
+        else
+        {
+            printf("usage: daisysp_samplecodec_bench [--seconds N]\n");
+            return 2;
+        }
+    }
+    seconds                 = seconds > 0 ? seconds : 1;
+    const size_t num_blocks = seconds * size_t(kSampleRate) / kBlockSize;
+
+    // a decaying chord, so the blocks use a range of shifts
+    std::vector<float> sample(size_t(kSampleRate) * 4);
+    for(size_t i = 0; i < sample.size(); i++)
+    {
+        const float t = i / kSampleRate;
+        sample[i]     = expf(-t) * 0.3f
+                    * (sinf(TWOPI_F * 220.0f * t) + sinf(TWOPI_F * 277.0f * t)
+                       + sinf(TWOPI_F * 330.0f * t));
+    }
+
+    printf("%-8s %12s %10s %10s\n", "format", "us/voice", "load", "KB/s");
+    Run("float32", Format::FLOAT32, sample, num_blocks);
+    Run("bfp12", Format::BFP12, sample, num_blocks);
+    Run("bfp8", Format::BFP8, sample, num_blocks);
+    Run("adpcm4", Format::ADPCM4, sample, num_blocks);
+    return 0;
+}
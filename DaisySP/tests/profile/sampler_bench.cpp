@@ -0,0 +1,118 @@
+#include "daisysp.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/** Measures the cost of Sampler voices per interpolation.
+ *
+ *  Voices play a looped four second sample a fifth apart from each other,
+ *  48 samples per block: 16 voices for LINEAR and CUBIC, the size of the
+ *  pool of resamplers for SINC. The load is the time per voice relative
+ *  to the 1 ms period of a block at 48 kHz.
+ *
+ *  Absolute numbers are from the host, the ratios are what matters.
+ *
+ *  Usage: daisysp_sampler_bench [--seconds N]
+ */
+
+using namespace daisysp;
+
+namespace
+{
+typedef std::chrono::steady_clock Clock;
+typedef Sampler::Interpolation    Interpolation;
+
+constexpr float  kSampleRate = 48000.0f;
+constexpr size_t kBlockSize  = 48;
+constexpr size_t kPasses     = 3;
+
+volatile float sink;
+
+void Run(const char*        name,
+         Interpolation      interpolation,
+         size_t             num_voices,
+         const SamplerZone& zone,
+         size_t             num_blocks)
+{
+    static Sampler sampler;
+    float          out[kBlockSize];
+    double         best = 1e30;
+    for(size_t pass = 0; pass < kPasses; pass++)
+    {
+        sampler.Init(kSampleRate, &zone, 1);
+        sampler.SetInterpolation(interpolation);
+        for(size_t v = 0; v < num_voices; v++)
+            sampler.NoteOn(static_cast<uint8_t>(48 + (v * 7) % 36), 100);
+
+        const auto start = Clock::now();
+        for(size_t b = 0; b < num_blocks; b++)
+        {
+            sampler.Process(out, kBlockSize);
+            sink = out[0];
+        }
+        const auto end = Clock::now();
+        best           = std::min(
+            best,
+            std::chrono::duration<double, std::micro>(end - start).count());
+    }
+
+    const double period_us = 1e6 * kBlockSize / kSampleRate;
+    const double per_voice = best / num_blocks / num_voices;
+    printf("%-8s %8zu %12.3f %9.2f%%\n",
+           name,
+           num_voices,
+           per_voice,
+           100.0 * per_voice / period_us);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t seconds = 10;
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "--seconds") && i + 1 < argc)
+            seconds = strtoul(argv[++i], nullptr, 10);
+        else
+        {
+            printf("usage: daisysp_sampler_bench [--seconds N]\n");
+            return 2;
+        }
+    }
+    seconds                 = seconds > 0 ? seconds : 1;
+    const size_t num_blocks = seconds * size_t(kSampleRate) / kBlockSize;
+
+    std::vector<float> sample(size_t(kSampleRate) * 4);
+    for(size_t i = 0; i < sample.size(); i++)
+    {
+        const float t = i / kSampleRate;
+        sample[i]     = 0.3f
+                    * (sinf(TWOPI_F * 220.0f * t) + sinf(TWOPI_F * 277.0f * t)
+                       + sinf(TWOPI_F * 330.0f * t));
+    }
+    SampleSource source;
+    source.Init(sample.data(), sample.size());
+
+    std::vector<float> crossfade(1024);
+    SamplerZone        zone = {};
+    zone.source             = &source;
+    zone.sample_rate        = kSampleRate;
+    zone.root_note          = 60;
+    zone.key_hi             = 127;
+    zone.vel_hi             = 127;
+    zone.loop_start         = sample.size() / 4;
+    zone.loop_end           = sample.size() - 1000;
+    zone.crossfade          = crossfade.size();
+    zone.gain               = 1.0f;
+    Sampler::PrepareZone(zone, crossfade.data());
+
+    printf("%-8s %8s %12s %10s\n", "interp", "voices", "us/voice", "load");
+    Run("linear", Interpolation::LINEAR, Sampler::kMaxVoices, zone, num_blocks);
+    Run("cubic", Interpolation::CUBIC, Sampler::kMaxVoices, zone, num_blocks);
+    Run("sinc", Interpolation::SINC, Sampler::kMaxSincVoices, zone, num_blocks);
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include "daisysp.h"
+#include "reverbsc.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+/** Host model of the boot-to-audio time of modules with large buffers.
+ *
+ *  For each module, the time of Init() is compared to the time it takes to
+ *  clear the whole buffer, which is what Init() used to do. Buffers are
+ *  filled with garbage first, so page faults on the host don't count.
+ *  ReverbSc clears its delay lines in small steps from Process(), so its
+ *  row also shows how many samples it takes until it is ready.
+ *
+ *  Absolute numbers are from the host. On the Daisy, the buffers are in
+ *  SDRAM, which is a lot slower to fill, so the difference is larger.
+ *
+ *  Usage: daisysp_startup_bench [--runs N]
+ */
+
+using namespace daisysp;
+
+namespace
+{
+typedef std::chrono::steady_clock Clock;
+
+constexpr float  kSampleRate = 48000.0f;
+constexpr size_t kLooperSize = 48000 * 60;
+
+DelayLine<float, 48000 * 4> delay;
+PitchShifter                pitch_shifter;
+ReverbSc                    reverb;
+Looper                      looper;
+float                       looper_buffer[kLooperSize];
+
+double TimeUs(const std::function<void()>& fn, size_t runs)
+{
+    double best = 1e30;
+    for(size_t i = 0; i < runs; i++)
+    {
+        const auto   start = Clock::now();
+        fn();
+        const auto   end = Clock::now();
+        const double us
+            = std::chrono::duration<double, std::micro>(end - start).count();
+        best = us < best ? us : best;
+    }
+    return best;
+}
+
+void Dirty(void* mem, size_t bytes)
+{
+    memset(mem, 0x7f, bytes);
+}
+
+double TimeClearUs(void* mem, size_t bytes, size_t runs)
+{
+    return TimeUs(
+        [&] {
+            float* f = static_cast<float*>(mem);
+            for(size_t i = 0; i < bytes / sizeof(float); i++)
+                f[i] = 0.0f;
+        },
+        runs);
+}
+
+void Print(const char* name, size_t bytes, double clear_us, double init_us)
+{
+    printf("%-14s %10zu %12.1f %12.2f\n",
+           name,
+           bytes / 1024,
+           clear_us,
+           init_us);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t runs = 10;
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "--runs") && i + 1 < argc)
+            runs = strtoul(argv[++i], nullptr, 10);
+        else
+        {
+            printf("usage: daisysp_startup_bench [--runs N]\n");
+            return 2;
+        }
+    }
+    runs = runs > 0 ? runs : 1;
+
+    printf("%-14s %10s %12s %12s\n", "module", "buffer KB", "clear us", "Init us");
+
+    double total_clear = 0.0, total_init = 0.0;
+
+    Dirty(&delay, sizeof(delay));
+    double clear_us = TimeClearUs(&delay, sizeof(delay), runs);
+    Dirty(&delay, sizeof(delay));
+    double init_us = TimeUs([] { delay.Init(); }, runs);
+    Print("DelayLine 4s", sizeof(delay), clear_us, init_us);
+    total_clear += clear_us;
+    total_init += init_us;
+
+    Dirty(&pitch_shifter, sizeof(pitch_shifter));
+    clear_us = TimeClearUs(&pitch_shifter, sizeof(pitch_shifter), runs);
+    Dirty(&pitch_shifter, sizeof(pitch_shifter));
+    init_us = TimeUs([] { pitch_shifter.Init(kSampleRate); }, runs);
+    Print("PitchShifter", sizeof(pitch_shifter), clear_us, init_us);
+    total_clear += clear_us;
+    total_init += init_us;
+
+    Dirty(looper_buffer, sizeof(looper_buffer));
+    clear_us = TimeClearUs(looper_buffer, sizeof(looper_buffer), runs);
+    Dirty(looper_buffer, sizeof(looper_buffer));
+    init_us = TimeUs([] { looper.Init(looper_buffer, kLooperSize); }, runs);
+    Print("Looper 60s", sizeof(looper_buffer), clear_us, init_us);
+    total_clear += clear_us;
+    total_init += init_us;
+
+    Dirty(&reverb, sizeof(reverb));
+    clear_us = TimeClearUs(&reverb, sizeof(reverb), runs);
+    Dirty(&reverb, sizeof(reverb));
+    init_us = TimeUs([] { reverb.Init(kSampleRate); }, runs);
+    Print("ReverbSc", sizeof(reverb), clear_us, init_us);
+    total_clear += clear_us;
+    total_init += init_us;
+
+    size_t samples_until_ready = 0;
+    float  left, right;
+    while(!reverb.IsReady())
+    {
+        reverb.Process(0.0f, 0.0f, &left, &right);
+        samples_until_ready++;
+    }
+
+    printf("%-14s %10s %12.1f %12.2f\n", "total", "", total_clear, total_init);
+    printf("ReverbSc is ready after %zu samples (%.1f ms)\n",
+           samples_until_ready,
+           1000.0f * samples_until_ready / kSampleRate);
+    return 0;
+}
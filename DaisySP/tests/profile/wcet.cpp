@@ -0,0 +1,293 @@
+#include "wcet.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+
+namespace daisysp
+{
+namespace profile
+{
+namespace
+{
+typedef std::chrono::steady_clock Clock;
+
+/** Keeps results alive so the compiler can't remove the timed calls */
+volatile float sink;
+
+constexpr float kSubnormalLevel = 1.0e-39f;
+
+double ElapsedNs(Clock::time_point start, Clock::time_point end)
+{
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+double Percentile(const std::vector<double>& sorted, double p)
+{
+    if(sorted.empty())
+        return 0.0;
+    const size_t idx = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[idx];
+}
+
+/** Times one call and appends the result. Returns the time in ns. */
+template <typename Fn>
+double TimeCall(std::vector<double>& timings, double overhead_ns, Fn fn)
+{
+    const auto start = Clock::now();
+    fn();
+    const auto   end = Clock::now();
+    const double ns  = std::max(0.0, ElapsedNs(start, end) - overhead_ns);
+    timings.push_back(ns);
+    return ns;
+}
+
+Stats MakeStats(const std::string&   module,
+                const std::string&   method,
+                std::vector<double>& timings,
+                Schedule             max_schedule)
+{
+    std::sort(timings.begin(), timings.end());
+    Stats s;
+    s.module       = module;
+    s.method       = method;
+    s.calls        = timings.size();
+    s.mean_ns      = timings.empty() ? 0.0
+                                     : std::accumulate(timings.begin(),
+                                                       timings.end(),
+                                                       0.0)
+                                      / timings.size();
+    s.p50_ns       = Percentile(timings, 0.5);
+    s.p99_ns       = Percentile(timings, 0.99);
+    s.max_ns       = timings.empty() ? 0.0 : timings.back();
+    s.max_schedule = max_schedule;
+    s.budget_ns    = 0.0;
+    s.over_budget  = false;
+    return s;
+}
+} // namespace
+
+const char* GetScheduleName(Schedule schedule)
+{
+    switch(schedule)
+    {
+        case Schedule::RANDOM_JUMPS: return "random";
+        case Schedule::EXTREMES: return "extremes";
+        case Schedule::DENORMALS: return "denormals";
+        default: return "";
+    }
+}
+
+double GetTimerOverheadNs()
+{
+    static double overhead = -1.0;
+    if(overhead < 0.0)
+    {
+        std::vector<double> timings;
+        timings.reserve(10000);
+        for(int i = 0; i < 10000; i++)
+            TimeCall(timings, 0.0, [] {});
+        std::sort(timings.begin(), timings.end());
+        overhead = Percentile(timings, 0.5);
+    }
+    return overhead;
+}
+
+ModuleProfile::ModuleProfile(const std::string& name, const Config& config)
+: name_(name),
+  config_(config),
+  process_max_schedule_(Schedule::RANDOM_JUMPS),
+  random_state_(config.seed)
+{
+}
+
+void ModuleProfile::AddSetter(const std::string& name,
+                              Range              range,
+                              SetterFn           setter)
+{
+    setters_.push_back({name, range, setter, {}, 0.0, Schedule::RANDOM_JUMPS});
+}
+
+void ModuleProfile::SetProcess(ProcessFn process)
+{
+    process_ = process;
+}
+
+float ModuleProfile::NextRandom()
+{
+    random_state_ = random_state_ * 1664525u + 1013904223u;
+    return float(random_state_ >> 8) / float(1 << 24);
+}
+
+float ModuleProfile::GetSetterValue(const Range& range,
+                                    Schedule     schedule,
+                                    size_t       block)
+{
+    switch(schedule)
+    {
+        case Schedule::RANDOM_JUMPS:
+        {
+            const float r = NextRandom();
+            if(range.log && range.min > 0.0f)
+                return range.min * powf(range.max / range.min, r);
+            return range.min + r * (range.max - range.min);
+        }
+        case Schedule::EXTREMES:
+        {
+            // min, max, and just above min, which often hits edge cases in
+            // log/exp based coefficient calculations
+            const float near_min = range.min + (range.max - range.min) * 1e-6f;
+            const float values[] = {range.min, range.max, near_min};
+            return values[block % 3];
+        }
+        default: return range.max;
+    }
+}
+
+float ModuleProfile::GetInput(Schedule schedule, size_t sample)
+{
+    switch(schedule)
+    {
+        case Schedule::RANDOM_JUMPS: return NextRandom() * 2.0f - 1.0f;
+        case Schedule::EXTREMES: return (sample / 64) % 2 ? 1.0f : -1.0f;
+        case Schedule::DENORMALS:
+            if(sample == 0)
+                return 1.0f;
+            return (NextRandom() * 2.0f - 1.0f) * kSubnormalLevel;
+        default: return 0.0f;
+    }
+}
+
+bool ModuleProfile::GetTrigger(Schedule schedule, size_t block)
+{
+    switch(schedule)
+    {
+        case Schedule::RANDOM_JUMPS: return NextRandom() < 0.25f;
+        case Schedule::EXTREMES: return true;
+        case Schedule::DENORMALS: return block == 0;
+        default: return false;
+    }
+}
+
+std::vector<Stats> ModuleProfile::Run()
+{
+    const double overhead      = GetTimerOverheadNs();
+    const size_t total_samples = config_.num_blocks * config_.block_size
+                                 * static_cast<size_t>(Schedule::LAST);
+    process_timings_.clear();
+    process_timings_.reserve(total_samples);
+    for(auto& setter : setters_)
+    {
+        setter.timings.clear();
+        setter.timings.reserve(config_.num_blocks
+                               * static_cast<size_t>(Schedule::LAST));
+        setter.max_ns = 0.0;
+    }
+
+    double process_max = 0.0;
+    for(int s = 0; s < static_cast<int>(Schedule::LAST); s++)
+    {
+        const auto schedule = static_cast<Schedule>(s);
+        size_t     sample   = 0;
+        for(size_t block = 0; block < config_.num_blocks; block++)
+        {
+            for(auto& setter : setters_)
+            {
+                const float value
+                    = GetSetterValue(setter.range, schedule, block);
+                const double ns = TimeCall(
+                    setter.timings, overhead, [&] { setter.fn(value); });
+                if(ns > setter.max_ns)
+                {
+                    setter.max_ns       = ns;
+                    setter.max_schedule = schedule;
+                }
+            }
+
+            bool trigger = GetTrigger(schedule, block);
+            for(size_t i = 0; i < config_.block_size; i++, sample++)
+            {
+                const float  in = GetInput(schedule, sample);
+                const double ns = TimeCall(process_timings_, overhead, [&] {
+                    sink = process_(in, trigger);
+                });
+                if(ns > process_max)
+                {
+                    process_max           = ns;
+                    process_max_schedule_ = schedule;
+                }
+                trigger = false;
+            }
+        }
+    }
+
+    std::vector<Stats> result;
+    result.push_back(
+        MakeStats(name_, "Process", process_timings_, process_max_schedule_));
+    const double budget = config_.setter_budget_ns > 0.0
+                              ? config_.setter_budget_ns
+                              : config_.setter_budget * config_.block_size
+                                    * result[0].mean_ns;
+    for(auto& setter : setters_)
+    {
+        Stats s = MakeStats(
+            name_, setter.name, setter.timings, setter.max_schedule);
+        s.budget_ns   = budget;
+        s.over_budget = s.p99_ns > budget;
+        result.push_back(s);
+    }
+    return result;
+}
+
+void PrintStats(const std::vector<Stats>& stats)
+{
+    printf("%-22s %-22s %9s %9s %9s %9s %10s %-10s %s\n",
+           "module",
+           "method",
+           "calls",
+           "mean ns",
+           "p50 ns",
+           "p99 ns",
+           "max ns",
+           "max in",
+           "budget");
+    for(const auto& s : stats)
+    {
+        printf("%-22s %-22s %9zu %9.1f %9.1f %9.1f %10.1f %-10s",
+               s.module.c_str(),
+               s.method.c_str(),
+               s.calls,
+               s.mean_ns,
+               s.p50_ns,
+               s.p99_ns,
+               s.max_ns,
+               GetScheduleName(s.max_schedule));
+        if(s.budget_ns > 0.0)
+            printf(" %.1f%s",
+                   s.budget_ns,
+                   s.over_budget ? "  OVER BUDGET" : "");
+        printf("\n");
+    }
+}
+
+bool WriteCsv(const std::string& path, const std::vector<Stats>& stats)
+{
+    std::ofstream file(path);
+    if(!file)
+        return false;
+    file << "module,method,calls,mean_ns,p50_ns,p99_ns,max_ns,max_schedule,"
+            "budget_ns,over_budget\n";
+    for(const auto& s : stats)
+    {
+        file << s.module << ',' << s.method << ',' << s.calls << ','
+             << s.mean_ns << ',' << s.p50_ns << ',' << s.p99_ns << ','
+             << s.max_ns << ',' << GetScheduleName(s.max_schedule) << ','
+             << s.budget_ns << ',' << (s.over_budget ? 1 : 0) << '\n';
+    }
+    return bool(file);
+}
+
+} // namespace profile
+} // namespace daisysp
@@ -0,0 +1,151 @@
+#pragma once
+#ifndef DSY_TEST_WCET_H
+#define DSY_TEST_WCET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/** @brief Worst case execution time profiling for DaisySP modules on the host
+ *
+ *  Every module is run under a set of adversarial parameter schedules, and
+ *  every single call to `Process()` and to each setter is timed. The
+ *  resulting latency distributions (p50/p99/max) show the spikes that
+ *  average ns/sample figures hide.
+ *
+ *  A setter is flagged when its p99 cost exceeds a fraction of the average
+ *  time the module needs to process one block. The p99 is used instead of the max,
+ *  since the max of a host measurement includes OS scheduling noise.
+ */
+namespace daisysp
+{
+namespace profile
+{
+/** The parameter and input schedules every module is run with */
+enum class Schedule
+{
+    /** Setters jump to random values, input is white noise */
+    RANDOM_JUMPS,
+    /** Setters alternate between the ends of their ranges, input is a
+     *  full scale square wave
+     */
+    EXTREMES,
+    /** One impulse followed by subnormal level input, setters stay at the
+     *  ends of their ranges to produce long decays
+     */
+    DENORMALS,
+    LAST,
+};
+
+/** Returns a printable name for a schedule */
+const char* GetScheduleName(Schedule schedule);
+
+/** Settings that apply to all modules */
+struct Config
+{
+    float    sample_rate = 48000.0f;
+    size_t   block_size  = 48;
+    /** Number of blocks run per schedule */
+    size_t   num_blocks = 1000;
+    /** Setters may cost at most this fraction of the module's
+     *  average processing time per block
+     */
+    float    setter_budget = 0.25f;
+    /** If > 0, an absolute setter budget in ns that replaces the relative one */
+    double   setter_budget_ns = 0.0;
+    uint32_t seed             = 1;
+};
+
+/** The range of values a setter is exercised with */
+struct Range
+{
+    float min;
+    float max;
+    /** Random values are distributed logarithmically, e.g. for frequencies */
+    bool log = false;
+};
+
+/** The latency distribution of one method */
+struct Stats
+{
+    std::string module;
+    std::string method;
+    size_t      calls;
+    double      mean_ns;
+    double      p50_ns;
+    double      p99_ns;
+    double      max_ns;
+    /** The schedule during which the max was measured */
+    Schedule    max_schedule;
+    double      budget_ns;
+    bool        over_budget;
+};
+
+/** Profiles a single module.
+ *
+ *  Register the setters with `AddSetter()` and the per sample processing with
+ *  `SetProcess()`, then call `Run()`. The process function receives the
+ *  input sample and a trigger flag, which is set at the start of some blocks
+ *  and can be used for gates and triggers.
+ */
+class ModuleProfile
+{
+  public:
+    typedef std::function<void(float)>        SetterFn;
+    typedef std::function<float(float, bool)> ProcessFn;
+
+    ModuleProfile(const std::string& name, const Config& config);
+
+    /** Adds a setter that's called once per block with a scheduled value */
+    void AddSetter(const std::string& name, Range range, SetterFn setter);
+
+    /** Sets the function that's called for every sample */
+    void SetProcess(ProcessFn process);
+
+    /** Runs all schedules and returns one entry for `Process` followed by one
+     *  entry per setter
+     */
+    std::vector<Stats> Run();
+
+  private:
+    struct Setter
+    {
+        std::string         name;
+        Range               range;
+        SetterFn            fn;
+        std::vector<double> timings;
+        double              max_ns;
+        Schedule            max_schedule;
+    };
+
+    float NextRandom();
+    float GetSetterValue(const Range& range, Schedule schedule, size_t block);
+    float GetInput(Schedule schedule, size_t sample);
+    bool  GetTrigger(Schedule schedule, size_t block);
+
+    std::string         name_;
+    Config              config_;
+    std::vector<Setter> setters_;
+    ProcessFn           process_;
+    std::vector<double> process_timings_;
+    Schedule            process_max_schedule_;
+    uint32_t            random_state_;
+};
+
+/** Returns the overhead of one timed call in ns, which is subtracted from
+ *  all measurements
+ */
+double GetTimerOverheadNs();
+
+/** Prints a table of results to stdout */
+void PrintStats(const std::vector<Stats>& stats);
+
+/** Writes results as CSV, returns false if the file can't be written */
+bool WriteCsv(const std::string& path, const std::vector<Stats>& stats);
+
+} // namespace profile
+} // namespace daisysp
+
+#endif
@@ -795,6 +795,81 @@ USBH_StatusTypeDef USBH_MSC_Read(USBH_HandleTypeDef *phost,
   return USBH_OK;
 }
 
+/**
+  * @brief  USBH_MSC_ReadStart
+  *         The function starts a Read operation without waiting for it,
+  *         USBH_MSC_ReadPoll then advances it
+  * @param  phost: Host handle
+  * @param  lun: logical Unit Number
+  * @param  address: sector address
+  * @param  pbuf: pointer to data
+  * @param  length: number of sector to read
+  * @retval USBH Status
+  */
+USBH_StatusTypeDef USBH_MSC_ReadStart(USBH_HandleTypeDef *phost,
+                                      uint8_t lun,
+                                      uint32_t address,
+                                      uint8_t *pbuf,
+                                      uint32_t length)
+{
+  MSC_HandleTypeDef *MSC_Handle = (MSC_HandleTypeDef *) phost->pActiveClass->pData;
+
+  if ((phost->device.is_connected == 0U) ||
+      (phost->gState != HOST_CLASS) ||
+      (MSC_Handle->unit[lun].state != MSC_IDLE))
+  {
+    return  USBH_FAIL;
+  }
+
+  MSC_Handle->state = MSC_READ;
+  MSC_Handle->unit[lun].state = MSC_READ;
+  MSC_Handle->rw_lun = lun;
+
+  USBH_MSC_SCSI_Read(phost, lun, address, pbuf, length);
+
+  MSC_Handle->timer = phost->Timer;
+
+  return USBH_OK;
+}
+
+/**
+  * @brief  USBH_MSC_ReadPoll
+  *         The function advances a Read operation started by
+  *         USBH_MSC_ReadStart, with the timeout of USBH_MSC_Read
+  * @param  phost: Host handle
+  * @param  lun: logical Unit Number
+  * @retval USBH Status: USBH_BUSY until the data is received
+  */
+USBH_StatusTypeDef USBH_MSC_ReadPoll(USBH_HandleTypeDef *phost, uint8_t lun)
+{
+  MSC_HandleTypeDef *MSC_Handle = (MSC_HandleTypeDef *) phost->pActiveClass->pData;
+  USBH_StatusTypeDef status;
+  uint32_t length;
+
+  if (MSC_Handle->state != MSC_READ)
+  {
+    return USBH_FAIL;
+  }
+
+  status = USBH_MSC_RdWrProcess(phost, lun);
+  if (status != USBH_BUSY)
+  {
+    MSC_Handle->state = MSC_IDLE;
+    return status;
+  }
+
+  length = MSC_Handle->hbot.cbw.field.DataTransferLength /
+           MSC_Handle->unit[lun].capacity.block_size;
+
+  if (((phost->Timer - MSC_Handle->timer) > (10000U * length)) || (phost->device.is_connected == 0U))
+  {
+    MSC_Handle->state = MSC_IDLE;
+    return USBH_FAIL;
+  }
+
+  return USBH_BUSY;
+}
+
 /**
   * @brief  USBH_MSC_Write
   *         The function performs a Write operation
@@ -60,15 +60,27 @@
 #include "ui/UiEventQueue.h"
 #include "ui/AbstractMenu.h"
 #include "ui/FullScreenItemMenu.h"
+#include "ui/ScopePage.h"
+#include "ui/SpectrumPage.h"
 #include "util/scopedirqblocker.h"
+#include "util/ScopedFlushToZero.h"
 #include "util/CpuLoadMeter.h"
 #include "util/FIFO.h"
 #include "util/FixedCapStr.h"
 #include "util/MappedValue.h"
 #include "util/PersistentStorage.h"
+#include "util/PresetBank.h"
+#include "util/RtSafetyChecker.h"
 #include "util/Stack.h"
 #include "util/VoctCalibration.h"
 #include "util/WaveTableLoader.h"
+#include "util/WavReader.h"
+#include "util/WavIndex.h"
+#include "util/ReadAheadCache.h"
+#include "util/BlockCache.h"
+#include "util/AudioScopeTap.h"
+#include "util/TaskScheduler.h"
+#include "util/SampleCatalog.h"
 #include "util/WavWriter.h"
 #endif
 #endif
@@ -359,6 +359,34 @@ class SSD130xDriver
             buffer_[x + (y / 8) * width] &= ~(1 << (y % 8));
     }
 
+    void DrawVerticalSpan(uint_fast8_t x,
+                          uint_fast8_t y1,
+                          uint_fast8_t y2,
+                          bool         on)
+    {
+        if(y1 > y2)
+        {
+            const uint_fast8_t y = y1;
+            y1                   = y2;
+            y2                   = y;
+        }
+        if(x >= width || y1 >= height)
+            return;
+        if(y2 >= height)
+            y2 = height - 1;
+        // a byte per page of 8 rows
+        for(size_t page = y1 / 8; page <= y2 / 8u; page++)
+        {
+            const uint_fast8_t top    = page == y1 / 8u ? y1 % 8 : 0;
+            const uint_fast8_t bottom = page == y2 / 8u ? y2 % 8 : 7;
+            const uint8_t      mask   = (0xff << top) & (0xff >> (7 - bottom));
+            if(on)
+                buffer_[x + page * width] |= mask;
+            else
+                buffer_[x + page * width] &= ~mask;
+        }
+    }
+
     void Fill(bool on)
     {
         for(size_t i = 0; i < sizeof(buffer_); i++)
@@ -1,4 +1,6 @@
 #include "hid/audio.h"
+#include "util/RtSafetyChecker.h"
+#include "util/ScopedFlushToZero.h"
 
 namespace daisy
 {
@@ -318,7 +320,14 @@ void AudioHandle::Impl::InternalCallback(int32_t* in, int32_t* out, size_t size)
                 break;
             default: break;
         }
-        cb(fin, fout, size);
+        {
+#ifdef DEBUG
+            // costs two reads of the timer per block
+            RtSafetyChecker::ScopedAudioThread rt_scope;
+#endif
+            ScopedFlushToZero ftz;
+            cb(fin, fout, size);
+        }
         switch(bd)
         {
             case SaiHandle::Config::BitDepth::SAI_16BIT:
@@ -424,7 +433,14 @@ void AudioHandle::Impl::InternalCallback(int32_t* in, int32_t* out, size_t size)
                 break;
             default: break;
         }
-        cb(fin, fout, size / 2);
+        {
+#ifdef DEBUG
+            // costs two reads of the timer per block
+            RtSafetyChecker::ScopedAudioThread rt_scope;
+#endif
+            ScopedFlushToZero ftz;
+            cb(fin, fout, size / 2);
+        }
         // Reinterleave and scale
         switch(bd)
         {
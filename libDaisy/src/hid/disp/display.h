@@ -48,6 +48,21 @@ class OneBitGraphicsDisplay
     */
     virtual void DrawPixel(uint_fast8_t x, uint_fast8_t y, bool on) = 0;
 
+    /**
+    Sets the pixels of a column from y1 to y2, both included, to be on/off,
+    e.g. for the bars of a meter or the envelope of a scope. Displays that
+    keep 8 pixels of a column in one byte set a whole byte at a time.
+    \param x   x Coordinate
+    \param y1  y Coordinate of one end
+    \param y2  y Coordinate of the other end
+    \param on  on or off
+    */
+    virtual void DrawVerticalSpan(uint_fast8_t x,
+                                  uint_fast8_t y1,
+                                  uint_fast8_t y2,
+                                  bool         on)
+        = 0;
+
     /**
     Draws a line from (x1, y1) to (y1, y2)
     \param x1  x Coordinate of the starting point
@@ -218,6 +233,25 @@ class OneBitGraphicsDisplayImpl : public OneBitGraphicsDisplay
     OneBitGraphicsDisplayImpl() {}
     virtual ~OneBitGraphicsDisplayImpl() {}
 
+    void DrawVerticalSpan(uint_fast8_t x,
+                          uint_fast8_t y1,
+                          uint_fast8_t y2,
+                          bool         on) override
+    {
+        if(y1 > y2)
+        {
+            const uint_fast8_t y = y1;
+            y1                   = y2;
+            y2                   = y;
+        }
+        for(uint_fast8_t y = y1; y <= y2; y++)
+        {
+            ((ChildType*)(this))->ChildType::DrawPixel(x, y, on);
+            if(y == 255)
+                break;
+        }
+    }
+
     void DrawLine(uint_fast8_t x1,
                   uint_fast8_t y1,
                   uint_fast8_t x2,
@@ -44,6 +44,21 @@ class OledDisplay : public OneBitGraphicsDisplayImpl<OledDisplay<DisplayDriver>>
         driver_.DrawPixel(x, y, on);
     }
 
+    /**
+    Sets the pixels of a column from y1 to y2 to be on/off, a byte at a time.
+    \param x   x Coordinate
+    \param y1  y Coordinate of one end
+    \param y2  y Coordinate of the other end
+    \param on  on or off
+    */
+    void DrawVerticalSpan(uint_fast8_t x,
+                          uint_fast8_t y1,
+                          uint_fast8_t y2,
+                          bool         on) override
+    {
+        driver_.DrawVerticalSpan(x, y1, y2, on);
+    }
+
     /** 
     Writes the current display buffer to the OLED device using SPI or I2C depending on 
     how the object was initialized.
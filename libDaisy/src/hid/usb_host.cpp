@@ -3,6 +3,8 @@
 #include "daisy_core.h"
 #include "usbh_core.h"
 #include "usbh_msc.h"
+#include "ff_gen_drv.h"
+#include "util/usbh_diskio.h"
 
 using namespace daisy;
 
@@ -29,8 +31,40 @@ class USBHostHandle::Impl
 
     inline Config &GetConfig() { return config_; }
 
+    inline ReadAheadCache &GetReadCache() { return cache_; }
+
   private:
-    Config config_;
+    Config            config_;
+    ReadAheadCache    cache_;
+    USBH_CacheTypeDef cache_hooks_;
+
+    static bool StartRead(void *, uint8_t *buffer, uint32_t sector, uint32_t n)
+    {
+        return USBH_ReadStart(0, buffer, sector, n) == USBH_OK;
+    }
+
+    static ReadAheadCache::Transfer PollRead(void *)
+    {
+        switch(USBH_ReadPoll(0))
+        {
+            case USBH_BUSY: return ReadAheadCache::Transfer::BUSY;
+            case USBH_OK: return ReadAheadCache::Transfer::DONE;
+            default: return ReadAheadCache::Transfer::FAILED;
+        }
+    }
+
+    static DRESULT CacheRead(void *context, BYTE *buff, DWORD sector, UINT n)
+    {
+        auto *cache = static_cast<ReadAheadCache *>(context);
+        return cache->Read(buff, sector, n) == ReadAheadCache::Result::OK
+                   ? RES_OK
+                   : RES_ERROR;
+    }
+
+    static void CacheInvalidate(void *context, DWORD sector, UINT n)
+    {
+        static_cast<ReadAheadCache *>(context)->Invalidate(sector, n);
+    }
 
     /** @brief Maps ST Middleware USBH_StatusTypeDef to USBHostHandle::Result codes */
     Result ConvertStatus(USBH_StatusTypeDef sta)
@@ -60,6 +94,20 @@ static void USBH_UserProcess(USBH_HandleTypeDef *phost, uint8_t id);
 USBHostHandle::Result USBHostHandle::Impl::Init(USBHostHandle::Config config)
 {
     config_ = config;
+
+    // The MSC driver reads through the cache when there is one
+    const ReadAheadCache::Device device = {StartRead, PollRead, nullptr};
+    if(config_.read_cache.buffer != nullptr
+       && cache_.Init(config_.read_cache, device) == ReadAheadCache::Result::OK)
+    {
+        cache_hooks_ = {CacheRead, CacheInvalidate, &cache_};
+        USBH_SetCache(&cache_hooks_);
+    }
+    else
+    {
+        USBH_SetCache(nullptr);
+    }
+
     /* Init host Library, add supported class and start the library. */
     USBH_StatusTypeDef sta;
     sta = USBH_Init(&hUsbHostHS, USBH_UserProcess, HOST_HS);
@@ -89,7 +137,10 @@ USBHostHandle::Result USBHostHandle::Impl::Deinit()
 
 USBHostHandle::Result USBHostHandle::Impl::Process()
 {
-    return ConvertStatus(USBH_Process(&hUsbHostHS));
+    const Result result = ConvertStatus(USBH_Process(&hUsbHostHS));
+    if(cache_.IsEnabled() && hUsbHostHS.gState == HOST_CLASS)
+        cache_.Process();
+    return result;
 }
 
 USBHostHandle::Result USBHostHandle::Impl::ReEnumerate()
@@ -99,7 +150,9 @@ USBHostHandle::Result USBHostHandle::Impl::ReEnumerate()
 
 bool USBHostHandle::Impl::GetReady()
 {
-    return (bool)USBH_MSC_IsReady(&hUsbHostHS);
+    // a read ahead in progress keeps the unit busy, but ready
+    return (bool)USBH_MSC_IsReady(&hUsbHostHS)
+           || (cache_.IsBusy() && hUsbHostHS.gState == HOST_CLASS);
 }
 
 // MSDHandle -> Impl
@@ -130,6 +183,12 @@ USBHostHandle::Result USBHostHandle::ReEnumerate()
     return pimpl_->ReEnumerate();
 }
 
+ReadAheadCache *USBHostHandle::GetReadCache()
+{
+    auto &cache = pimpl_->GetReadCache();
+    return cache.IsEnabled() ? &cache : nullptr;
+}
+
 bool USBHostHandle::GetPresent()
 {
     auto state = hUsbHostHS.gState;
@@ -165,6 +224,8 @@ static void USBH_UserProcess(USBH_HandleTypeDef *phost, uint8_t id)
             break;
         case HOST_USER_DISCONNECTION:
             Appli_state = APPLICATION_DISCONNECT;
+            // the next drive starts from an empty cache
+            msd_impl.GetReadCache().Invalidate();
             if(conf.disconnect_callback)
             {
                 auto cb = (conf.disconnect_callback);
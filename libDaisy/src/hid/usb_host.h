@@ -2,6 +2,7 @@
 #define DSY_MSD
 
 #include <cstdint>
+#include "util/ReadAheadCache.h"
 
 namespace daisy
 {
@@ -82,6 +83,11 @@ class USBHostHandle
         ClassActiveCallback class_active_callback;
         ErrorCallback       error_callback;
         void*               userdata;
+
+        /** Lines of the sector cache of the drive, see ReadAheadCache.
+         *  Without a buffer, FatFs reads the drive directly.
+         */
+        ReadAheadCache::Config read_cache;
     };
 
     /** Initializes the USB drivers and starts timeout.
@@ -115,6 +121,12 @@ class USBHostHandle
      */
     bool GetPresent();
 
+    /** Returns the read cache of the drive, to give it hints and read its
+     *  statistics, or nullptr when Config::read_cache has no buffer.
+     *  `Process` advances its read ahead.
+     */
+    ReadAheadCache* GetReadCache();
+
     USBHostHandle() : pimpl_(nullptr) {}
     USBHostHandle(const USBHostHandle& other) = default;
     USBHostHandle& operator=(const USBHostHandle& other) = default;
@@ -5,87 +5,60 @@ using namespace daisy;
 
 void WavPlayer::Init(const char *search_path)
 {
-    // First check for all .wav files, and add them to the list until its full or there are no more.
-    // Only checks '/'
-    FRESULT result = FR_OK;
-    FILINFO fno;
-    DIR     dir;
-    char *  fn;
+    Init(search_path, records_, kMaxFiles);
+}
+
+void WavPlayer::Init(const char *      search_path,
+                     WavIndex::Record *records,
+                     size_t            max_files)
+{
     file_sel_ = 0;
-    file_cnt_ = 0;
     playing_  = true;
     looping_  = false;
-    // Open Dir and scan for files.
-    if(f_opendir(&dir, search_path) != FR_OK)
-    {
-        return;
-    }
-    do
-    {
-        result = f_readdir(&dir, &fno);
-        // Exit if bad read or NULL fname
-        if(result != FR_OK || fno.fname[0] == 0)
-            break;
-        // Skip if its a directory or a hidden file.
-        if(fno.fattrib & (AM_HID | AM_DIR))
-            continue;
-        // Now we'll check if its .wav and add to the list.
-        fn = fno.fname;
-        if(file_cnt_ < kMaxFiles - 1)
-        {
-            if(strstr(fn, ".wav") || strstr(fn, ".WAV"))
-            {
-                strcpy(file_info_[file_cnt_].name, search_path);
-                strcat(file_info_[file_cnt_].name, fn);
-                file_cnt_++;
-                // For now lets break anyway to test.
-                //                break;
-            }
-        }
-        else
-        {
-            break;
-        }
-    } while(result == FR_OK);
-    f_closedir(&dir);
-    // Now we'll go through each file and load the WavInfo.
-    for(size_t i = 0; i < file_cnt_; i++)
-    {
-        size_t bytesread;
-        if(f_open(&fil_, file_info_[i].name, (FA_OPEN_EXISTING | FA_READ))
-           == FR_OK)
-        {
-            // Populate the WAV Info
-            if(f_read(&fil_,
-                      (void *)&file_info_[i].raw_data,
-                      sizeof(WAV_FormatTypeDef),
-                      &bytesread)
-               != FR_OK)
-            {
-                // Maybe add return type
-                return;
-            }
-            f_close(&fil_);
-        }
-    }
+    // Lists the directory, the headers are read as the files are opened
+    index_.Init(search_path, records, max_files);
+    file_cnt_ = index_.GetNumFiles();
     // fill buffer with first file preemptively.
-    buff_state_ = BUFFER_STATE_PREPARE_0;
-    Open(0);
-    Prepare();
-    read_ptr_ = 0;
+    if(file_cnt_ > 0)
+        Open(0);
 }
 
 
 int WavPlayer::Open(size_t sel)
 {
+    if(file_cnt_ == 0)
+        return FR_NO_FILE;
     if(sel != file_sel_)
     {
         f_close(&fil_);
         file_sel_ = sel < file_cnt_ ? sel : file_cnt_ - 1;
     }
-    // Set Buffer Position
-    return f_open(
-        &fil_, file_info_[file_sel_].name, (FA_OPEN_EXISTING | FA_READ));
+    buff_state_ = BUFFER_STATE_IDLE;
+    channels_   = 1;
+    half_size_  = kBufferSize / 2;
+    read_ptr_   = 0;
+    memset(buff_, 0, sizeof(buff_));
+
+    char path[WavIndex::kPathLength];
+    if(!index_.GetPath(file_sel_, path, sizeof(path)))
+        return FR_INVALID_NAME;
+    int result = f_open(&fil_, path, (FA_OPEN_EXISTING | FA_READ));
+    if(result != FR_OK)
+        return result;
+    if(reader_.Open(&fil_) != WavReader::Result::OK)
+    {
+        playing_ = false;
+        return FR_INT_ERR;
+    }
+    index_.Update(file_sel_, reader_);
+
+    // Each half of the buffer holds whole frames
+    channels_  = reader_.GetFormat().num_channels;
+    half_size_ = (kBufferSize / 2 / channels_) * channels_;
+    playing_   = true;
+    Fill(&buff_[0]);
+    Fill(&buff_[half_size_]);
+    return FR_OK;
 }
 
 int WavPlayer::Close()
@@ -93,69 +66,85 @@ int WavPlayer::Close()
     return f_close(&fil_);
 }
 
-int16_t WavPlayer::Stream()
+const float *WavPlayer::NextFrame()
 {
-    int16_t samp;
-    if(playing_)
-    {
-        samp = buff_[read_ptr_];
-        // Increment rpo
-        read_ptr_ = (read_ptr_ + 1) % kBufferSize;
-        if(read_ptr_ == 0)
-            buff_state_ = BUFFER_STATE_PREPARE_1;
-        else if(read_ptr_ == kBufferSize / 2)
-            buff_state_ = BUFFER_STATE_PREPARE_0;
-    }
-    else
+    static const float kSilence[WavReader::kMaxChannels] = {};
+    if(!playing_)
     {
-        samp = 0;
         if(looping_)
             playing_ = true;
+        return kSilence;
     }
-    return samp;
+    const float *frame = &buff_[read_ptr_];
+    // Increment rpo
+    read_ptr_ += channels_;
+    if(read_ptr_ >= 2 * half_size_)
+    {
+        read_ptr_   = 0;
+        buff_state_ = BUFFER_STATE_PREPARE_1;
+    }
+    else if(read_ptr_ == half_size_)
+    {
+        buff_state_ = BUFFER_STATE_PREPARE_0;
+    }
+    return frame;
+}
+
+int16_t WavPlayer::Stream()
+{
+    return f2s16(NextFrame()[0]);
+}
+
+void WavPlayer::Stream(float *out)
+{
+    memcpy(out, NextFrame(), channels_ * sizeof(float));
 }
 
 void WavPlayer::Prepare()
 {
     if(buff_state_ != BUFFER_STATE_IDLE)
     {
-        size_t offset, bytesread, rxsize;
-        bytesread = 0;
-        rxsize    = (kBufferSize / 2) * sizeof(buff_[0]);
-        offset    = buff_state_ == BUFFER_STATE_PREPARE_1 ? kBufferSize / 2 : 0;
-        f_read(&fil_, &buff_[offset], rxsize, &bytesread);
-        if(bytesread < rxsize || f_eof(&fil_))
+        const size_t offset
+            = buff_state_ == BUFFER_STATE_PREPARE_1 ? half_size_ : 0;
+        Fill(&buff_[offset]);
+        buff_state_ = BUFFER_STATE_IDLE;
+    }
+}
+
+void WavPlayer::Fill(float *dst)
+{
+    const size_t frames = half_size_ / channels_;
+    size_t       read   = reader_.Read(dst, frames);
+    if(read < frames)
+    {
+        if(looping_)
         {
-            if(looping_)
-            {
-                Restart();
-                f_read(&fil_,
-                       &buff_[offset + (bytesread / 2)],
-                       rxsize - bytesread,
-                       &bytesread);
-            }
-            else
-            {
-                playing_ = false;
-            }
+            Restart();
+            read += reader_.Read(&dst[read * channels_], frames - read);
         }
-        buff_state_ = BUFFER_STATE_IDLE;
+        else
+        {
+            playing_ = false;
+        }
+        const size_t left = (frames - read) * channels_;
+        memset(&dst[read * channels_], 0, left * sizeof(float));
     }
+    // the next refill reads as much
+    if(read_ahead_ != nullptr)
+        read_ahead_->HintFile(&fil_, frames * reader_.GetFormat().block_align);
 }
 
 void WavPlayer::Restart()
 {
     playing_ = true;
-    f_lseek(&fil_,
-            sizeof(WAV_FormatTypeDef)
-                + file_info_[file_sel_].raw_data.SubChunk1Size);
+    reader_.Rewind();
 }
 
 WavPlayer::BufferState WavPlayer::GetNextBuffState()
 {
     size_t next_samp;
-    next_samp = (read_ptr_ + 1) % kBufferSize;
-    if(next_samp < kBufferSize / 2)
+    next_samp = (read_ptr_ + channels_) % (2 * half_size_);
+    if(next_samp < half_size_)
     {
         return BUFFER_STATE_PREPARE_1;
     }
@@ -1,6 +1,7 @@
 /* Current Limitations:
-- 1x Playback speed only
-- 16-bit, mono files only (otherwise fun weirdness can happen).
+- Frames are streamed at the rate of the audio engine. Files at another rate
+play at the wrong pitch unless they go through a resampler, e.g. a
+daisysp::Resampler set to GetSampleRate() / the audio sample rate.
 - Only 1 file playing back at a time.
 - Not sure how this would interfere with trying to use the SDCard/FatFs outside of
 this module. However, by using the extern'd SDFile, etc. I think that would break things.
@@ -10,21 +11,13 @@ this module. However, by using the extern'd SDFile, etc. I think that would brea
 #define DSY_WAVPLAYER_H /**< Macro */
 #include "daisy_core.h"
 #include "util/wav_format.h"
+#include "util/WavReader.h"
+#include "util/WavIndex.h"
+#include "util/ReadAheadCache.h"
 #include "ff.h"
 
-#define WAV_FILENAME_MAX \
-    256 /**< Maximum LFN (set to same in FatFs (ffconf.h) */
-
 namespace daisy
 {
-// TODO: add bitrate, samplerate, length, etc.
-/** Struct containing details of Wav File. */
-struct WavFileInfo
-{
-    WAV_FormatTypeDef raw_data;               /**< Raw wav data */
-    char              name[WAV_FILENAME_MAX]; /**< Wav filename */
-};
-
 /* 
 TODO:
 - Make template-y to reduce memory usage.
@@ -33,16 +26,34 @@ TODO:
 
 /** Wav Player that will load .wav files from an SD Card,
 and then provide a method of accessing the samples with
-double-buffering. */
+double-buffering. 
+
+Files are read with a WavReader, so any of its formats and
+any number of channels can be played.
+
+The files of the directory are listed by a WavIndex, in the order of
+their names. The headers are only read when a file is opened, and kept
+in the index file of the directory for the next boot. */
 class WavPlayer
 {
   public:
-    WavPlayer() {}
+    WavPlayer() : read_ahead_(nullptr) {}
     ~WavPlayer() {}
 
-    /** Initializes the WavPlayer, loading up to max_files of wav files from an SD Card. */
+    /** Initializes the WavPlayer with up to kMaxFiles wav files of a
+    directory of an SD Card, and opens the first one. */
     void Init(const char* search_path);
 
+    /** Initializes the WavPlayer with the records of an application, for
+    directories with many files.
+    \param search_path directory of the files
+    \param records memory for the index, e.g. in SDRAM
+    \param max_files number of records
+    */
+    void Init(const char*       search_path,
+              WavIndex::Record* records,
+              size_t            max_files);
+
     /** Opens the file at index sel for reading.
     \param sel File to open
      */
@@ -53,9 +64,14 @@ class WavPlayer
      */
     int Close();
 
-    /** \return The next sample if playing, otherwise returns 0 */
+    /** \return The next sample of the first channel if playing, otherwise returns 0 */
     int16_t Stream();
 
+    /** Writes the next frame if playing, otherwise zeros.
+    \param out One sample per channel of the file, GetNumChannels() floats
+    */
+    void Stream(float* out);
+
     /** Collects buffer for playback when needed. */
     void Prepare();
 
@@ -76,6 +92,33 @@ class WavPlayer
     /** \return currently selected file.*/
     inline size_t GetCurrentFile() const { return file_sel_; }
 
+    /** \return the index of a file by name, or -1 */
+    inline int Find(const char* name) const { return index_.Find(name); }
+
+    /** \return the index of the files, with the headers read so far */
+    inline const WavIndex& GetIndex() const { return index_; }
+
+    /** Stores the headers read since Init() in the index file, so the
+    next boot has them without opening the files. Not for the audio
+    callback.
+    */
+    inline WavIndex::Result SaveIndex() { return index_.Save(); }
+
+    /** Tells a cache of the disk which part of the file comes next after
+    each refill, so it is loaded before Prepare() needs it, e.g. the cache
+    of USBHostHandle::GetReadCache(). nullptr stops the hints.
+    */
+    inline void SetReadAhead(ReadAheadCache* cache) { read_ahead_ = cache; }
+
+    /** \return Number of channels of the open file */
+    inline size_t GetNumChannels() const { return channels_; }
+
+    /** \return Sample rate of the open file in Hz */
+    inline uint32_t GetSampleRate() const
+    {
+        return reader_.GetFormat().sample_rate;
+    }
+
   private:
     enum BufferState
     {
@@ -84,17 +127,22 @@ class WavPlayer
         BUFFER_STATE_PREPARE_1,
     };
 
-    BufferState GetNextBuffState();
+    BufferState  GetNextBuffState();
+    const float* NextFrame();
+    void         Fill(float* dst);
 
     static constexpr size_t kMaxFiles   = 8;
     static constexpr size_t kBufferSize = 4096;
-    WavFileInfo             file_info_[kMaxFiles];
+    WavIndex::Record        records_[kMaxFiles];
+    WavIndex                index_;
     size_t                  file_cnt_, file_sel_;
     BufferState             buff_state_;
-    int16_t                 buff_[kBufferSize];
-    size_t                  read_ptr_;
+    float                   buff_[kBufferSize];
+    size_t                  read_ptr_, half_size_, channels_;
     bool                    looping_, playing_;
     FIL                     fil_;
+    WavReader               reader_;
+    ReadAheadCache*         read_ahead_;
 };
 
 } // namespace daisy
@@ -219,9 +219,7 @@ class QSPIHandle
         AdaptToSize(total_bytes);
         // Copy data into vector
         uint8_t* dest = testIsolator_.GetStateForCurrentTest()->memory_.data();
-        std::copy(&buffer[adjusted_addr],
-                  &buffer[adjusted_addr + size],
-                  &dest[adjusted_addr]);
+        std::copy(&buffer[0], &buffer[size], &dest[adjusted_addr]);
         return Result::OK;
     }
 
@@ -6,14 +6,70 @@
 
 using namespace daisy;
 
+namespace
+{
+bool SdRead(void*, uint8_t* buffer, uint32_t sector, uint32_t count)
+{
+    return SD_ReadUncached(0, buffer, sector, count) == RES_OK;
+}
+
+bool SdWrite(void*, const uint8_t* buffer, uint32_t sector, uint32_t count)
+{
+    return SD_WriteUncached(0, buffer, sector, count) == RES_OK;
+}
+
+DRESULT CacheRead(void* context, BYTE* buff, DWORD sector, UINT count)
+{
+    auto* cache = static_cast<BlockCache*>(context);
+    return cache->Read(buff, sector, count) == BlockCache::Result::OK
+               ? RES_OK
+               : RES_ERROR;
+}
+
+DRESULT CacheWrite(void* context, const BYTE* buff, DWORD sector, UINT count)
+{
+    auto* cache = static_cast<BlockCache*>(context);
+    return cache->Write(buff, sector, count) == BlockCache::Result::OK
+               ? RES_OK
+               : RES_ERROR;
+}
+
+DRESULT CacheSync(void* context)
+{
+    return static_cast<BlockCache*>(context)->Flush() == BlockCache::Result::OK
+               ? RES_OK
+               : RES_ERROR;
+}
+
+void CacheInvalidate(void* context)
+{
+    static_cast<BlockCache*>(context)->Invalidate();
+}
+} // namespace
+
 FatFSInterface::Result FatFSInterface::Init(const FatFSInterface::Config& cfg)
 {
     Result ret = Result::ERR_NO_MEDIA_SELECTED;
     cfg_       = cfg;
     if(cfg_.media & Config::MEDIA_SD)
+    {
         ret = FATFS_LinkDriver(&SD_Driver, path_[0]) == FR_OK
                   ? Result::OK
                   : Result::ERR_TOO_MANY_VOLUMES;
+        // The card is read and written through the cache when there is one
+        const BlockCache::Device device = {SdRead, SdWrite, nullptr};
+        if(cfg_.sd_cache.buffer != nullptr
+           && sd_cache_.Init(cfg_.sd_cache, device) == BlockCache::Result::OK)
+        {
+            sd_cache_hooks_ = {
+                CacheRead, CacheWrite, CacheSync, CacheInvalidate, &sd_cache_};
+            SD_SetCache(&sd_cache_hooks_);
+        }
+        else
+        {
+            SD_SetCache(nullptr);
+        }
+    }
     if(cfg_.media & Config::MEDIA_USB)
         ret = FATFS_LinkDriver(&USBH_Driver, path_[1]) == FR_OK
                   ? Result::OK
@@ -34,9 +90,15 @@ FatFSInterface::Result FatFSInterface::DeInit()
 {
     Result ret = Result::ERR_NO_MEDIA_SELECTED;
     if(cfg_.media & Config::MEDIA_SD)
+    {
+        // what wasn't synced yet still goes to the card
+        if(sd_cache_.IsEnabled())
+            sd_cache_.Flush();
+        SD_SetCache(nullptr);
         ret = FATFS_UnLinkDriver(path_[0]) == FR_OK
                   ? Result::OK
                   : Result::ERR_TOO_MANY_VOLUMES;
+    }
     if(cfg_.media & Config::MEDIA_USB)
         ret = FATFS_UnLinkDriver(path_[1]) == FR_OK
                   ? Result::OK
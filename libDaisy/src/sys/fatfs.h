@@ -2,6 +2,8 @@
 #define __fatfs_H /**< & */
 
 #include "ff.h"
+#include "util/BlockCache.h"
+#include "util/sd_diskio.h"
 
 namespace daisy
 {
@@ -59,6 +61,12 @@ class FatFSInterface
         };
 
         uint8_t media;
+
+        /** Blocks of the write-back cache of the SD card, see BlockCache,
+         *  in the AXI SRAM like this object. The card is used directly
+         *  while sd_cache.buffer is nullptr.
+         */
+        BlockCache::Config sd_cache;
     };
 
     FatFSInterface() {}
@@ -95,11 +103,22 @@ class FatFSInterface
     /** Returns reference to filesystem object for the USB volume. */
     FATFS& GetUSBFileSystem() { return fs_[1]; }
 
+    /** Returns the cache of the SD card, to read its statistics, or
+     *  nullptr when Config::sd_cache has no buffer.
+     *  f_sync() and f_close() write what it holds to the card.
+     */
+    BlockCache* GetSDCache()
+    {
+        return sd_cache_.IsEnabled() ? &sd_cache_ : nullptr;
+    }
+
   private:
-    Config cfg_;
-    FATFS  fs_[_VOLUMES];
-    char   path_[_VOLUMES][4];
-    bool   initialized_;
+    Config          cfg_;
+    FATFS           fs_[_VOLUMES];
+    char            path_[_VOLUMES][4];
+    bool            initialized_;
+    BlockCache      sd_cache_;
+    SD_CacheTypeDef sd_cache_hooks_;
 };
 
 } // namespace daisy
@@ -0,0 +1,118 @@
+#include "ScopePage.h"
+
+namespace daisy
+{
+constexpr float ScopePage::kMaxGain;
+
+void ScopePage::Init(const AudioScopeTap* tap)
+{
+    tap_       = tap;
+    has_frame_ = false;
+}
+
+void ScopePage::SetGain(float gain)
+{
+    gain_ = gain < 1.f ? 1.f : (gain > kMaxGain ? kMaxGain : gain);
+}
+
+void ScopePage::SetOneBitGraphicsDisplayToDrawTo(uint16_t canvasId)
+{
+    canvasIdToDrawTo_ = canvasId;
+}
+
+bool ScopePage::OnCancelButton(uint8_t numberOfPresses, bool isRetriggering)
+{
+    (void)(isRetriggering); // silence unused variable warning
+
+    if(numberOfPresses >= 1)
+        Close();
+    return true;
+}
+
+bool ScopePage::OnArrowButton(ArrowButtonType arrowType,
+                              uint8_t         numberOfPresses,
+                              bool            isRetriggering)
+{
+    (void)(isRetriggering); // silence unused variable warning
+
+    if(numberOfPresses < 1)
+        return true;
+
+    if(arrowType == ArrowButtonType::up)
+        SetGain(gain_ * 2.f);
+    else if(arrowType == ArrowButtonType::down)
+        SetGain(gain_ * 0.5f);
+    return true;
+}
+
+void ScopePage::Draw(const UiCanvasDescriptor& canvas)
+{
+    // Find out if this canvas is one we should draw to.
+    if(canvasIdToDrawTo_ == UI::invalidCanvasId)
+    {
+        auto* ui = GetParentUI();
+        if(!ui || ui->GetPrimaryOneBitGraphicsDisplayId() != canvas.id_)
+            return;
+    }
+    else if(canvasIdToDrawTo_ != canvas.id_)
+        return;
+
+    OneBitGraphicsDisplay& display = *(OneBitGraphicsDisplay*)(canvas.handle_);
+    const uint_fast8_t     width   = display.Width();
+    const uint_fast8_t     height  = display.Height();
+    if(width == 0 || height == 0)
+        return;
+
+    // the frame stays until the tap completes the next one
+    if(tap_ != nullptr && tap_->ReadScope(frame_))
+        has_frame_ = true;
+
+    // dotted zero line
+    const uint_fast8_t zero = ToRow(0.f, height);
+    for(uint_fast8_t x = 0; x < width; x += 4)
+        display.DrawPixel(x, zero, true);
+    if(!has_frame_)
+        return;
+
+    const size_t points = AudioScopeTap::kScopePoints;
+    uint_fast8_t prev_top = 0, prev_bottom = 0;
+    for(uint_fast8_t x = 0; x < width; x++)
+    {
+        // the points of this column
+        const size_t first = x * points / width;
+        size_t       last  = (x + 1) * points / width;
+        last               = last > first ? last : first + 1;
+        float lo = frame_.min[first], hi = frame_.max[first];
+        for(size_t i = first + 1; i < last; i++)
+        {
+            lo = frame_.min[i] < lo ? frame_.min[i] : lo;
+            hi = frame_.max[i] > hi ? frame_.max[i] : hi;
+        }
+
+        const uint_fast8_t row_hi = ToRow(hi, height);
+        const uint_fast8_t row_lo = ToRow(lo, height);
+        uint_fast8_t       top    = row_hi;
+        uint_fast8_t       bottom = row_lo;
+        if(x > 0)
+        {
+            // connect to the previous column
+            top    = prev_bottom < top ? prev_bottom : top;
+            bottom = prev_top > bottom ? prev_top : bottom;
+        }
+        display.DrawVerticalSpan(x, top, bottom, true);
+        prev_top    = row_hi;
+        prev_bottom = row_lo;
+    }
+}
+
+uint_fast8_t ScopePage::ToRow(float value, uint_fast8_t height) const
+{
+    // 1 at the top, -1 at the bottom
+    const float row = (1.f - value * gain_) * 0.5f * (height - 1) + 0.5f;
+    if(row <= 0.f)
+        return 0;
+    if(row >= height - 1)
+        return height - 1;
+    return uint_fast8_t(row);
+}
+} // namespace daisy
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "hid/disp/display.h"
+#include "util/AudioScopeTap.h"
+#include "UI.h"
+
+namespace daisy
+{
+/** @brief A page that shows the signal of an AudioScopeTap like a scope
+ *  @ingroup ui
+ *
+ *  Each column of the display is the range of the signal during a point
+ *  of the last scope frame, from its minimum to its maximum, drawn as one
+ *  vertical span. The spans of neighbouring columns touch, so fast
+ *  signals stay a connected trace.
+ *
+ *  The up and down arrow buttons zoom in and out, the cancel button
+ *  closes the page.
+ *
+ *  By default, it will paint to the canvas returned by
+ *  `UI::GetPrimaryOneBitGraphicsDisplayId()`. It can also be
+ *  configured to paint to a different canvas.
+ */
+class ScopePage : public UiPage
+{
+  public:
+    static constexpr float kMaxGain = 64.f;
+
+    ScopePage() : tap_(nullptr), gain_(1.f), has_frame_(false) {}
+
+    /** Call this to initialize the page with the tap it shows. The tap
+     *  must outlive the page.
+     */
+    void Init(const AudioScopeTap* tap);
+
+    /** Sets the vertical zoom: 1 shows -1 to 1, from 1 to kMaxGain */
+    void SetGain(float gain);
+    inline float GetGain() const { return gain_; }
+
+    /** Call this to change which canvas this page will draw to. The canvas
+     *  must be a `OneBitGraphicsDisplay`, e.g. the `OledDisplay` class.
+     *  If `canvasId == UI::invalidCanvasId` then this page will draw to the
+     *  canvas returned by `UI::GetPrimaryOneBitGraphicsDisplayId()`. This
+     *  is also the default behaviour.
+     */
+    void SetOneBitGraphicsDisplayToDrawTo(uint16_t canvasId);
+
+    // inherited from UiPage
+    bool OnCancelButton(uint8_t numberOfPresses, bool isRetriggering) override;
+    bool OnArrowButton(ArrowButtonType arrowType,
+                       uint8_t         numberOfPresses,
+                       bool            isRetriggering) override;
+    void Draw(const UiCanvasDescriptor& canvas) override;
+
+  private:
+    uint_fast8_t ToRow(float value, uint_fast8_t height) const;
+
+    const AudioScopeTap*      tap_;
+    float                     gain_;
+    bool                      has_frame_;
+    AudioScopeTap::ScopeFrame frame_;
+    uint16_t                  canvasIdToDrawTo_ = UI::invalidCanvasId;
+};
+} // namespace daisy
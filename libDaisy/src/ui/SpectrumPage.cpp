@@ -0,0 +1,101 @@
+#include <math.h>
+#include "SpectrumPage.h"
+
+namespace daisy
+{
+constexpr float SpectrumPage::kMinRangeDb;
+constexpr float SpectrumPage::kMaxRangeDb;
+
+void SpectrumPage::Init(const AudioScopeTap* tap)
+{
+    tap_       = tap;
+    has_frame_ = false;
+}
+
+void SpectrumPage::SetRange(float range_db)
+{
+    range_db_ = range_db < kMinRangeDb
+                    ? kMinRangeDb
+                    : (range_db > kMaxRangeDb ? kMaxRangeDb : range_db);
+}
+
+void SpectrumPage::SetOneBitGraphicsDisplayToDrawTo(uint16_t canvasId)
+{
+    canvasIdToDrawTo_ = canvasId;
+}
+
+bool SpectrumPage::OnCancelButton(uint8_t numberOfPresses, bool isRetriggering)
+{
+    (void)(isRetriggering); // silence unused variable warning
+
+    if(numberOfPresses >= 1)
+        Close();
+    return true;
+}
+
+bool SpectrumPage::OnArrowButton(ArrowButtonType arrowType,
+                                 uint8_t         numberOfPresses,
+                                 bool            isRetriggering)
+{
+    (void)(isRetriggering); // silence unused variable warning
+
+    if(numberOfPresses < 1)
+        return true;
+
+    if(arrowType == ArrowButtonType::up)
+        SetRange(range_db_ - 12.f);
+    else if(arrowType == ArrowButtonType::down)
+        SetRange(range_db_ + 12.f);
+    return true;
+}
+
+void SpectrumPage::Draw(const UiCanvasDescriptor& canvas)
+{
+    // Find out if this canvas is one we should draw to.
+    if(canvasIdToDrawTo_ == UI::invalidCanvasId)
+    {
+        auto* ui = GetParentUI();
+        if(!ui || ui->GetPrimaryOneBitGraphicsDisplayId() != canvas.id_)
+            return;
+    }
+    else if(canvasIdToDrawTo_ != canvas.id_)
+        return;
+
+    OneBitGraphicsDisplay& display = *(OneBitGraphicsDisplay*)(canvas.handle_);
+    const uint_fast8_t     width   = display.Width();
+    const uint_fast8_t     height  = display.Height();
+
+    // the frame stays until the tap completes the next one
+    if(tap_ != nullptr && tap_->ReadSpectrum(frame_))
+        has_frame_ = true;
+    if(!has_frame_ || frame_.num_bins < 2 || width == 0 || height == 0)
+        return;
+
+    size_t first = FirstBin(0, width, frame_.num_bins);
+    for(uint_fast8_t x = 0; x < width; x++)
+    {
+        size_t last = FirstBin(x + 1, width, frame_.num_bins);
+        last        = last > first ? last : first + 1;
+        float power = 0.f;
+        for(size_t k = first; k < last && k < frame_.num_bins; k++)
+            power = frame_.power[k] > power ? frame_.power[k] : power;
+        first = last;
+
+        // 0 dB at the top
+        const float db  = power > 1e-12f ? 10.f * log10f(power) : -120.f;
+        const float bar = (1.f + db / range_db_) * height;
+        if(bar < 1.f)
+            continue;
+        const uint_fast8_t top = bar >= height ? 0 : height - uint_fast8_t(bar);
+        display.DrawVerticalSpan(x, top, height - 1, true);
+    }
+}
+
+size_t SpectrumPage::FirstBin(size_t column, size_t columns, size_t bins) const
+{
+    if(!log_frequency_)
+        return 1 + column * (bins - 1) / columns;
+    // from bin 1 to bin `bins`, the same ratio per column
+    return size_t(powf(float(bins), float(column) / columns));
+}
+} // namespace daisy
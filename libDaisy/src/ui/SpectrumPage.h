@@ -0,0 +1,80 @@
+#pragma once
+
+#include "hid/disp/display.h"
+#include "util/AudioScopeTap.h"
+#include "UI.h"
+
+namespace daisy
+{
+/** @brief A page that shows the spectrum of an AudioScopeTap as bars
+ *  @ingroup ui
+ *
+ *  Each column of the display is a bar for the loudest bin of its range
+ *  of frequencies, on a logarithmic frequency axis by default. The height
+ *  of the bars is in dB, from the top of the display for a full scale
+ *  sine down to -range dB at the bottom.
+ *
+ *  The up and down arrow buttons change the range, the cancel button
+ *  closes the page.
+ *
+ *  By default, it will paint to the canvas returned by
+ *  `UI::GetPrimaryOneBitGraphicsDisplayId()`. It can also be
+ *  configured to paint to a different canvas.
+ */
+class SpectrumPage : public UiPage
+{
+  public:
+    static constexpr float kMinRangeDb = 24.f;
+    static constexpr float kMaxRangeDb = 120.f;
+
+    SpectrumPage()
+    : tap_(nullptr), range_db_(72.f), log_frequency_(true), has_frame_(false)
+    {
+    }
+
+    /** Call this to initialize the page with the tap it shows. The tap
+     *  must outlive the page.
+     */
+    void Init(const AudioScopeTap* tap);
+
+    /** Sets the dB shown from the top to the bottom of the display,
+     *  kMinRangeDb to kMaxRangeDb
+     */
+    void         SetRange(float range_db);
+    inline float GetRange() const { return range_db_; }
+
+    /** Spreads the bins linearly over the columns, instead of
+     *  logarithmically
+     */
+    inline void SetLogFrequency(bool log_frequency)
+    {
+        log_frequency_ = log_frequency;
+    }
+
+    /** Call this to change which canvas this page will draw to. The canvas
+     *  must be a `OneBitGraphicsDisplay`, e.g. the `OledDisplay` class.
+     *  If `canvasId == UI::invalidCanvasId` then this page will draw to the
+     *  canvas returned by `UI::GetPrimaryOneBitGraphicsDisplayId()`. This
+     *  is also the default behaviour.
+     */
+    void SetOneBitGraphicsDisplayToDrawTo(uint16_t canvasId);
+
+    // inherited from UiPage
+    bool OnCancelButton(uint8_t numberOfPresses, bool isRetriggering) override;
+    bool OnArrowButton(ArrowButtonType arrowType,
+                       uint8_t         numberOfPresses,
+                       bool            isRetriggering) override;
+    void Draw(const UiCanvasDescriptor& canvas) override;
+
+  private:
+    /** first bin of a column, bin 0 (DC) isn't shown */
+    size_t FirstBin(size_t column, size_t columns, size_t bins) const;
+
+    const AudioScopeTap*         tap_;
+    float                        range_db_;
+    bool                         log_frequency_;
+    bool                         has_frame_;
+    AudioScopeTap::SpectrumFrame frame_;
+    uint16_t                     canvasIdToDrawTo_ = UI::invalidCanvasId;
+};
+} // namespace daisy
@@ -0,0 +1,292 @@
+#include <math.h>
+#include "util/AudioScopeTap.h"
+
+using namespace daisy;
+
+#if(defined(USE_ARM_DSP) && defined(__arm__))
+#define DSY_SCOPE_ARM_FFT
+#endif
+
+constexpr size_t AudioScopeTap::kScopePoints;
+constexpr size_t AudioScopeTap::kMinFftSize;
+constexpr size_t AudioScopeTap::kMaxFftSize;
+constexpr size_t AudioScopeTap::kMaxBins;
+
+AudioScopeTap::Result AudioScopeTap::Init(const Config& config)
+{
+    const size_t n = config.fft_size;
+    if(config.decimation == 0
+       || (n != 0
+           && (n < kMinFftSize || n > kMaxFftSize || (n & (n - 1)) != 0)))
+        return Result::ERR_CONFIG;
+
+    decimation_    = config.decimation;
+    trigger_       = config.trigger;
+    trigger_level_ = config.trigger_level;
+    armed_         = trigger_;
+    point_         = 0;
+    count_         = 0;
+    wait_          = 0;
+    prev_          = 0.f;
+    min_           = 0.f;
+    max_           = 0.f;
+
+    fft_size_     = n;
+    fft_interval_ = config.fft_interval;
+    history_pos_  = 0;
+    history_fill_ = 0;
+    elapsed_      = fft_interval_;
+    step_         = 0;
+    num_passes_   = 0;
+    // a full scale sine at a bin is N / 4 after the Hann window
+    scale_ = n > 0 ? 16.f / float(n * n) : 0.f;
+    for(size_t m = n / 2; m > 1; m >>= 1)
+        num_passes_++;
+    for(size_t i = 0; i < n; i++)
+    {
+        const float phase = 6.28318530718f * i / n;
+        history_[i]       = 0.f;
+        window_[i]        = 0.5f - 0.5f * cosf(phase);
+#ifndef DSY_SCOPE_ARM_FFT
+        if(i < n / 2)
+        {
+            twiddle_[2 * i]     = cosf(phase);
+            twiddle_[2 * i + 1] = -sinf(phase);
+        }
+#endif
+    }
+#ifdef DSY_SCOPE_ARM_FFT
+    if(n > 0)
+        arm_rfft_fast_init_f32(&rfft_, n);
+#endif
+
+    scope_frames_.store(0, std::memory_order_release);
+    spectrum_frames_.store(0, std::memory_order_release);
+    return Result::OK;
+}
+
+void AudioScopeTap::Process(const float* in, size_t size, size_t stride)
+{
+    uint32_t     frames  = scope_frames_.load(std::memory_order_relaxed);
+    ScopeFrame*  frame   = &scope_[(frames + 1) & 1];
+    const size_t mask    = fft_size_ > 0 ? fft_size_ - 1 : 0;
+    const size_t timeout = kScopePoints * decimation_;
+    for(size_t i = 0; i < size; i++, in += stride)
+    {
+        const float x = *in;
+        if(fft_size_ > 0)
+        {
+            history_[history_pos_] = x;
+            history_pos_           = (history_pos_ + 1) & mask;
+        }
+
+        const bool edge = prev_ < trigger_level_ && x >= trigger_level_;
+        prev_           = x;
+        if(armed_)
+        {
+            if(!edge && ++wait_ < timeout)
+                continue;
+            armed_ = false;
+        }
+
+        if(count_ == 0)
+        {
+            min_ = x;
+            max_ = x;
+        }
+        else
+        {
+            min_ = x < min_ ? x : min_;
+            max_ = x > max_ ? x : max_;
+        }
+        if(++count_ < decimation_)
+            continue;
+
+        frame->min[point_] = min_;
+        frame->max[point_] = max_;
+        count_             = 0;
+        if(++point_ == kScopePoints)
+        {
+            scope_frames_.store(++frames, std::memory_order_release);
+            frame  = &scope_[(frames + 1) & 1];
+            point_ = 0;
+            armed_ = trigger_;
+            wait_  = 0;
+        }
+    }
+
+    if(fft_size_ == 0)
+        return;
+    history_fill_ += size;
+    history_fill_ = history_fill_ < fft_size_ ? history_fill_ : fft_size_;
+    elapsed_ += size;
+    elapsed_ = elapsed_ < fft_interval_ ? elapsed_ : fft_interval_;
+    StepSpectrum();
+}
+
+bool AudioScopeTap::ReadScope(ScopeFrame& frame) const
+{
+    // the callback writes the other buffer until it completes a frame
+    for(size_t attempt = 0; attempt < 3; attempt++)
+    {
+        const uint32_t n = scope_frames_.load(std::memory_order_acquire);
+        if(n == 0)
+            return false;
+        frame = scope_[n & 1];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(scope_frames_.load(std::memory_order_relaxed) == n)
+            return true;
+    }
+    return false;
+}
+
+bool AudioScopeTap::ReadSpectrum(SpectrumFrame& frame) const
+{
+    for(size_t attempt = 0; attempt < 3; attempt++)
+    {
+        const uint32_t n = spectrum_frames_.load(std::memory_order_acquire);
+        if(n == 0)
+            return false;
+        frame = spectrum_[n & 1];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(spectrum_frames_.load(std::memory_order_relaxed) == n)
+            return true;
+    }
+    return false;
+}
+
+void AudioScopeTap::StepSpectrum()
+{
+    if(step_ == 0)
+    {
+        if(history_fill_ < fft_size_ || elapsed_ < fft_interval_)
+            return;
+        elapsed_ = 0;
+        Window();
+        step_ = 1;
+        return;
+    }
+
+#ifdef DSY_SCOPE_ARM_FFT
+    if(step_ == 1)
+    {
+        arm_rfft_fast_f32(&rfft_, work_, packed_, 0);
+        step_ = 2;
+        return;
+    }
+    Magnitudes(packed_);
+#else
+    if(step_ <= num_passes_)
+    {
+        Pass(size_t(2) << (step_ - 1));
+        step_++;
+        return;
+    }
+    if(step_ == num_passes_ + 1)
+    {
+        Split();
+        step_++;
+        return;
+    }
+    Magnitudes(work_);
+#endif
+    step_ = 0;
+}
+
+void AudioScopeTap::Window()
+{
+    // oldest sample first
+    const size_t mask = fft_size_ - 1;
+#ifdef DSY_SCOPE_ARM_FFT
+    for(size_t i = 0; i < fft_size_; i++)
+        work_[i] = history_[(history_pos_ + i) & mask] * window_[i];
+#else
+    // pairs of samples are the complex points of a transform of half the
+    // size, stored in bit reversed order for the passes
+    const size_t m = fft_size_ / 2;
+    size_t       j = 0;
+    for(size_t p = 0; p < m; p++)
+    {
+        const size_t i   = 2 * p;
+        work_[2 * j]     = history_[(history_pos_ + i) & mask] * window_[i];
+        work_[2 * j + 1] = history_[(history_pos_ + i + 1) & mask]
+                           * window_[i + 1];
+        size_t bit = m >> 1;
+        while(bit != 0 && (j & bit) != 0)
+        {
+            j ^= bit;
+            bit >>= 1;
+        }
+        j |= bit;
+    }
+#endif
+}
+
+#ifndef DSY_SCOPE_ARM_FFT
+void AudioScopeTap::Pass(size_t len)
+{
+    const size_t m      = fft_size_ / 2;
+    const size_t half   = len / 2;
+    const size_t stride = 2 * (fft_size_ / len);
+    for(size_t i = 0; i < m; i += len)
+    {
+        for(size_t k = 0; k < half; k++)
+        {
+            float*      a  = work_ + 2 * (i + k);
+            float*      b  = a + 2 * half;
+            const float c  = twiddle_[k * stride];
+            const float s  = twiddle_[k * stride + 1];
+            const float re = b[0] * c - b[1] * s;
+            const float im = b[0] * s + b[1] * c;
+            b[0]           = a[0] - re;
+            b[1]           = a[1] - im;
+            a[0] += re;
+            a[1] += im;
+        }
+    }
+}
+
+void AudioScopeTap::Split()
+{
+    // the half size transform of the pairs gives the spectrum of the real
+    // signal, packed like arm_rfft_fast_f32(): DC and Nyquist come first
+    const size_t m  = fft_size_ / 2;
+    const float  re = work_[0];
+    const float  im = work_[1];
+    work_[0]        = re + im;
+    work_[1]        = re - im;
+    for(size_t k = 1; k <= m / 2; k++)
+    {
+        float*      a    = work_ + 2 * k;
+        float*      b    = work_ + 2 * (m - k);
+        const float c    = twiddle_[2 * k];
+        const float s    = twiddle_[2 * k + 1];
+        const float s_re = 0.5f * (a[0] + b[0]);
+        const float s_im = 0.5f * (a[1] - b[1]);
+        const float d_re = 0.5f * (a[0] - b[0]);
+        const float d_im = 0.5f * (a[1] + b[1]);
+        const float p_re = d_im * c + d_re * s;
+        const float p_im = d_im * s - d_re * c;
+        a[0]             = s_re + p_re;
+        a[1]             = s_im + p_im;
+        b[0]             = s_re - p_re;
+        b[1]             = p_im - s_im;
+    }
+}
+#endif
+
+void AudioScopeTap::Magnitudes(const float* packed)
+{
+    const uint32_t n     = spectrum_frames_.load(std::memory_order_relaxed);
+    SpectrumFrame& frame = spectrum_[(n + 1) & 1];
+    const size_t   bins  = fft_size_ / 2;
+    frame.num_bins       = bins;
+    frame.power[0]       = packed[0] * packed[0] * scale_;
+    for(size_t k = 1; k < bins; k++)
+    {
+        const float re = packed[2 * k];
+        const float im = packed[2 * k + 1];
+        frame.power[k] = (re * re + im * im) * scale_;
+    }
+    spectrum_frames_.store(n + 1, std::memory_order_release);
+}
@@ -0,0 +1,187 @@
+#pragma once
+#ifndef DSY_AUDIOSCOPETAP_H
+#define DSY_AUDIOSCOPETAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#if(defined(USE_ARM_DSP) && defined(__arm__))
+#include "arm_math.h"
+#endif
+
+namespace daisy
+{
+/** @brief Captures a signal of the audio callback for a scope and a
+ *  spectrum on the display.
+ *  @addtogroup utility
+ *
+ *  Process() goes in the audio callback. It keeps the minimum and the
+ *  maximum of every `decimation` samples, kScopePoints of them per scope
+ *  frame, and the last `fft_size` samples for the spectrum. A scope frame
+ *  starts on a rising edge through `trigger_level`, so a periodic signal
+ *  stands still on the display.
+ *
+ *  Every `fft_interval` samples, the power spectrum of the last
+ *  `fft_size` samples is computed, windowed with a Hann window, one step
+ *  per call of Process(): the cost of a block stays below the window
+ *  (`fft_size` multiplications) or one radix-2 pass of the transform
+ *  (`fft_size / 4` butterflies), on top of a few operations per sample.
+ *  With USE_ARM_DSP defined on the target, the transform is one call of
+ *  arm_rfft_fast_f32() instead of log2(fft_size) steps, which needs the
+ *  TransformFunctions and CommonTables sources of CMSIS-DSP in the build.
+ *
+ *  Both kinds of frames are double buffered: the callback writes one
+ *  buffer while the main loop reads the other. ReadScope() and
+ *  ReadSpectrum() copy the last complete frame without locks, and tell
+ *  when the callback got to it during the copy.
+ *
+ *  \code
+ *  AudioScopeTap tap;
+ *
+ *  void AudioCallback(AudioHandle::InputBuffer  in,
+ *                     AudioHandle::OutputBuffer out,
+ *                     size_t                    size)
+ *  {
+ *      ...
+ *      tap.Process(out[0], size);
+ *  }
+ *  \endcode
+ */
+class AudioScopeTap
+{
+  public:
+    enum class Result
+    {
+        OK,
+        ERR_CONFIG,
+    };
+
+    static constexpr size_t kScopePoints = 128;
+    static constexpr size_t kMinFftSize  = 64;
+    static constexpr size_t kMaxFftSize  = 512;
+    static constexpr size_t kMaxBins     = kMaxFftSize / 2;
+
+    struct Config
+    {
+        Config()
+        : decimation(8),
+          trigger(true),
+          trigger_level(0.f),
+          fft_size(256),
+          fft_interval(2048)
+        {
+        }
+
+        /** Samples per point of the scope, at least 1 */
+        size_t decimation;
+        /** Waits for a rising edge before each scope frame, at most one
+         *  frame long
+         */
+        bool  trigger;
+        float trigger_level;
+        /** Power of two from kMinFftSize to kMaxFftSize, or 0 for no
+         *  spectrum
+         */
+        size_t fft_size;
+        /** Samples between the starts of two spectrum frames */
+        size_t fft_interval;
+    };
+
+    /** Envelope of the signal, from left to right */
+    struct ScopeFrame
+    {
+        float min[kScopePoints];
+        float max[kScopePoints];
+    };
+
+    /** Power of the bins, 1 for a full scale sine at the frequency of a
+     *  bin. Bin k is at k * samplerate / fft_size.
+     */
+    struct SpectrumFrame
+    {
+        size_t num_bins;
+        float  power[kMaxBins];
+    };
+
+    AudioScopeTap() : fft_size_(0), scope_frames_(0), spectrum_frames_(0) {}
+    ~AudioScopeTap() {}
+
+    /** Not for the audio callback: computes the tables of the spectrum */
+    Result Init(const Config& config);
+
+    /** Takes a block of samples, in the audio callback
+     *  \param in first sample of the channel
+     *  \param size number of samples
+     *  \param stride distance between two samples, e.g. 2 for the left
+     *  channel of an interleaved buffer
+     */
+    void Process(const float* in, size_t size, size_t stride = 1);
+
+    /** Copies the last scope frame
+     *  \return false before the first frame, or if the callback kept
+     *  replacing it during the copy
+     */
+    bool ReadScope(ScopeFrame& frame) const;
+
+    /** Copies the last spectrum frame, same as ReadScope() */
+    bool ReadSpectrum(SpectrumFrame& frame) const;
+
+    /** \return number of frames completed since Init(), to see whether
+     *  there is a new one
+     */
+    inline uint32_t GetScopeFrames() const
+    {
+        return scope_frames_.load(std::memory_order_acquire);
+    }
+    inline uint32_t GetSpectrumFrames() const
+    {
+        return spectrum_frames_.load(std::memory_order_acquire);
+    }
+
+    /** \return fft_size / 2, 0 without spectrum */
+    inline size_t GetNumBins() const { return fft_size_ / 2; }
+
+    /** \return frequency of a bin in Hz */
+    inline float GetBinFrequency(size_t bin, float samplerate) const
+    {
+        return fft_size_ > 0 ? bin * samplerate / fft_size_ : 0.f;
+    }
+
+  private:
+    void StepSpectrum();
+    void Window();
+    void Magnitudes(const float* packed);
+#if !(defined(USE_ARM_DSP) && defined(__arm__))
+    void Pass(size_t len);
+    void Split();
+#endif
+
+    // scope, written by Process()
+    size_t decimation_, point_, count_, wait_;
+    bool   trigger_, armed_;
+    float  trigger_level_, prev_, min_, max_;
+
+    // spectrum
+    size_t fft_size_, fft_interval_, history_pos_, history_fill_, elapsed_;
+    size_t step_, num_passes_;
+    float  scale_;
+    float  history_[kMaxFftSize];
+    float  window_[kMaxFftSize];
+    float  work_[kMaxFftSize];
+#if(defined(USE_ARM_DSP) && defined(__arm__))
+    float                     packed_[kMaxFftSize];
+    arm_rfft_fast_instance_f32 rfft_;
+#else
+    /** cos and -sin of 2 pi k / fft_size, k < fft_size / 2 */
+    float twiddle_[kMaxFftSize];
+#endif
+
+    ScopeFrame            scope_[2];
+    SpectrumFrame         spectrum_[2];
+    std::atomic<uint32_t> scope_frames_, spectrum_frames_;
+};
+
+} // namespace daisy
+
+#endif
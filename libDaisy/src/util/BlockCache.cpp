@@ -0,0 +1,329 @@
+#include <string.h>
+#include "util/BlockCache.h"
+
+using namespace daisy;
+
+namespace
+{
+inline bool IsDmaAligned(const void* ptr)
+{
+    return (reinterpret_cast<uintptr_t>(ptr) & 31) == 0;
+}
+
+inline uint32_t CountSectors(uint32_t mask)
+{
+    return __builtin_popcount(mask);
+}
+} // namespace
+
+BlockCache::Result BlockCache::Init(const Config& config, const Device& device)
+{
+    num_blocks_ = 0;
+    if(config.buffer == nullptr || !IsDmaAligned(config.buffer)
+       || config.num_blocks < 2 || config.num_blocks > kMaxBlocks
+       || config.block_sectors == 0
+       || config.block_sectors > kMaxBlockSectors || device.read == nullptr
+       || device.write == nullptr)
+        return Result::ERR_CONFIG;
+
+    device_        = device;
+    blocks_        = config.buffer;
+    num_blocks_    = config.num_blocks;
+    block_sectors_ = config.block_sectors;
+    full_          = Span(0, block_sectors_);
+    stamp_         = 0;
+    Invalidate();
+    ResetStats();
+    return Result::OK;
+}
+
+BlockCache::Result
+BlockCache::Read(uint8_t* buffer, uint32_t sector, uint32_t count)
+{
+    if(!IsEnabled())
+        return Result::ERR_CONFIG;
+
+    stats_.reads++;
+    while(count > 0)
+    {
+        const uint32_t base   = sector - sector % block_sectors_;
+        const uint32_t offset = sector - base;
+        uint32_t       n      = block_sectors_ - offset;
+        n                     = n < count ? n : count;
+
+        int block = FindBlock(base);
+        if(block < 0)
+        {
+            // whole blocks that aren't cached go in one transaction
+            uint32_t run = 0;
+            if(offset == 0 && IsDmaAligned(buffer))
+            {
+                while(run + block_sectors_ <= count
+                      && FindBlock(base + run) < 0)
+                    run += block_sectors_;
+            }
+            if(run > 0)
+            {
+                stats_.read_misses += run;
+                if(!ReadDevice(buffer, sector, run))
+                    return Result::ERR_DEVICE;
+                buffer += run * kSectorSize;
+                sector += run;
+                count -= run;
+                continue;
+            }
+            block = Allocate(base);
+            if(block < 0)
+                return Result::ERR_DEVICE;
+        }
+
+        Block&     b       = block_[block];
+        const Mask span    = Span(offset, n);
+        const Mask missing = span & ~b.valid;
+        stats_.read_misses += CountSectors(missing);
+        stats_.read_hits += n - CountSectors(missing);
+        // the rest of the block comes along, unless it can't be read,
+        // e.g. past the end of the disk
+        if(missing != 0 && !Fill(block, full_ & ~b.valid)
+           && !Fill(block, span & ~b.valid))
+            return Result::ERR_DEVICE;
+
+        b.stamp = ++stamp_;
+        memcpy(
+            buffer, BlockData(block) + offset * kSectorSize, n * kSectorSize);
+        buffer += n * kSectorSize;
+        sector += n;
+        count -= n;
+    }
+    return Result::OK;
+}
+
+BlockCache::Result
+BlockCache::Write(const uint8_t* buffer, uint32_t sector, uint32_t count)
+{
+    if(!IsEnabled())
+        return Result::ERR_CONFIG;
+
+    stats_.writes++;
+    while(count > 0)
+    {
+        const uint32_t base   = sector - sector % block_sectors_;
+        const uint32_t offset = sector - base;
+        uint32_t       n      = block_sectors_ - offset;
+        n                     = n < count ? n : count;
+
+        int block = FindBlock(base);
+        if(block < 0)
+        {
+            // whole blocks that aren't cached go in one transaction
+            uint32_t run = 0;
+            if(offset == 0 && IsDmaAligned(buffer))
+            {
+                while(run + block_sectors_ <= count
+                      && FindBlock(base + run) < 0)
+                    run += block_sectors_;
+            }
+            if(run > 0)
+            {
+                stats_.write_misses += run;
+                if(!WriteDevice(buffer, sector, run))
+                    return Result::ERR_DEVICE;
+                buffer += run * kSectorSize;
+                sector += run;
+                count -= run;
+                continue;
+            }
+            block = Allocate(base);
+            if(block < 0)
+                return Result::ERR_DEVICE;
+            stats_.write_misses += n;
+        }
+        else
+        {
+            stats_.write_hits += n;
+        }
+
+        // the sectors that aren't written don't need to be read
+        Block&     b    = block_[block];
+        const Mask span = Span(offset, n);
+        b.valid |= span;
+        b.dirty |= span;
+        b.stamp = ++stamp_;
+        memcpy(
+            BlockData(block) + offset * kSectorSize, buffer, n * kSectorSize);
+        buffer += n * kSectorSize;
+        sector += n;
+        count -= n;
+    }
+    return Result::OK;
+}
+
+BlockCache::Result BlockCache::Flush()
+{
+    if(!IsEnabled())
+        return Result::ERR_CONFIG;
+    stats_.flushes++;
+    return WriteBack(0, num_blocks_ - 1) ? Result::OK : Result::ERR_DEVICE;
+}
+
+void BlockCache::Invalidate()
+{
+    for(size_t i = 0; i < num_blocks_; i++)
+    {
+        block_[i].valid = 0;
+        block_[i].dirty = 0;
+    }
+}
+
+size_t BlockCache::GetDirtyBlocks() const
+{
+    size_t dirty = 0;
+    for(size_t i = 0; i < num_blocks_; i++)
+    {
+        if(block_[i].dirty != 0)
+            dirty++;
+    }
+    return dirty;
+}
+
+float BlockCache::GetHitRate() const
+{
+    const uint32_t hits  = stats_.read_hits + stats_.write_hits;
+    const uint32_t total = hits + stats_.read_misses + stats_.write_misses;
+    return total > 0 ? float(hits) / float(total) : 0.f;
+}
+
+void BlockCache::ResetStats()
+{
+    memset(&stats_, 0, sizeof(stats_));
+}
+
+int BlockCache::FindBlock(uint32_t sector) const
+{
+    for(size_t i = 0; i < num_blocks_; i++)
+    {
+        if(block_[i].valid != 0 && block_[i].sector == sector)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+int BlockCache::Allocate(uint32_t sector)
+{
+    // an empty block, or the least recently used one
+    size_t victim = 0;
+    for(size_t i = 0; i < num_blocks_; i++)
+    {
+        if(block_[i].valid == 0)
+        {
+            victim = i;
+            break;
+        }
+        if(block_[i].stamp - block_[victim].stamp > 0x80000000)
+            victim = i;
+    }
+
+    if(block_[victim].dirty != 0)
+    {
+        // the blocks after it that continue it on the disk go along, in
+        // the same transaction
+        size_t last = victim;
+        while(last + 1 < num_blocks_ && block_[last + 1].dirty != 0
+              && block_[last + 1].sector
+                     == block_[last].sector + block_sectors_)
+            last++;
+        stats_.write_backs++;
+        if(!WriteBack(victim, last))
+            return -1;
+    }
+
+    Block& b = block_[victim];
+    b.sector = sector;
+    b.valid  = 0;
+    b.dirty  = 0;
+    b.stamp  = ++stamp_;
+    return static_cast<int>(victim);
+}
+
+bool BlockCache::Fill(size_t block, Mask sectors)
+{
+    Block& b  = block_[block];
+    bool   ok = true;
+    for(uint32_t i = 0; i < block_sectors_;)
+    {
+        if((sectors & (Mask(1) << i)) == 0)
+        {
+            i++;
+            continue;
+        }
+        uint32_t end = i + 1;
+        while(end < block_sectors_ && (sectors & (Mask(1) << end)) != 0)
+            end++;
+        if(ReadDevice(
+               BlockData(block) + i * kSectorSize, b.sector + i, end - i))
+            b.valid |= Span(i, end - i);
+        else
+            ok = false;
+        i = end;
+    }
+    return ok;
+}
+
+bool BlockCache::WriteBack(size_t first, size_t last)
+{
+    // The blocks are one array of sectors: a run of dirty sectors goes on
+    // into the next block when that block continues it on the disk.
+    const size_t end = (last + 1) * block_sectors_;
+    bool         ok  = true;
+    for(size_t pos = first * block_sectors_; pos < end;)
+    {
+        const Block& b = block_[pos / block_sectors_];
+        if((b.dirty & (Mask(1) << (pos % block_sectors_))) == 0)
+        {
+            pos++;
+            continue;
+        }
+        size_t run_end = pos + 1;
+        while(run_end < end)
+        {
+            const size_t block  = run_end / block_sectors_;
+            const size_t offset = run_end % block_sectors_;
+            if((block_[block].dirty & (Mask(1) << offset)) == 0
+               || (offset == 0
+                   && block_[block].sector
+                          != block_[block - 1].sector + block_sectors_))
+                break;
+            run_end++;
+        }
+
+        const uint32_t sector = b.sector + pos % block_sectors_;
+        if(WriteDevice(blocks_ + pos * kSectorSize, sector, run_end - pos))
+        {
+            for(size_t p = pos; p < run_end; p++)
+                block_[p / block_sectors_].dirty
+                    &= ~(Mask(1) << (p % block_sectors_));
+        }
+        else
+        {
+            ok = false;
+        }
+        pos = run_end;
+    }
+    return ok;
+}
+
+bool BlockCache::ReadDevice(uint8_t* buffer, uint32_t sector, uint32_t count)
+{
+    stats_.device_reads++;
+    stats_.device_read_sectors += count;
+    return device_.read(device_.context, buffer, sector, count);
+}
+
+bool BlockCache::WriteDevice(const uint8_t* buffer,
+                             uint32_t       sector,
+                             uint32_t       count)
+{
+    stats_.device_writes++;
+    stats_.device_write_sectors += count;
+    return device_.write(device_.context, buffer, sector, count);
+}
@@ -0,0 +1,197 @@
+#pragma once
+#ifndef DSY_BLOCKCACHE_H
+#define DSY_BLOCKCACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace daisy
+{
+/** @brief Write-back sector cache between FatFs and a block device such as
+ *  the SD card.
+ *  @addtogroup utility
+ *
+ *  FatFs reads and writes one sector at a time for the FAT, the
+ *  directories and the partial sectors of files, and each of those is a
+ *  transaction with the card. Recording while playing back rewrites the
+ *  same FAT sectors over and over, and interleaves small writes with
+ *  reads.
+ *
+ *  The cache keeps blocks of `block_sectors` contiguous sectors, replaced
+ *  in least recently used order. Writes only go to the blocks, and reach
+ *  the card when a dirty block is replaced or on `Flush()`, which FatFs
+ *  calls through CTRL_SYNC on f_sync() and f_close(). Contiguous dirty
+ *  sectors are written in one transaction, across blocks that follow
+ *  each other on the card and in the buffer.
+ *
+ *  Every transfer of the cache uses its own buffer, aligned to 32 bytes,
+ *  or the buffer of the caller when it is aligned as well: large reads
+ *  and writes of whole blocks go straight between the card and that
+ *  buffer in a single transaction. The D-Cache maintenance of the DMA
+ *  then never touches the memory around a buffer.
+ *
+ *  Data written without f_sync() or f_close() can be lost on power down,
+ *  as with the sector buffers of FatFs itself. When FatFs initializes the
+ *  card again, e.g. on f_mount(), the SD driver flushes the cache before
+ *  it forgets the blocks.
+ *
+ *  The SDMMC1 DMA only reaches the AXI SRAM, so the blocks of the SD card
+ *  stay in the default data section rather than DMA_BUFFER_MEM_SECTION.
+ *
+ *  \code
+ *  static uint8_t __attribute__((aligned(32))) blocks[32 * 8 * 512];
+ *
+ *  FatFSInterface::Config cfg;
+ *  cfg.media                  = FatFSInterface::Config::MEDIA_SD;
+ *  cfg.sd_cache.buffer        = blocks;
+ *  cfg.sd_cache.num_blocks    = 32;
+ *  cfg.sd_cache.block_sectors = 8;
+ *  fsi.Init(cfg);
+ *  \endcode
+ */
+class BlockCache
+{
+  public:
+    enum class Result
+    {
+        OK,
+        ERR_CONFIG,
+        ERR_DEVICE,
+    };
+
+    /** The disk under the cache. Buffers are always aligned to 32 bytes. */
+    struct Device
+    {
+        /** @return false if the sectors couldn't be read */
+        bool (*read)(void*    context,
+                     uint8_t* buffer,
+                     uint32_t sector,
+                     uint32_t count);
+
+        /** @return false if the sectors couldn't be written */
+        bool (*write)(void*          context,
+                      const uint8_t* buffer,
+                      uint32_t       sector,
+                      uint32_t       count);
+
+        void* context;
+    };
+
+    struct Config
+    {
+        Config() : buffer(nullptr), num_blocks(0), block_sectors(0) {}
+
+        /** num_blocks * block_sectors * kSectorSize bytes, aligned to 32
+         *  bytes, in memory the disk can reach by DMA. No cache without it.
+         */
+        uint8_t* buffer;
+        /** Blocks of the cache, 2 to kMaxBlocks */
+        size_t num_blocks;
+        /** Sectors per block, up to kMaxBlockSectors */
+        size_t block_sectors;
+    };
+
+    struct Stats
+    {
+        /** Calls to Read() and Write() */
+        uint32_t reads;
+        uint32_t writes;
+        /** Sectors read or written to blocks that held them */
+        uint32_t read_hits;
+        uint32_t write_hits;
+        /** Sectors read or written that were not cached */
+        uint32_t read_misses;
+        uint32_t write_misses;
+        /** Transactions with the device, and the sectors they moved */
+        uint32_t device_reads;
+        uint32_t device_writes;
+        uint32_t device_read_sectors;
+        uint32_t device_write_sectors;
+        /** Dirty blocks written when they were replaced */
+        uint32_t write_backs;
+        /** Calls to Flush() */
+        uint32_t flushes;
+    };
+
+    static constexpr size_t kSectorSize      = 512;
+    static constexpr size_t kMaxBlocks       = 64;
+    static constexpr size_t kMaxBlockSectors = 32;
+
+    BlockCache() : blocks_(nullptr), num_blocks_(0) {}
+    ~BlockCache() {}
+
+    Result Init(const Config& config, const Device& device);
+
+    /** @return true once Init() succeeded */
+    inline bool IsEnabled() const { return num_blocks_ > 0; }
+
+    /** Reads sectors through the cache, for disk_read() */
+    Result Read(uint8_t* buffer, uint32_t sector, uint32_t count);
+
+    /** Writes sectors to the cache, for disk_write() */
+    Result Write(const uint8_t* buffer, uint32_t sector, uint32_t count);
+
+    /** Writes all dirty sectors to the device, for CTRL_SYNC.
+     *  The sectors that failed stay dirty.
+     */
+    Result Flush();
+
+    /** Forgets everything, dirty sectors included, e.g. when the card is
+     *  changed. Flush() first to keep them.
+     */
+    void Invalidate();
+
+    /** @return number of blocks holding sectors not written yet */
+    size_t GetDirtyBlocks() const;
+
+    /** @return sectors read or written from the blocks, over all sectors
+     *  read or written, 0 to 1
+     */
+    float GetHitRate() const;
+
+    inline const Stats& GetStats() const { return stats_; }
+
+    void ResetStats();
+
+  private:
+    /** One bit per sector of a block */
+    typedef uint32_t Mask;
+
+    struct Block
+    {
+        uint32_t sector;
+        uint32_t stamp;
+        Mask     valid;
+        Mask     dirty;
+    };
+
+    inline uint8_t* BlockData(size_t block)
+    {
+        return blocks_ + block * block_sectors_ * kSectorSize;
+    }
+
+    inline Mask Span(uint32_t first, uint32_t count) const
+    {
+        return (count >= 32 ? ~Mask(0) : (Mask(1) << count) - 1) << first;
+    }
+
+    int  FindBlock(uint32_t sector) const;
+    int  Allocate(uint32_t sector);
+    bool Fill(size_t block, Mask sectors);
+    bool WriteBack(size_t first, size_t last);
+    bool ReadDevice(uint8_t* buffer, uint32_t sector, uint32_t count);
+    bool
+    WriteDevice(const uint8_t* buffer, uint32_t sector, uint32_t count);
+
+    Device   device_;
+    uint8_t* blocks_;
+    size_t   num_blocks_, block_sectors_;
+    Mask     full_;
+    Block    block_[kMaxBlocks];
+    uint32_t stamp_;
+    Stats    stats_;
+};
+
+} // namespace daisy
+
+#endif
@@ -8,6 +8,23 @@ namespace daisy
 
 // ==========================================================================
 
+uint32_t MappedValue::GetRaw() const
+{
+    const float normalized = GetAs0to1();
+    uint32_t    raw;
+    memcpy(&raw, &normalized, sizeof(raw));
+    return raw;
+}
+
+void MappedValue::SetFromRaw(uint32_t raw)
+{
+    float normalized;
+    memcpy(&normalized, &raw, sizeof(normalized));
+    SetFrom0to1(normalized);
+}
+
+// ==========================================================================
+
 MappedFloatValue::MappedFloatValue(float       min,
                                    float       max,
                                    float       defaultValue,
@@ -95,6 +112,20 @@ void MappedFloatValue::Step(int16_t numSteps, bool useCoarseStepSize)
     SetFrom0to1(std::max(0.0f, std::min(mapped + step, 1.0f)));
 }
 
+uint32_t MappedFloatValue::GetRaw() const
+{
+    uint32_t raw;
+    memcpy(&raw, &value_, sizeof(raw));
+    return raw;
+}
+
+void MappedFloatValue::SetFromRaw(uint32_t raw)
+{
+    float v;
+    memcpy(&v, &raw, sizeof(v));
+    Set(v);
+}
+
 // ==========================================================================
 
 // ==========================================================================
@@ -151,6 +182,16 @@ void MappedIntValue::Step(int16_t numStepsUp, bool useCoarseStepSize)
     value_ = std::max(min_, std::min(max_, value_ + numStepsUp * stepsize));
 }
 
+uint32_t MappedIntValue::GetRaw() const
+{
+    return uint32_t(value_);
+}
+
+void MappedIntValue::SetFromRaw(uint32_t raw)
+{
+    Set(int(raw));
+}
+
 // ==========================================================================
 
 // ==========================================================================
@@ -208,4 +249,14 @@ void MappedStringListValue::Step(int16_t numStepsUp, bool useCoarseStepSize)
     }
 }
 
+uint32_t MappedStringListValue::GetRaw() const
+{
+    return index_;
+}
+
+void MappedStringListValue::SetFromRaw(uint32_t raw)
+{
+    SetIndex(raw);
+}
+
 } // namespace daisy
\ No newline at end of file
@@ -32,6 +32,15 @@ class MappedValue
      *  to increment/decrement the value with buttons/encoders while making use 
      *  of the specific mapping. */
     virtual void Step(int16_t numStepsUp, bool useCoarseStepSize) = 0;
+
+    /** Returns a lossless 32 bit representation of the value, e.g. to store
+     *  it in a preset. The default implementation stores the bit pattern of
+     *  `GetAs0to1()`; subclasses should override this to store the actual value.
+     */
+    virtual uint32_t GetRaw() const;
+
+    /** Restores a value previously returned by `GetRaw()`. */
+    virtual void SetFromRaw(uint32_t raw);
 };
 
 /** @brief A `MappedValue` that maps a float value using various mapping functions.
@@ -111,6 +120,12 @@ class MappedFloatValue : public MappedValue
      */
     void Step(int16_t numStepsUp, bool useCoarseStepSize) override;
 
+    /** Returns the bit pattern of the current value. */
+    uint32_t GetRaw() const override;
+
+    /** Restores a bit pattern from `GetRaw()`, clamping it to the valid range. */
+    void SetFromRaw(uint32_t raw) override;
+
   private:
     float                  value_;
     const float            min_;
@@ -185,6 +200,12 @@ class MappedIntValue : public MappedValue
     /** Steps the value up or down using the step sizes specified in the constructor. */
     void Step(int16_t numStepsUp, bool useCoarseStepSize) override;
 
+    /** Returns the current value. */
+    uint32_t GetRaw() const override;
+
+    /** Restores a value from `GetRaw()`, clamping it to the valid range. */
+    void SetFromRaw(uint32_t raw) override;
+
   private:
     int         value_;
     const int   min_;
@@ -254,6 +275,12 @@ class MappedStringListValue : public MappedValue
      *  value will jump to the first or last item. */
     void Step(int16_t numStepsUp, bool useCoarseStepSize) override;
 
+    /** Returns the current item index. */
+    uint32_t GetRaw() const override;
+
+    /** Restores an item index from `GetRaw()`, clamping it to a valid item index. */
+    void SetFromRaw(uint32_t raw) override;
+
   private:
     uint32_t     index_;
     const char** itemStrings_;
@@ -0,0 +1,445 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include "daisy_core.h"
+#include "per/qspi.h"
+#include "sys/dma.h"
+#include "sys/system.h"
+#include "util/MappedValue.h"
+#include "util/scopedirqblocker.h"
+
+namespace daisy
+{
+/** @brief A bank of presets for `MappedValue`s stored in a compact binary format.
+ *  @addtogroup utility
+ *
+ *  Parameters are registered with `AddParam()` using a unique id that must
+ *  stay the same across firmware versions. A preset consists of a small
+ *  header followed by one (id, raw value) entry per parameter:
+ *
+ *  | field            | size     |
+ *  |------------------|----------|
+ *  | magic            | 4 bytes  |
+ *  | format version   | 2 bytes  |
+ *  | number of entries| 2 bytes  |
+ *  | schema version   | 4 bytes  |
+ *  | checksum         | 4 bytes  |
+ *  | name             | 16 bytes |
+ *  | entries          | 8 bytes each (2 byte id, 2 bytes reserved, 4 byte raw value) |
+ *
+ *  The checksum is a 32 bit FNV-1a hash of the header, with the checksum
+ *  field set to zero, followed by the entries.
+ *
+ *  Since entries are matched by id, presets stay loadable when parameters
+ *  are added or removed: unknown ids are skipped and parameters that are
+ *  missing from a preset keep their current value. The schema version is
+ *  stored alongside so that the application can migrate older presets.
+ *
+ *  Each of the `kNumSlots` slots on the QSPI flash occupies a whole number of
+ *  4kB sectors. Recalling a preset reads it directly from the memory mapped
+ *  QSPI region without copying it to RAM. Only parameters whose stored value
+ *  differs from their current value are marked as pending, and pending
+ *  parameters are applied in small batches by calling `Process()` once per
+ *  audio block. This spreads any coefficient recalculation that happens in
+ *  the parameter callbacks over several blocks instead of causing a CPU
+ *  spike on a program change.
+ *
+ *  Presets can also be serialized to and recalled from any memory buffer,
+ *  e.g. to store them in a file on an SD card.
+ *
+ *  `Store()` and `Recall()` should be called from the main loop, `Process()`
+ *  should be called from the audio callback. A recall blocks interrupts
+ *  while it marks each parameter, so that `Process()` never sees a
+ *  parameter half marked.
+ *
+ *  \tparam kMaxParams  Maximum number of parameters that can be registered
+ *  \tparam kNumSlots   Number of preset slots reserved on the QSPI flash
+ */
+template <size_t kMaxParams, size_t kNumSlots>
+class PresetBank
+{
+  public:
+    /** Callback that is invoked from `Process()` after a parameter was changed
+     *  by a preset recall. Use this to update the DSP modules that depend on
+     *  the parameter.
+     */
+    typedef void (*ParamChangedCallback)(void*              context,
+                                         const MappedValue& value);
+
+    enum class Result
+    {
+        OK,
+        ERR_INVALID_SLOT,
+        ERR_NO_PRESET,
+        ERR_TOO_MANY_PARAMS,
+        ERR_DUPLICATE_ID,
+        ERR_STORAGE,
+    };
+
+    /** Version of the binary format written by this class */
+    static constexpr uint16_t kFormatVersion = 1;
+    /** Marks the beginning of a valid preset ("DPRS" in memory) */
+    static constexpr uint32_t kMagic = 0x53525044;
+    /** Maximum length of a preset name, including the terminating zero */
+    static constexpr size_t kNameLength = 16;
+
+    /** Header at the start of each serialized preset */
+    struct Header
+    {
+        uint32_t magic;
+        uint16_t format_version;
+        uint16_t num_entries;
+        uint32_t schema_version;
+        uint32_t checksum;
+        char     name[kNameLength];
+    };
+
+    /** A single serialized parameter */
+    struct Entry
+    {
+        uint16_t id;
+        uint16_t reserved;
+        uint32_t raw;
+    };
+
+    /** Maximum size of a serialized preset in bytes */
+    static constexpr size_t kMaxPresetSize
+        = sizeof(Header) + kMaxParams * sizeof(Entry);
+
+    /** Smallest erasable unit of the QSPI flash */
+    static constexpr uint32_t kSectorSize = 4096;
+
+    /** Space occupied by each slot on the QSPI flash */
+    static constexpr uint32_t kSlotSize
+        = ((kMaxPresetSize + kSectorSize - 1) / kSectorSize) * kSectorSize;
+
+    /** Constructor for the preset bank
+     *  \param qspi reference to the hardware qspi peripheral.
+     */
+    PresetBank(QSPIHandle& qspi)
+    : qspi_(qspi),
+      address_offset_(0),
+      schema_version_(0),
+      num_params_(0),
+      num_pending_(0),
+      next_pending_(0)
+    {
+    }
+
+    /** Initializes the preset bank.
+     *  \param address_offset   offset for location on the QSPI chip (offset to base address of device).
+     *                          This will be masked to the nearest multiple of 4096.
+     *  \param schema_version   application defined version of the parameter set,
+     *                          written to each stored preset.
+     */
+    void Init(uint32_t address_offset = 0, uint32_t schema_version = 0)
+    {
+        address_offset_ = address_offset & ~(kSectorSize - 1);
+        schema_version_ = schema_version;
+        num_params_     = 0;
+        num_pending_    = 0;
+        next_pending_   = 0;
+    }
+
+    /** Registers a parameter with the bank.
+     *  \param id       unique and stable identifier for this parameter
+     *  \param value    the value to store/recall
+     *  \param callback optional callback that's invoked from `Process()`
+     *                  when the value was changed by a recall.
+     *  \param context  pointer passed to the callback
+     */
+    Result AddParam(uint16_t             id,
+                    MappedValue&         value,
+                    ParamChangedCallback callback = nullptr,
+                    void*                context  = nullptr)
+    {
+        if(num_params_ >= kMaxParams)
+            return Result::ERR_TOO_MANY_PARAMS;
+        if(FindParam(id, num_params_) < num_params_)
+            return Result::ERR_DUPLICATE_ID;
+
+        Param& p     = params_[num_params_];
+        p.id         = id;
+        p.value      = &value;
+        p.callback   = callback;
+        p.context    = context;
+        p.target_raw = 0;
+        p.pending    = false;
+        num_params_++;
+        return Result::OK;
+    }
+
+    /** Returns the number of registered parameters */
+    size_t GetNumParams() const { return num_params_; }
+
+    /** Writes the current parameter values into a buffer.
+     *  \param buffer   destination, must hold at least `GetSerializedSize()` bytes
+     *  \param size     size of the buffer in bytes
+     *  \param name     optional name to store with the preset
+     *  \returns the number of bytes written, or 0 if the buffer was too small.
+     */
+    size_t Serialize(uint8_t* buffer, size_t size, const char* name = "") const
+    {
+        const size_t total = GetSerializedSize();
+        if(size < total)
+            return 0;
+
+        Header header;
+        memset(&header, 0, sizeof(header));
+        header.magic          = kMagic;
+        header.format_version = kFormatVersion;
+        header.num_entries    = uint16_t(num_params_);
+        header.schema_version = schema_version_;
+        if(name != nullptr)
+            strncpy(header.name, name, kNameLength - 1);
+
+        uint8_t* entries = buffer + sizeof(Header);
+        for(size_t i = 0; i < num_params_; i++)
+        {
+            Entry e;
+            e.id       = params_[i].id;
+            e.reserved = 0;
+            e.raw      = params_[i].value->GetRaw();
+            memcpy(entries + i * sizeof(Entry), &e, sizeof(Entry));
+        }
+        header.checksum = 0;
+        header.checksum = Checksum(entries,
+                                   num_params_ * sizeof(Entry),
+                                   Checksum(&header, sizeof(Header)));
+        memcpy(buffer, &header, sizeof(Header));
+        return total;
+    }
+
+    /** Returns the number of bytes needed to serialize the current parameters */
+    size_t GetSerializedSize() const
+    {
+        return sizeof(Header) + num_params_ * sizeof(Entry);
+    }
+
+    /** Recalls a preset from a buffer, e.g. a file loaded from an SD card.
+     *  The data is read in place. Parameters with a different value are
+     *  marked as pending and will be applied by `Process()`.
+     *  \param data     pointer to the serialized preset
+     *  \param size     number of valid bytes at `data`
+     */
+    Result RecallFromBuffer(const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        Header         header;
+        if(!ReadHeader(bytes, size, header))
+            return Result::ERR_NO_PRESET;
+
+        const uint8_t* entries = bytes + sizeof(Header);
+        for(size_t i = 0; i < header.num_entries; i++)
+        {
+            Entry e;
+            memcpy(&e, entries + i * sizeof(Entry), sizeof(Entry));
+
+            // entries are written in registration order, so try that first.
+            size_t idx = (i < num_params_ && params_[i].id == e.id)
+                             ? i
+                             : FindParam(e.id, num_params_);
+            if(idx >= num_params_)
+                continue; // parameter no longer exists
+
+            // Process() may interrupt the recall from the audio callback
+            ScopedIrqBlocker block;
+            Param&           p = params_[idx];
+            if(p.value->GetRaw() != e.raw)
+            {
+                p.target_raw = e.raw;
+                if(!p.pending)
+                {
+                    p.pending = true;
+                    num_pending_++;
+                }
+            }
+            else if(p.pending)
+            {
+                // a previous recall is still pending for this parameter
+                p.pending = false;
+                num_pending_--;
+            }
+        }
+        return Result::OK;
+    }
+
+    /** Stores the current parameter values in a slot on the QSPI flash.
+     *  This erases the slot first and blocks until the data is written.
+     *  \param slot     index of the slot, 0 .. kNumSlots - 1
+     *  \param name     optional name to store with the preset
+     */
+    Result Store(size_t slot, const char* name = "")
+    {
+        if(slot >= kNumSlots)
+            return Result::ERR_INVALID_SLOT;
+
+        const size_t   size    = Serialize(scratch_, sizeof(scratch_), name);
+        const uint32_t address = GetSlotAddress(slot);
+        if(qspi_.Erase(address, address + kSlotSize) != QSPIHandle::Result::OK)
+            return Result::ERR_STORAGE;
+        if(qspi_.Write(address, size, scratch_) != QSPIHandle::Result::OK)
+            return Result::ERR_STORAGE;
+        return Result::OK;
+    }
+
+    /** Recalls a preset from a slot on the QSPI flash. The preset is read
+     *  directly from the memory mapped flash. Parameters with a different
+     *  value are marked as pending and will be applied by `Process()`.
+     *  \param slot     index of the slot, 0 .. kNumSlots - 1
+     */
+    Result Recall(size_t slot)
+    {
+        if(slot >= kNumSlots)
+            return Result::ERR_INVALID_SLOT;
+        return RecallFromBuffer(GetSlotData(slot), kSlotSize);
+    }
+
+    /** Returns true if the slot contains a valid preset */
+    bool IsSlotUsed(size_t slot)
+    {
+        if(slot >= kNumSlots)
+            return false;
+        Header header;
+        return ReadHeader(GetSlotData(slot), kSlotSize, header);
+    }
+
+    /** Returns the name of the preset stored in a slot, or nullptr if
+     *  the slot is empty. The string is a copy that stays valid until the
+     *  next call.
+     */
+    const char* GetSlotName(size_t slot)
+    {
+        if(slot >= kNumSlots)
+            return nullptr;
+        Header header;
+        if(!ReadHeader(GetSlotData(slot), kSlotSize, header))
+            return nullptr;
+        memcpy(name_, header.name, kNameLength);
+        return name_;
+    }
+
+    /** Applies up to `max_updates` pending parameters.
+     *  Call this once per audio block.
+     *  \returns the number of parameters that were applied.
+     */
+    size_t Process(size_t max_updates = 1)
+    {
+        size_t applied = 0;
+        for(size_t n = 0; n < num_params_ && applied < max_updates
+                          && num_pending_ > 0;
+            n++)
+        {
+            Param& p      = params_[next_pending_];
+            next_pending_ = (next_pending_ + 1) % num_params_;
+            if(!p.pending)
+                continue;
+
+            p.value->SetFromRaw(p.target_raw);
+            p.pending = false;
+            num_pending_--;
+            applied++;
+            if(p.callback != nullptr)
+                p.callback(p.context, *p.value);
+        }
+        return applied;
+    }
+
+    /** Returns the number of parameters that still have to be applied */
+    size_t GetNumPending() const { return num_pending_; }
+
+    /** Returns true while a recalled preset is still being applied */
+    bool IsRecallPending() const { return num_pending_ > 0; }
+
+  private:
+    struct Param
+    {
+        uint16_t             id;
+        MappedValue*         value;
+        ParamChangedCallback callback;
+        void*                context;
+        uint32_t             target_raw;
+        bool                 pending;
+    };
+
+    size_t FindParam(uint16_t id, size_t count) const
+    {
+        for(size_t i = 0; i < count; i++)
+        {
+            if(params_[i].id == id)
+                return i;
+        }
+        return count;
+    }
+
+    uint32_t GetSlotAddress(size_t slot) const
+    {
+        return address_offset_ + uint32_t(slot) * kSlotSize;
+    }
+
+    const uint8_t* GetSlotData(size_t slot)
+    {
+        void* data_ptr = qspi_.GetData(GetSlotAddress(slot));
+#if !UNIT_TEST
+        // Caching behavior is different when running programs outside internal flash
+        // so we need to explicitly invalidate the QSPI mapped memory to ensure we are
+        // reading the most recently stored preset.
+        if(System::GetProgramMemoryRegion()
+           != System::MemoryRegion::INTERNAL_FLASH)
+        {
+            dsy_dma_invalidate_cache_for_buffer((uint8_t*)data_ptr, kSlotSize);
+        }
+#endif
+        return static_cast<const uint8_t*>(data_ptr);
+    }
+
+    static bool ReadHeader(const uint8_t* data, size_t size, Header& header)
+    {
+        if(size < sizeof(Header))
+            return false;
+        memcpy(&header, data, sizeof(Header));
+        if(header.magic != kMagic || header.format_version > kFormatVersion)
+            return false;
+        const size_t entries_size = header.num_entries * sizeof(Entry);
+        if(sizeof(Header) + entries_size > size)
+            return false;
+
+        // the checksum covers the header with a zero checksum, then the
+        // entries
+        const uint32_t checksum = header.checksum;
+        header.checksum         = 0;
+        const uint32_t hash     = Checksum(data + sizeof(Header),
+                                       entries_size,
+                                       Checksum(&header, sizeof(Header)));
+        header.checksum              = checksum;
+        header.name[kNameLength - 1] = 0;
+        return hash == checksum;
+    }
+
+    /** 32 bit FNV-1a hash, continued from `hash` */
+    static uint32_t
+    Checksum(const void* data, size_t size, uint32_t hash = 2166136261u)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for(size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    QSPIHandle&     qspi_;
+    uint32_t        address_offset_;
+    uint32_t        schema_version_;
+    Param           params_[kMaxParams];
+    size_t          num_params_;
+    /** Also modified by Process() in the audio callback */
+    volatile size_t num_pending_;
+    size_t          next_pending_;
+    uint8_t         scratch_[kMaxPresetSize];
+    char            name_[kNameLength];
+};
+
+} // namespace daisy
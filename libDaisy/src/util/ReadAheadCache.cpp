@@ -0,0 +1,333 @@
+#include <string.h>
+#include "util/ReadAheadCache.h"
+
+using namespace daisy;
+
+namespace
+{
+inline bool IsAligned(const void* ptr)
+{
+    return (reinterpret_cast<uintptr_t>(ptr) & 31) == 0;
+}
+} // namespace
+
+ReadAheadCache::Result ReadAheadCache::Init(const Config& config,
+                                            const Device& device)
+{
+    num_lines_ = 0;
+    if(config.buffer == nullptr || !IsAligned(config.buffer)
+       || config.num_lines < 2 || config.num_lines > kMaxLines
+       || config.line_sectors == 0 || device.start_read == nullptr
+       || device.poll == nullptr)
+        return Result::ERR_CONFIG;
+
+    device_           = device;
+    lines_            = config.buffer;
+    num_lines_        = config.num_lines;
+    line_sectors_     = config.line_sectors;
+    read_ahead_lines_ = config.read_ahead_lines < num_lines_
+                            ? config.read_ahead_lines
+                            : num_lines_ - 1;
+    stamp_            = 0;
+    busy_             = false;
+    busy_line_        = -1;
+    Invalidate();
+    ResetStats();
+    return Result::OK;
+}
+
+ReadAheadCache::Result
+ReadAheadCache::Read(uint8_t* buffer, uint32_t sector, uint32_t count)
+{
+    if(!IsEnabled())
+        return Result::ERR_CONFIG;
+
+    stats_.reads++;
+    const bool sequential = sector == next_sector_;
+    next_sector_          = sector + count;
+    while(count > 0)
+    {
+        const uint32_t base   = sector - sector % line_sectors_;
+        const uint32_t offset = sector - base;
+        uint32_t       n      = line_sectors_ - offset;
+        n                     = n < count ? n : count;
+
+        int line = FindLine(base);
+        if(line >= 0 && line_[line].state == LineState::LOADING)
+        {
+            stats_.waits++;
+            Wait();
+            continue;
+        }
+
+        if(line >= 0)
+        {
+            stats_.hit_sectors += n;
+            if(line_[line].ahead)
+            {
+                line_[line].ahead = false;
+                stats_.read_ahead_hits++;
+            }
+        }
+        else
+        {
+            // whole lines that aren't cached go in one transaction
+            uint32_t run = 0;
+            if(offset == 0 && IsAligned(buffer))
+            {
+                while(run + line_sectors_ <= count
+                      && FindLine(base + run) < 0)
+                    run += line_sectors_;
+            }
+            if(run > 0)
+            {
+                stats_.miss_sectors += run;
+                if(!ReadDirect(buffer, sector, run))
+                    return Result::ERR_DEVICE;
+                buffer += run * kSectorSize;
+                sector += run;
+                count -= run;
+                continue;
+            }
+
+            stats_.miss_sectors += n;
+            if(busy_)
+            {
+                stats_.waits++;
+                Wait();
+            }
+            line = FindVictim(false);
+            if(!Start(line, base, false) || !Wait())
+            {
+                // e.g. a line past the end of the disk, read what's asked
+                if(!ReadDirect(LineData(line), sector, n))
+                    return Result::ERR_DEVICE;
+                memcpy(buffer, LineData(line), n * kSectorSize);
+                buffer += n * kSectorSize;
+                sector += n;
+                count -= n;
+                continue;
+            }
+        }
+        line_[line].stamp = ++stamp_;
+        memcpy(buffer, LineData(line) + offset * kSectorSize, n * kSectorSize);
+        buffer += n * kSectorSize;
+        sector += n;
+        count -= n;
+    }
+
+    if(sequential && read_ahead_lines_ > 0)
+        Hint(next_sector_, read_ahead_lines_ * line_sectors_);
+    StartReadAhead();
+    return Result::OK;
+}
+
+void ReadAheadCache::Hint(uint32_t sector, uint32_t count)
+{
+    if(!IsEnabled() || count == 0)
+        return;
+    // the same range again is already on its way
+    for(size_t i = 0; i < num_hints_; i++)
+    {
+        const Range& r = hints_[(hint_head_ + i) % kMaxHints];
+        if(r.sector == sector && r.count == count)
+            return;
+    }
+    if(num_hints_ == kMaxHints)
+    {
+        hint_head_ = (hint_head_ + 1) % kMaxHints;
+        num_hints_--;
+    }
+    hints_[(hint_head_ + num_hints_) % kMaxHints] = {sector, count};
+    num_hints_++;
+}
+
+void ReadAheadCache::HintFile(const FIL* file, uint32_t bytes)
+{
+    const FATFS* fs = file->obj.fs;
+    if(!IsEnabled() || fs == nullptr || bytes == 0
+       || file->fptr >= file->obj.objsize)
+        return;
+
+    const uint32_t cluster_bytes = fs->csize * kSectorSize;
+    uint32_t       cluster       = file->clust;
+    if(file->fptr == 0)
+        cluster = file->obj.sclust;
+    else if(file->fptr % cluster_bytes == 0)
+        cluster++; // FatFs moves to the next cluster on the next read
+    if(cluster < 2)
+        return;
+
+    const uint32_t left = file->obj.objsize - file->fptr;
+    bytes               = bytes < left ? bytes : left;
+    const uint32_t first
+        = (file->fptr % cluster_bytes) / kSectorSize; // sector in cluster
+    const uint32_t last = (file->fptr % kSectorSize + bytes - 1) / kSectorSize;
+    Hint(fs->database + (cluster - 2) * fs->csize + first, last + 1);
+}
+
+void ReadAheadCache::Process()
+{
+    if(!IsEnabled())
+        return;
+    if(busy_)
+    {
+        const Transfer transfer = device_.poll(device_.context);
+        if(transfer == Transfer::BUSY)
+            return;
+        Complete(transfer);
+    }
+    StartReadAhead();
+}
+
+void ReadAheadCache::Invalidate(uint32_t sector, uint32_t count)
+{
+    if(busy_)
+        Wait();
+    for(size_t i = 0; i < num_lines_; i++)
+    {
+        Line& line = line_[i];
+        if(line.state == LineState::EMPTY || line.sector >= sector + count
+           || line.sector + line_sectors_ <= sector)
+            continue;
+        line.state = LineState::EMPTY;
+    }
+}
+
+void ReadAheadCache::Invalidate()
+{
+    if(busy_)
+        Wait();
+    for(size_t i = 0; i < num_lines_; i++)
+        line_[i].state = LineState::EMPTY;
+    hint_head_   = 0;
+    num_hints_   = 0;
+    next_sector_ = 0xffffffff;
+}
+
+void ReadAheadCache::ResetStats()
+{
+    memset(&stats_, 0, sizeof(stats_));
+}
+
+int ReadAheadCache::FindLine(uint32_t sector) const
+{
+    for(size_t i = 0; i < num_lines_; i++)
+    {
+        if(line_[i].state != LineState::EMPTY && line_[i].sector == sector)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+int ReadAheadCache::FindVictim(bool ahead) const
+{
+    // an empty line, or the least recently used one. Read ahead doesn't
+    // replace lines that were loaded ahead and not read yet.
+    int victim = -1;
+    for(size_t i = 0; i < num_lines_; i++)
+    {
+        const Line& line = line_[i];
+        if(line.state == LineState::EMPTY)
+            return static_cast<int>(i);
+        if(line.state == LineState::LOADING || (ahead && line.ahead))
+            continue;
+        if(victim < 0 || line.stamp - line_[victim].stamp > 0x80000000)
+            victim = static_cast<int>(i);
+    }
+    return victim;
+}
+
+bool ReadAheadCache::Start(size_t line, uint32_t sector, bool ahead)
+{
+    if(busy_)
+        Wait();
+    Line& l  = line_[line];
+    l.sector = sector;
+    l.stamp  = ++stamp_;
+    l.ahead  = ahead;
+    if(!device_.start_read(
+           device_.context, LineData(line), sector, line_sectors_))
+    {
+        l.state = LineState::EMPTY;
+        return false;
+    }
+    l.state    = LineState::LOADING;
+    busy_      = true;
+    busy_line_ = static_cast<int>(line);
+    stats_.transfers++;
+    stats_.transfer_sectors += line_sectors_;
+    if(ahead)
+        stats_.read_aheads++;
+    return true;
+}
+
+bool ReadAheadCache::Wait()
+{
+    Transfer transfer = Transfer::DONE;
+    while(busy_)
+    {
+        transfer = device_.poll(device_.context);
+        if(transfer != Transfer::BUSY)
+            Complete(transfer);
+    }
+    return transfer == Transfer::DONE;
+}
+
+void ReadAheadCache::Complete(Transfer transfer)
+{
+    busy_ = false;
+    if(busy_line_ >= 0)
+    {
+        line_[busy_line_].state = transfer == Transfer::DONE
+                                      ? LineState::VALID
+                                      : LineState::EMPTY;
+    }
+    busy_line_ = -1;
+}
+
+bool ReadAheadCache::ReadDirect(uint8_t* buffer,
+                                uint32_t sector,
+                                uint32_t count)
+{
+    if(busy_)
+    {
+        stats_.waits++;
+        Wait();
+    }
+    if(!device_.start_read(device_.context, buffer, sector, count))
+        return false;
+    busy_      = true;
+    busy_line_ = -1;
+    stats_.transfers++;
+    stats_.transfer_sectors += count;
+    return Wait();
+}
+
+void ReadAheadCache::StartReadAhead()
+{
+    while(!busy_ && num_hints_ > 0)
+    {
+        Range&         hint = hints_[hint_head_];
+        const uint32_t base = hint.sector - hint.sector % line_sectors_;
+        if(FindLine(base) < 0)
+        {
+            const int line = FindVictim(true);
+            if(line < 0)
+                return; // the lines ahead fill the cache
+            if(!Start(line, base, true))
+                return;
+        }
+        const uint32_t step = base + line_sectors_ - hint.sector;
+        if(step >= hint.count)
+        {
+            hint_head_ = (hint_head_ + 1) % kMaxHints;
+            num_hints_--;
+        }
+        else
+        {
+            hint.sector += step;
+            hint.count -= step;
+        }
+    }
+}
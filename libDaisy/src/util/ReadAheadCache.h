@@ -0,0 +1,217 @@
+#pragma once
+#ifndef DSY_READAHEADCACHE_H
+#define DSY_READAHEADCACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ff.h"
+
+namespace daisy
+{
+/** @brief Sector cache with asynchronous read ahead, for streaming from
+ *  slow disks such as USB sticks.
+ *  @addtogroup utility
+ *
+ *  Each transaction with a USB mass storage device costs a command, a
+ *  status and a round trip through the host stack, whatever its size.
+ *  Reading samples with the sector by sector requests of FatFs spends
+ *  most of the time waiting, and the audio stutters.
+ *
+ *  The cache keeps lines of `line_sectors` contiguous sectors and loads
+ *  whole lines per transaction. Reads that continue the previous one load
+ *  the next lines in the background, and a streaming player can name the
+ *  parts of a file it will read next with `HintFile()`. Transfers run
+ *  asynchronously through a Device: `Process()`, called from the main
+ *  loop, advances the one in progress and starts the next, so a read only
+ *  waits for a line that isn't there yet.
+ *
+ *  Large reads aligned to lines go straight to the buffer of the caller
+ *  when it is aligned for DMA, in a single transaction.
+ *
+ *  `Read()`, `Process()` and the hints must be called from the same
+ *  context, e.g. the main loop, not the audio callback.
+ *
+ *  \code
+ *  static uint8_t DMA_BUFFER_MEM_SECTION __attribute__((aligned(32)))
+ *      lines[16 * 16 * 512];
+ *
+ *  USBHostHandle::Config cfg;
+ *  cfg.read_cache.buffer       = lines;
+ *  cfg.read_cache.num_lines    = 16;
+ *  cfg.read_cache.line_sectors = 16;
+ *  usb.Init(cfg);
+ *  player.SetReadAhead(usb.GetReadCache());
+ *  \endcode
+ */
+class ReadAheadCache
+{
+  public:
+    enum class Result
+    {
+        OK,
+        ERR_CONFIG,
+        ERR_DEVICE,
+    };
+
+    /** State of a transfer of the device */
+    enum class Transfer
+    {
+        BUSY,
+        DONE,
+        FAILED,
+    };
+
+    /** The disk under the cache, one transfer at a time */
+    struct Device
+    {
+        /** Starts reading count sectors to a buffer aligned to 32 bytes.
+         *  @return false if the transfer couldn't start
+         */
+        bool (*start_read)(void*    context,
+                           uint8_t* buffer,
+                           uint32_t sector,
+                           uint32_t count);
+
+        /** Advances the transfer in progress */
+        Transfer (*poll)(void* context);
+
+        void* context;
+    };
+
+    struct Config
+    {
+        Config()
+        : buffer(nullptr), num_lines(0), line_sectors(0), read_ahead_lines(4)
+        {
+        }
+
+        /** num_lines * line_sectors * kSectorSize bytes, aligned to 32
+         *  bytes, in memory the disk can reach by DMA. No cache without it.
+         */
+        uint8_t* buffer;
+        /** Lines of the cache, up to kMaxLines */
+        size_t num_lines;
+        /** Sectors per line, e.g. 16 for 8 KB per transaction */
+        size_t line_sectors;
+        /** Lines loaded ahead of sequential reads, less than num_lines */
+        size_t read_ahead_lines;
+    };
+
+    struct Stats
+    {
+        /** Calls to Read() */
+        uint32_t reads;
+        /** Sectors read from the lines */
+        uint32_t hit_sectors;
+        /** Sectors that were not cached when they were read */
+        uint32_t miss_sectors;
+        /** Transactions with the device, and the sectors they moved */
+        uint32_t transfers;
+        uint32_t transfer_sectors;
+        /** Times a read waited for a transfer */
+        uint32_t waits;
+        /** Lines loaded ahead, and the ones read before being replaced */
+        uint32_t read_aheads;
+        uint32_t read_ahead_hits;
+    };
+
+    static constexpr size_t kSectorSize = 512;
+    static constexpr size_t kMaxLines   = 32;
+    static constexpr size_t kMaxHints   = 4;
+
+    ReadAheadCache()
+    : lines_(nullptr), num_lines_(0), busy_(false), busy_line_(-1)
+    {
+    }
+    ~ReadAheadCache() {}
+
+    Result Init(const Config& config, const Device& device);
+
+    /** @return true once Init() succeeded */
+    inline bool IsEnabled() const { return num_lines_ > 0; }
+
+    /** Reads sectors through the cache, for disk_read() */
+    Result Read(uint8_t* buffer, uint32_t sector, uint32_t count);
+
+    /** Loads sectors in the background. The last kMaxHints are kept. */
+    void Hint(uint32_t sector, uint32_t count);
+
+    /** Loads the next bytes of a file in the background, from its read
+     *  position. The sectors are derived from the cluster of the position,
+     *  assuming the file is contiguous after it: a fragmented file only
+     *  loads sectors that aren't needed.
+     */
+    void HintFile(const FIL* file, uint32_t bytes);
+
+    /** Advances the transfer in progress, and starts the next read ahead.
+     *  Call it often, e.g. every pass of the main loop.
+     */
+    void Process();
+
+    /** Forgets cached sectors, e.g. before they are written. Waits for
+     *  the transfer in progress, so the disk is free afterwards.
+     */
+    void Invalidate(uint32_t sector, uint32_t count);
+
+    /** Forgets everything, e.g. when the disk is removed. Waits for the
+     *  transfer in progress, which fails if the disk is gone.
+     */
+    void Invalidate();
+
+    /** @return true while a transfer is in progress */
+    inline bool IsBusy() const { return busy_; }
+
+    inline const Stats& GetStats() const { return stats_; }
+
+    void ResetStats();
+
+  private:
+    enum class LineState : uint8_t
+    {
+        EMPTY,
+        LOADING,
+        VALID,
+    };
+
+    struct Line
+    {
+        uint32_t  sector;
+        uint32_t  stamp;
+        LineState state;
+        /** Loaded ahead, and not read yet */
+        bool ahead;
+    };
+
+    struct Range
+    {
+        uint32_t sector, count;
+    };
+
+    inline uint8_t* LineData(size_t line)
+    {
+        return lines_ + line * line_sectors_ * kSectorSize;
+    }
+
+    int  FindLine(uint32_t sector) const;
+    int  FindVictim(bool ahead) const;
+    bool Start(size_t line, uint32_t sector, bool ahead);
+    bool Wait();
+    void Complete(Transfer transfer);
+    bool ReadDirect(uint8_t* buffer, uint32_t sector, uint32_t count);
+    void StartReadAhead();
+
+    Device   device_;
+    uint8_t* lines_;
+    size_t   num_lines_, line_sectors_, read_ahead_lines_;
+    Line     line_[kMaxLines];
+    uint32_t stamp_, next_sector_;
+    bool     busy_;
+    int      busy_line_;
+    Range    hints_[kMaxHints];
+    size_t   hint_head_, num_hints_;
+    Stats    stats_;
+};
+
+} // namespace daisy
+
+#endif
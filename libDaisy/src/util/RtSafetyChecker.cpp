@@ -0,0 +1,178 @@
+#include "RtSafetyChecker.h"
+
+namespace daisy
+{
+namespace
+{
+#ifdef UNIT_TEST
+// The host test thread that runs a callback is the "audio thread"
+thread_local bool in_audio_thread = false;
+#else
+// On the target, the audio callback runs in a single interrupt context
+bool in_audio_thread = false;
+#endif
+
+constexpr int kNumViolationKinds
+    = static_cast<int>(RtSafetyChecker::Violation::LAST);
+
+uint32_t                           num_violations[kNumViolationKinds] = {};
+uint32_t                           num_callbacks                      = 0;
+uint32_t                           worst_callback_us                  = 0;
+RtSafetyChecker::ViolationCallback violation_callback                 = nullptr;
+void*                              violation_context                  = nullptr;
+} // namespace
+
+bool RtSafetyChecker::IsInAudioThread()
+{
+    return in_audio_thread;
+}
+
+void RtSafetyChecker::CheckViolation(Violation violation)
+{
+    if(!in_audio_thread)
+        return;
+    num_violations[static_cast<int>(violation)]++;
+    if(violation_callback != nullptr)
+    {
+        // don't report calls made by the callback itself
+        in_audio_thread = false;
+        violation_callback(violation, violation_context);
+        in_audio_thread = true;
+    }
+}
+
+uint32_t RtSafetyChecker::GetNumViolations()
+{
+    uint32_t sum = 0;
+    for(int i = 0; i < kNumViolationKinds; i++)
+        sum += num_violations[i];
+    return sum;
+}
+
+uint32_t RtSafetyChecker::GetNumViolations(Violation violation)
+{
+    return num_violations[static_cast<int>(violation)];
+}
+
+uint32_t RtSafetyChecker::GetNumCallbacks()
+{
+    return num_callbacks;
+}
+
+uint32_t RtSafetyChecker::GetWorstCallbackTimeUs()
+{
+    return worst_callback_us;
+}
+
+void RtSafetyChecker::SetViolationCallback(ViolationCallback callback,
+                                           void*             context)
+{
+    violation_callback = callback;
+    violation_context  = context;
+}
+
+void RtSafetyChecker::Reset()
+{
+    for(int i = 0; i < kNumViolationKinds; i++)
+        num_violations[i] = 0;
+    num_callbacks     = 0;
+    worst_callback_us = 0;
+}
+
+void RtSafetyChecker::SetInAudioThread(bool state)
+{
+    in_audio_thread = state;
+}
+
+void RtSafetyChecker::RecordCallbackTime(uint32_t us)
+{
+    num_callbacks++;
+    if(us > worst_callback_us)
+        worst_callback_us = us;
+}
+
+} // namespace daisy
+
+#if defined(UNIT_TEST) && defined(__GLIBC__)
+// ================================================================
+// Interposed C library functions for host builds
+// ================================================================
+// glibc exports its allocator under these names, so the
+// definitions below can replace the public symbols.
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t num, size_t size);
+    void* __libc_realloc(void* ptr, size_t size);
+    void  __libc_free(void* ptr);
+
+    void* malloc(size_t size) noexcept
+    {
+        daisy::RtSafetyChecker::CheckViolation(
+            daisy::RtSafetyChecker::Violation::ALLOCATION);
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t num, size_t size) noexcept
+    {
+        daisy::RtSafetyChecker::CheckViolation(
+            daisy::RtSafetyChecker::Violation::ALLOCATION);
+        return __libc_calloc(num, size);
+    }
+
+    void* realloc(void* ptr, size_t size) noexcept
+    {
+        daisy::RtSafetyChecker::CheckViolation(
+            daisy::RtSafetyChecker::Violation::ALLOCATION);
+        return __libc_realloc(ptr, size);
+    }
+
+    void free(void* ptr) noexcept
+    {
+        if(ptr != nullptr)
+            daisy::RtSafetyChecker::CheckViolation(
+                daisy::RtSafetyChecker::Violation::DEALLOCATION);
+        __libc_free(ptr);
+    }
+
+    int vprintf(const char* format, va_list args)
+    {
+        daisy::RtSafetyChecker::CheckViolation(
+            daisy::RtSafetyChecker::Violation::PRINT);
+        return vfprintf(stdout, format, args);
+    }
+
+    int printf(const char* format, ...)
+    {
+        daisy::RtSafetyChecker::CheckViolation(
+            daisy::RtSafetyChecker::Violation::PRINT);
+        va_list args;
+        va_start(args, format);
+        const int result = vfprintf(stdout, format, args);
+        va_end(args);
+        return result;
+    }
+
+    int puts(const char* str)
+    {
+        daisy::RtSafetyChecker::CheckViolation(
+            daisy::RtSafetyChecker::Violation::PRINT);
+        if(fputs(str, stdout) == EOF)
+            return EOF;
+        return fputc('\n', stdout);
+    }
+
+    int putchar(int character)
+    {
+        daisy::RtSafetyChecker::CheckViolation(
+            daisy::RtSafetyChecker::Violation::PRINT);
+        return fputc(character, stdout);
+    }
+}
+
+#endif // defined(UNIT_TEST) && defined(__GLIBC__)
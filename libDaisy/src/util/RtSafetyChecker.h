@@ -0,0 +1,132 @@
+#pragma once
+
+#include <stdint.h>
+#include "sys/system.h"
+
+namespace daisy
+{
+/** @brief Real-time safety checks for audio callback code
+ *  @addtogroup utility
+ *
+ *  Code that runs in the audio callback must never allocate memory,
+ *  free memory or print, as these calls can block for an unbounded time.
+ *  In debug builds (`DEBUG`), the `AudioHandle` marks the duration of each
+ *  callback with a `RtSafetyChecker::ScopedAudioThread`, which also records
+ *  the worst case callback time.
+ *
+ *  In host builds (`UNIT_TEST`), `malloc()`, `calloc()`, `realloc()`,
+ *  `free()` (and thus `new` and `delete`), `printf()`, `vprintf()`, `puts()`
+ *  and `putchar()` are interposed and report a violation when they are
+ *  called from inside the marked scope. Tests can wrap their own callbacks
+ *  in a `ScopedAudioThread` and expect `GetNumViolations()` to be zero.
+ *  On the target, only the callback timing is recorded.
+ *
+ *  All state is global and assumes a single audio thread.
+ */
+class RtSafetyChecker
+{
+  public:
+    /** The kinds of calls that are forbidden in the audio callback */
+    enum class Violation
+    {
+        ALLOCATION,
+        DEALLOCATION,
+        PRINT,
+        LAST,
+    };
+
+    /** A function that's called for every violation.
+     *  It's called from inside the offending call (e.g. `malloc()`),
+     *  so it must not allocate or print itself.
+     */
+    typedef void (*ViolationCallback)(Violation violation, void* context);
+
+    /** Marks the current thread as the audio thread for the lifetime of
+     *  this object, and records the time spent in the scope.
+     */
+    class ScopedAudioThread
+    {
+      public:
+        ScopedAudioThread()
+        {
+            startUs_          = System::GetUs();
+            wasInAudioThread_ = IsInAudioThread();
+            SetInAudioThread(true);
+        }
+
+        ~ScopedAudioThread()
+        {
+            SetInAudioThread(wasInAudioThread_);
+            RecordCallbackTime(System::GetUs() - startUs_);
+        }
+
+      private:
+        uint32_t startUs_;
+        bool     wasInAudioThread_;
+
+        ScopedAudioThread(const ScopedAudioThread&) = delete;
+        ScopedAudioThread& operator=(const ScopedAudioThread&) = delete;
+    };
+
+    /** Temporarily suspends the checks inside a `ScopedAudioThread`, e.g.
+     *  for test code that's allowed to allocate from within a callback.
+     */
+    class ScopedUnmonitored
+    {
+      public:
+        ScopedUnmonitored()
+        {
+            wasInAudioThread_ = IsInAudioThread();
+            SetInAudioThread(false);
+        }
+
+        ~ScopedUnmonitored() { SetInAudioThread(wasInAudioThread_); }
+
+      private:
+        bool wasInAudioThread_;
+
+        ScopedUnmonitored(const ScopedUnmonitored&) = delete;
+        ScopedUnmonitored& operator=(const ScopedUnmonitored&) = delete;
+    };
+
+    /** Returns true if the calling thread is inside a `ScopedAudioThread` */
+    static bool IsInAudioThread();
+
+    /** Records a violation if the calling thread is the audio thread.
+     *  This is called by the interposed functions in host builds.
+     */
+    static void CheckViolation(Violation violation);
+
+    /** Returns the number of violations since the last call to `Reset()` */
+    static uint32_t GetNumViolations();
+
+    /** Returns the number of violations of a particular kind since the
+     *  last call to `Reset()`
+     */
+    static uint32_t GetNumViolations(Violation violation);
+
+    /** Returns the number of completed callbacks since the last call to
+     *  `Reset()`
+     */
+    static uint32_t GetNumCallbacks();
+
+    /** Returns the longest callback time in microseconds observed since the
+     *  last call to `Reset()`
+     */
+    static uint32_t GetWorstCallbackTimeUs();
+
+    /** Sets a function to call for every violation, or nullptr to disable */
+    static void SetViolationCallback(ViolationCallback callback,
+                                     void*             context = nullptr);
+
+    /** Resets the violation counters and the callback statistics */
+    static void Reset();
+
+  private:
+    static void SetInAudioThread(bool in_audio_thread);
+    static void RecordCallbackTime(uint32_t us);
+
+    RtSafetyChecker() = delete;
+};
+
+} // namespace daisy
@@ -0,0 +1,238 @@
+#include <string.h>
+#include "util/SampleCatalog.h"
+
+namespace daisy
+{
+namespace
+{
+/** Floats of one table and all its mip levels */
+size_t TableFloats(const SampleCatalog::Entry& entry)
+{
+    size_t floats = 0;
+    for(size_t mip = 0; mip < entry.num_mips; mip++)
+        floats += SampleCatalog::GetMipSize(entry, mip);
+    return floats;
+}
+
+/** Bytes of num_frames encoded in a format, as
+ *  daisysp::SampleCodec::GetEncodedSize(), or UINT64_MAX for an unknown
+ *  format.
+ *  The block sizes of the FLOAT32, ADPCM4, BFP8 and BFP12 formats, of 64
+ *  samples each, are repeated here as libDaisy doesn't use DaisySP.
+ */
+uint64_t CatalogEncodedSize(uint8_t format, uint32_t num_frames)
+{
+    static const uint16_t block_bytes[] = {256, 36, 68, 100};
+    if(format >= sizeof(block_bytes) / sizeof(block_bytes[0]))
+        return UINT64_MAX;
+    const uint64_t blocks = (uint64_t(num_frames) + 63) / 64;
+    return blocks * block_bytes[format];
+}
+
+inline int CompareNames(const char* a, const char* b)
+{
+    return strncmp(a, b, SampleCatalog::kNameLength);
+}
+} // namespace
+
+SampleCatalog::Result SampleCatalog::Init(const void* image, size_t size)
+{
+    image_   = static_cast<const uint8_t*>(image);
+    header_  = nullptr;
+    entries_ = nullptr;
+
+    if(size < sizeof(Header))
+        return Result::ERR_TOO_SMALL;
+    const Header* header = reinterpret_cast<const Header*>(image_);
+    if(header->magic != kMagic)
+        return Result::ERR_NOT_CATALOG;
+    if(header->format_version > kFormatVersion)
+        return Result::ERR_VERSION;
+    const size_t table_size = header->num_entries * sizeof(Entry);
+    if(header->image_size > size || sizeof(Header) + table_size > size)
+        return Result::ERR_TOO_SMALL;
+
+    const Entry* entries
+        = reinterpret_cast<const Entry*>(image_ + sizeof(Header));
+    if(Checksum(entries, table_size) != header->checksum)
+        return Result::ERR_CHECKSUM;
+
+    for(size_t i = 0; i < header->num_entries; i++)
+    {
+        if(!CheckEntry(entries[i], header->image_size))
+            return Result::ERR_CORRUPT;
+        // Find() relies on the order
+        if(i > 0 && CompareNames(entries[i - 1].name, entries[i].name) >= 0)
+            return Result::ERR_CORRUPT;
+    }
+
+    header_  = header;
+    entries_ = entries;
+    return Result::OK;
+}
+
+const SampleCatalog::Entry* SampleCatalog::Find(const char* name) const
+{
+    size_t lo = 0, hi = GetNumEntries();
+    while(lo < hi)
+    {
+        const size_t mid = lo + (hi - lo) / 2;
+        const int    cmp = CompareNames(entries_[mid].name, name);
+        if(cmp == 0)
+            return &entries_[mid];
+        if(cmp < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return nullptr;
+}
+
+const void* SampleCatalog::GetChannel(const Entry& entry, size_t channel) const
+{
+    if(channel >= entry.num_channels)
+        return nullptr;
+    return image_ + entry.offset + channel * GetChannelBytes(entry);
+}
+
+size_t SampleCatalog::GetMipLevel(const Entry& entry, float increment)
+{
+    size_t mip = 0;
+    while(mip + 1 < entry.num_mips && increment > float(1u << mip))
+        mip++;
+    return mip;
+}
+
+const float*
+SampleCatalog::GetWaveTable(const Entry& entry, size_t table, size_t mip) const
+{
+    if(entry.kind != Kind::WAVETABLE || table >= entry.num_tables
+       || mip >= entry.num_mips)
+        return nullptr;
+    size_t pos = table * TableFloats(entry);
+    for(size_t m = 0; m < mip; m++)
+        pos += GetMipSize(entry, m);
+    return reinterpret_cast<const float*>(image_ + entry.offset) + pos;
+}
+
+bool SampleCatalog::Verify(const Entry& entry) const
+{
+    return Checksum(GetData(entry), entry.size) == entry.checksum;
+}
+
+uint32_t SampleCatalog::Checksum(const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint32_t       hash  = 2166136261u;
+    for(size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool SampleCatalog::CheckEntry(const Entry& entry, size_t image_size) const
+{
+    if(entry.name[kNameLength - 1] != '\0' || entry.num_channels == 0)
+        return false;
+    if(entry.offset % 4 != 0 || entry.offset > image_size
+       || entry.size > image_size - entry.offset)
+        return false;
+    if(entry.size % entry.num_channels != 0)
+        return false;
+    if(entry.kind == Kind::WAVETABLE)
+    {
+        // whole tables of floats, and the smallest mip still has samples
+        if(entry.format != kFormatFloat || entry.num_mips == 0
+           || entry.num_mips > 16
+           || GetMipSize(entry, entry.num_mips - 1) == 0)
+            return false;
+        const size_t bytes = entry.num_tables * TableFloats(entry) * 4;
+        return bytes == entry.size;
+    }
+    if(entry.kind != Kind::SAMPLE)
+        return false;
+    // every channel holds the blocks of all its frames, and the loop is
+    // inside the sample
+    const uint64_t bytes = CatalogEncodedSize(entry.format, entry.num_frames);
+    if(bytes > GetChannelBytes(entry))
+        return false;
+    return entry.loop_start <= entry.loop_end
+           && entry.loop_end <= entry.num_frames;
+}
+
+void SampleCatalogWriter::Init(uint8_t* buffer, size_t size, size_t max_entries)
+{
+    buffer_      = buffer;
+    size_        = size;
+    max_entries_ = max_entries;
+    num_entries_ = 0;
+    entries_ = reinterpret_cast<SampleCatalog::Entry*>(
+        buffer + sizeof(SampleCatalog::Header));
+    used_ = Align(sizeof(SampleCatalog::Header)
+                  + max_entries * sizeof(SampleCatalog::Entry));
+}
+
+uint8_t* SampleCatalogWriter::Add(const SampleCatalog::Entry& entry)
+{
+    if(num_entries_ >= max_entries_ || used_ > size_
+       || entry.size > size_ - used_)
+        return nullptr;
+    SampleCatalog::Entry& e = entries_[num_entries_++];
+    e                       = entry;
+    e.name[SampleCatalog::kNameLength - 1] = '\0';
+    e.offset                               = used_;
+
+    // the padding of the last entry may not fit
+    const size_t end = Align(used_ + entry.size);
+    used_            = end < size_ ? end : size_;
+    return buffer_ + e.offset;
+}
+
+size_t SampleCatalogWriter::Finish()
+{
+    // insertion sort, the order of the data doesn't change
+    for(size_t i = 1; i < num_entries_; i++)
+    {
+        const SampleCatalog::Entry e = entries_[i];
+        size_t                     j = i;
+        for(; j > 0 && CompareNames(entries_[j - 1].name, e.name) > 0; j--)
+            entries_[j] = entries_[j - 1];
+        entries_[j] = e;
+    }
+    for(size_t i = 0; i < num_entries_; i++)
+    {
+        if(i > 0 && CompareNames(entries_[i - 1].name, entries_[i].name) == 0)
+            return 0;
+        SampleCatalog::Entry& e = entries_[i];
+        e.checksum = SampleCatalog::Checksum(buffer_ + e.offset, e.size);
+    }
+
+    // the table keeps the room of max_entries_, the rest is zero
+    const size_t table_size = num_entries_ * sizeof(SampleCatalog::Entry);
+    memset(reinterpret_cast<uint8_t*>(entries_) + table_size,
+           0,
+           (max_entries_ - num_entries_) * sizeof(SampleCatalog::Entry));
+
+    SampleCatalog::Header header = {};
+    header.magic                 = SampleCatalog::kMagic;
+    header.format_version        = SampleCatalog::kFormatVersion;
+    header.num_entries           = num_entries_;
+    header.image_size            = used_;
+    header.checksum = SampleCatalog::Checksum(entries_, table_size);
+    memcpy(buffer_, &header, sizeof(header));
+    return used_;
+}
+
+size_t SampleCatalogWriter::GetImageSize(size_t        num_entries,
+                                         const size_t* sizes)
+{
+    size_t size = Align(sizeof(SampleCatalog::Header)
+                        + num_entries * sizeof(SampleCatalog::Entry));
+    for(size_t i = 0; i < num_entries; i++)
+        size += Align(sizes[i]);
+    return size;
+}
+
+} // namespace daisy
@@ -0,0 +1,255 @@
+#pragma once
+#ifndef DSY_SAMPLECATALOG_H
+#define DSY_SAMPLECATALOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace daisy
+{
+/** @brief Read only catalog of samples and wavetables in a memory mapped image.
+ *  @addtogroup utility
+ *
+ *  A catalog image is built on the host by the samplepack tool (see
+ *  tools/samplepack at the root of the repository) and flashed to the
+ *  QSPI chip. At boot, `Init()` checks the index of the image in place,
+ *  and the samples are then played straight from the memory mapped flash,
+ *  with no SD card and no copy to SDRAM:
+ *
+ *  \code
+ *  SampleCatalog catalog;
+ *  if(catalog.Init(hw.qspi.GetData(), kQspiSize) == SampleCatalog::Result::OK)
+ *  {
+ *      const SampleCatalog::Entry* kick = catalog.Find("kick");
+ *      const void* data = catalog.GetChannel(*kick, 0);
+ *  }
+ *  \endcode
+ *
+ *  The image starts with a header and a table of entries sorted by name,
+ *  followed by the data of each entry, aligned to kAlignment bytes:
+ *
+ *  | field            | size     |
+ *  |------------------|----------|
+ *  | magic            | 4 bytes  |
+ *  | format version   | 2 bytes  |
+ *  | number of entries| 2 bytes  |
+ *  | image size       | 4 bytes  |
+ *  | checksum         | 4 bytes, of the entry table |
+ *  | reserved         | 16 bytes |
+ *  | entries          | 72 bytes each, see Entry |
+ *
+ *  Samples store their channels one after the other, each encoded in the
+ *  format of the entry, whose values are those of daisysp::SampleCodec,
+ *  so a channel can be read with a daisysp::SampleReader. A channel holds
+ *  the whole blocks of its frames, SampleCodec::GetEncodedSize(), float
+ *  samples included. Wavetables are float, each table followed by its
+ *  mip-maps: band limited copies at half the length and half the
+ *  harmonics of the previous one, to play high notes without aliasing.
+ */
+class SampleCatalog
+{
+  public:
+    enum class Result
+    {
+        OK,
+        ERR_TOO_SMALL,
+        ERR_NOT_CATALOG,
+        ERR_VERSION,
+        ERR_CHECKSUM,
+        ERR_CORRUPT,
+    };
+
+    enum class Kind : uint8_t
+    {
+        SAMPLE,
+        WAVETABLE,
+    };
+
+    /** Marks the beginning of a catalog ("DSMP" in memory) */
+    static constexpr uint32_t kMagic = 0x504d5344;
+    /** Version of the image format */
+    static constexpr uint16_t kFormatVersion = 1;
+    /** Maximum length of a name, including the terminating zero */
+    static constexpr size_t kNameLength = 32;
+    /** Alignment of the data of each entry, a cache line of the M7 */
+    static constexpr size_t kAlignment = 32;
+    /** Format of float data, the FLOAT32 format of daisysp::SampleCodec */
+    static constexpr uint8_t kFormatFloat = 0;
+
+    struct Header
+    {
+        uint32_t magic;
+        uint16_t format_version;
+        uint16_t num_entries;
+        /** Size of the whole image in bytes */
+        uint32_t image_size;
+        /** FNV-1a hash of the entry table */
+        uint32_t checksum;
+        uint32_t reserved[4];
+    };
+
+    struct Entry
+    {
+        char name[kNameLength];
+        /** Position of the data from the start of the image */
+        uint32_t offset;
+        /** Size of the data of all channels in bytes */
+        uint32_t size;
+        /** Samples per channel, or all samples of all tables at mip 0 */
+        uint32_t num_frames;
+        uint32_t sample_rate;
+        /** First frame of the loop, and the frame after it. Both are 0 if
+         *  the sample has no loop.
+         */
+        uint32_t loop_start;
+        uint32_t loop_end;
+        /** FNV-1a hash of the data, see Verify() */
+        uint32_t checksum;
+        Kind     kind;
+        /** A daisysp::SampleCodec::Format */
+        uint8_t format;
+        uint8_t num_channels;
+        /** MIDI note of the recorded pitch */
+        uint8_t root_note;
+        /** Samples per table at mip 0, wavetables only */
+        uint16_t table_size;
+        uint16_t num_tables;
+        uint8_t  num_mips;
+        uint8_t  reserved[3];
+    };
+
+    SampleCatalog() : image_(nullptr), header_(nullptr), entries_(nullptr) {}
+    ~SampleCatalog() {}
+
+    /** Checks the header and the entry table of an image, in place.
+     *  The data of the entries is not read, see Verify().
+     *  \param image start of the image, e.g. QSPIHandle::GetData()
+     *  \param size bytes that can be read from image
+     */
+    Result Init(const void* image, size_t size);
+
+    /** \return number of entries, 0 until Init() succeeds */
+    inline size_t GetNumEntries() const
+    {
+        return header_ ? header_->num_entries : 0;
+    }
+
+    /** \return an entry in the order of the names, or nullptr */
+    inline const Entry* GetEntry(size_t idx) const
+    {
+        return idx < GetNumEntries() ? &entries_[idx] : nullptr;
+    }
+
+    /** Finds an entry by name with a binary search.
+     *  \return the entry, or nullptr if there is none
+     */
+    const Entry* Find(const char* name) const;
+
+    /** \return the data of an entry, inside the image */
+    inline const void* GetData(const Entry& entry) const
+    {
+        return image_ + entry.offset;
+    }
+
+    /** \return size of the data of each channel */
+    static inline size_t GetChannelBytes(const Entry& entry)
+    {
+        return entry.size / entry.num_channels;
+    }
+
+    /** \return the data of a channel, or nullptr */
+    const void* GetChannel(const Entry& entry, size_t channel) const;
+
+    /** \return length of a table at a mip level */
+    static inline size_t GetMipSize(const Entry& entry, size_t mip)
+    {
+        return entry.table_size >> mip;
+    }
+
+    /** Mip level for a phase increment, in samples of mip 0 per output
+     *  sample. The level has no harmonics above the Nyquist frequency.
+     */
+    static size_t GetMipLevel(const Entry& entry, float increment);
+
+    /** \return a table of a wavetable at a mip level, GetMipSize() floats,
+     *  or nullptr
+     */
+    const float*
+    GetWaveTable(const Entry& entry, size_t table, size_t mip) const;
+
+    /** Checks the data of an entry against its checksum. This reads all of
+     *  it, so it's slow for large entries.
+     */
+    bool Verify(const Entry& entry) const;
+
+    /** 32 bit FNV-1a hash, as used for the checksums of the image */
+    static uint32_t Checksum(const void* data, size_t size);
+
+  private:
+    bool CheckEntry(const Entry& entry, size_t image_size) const;
+
+    const uint8_t* image_;
+    const Header*  header_;
+    const Entry*   entries_;
+};
+
+/** @brief Lays out a SampleCatalog image in a buffer.
+ *  @addtogroup utility
+ *
+ *  Used by the samplepack tool, and by firmware that writes an image to
+ *  the QSPI flash itself, e.g. from files on an SD card.
+ *
+ *  \code
+ *  SampleCatalogWriter writer;
+ *  writer.Init(buffer, sizeof(buffer), 2);
+ *  SampleCatalog::Entry entry = {};
+ *  strcpy(entry.name, "kick");
+ *  entry.size = bytes;
+ *  ...
+ *  memcpy(writer.Add(entry), data, bytes);
+ *  size_t image_size = writer.Finish();
+ *  \endcode
+ */
+class SampleCatalogWriter
+{
+  public:
+    SampleCatalogWriter() {}
+    ~SampleCatalogWriter() {}
+
+    /** \param buffer memory for the image, 4 byte aligned
+     *  \param size size of buffer
+     *  \param max_entries number of entries the table has room for
+     */
+    void Init(uint8_t* buffer, size_t size, size_t max_entries);
+
+    /** Adds an entry. Its offset and checksum are set by the writer.
+     *  \return where to write entry.size bytes of data, or nullptr if the
+     *  buffer or the table is full
+     */
+    uint8_t* Add(const SampleCatalog::Entry& entry);
+
+    /** Sorts the entries, computes the checksums and writes the header.
+     *  \return size of the image, 0 if two entries have the same name
+     */
+    size_t Finish();
+
+    /** \return the size of an image with num_entries entries and the
+     *  given sizes of data, to allocate the buffer
+     */
+    static size_t GetImageSize(size_t num_entries, const size_t* sizes);
+
+  private:
+    static size_t Align(size_t size)
+    {
+        return (size + SampleCatalog::kAlignment - 1)
+               & ~(SampleCatalog::kAlignment - 1);
+    }
+
+    uint8_t*              buffer_;
+    size_t                size_, max_entries_, num_entries_, used_;
+    SampleCatalog::Entry* entries_;
+};
+
+} // namespace daisy
+
+#endif
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifndef UNIT_TEST // provide dummy implementation for unit tests
+// the device header enables the FPU register access in CMSIS
+#include "stm32h7xx.h"
+
+namespace daisy
+{
+/** @brief Enables flush-to-zero mode of the FPU with RAII techniques
+ *  @addtogroup utility
+ *
+ *  While the object exists, subnormal floating point results are replaced
+ *  by zero (FPSCR.FZ). This keeps decaying filter and feedback states in
+ *  the audio callback from slowing down the CPU when the input is silent.
+ *  The previous mode is restored when the object goes out of scope.
+ *  The `AudioHandle` uses this around every audio callback.
+ *
+ *  This is the Cortex-M7 part of `daisysp::FtzScope`: libDaisy doesn't
+ *  depend on DaisySP, so it keeps its own copy.
+ */
+class ScopedFlushToZero
+{
+  public:
+    ScopedFlushToZero()
+    {
+        fpscr_ = __get_FPSCR();
+        __set_FPSCR(fpscr_ | kFpscrFz);
+    }
+
+    ~ScopedFlushToZero() { __set_FPSCR(fpscr_); }
+
+  private:
+    static constexpr uint32_t kFpscrFz = 1u << 24;
+
+    uint32_t fpscr_;
+};
+} // namespace daisy
+
+#else // ifndef UNIT_TEST
+
+namespace daisy
+{
+/** A dummy implementation for unit tests */
+class ScopedFlushToZero
+{
+  public:
+    ScopedFlushToZero() {}
+    ~ScopedFlushToZero() = default;
+};
+} // namespace daisy
+
+#endif
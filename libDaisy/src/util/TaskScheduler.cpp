@@ -0,0 +1,276 @@
+#include <string.h>
+#include "util/TaskScheduler.h"
+
+using namespace daisy;
+
+constexpr size_t TaskScheduler::kMaxTasks;
+constexpr int    TaskScheduler::kInvalidTask;
+
+void TaskScheduler::Init()
+{
+    for(size_t i = 0; i < kMaxTasks; i++)
+    {
+        task_[i].used        = false;
+        task_[i].pending     = false;
+        task_[i].rescheduled = false;
+    }
+    clock_        = 0;
+    last_tick_    = 0;
+    ticks_per_us_ = 0;
+    ResetStats();
+}
+
+int TaskScheduler::AddTask(const TaskConfig& config)
+{
+    if(config.function == nullptr)
+        return kInvalidTask;
+    for(size_t i = 0; i < kMaxTasks; i++)
+    {
+        if(task_[i].used)
+            continue;
+        Start();
+        Task& t   = task_[i];
+        t.config  = config;
+        t.release = Now() + ToTicks(config.delay_us);
+        t.used    = true;
+        t.pending = true;
+        memset(&t.stats, 0, sizeof(t.stats));
+        return int(i);
+    }
+    return kInvalidTask;
+}
+
+void TaskScheduler::RemoveTask(int task)
+{
+    if(IsValid(task))
+    {
+        task_[task].used    = false;
+        task_[task].pending = false;
+    }
+}
+
+void TaskScheduler::Schedule(int task, uint32_t delay_us)
+{
+    if(IsValid(task))
+    {
+        task_[task].release     = Now() + ToTicks(delay_us);
+        task_[task].pending     = true;
+        task_[task].rescheduled = task == running_;
+    }
+}
+
+void TaskScheduler::Cancel(int task)
+{
+    if(IsValid(task))
+        task_[task].pending = false;
+}
+
+size_t TaskScheduler::Process()
+{
+    // a bit per task that ran or waited in this call
+    uint32_t done = 0;
+    size_t   ran  = 0;
+    while(true)
+    {
+        const uint64_t now           = Now();
+        int            next          = kInvalidTask;
+        uint64_t       next_deadline = 0;
+        for(size_t i = 0; i < kMaxTasks; i++)
+        {
+            const Task& t = task_[i];
+            if(!t.pending || (done & (1u << i)) != 0 || now < t.release)
+                continue;
+            // no deadline sorts last
+            const uint64_t deadline = Deadline(t) > 0
+                                          ? t.release + ToTicks(Deadline(t))
+                                          : UINT64_MAX;
+            if(next == kInvalidTask
+               || t.config.priority > task_[next].config.priority
+               || (t.config.priority == task_[next].config.priority
+                   && deadline < next_deadline))
+            {
+                next          = int(i);
+                next_deadline = deadline;
+            }
+        }
+        if(next == kInvalidTask)
+            break;
+
+        done |= 1u << next;
+        if(Fits(next, now))
+        {
+            Run(next);
+            ran++;
+        }
+        else
+        {
+            task_[next].stats.deferrals++;
+        }
+    }
+    return ran;
+}
+
+uint32_t TaskScheduler::GetTimeToNextUs() const
+{
+    const uint64_t now  = Now();
+    uint32_t       wait = UINT32_MAX;
+    for(size_t i = 0; i < kMaxTasks; i++)
+    {
+        const Task& t = task_[i];
+        if(!t.pending)
+            continue;
+        if(t.release <= now)
+            return 0;
+        const uint32_t us = ToUs(t.release - now);
+        wait              = us < wait ? us : wait;
+    }
+    return wait;
+}
+
+uint32_t TaskScheduler::GetTimeLeftUs() const
+{
+    if(running_ == kInvalidTask)
+        return UINT32_MAX;
+    const uint64_t now  = Now();
+    uint32_t       left = UINT32_MAX;
+    for(size_t i = 0; i < kMaxTasks; i++)
+    {
+        const Task& t = task_[i];
+        if(!t.pending || Deadline(t) == 0
+           || t.config.priority <= task_[running_].config.priority)
+            continue;
+        // the latest start that still meets the deadline
+        const uint32_t budget = t.config.budget_us < Deadline(t)
+                                    ? t.config.budget_us
+                                    : Deadline(t);
+        const uint64_t start = t.release + ToTicks(Deadline(t) - budget);
+        if(start <= now)
+            return 0;
+        const uint32_t us = ToUs(start - now);
+        left              = us < left ? us : left;
+    }
+    return left;
+}
+
+const TaskScheduler::TaskStats& TaskScheduler::GetStats(int task) const
+{
+    return task_[IsValid(task) ? task : 0].stats;
+}
+
+const char* TaskScheduler::GetName(int task) const
+{
+    return IsValid(task) ? task_[task].config.name : "";
+}
+
+void TaskScheduler::ResetStats()
+{
+    for(size_t i = 0; i < kMaxTasks; i++)
+        memset(&task_[i].stats, 0, sizeof(task_[i].stats));
+}
+
+#ifdef UNIT_TEST
+void TaskScheduler::Simulate(uint32_t duration_us)
+{
+    Start();
+    const uint64_t end = Now() + ToTicks(duration_us);
+    while(Now() < end)
+    {
+        if(Process() > 0)
+            continue;
+        // nothing could run: on to the next release, less than a wrap of
+        // the ticks away
+        const uint64_t now  = Now();
+        uint64_t       next = end;
+        for(size_t i = 0; i < kMaxTasks; i++)
+        {
+            const Task& t = task_[i];
+            if(t.pending && now < t.release && t.release < next)
+                next = t.release;
+        }
+        const uint64_t jump = next - now < 0x80000000u ? next - now
+                                                       : 0x80000000u;
+        System::SetTickForUnitTest(last_tick_ + uint32_t(jump));
+    }
+}
+#endif
+
+void TaskScheduler::Start()
+{
+    if(ticks_per_us_ > 0)
+        return;
+    const uint32_t ticks_per_us = System::GetTickFreq() / 1000000;
+    ticks_per_us_               = ticks_per_us > 0 ? ticks_per_us : 1;
+    last_tick_                  = System::GetTick();
+}
+
+uint64_t TaskScheduler::Now() const
+{
+    // the difference is right across one wrap of the ticks
+    const uint32_t tick = System::GetTick();
+    clock_ += uint32_t(tick - last_tick_);
+    last_tick_ = tick;
+    return clock_;
+}
+
+bool TaskScheduler::Fits(size_t task, uint64_t now) const
+{
+    const uint32_t budget = task_[task].config.budget_us;
+    if(budget == 0)
+        return true;
+    // the run may not push a more urgent task past its deadline
+    for(size_t i = 0; i < kMaxTasks; i++)
+    {
+        const Task& t = task_[i];
+        if(i == task || !t.pending || Deadline(t) == 0
+           || t.config.priority <= task_[task].config.priority)
+            continue;
+        const uint32_t slack = t.config.budget_us < Deadline(t)
+                                   ? Deadline(t) - t.config.budget_us
+                                   : 0;
+        if(t.release + ToTicks(slack) < now + ToTicks(budget))
+            return false;
+    }
+    return true;
+}
+
+void TaskScheduler::Run(size_t task)
+{
+    Task&          t      = task_[task];
+    TaskStats&     s      = t.stats;
+    const uint64_t start  = Now();
+    const uint64_t period = ToTicks(t.config.period_us);
+    // a task a period late or more drops the releases it missed
+    if(period > 0 && start >= t.release + period)
+    {
+        const uint64_t missed = (start - t.release) / period;
+        t.release += missed * period;
+        s.skipped += uint32_t(missed);
+    }
+
+    const uint64_t release = t.release;
+    t.rescheduled          = false;
+    running_               = int(task);
+    t.config.function(t.config.context);
+    running_           = kInvalidTask;
+    const uint64_t end = Now();
+
+    const uint32_t elapsed = ToUs(end - start);
+    const uint32_t latency = ToUs(start - release);
+    s.runs++;
+    s.last_us = elapsed;
+    s.max_us  = elapsed > s.max_us ? elapsed : s.max_us;
+    s.total_us += elapsed;
+    s.max_latency_us = latency > s.max_latency_us ? latency : s.max_latency_us;
+    if(Deadline(t) > 0 && end > release + ToTicks(Deadline(t)))
+        s.deadline_misses++;
+    if(t.config.budget_us > 0 && elapsed > t.config.budget_us)
+        s.budget_overruns++;
+
+    // the task may have removed, cancelled or scheduled itself
+    if(!t.used || !t.pending || t.rescheduled)
+        return;
+    if(period > 0)
+        t.release += period;
+    else
+        t.pending = false;
+}
@@ -0,0 +1,215 @@
+#pragma once
+#ifndef DSY_TASKSCHEDULER_H
+#define DSY_TASKSCHEDULER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sys/system.h"
+
+namespace daisy
+{
+/** @brief Cooperative scheduler for the tasks of the main loop
+ *  @addtogroup utility
+ *
+ *  Tasks are functions that return after a short piece of work: polling
+ *  the controls, UI::Process(), refilling the buffers of a player,
+ *  writing a recording. Each task is periodic, or runs once after a
+ *  delay, and has a priority. Process() runs the tasks that are due,
+ *  the highest priority first, and the earliest deadline first among
+ *  tasks of the same priority. The time comes from the ticks of
+ *  System::GetTick(), counted on in 64 bits past the wrap of the timer
+ *  (every 21.47 s on the Daisy Seed): something has to call the
+ *  scheduler at least once per wrap, and the tasks are added after
+ *  System::Init(), when the frequency of the ticks is known.
+ *
+ *  Nothing interrupts a task once it runs. A task that declares a
+ *  budget, the longest it runs, only starts when it leaves every more
+ *  urgent task time to meet its deadline: background work with a budget
+ *  never delays the UI or the refills of a stream. Long jobs can also
+ *  work in pieces for as long as GetTimeLeftUs() allows.
+ *
+ *  Every task keeps statistics of its runs: run times, latencies,
+ *  deadlines missed, budgets overrun and periods skipped.
+ *
+ *  On the host (UNIT_TEST), Simulate() drives the virtual ticks of
+ *  System, and tasks model their run time by moving them forward.
+ *
+ *  \code
+ *  TaskScheduler scheduler;
+ *
+ *  TaskScheduler::TaskConfig buttons;
+ *  buttons.function    = PollButtons;
+ *  buttons.period_us   = 1000;
+ *  buttons.deadline_us = 500;
+ *  buttons.budget_us   = 20;
+ *  buttons.priority    = 2;
+ *  scheduler.AddTask(buttons);
+ *
+ *  while(1)
+ *      scheduler.Process();
+ *  \endcode
+ */
+class TaskScheduler
+{
+  public:
+    typedef void (*TaskFunction)(void* context);
+
+    static constexpr size_t kMaxTasks    = 16;
+    static constexpr int    kInvalidTask = -1;
+
+    struct TaskConfig
+    {
+        TaskConfig()
+        : function(nullptr),
+          context(nullptr),
+          name(""),
+          period_us(0),
+          delay_us(0),
+          deadline_us(0),
+          budget_us(0),
+          priority(0)
+        {
+        }
+
+        TaskFunction function;
+        void*        context;
+        /** For the statistics, not copied */
+        const char* name;
+        /** Time between two releases, 0 for a task that runs once */
+        uint32_t period_us;
+        /** Time from AddTask() to the first release */
+        uint32_t delay_us;
+        /** Time from a release to the end of the run. 0 is the period, or
+         *  no deadline for a task that runs once.
+         */
+        uint32_t deadline_us;
+        /** Longest run of the task, 0 if unknown. Tasks with a budget wait
+         *  when they would make a more urgent task miss its deadline.
+         */
+        uint32_t budget_us;
+        /** Higher runs first */
+        uint8_t priority;
+    };
+
+    struct TaskStats
+    {
+        uint32_t runs;
+        /** Runs that ended after their deadline */
+        uint32_t deadline_misses;
+        /** Runs longer than the budget */
+        uint32_t budget_overruns;
+        /** Releases dropped because the task was a period late or more */
+        uint32_t skipped;
+        /** Calls of Process() that held the task back for a more urgent
+         *  one
+         */
+        uint32_t deferrals;
+        /** Run times */
+        uint32_t last_us;
+        uint32_t max_us;
+        uint64_t total_us;
+        /** Longest time from a release to the start of the run */
+        uint32_t max_latency_us;
+    };
+
+    TaskScheduler() : running_(kInvalidTask) { Init(); }
+    ~TaskScheduler() {}
+
+    /** Removes all tasks */
+    void Init();
+
+    /** Adds a task, released after its delay
+     *  \return id of the task, or kInvalidTask when the config is invalid
+     *  or there are kMaxTasks tasks already
+     */
+    int AddTask(const TaskConfig& config);
+
+    void RemoveTask(int task);
+
+    /** Releases a task after a delay, e.g. to run a one-shot task again,
+     *  or to move the phase of a periodic one
+     */
+    void Schedule(int task, uint32_t delay_us);
+
+    /** Stops a task until Schedule() */
+    void Cancel(int task);
+
+    /** Runs the tasks that are due, each once at most
+     *  \return number of tasks that ran
+     */
+    size_t Process();
+
+    /** \return time until the next release, 0 if a task is due,
+     *  UINT32_MAX without tasks
+     */
+    uint32_t GetTimeToNextUs() const;
+
+    /** \return for the running task, the time it can still take before
+     *  a more urgent task has to start, UINT32_MAX if none is waiting
+     */
+    uint32_t GetTimeLeftUs() const;
+
+    /** \return id of the running task, or kInvalidTask */
+    inline int GetRunningTask() const { return running_; }
+
+    const TaskStats& GetStats(int task) const;
+    const char*      GetName(int task) const;
+
+    void ResetStats();
+
+#ifdef UNIT_TEST
+    /** Runs the tasks for a duration of virtual time, jumping the ticks
+     *  of System over the time nothing is due
+     */
+    void Simulate(uint32_t duration_us);
+#endif
+
+  private:
+    struct Task
+    {
+        TaskConfig config;
+        TaskStats  stats;
+        /** In ticks of the clock */
+        uint64_t release;
+        bool     used, pending, rescheduled;
+    };
+
+    inline bool IsValid(int task) const
+    {
+        return task >= 0 && task < int(kMaxTasks) && task_[task].used;
+    }
+
+    inline uint32_t Deadline(const Task& t) const
+    {
+        return t.config.deadline_us > 0 ? t.config.deadline_us
+                                        : t.config.period_us;
+    }
+
+    inline uint64_t ToTicks(uint32_t us) const
+    {
+        return uint64_t(us) * ticks_per_us_;
+    }
+
+    inline uint32_t ToUs(uint64_t ticks) const
+    {
+        const uint64_t us = ticks / ticks_per_us_;
+        return us < UINT32_MAX ? uint32_t(us) : UINT32_MAX;
+    }
+
+    /** Starts the clock with the first task */
+    void     Start();
+    uint64_t Now() const;
+    bool     Fits(size_t task, uint64_t now) const;
+    void     Run(size_t task);
+
+    Task task_[kMaxTasks];
+    int  running_;
+    /** The ticks of System, without the wraps */
+    mutable uint64_t clock_;
+    mutable uint32_t last_tick_;
+    uint32_t         ticks_per_us_;
+};
+
+} // namespace daisy
+
+#endif
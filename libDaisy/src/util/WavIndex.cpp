@@ -0,0 +1,306 @@
+#include <string.h>
+#include <algorithm>
+#include "util/WavIndex.h"
+
+namespace daisy
+{
+constexpr char WavIndex::kFileName[];
+
+namespace
+{
+struct FileHeader
+{
+    uint32_t magic;
+    uint16_t format_version;
+    uint16_t record_size;
+    uint32_t num_records;
+    uint32_t dir_checksum;
+    uint32_t checksum;
+    uint32_t reserved[3];
+};
+
+constexpr uint32_t kFnvBasis = 2166136261u;
+
+/** 32 bit FNV-1a, continued from hash */
+uint32_t Fnv(uint32_t hash, const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for(size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/** Case insensitive ".wav" at the end of the name */
+bool IsWavName(const char* name)
+{
+    const size_t len = strlen(name);
+    if(len < 4 || name[len - 4] != '.')
+        return false;
+    const char* ext = "wav";
+    for(size_t i = 0; i < 3; i++)
+    {
+        const char c = name[len - 3 + i];
+        if(c != ext[i] && c != ext[i] - 'a' + 'A')
+            return false;
+    }
+    return true;
+}
+
+/** The part of a record that says whether the file changed */
+bool SameFile(const WavIndex::Record& a, const WavIndex::Record& b)
+{
+    return a.file_size == b.file_size && a.fdate == b.fdate
+           && a.ftime == b.ftime;
+}
+
+size_t ReadFile(void* context, void* dst, size_t size)
+{
+    UINT read = 0;
+    if(f_read(static_cast<FIL*>(context), dst, size, &read) != FR_OK)
+        return 0;
+    return read;
+}
+
+bool SeekFile(void* context, uint32_t position)
+{
+    return f_lseek(static_cast<FIL*>(context), position) == FR_OK;
+}
+} // namespace
+
+WavIndex::Result
+WavIndex::Init(const char* dir, Record* records, size_t max_records)
+{
+    records_     = records;
+    max_records_ = max_records;
+    num_records_ = 0;
+    num_skipped_ = 0;
+    rebuilt_     = false;
+    dirty_       = false;
+    strncpy(dir_, dir, kPathLength - 1);
+    dir_[kPathLength - 1] = '\0';
+
+    DIR d;
+    if(f_opendir(&d, dir_) != FR_OK)
+        return Result::ERR_NO_DIR;
+    ListDirectory(&d);
+    f_closedir(&d);
+
+    std::sort(records_,
+              records_ + num_records_,
+              [](const Record& a, const Record& b) {
+                  return strcmp(a.name, b.name) < 0;
+              });
+
+    // the state of the directory, independent of the order of f_readdir()
+    dir_checksum_ = kFnvBasis;
+    for(size_t i = 0; i < num_records_; i++)
+    {
+        // field by field, whatever the layout of Record
+        const Record& r    = records_[i];
+        uint32_t      hash = Fnv(dir_checksum_, r.name, strlen(r.name));
+        hash               = Fnv(hash, &r.file_size, sizeof(r.file_size));
+        hash               = Fnv(hash, &r.fdate, sizeof(r.fdate));
+        dir_checksum_      = Fnv(hash, &r.ftime, sizeof(r.ftime));
+    }
+
+    MergeIndexFile(dir_checksum_);
+    return dirty_ ? Save() : Result::OK;
+}
+
+void WavIndex::ListDirectory(DIR* dir)
+{
+    FILINFO fno;
+    while(f_readdir(dir, &fno) == FR_OK && fno.fname[0] != '\0')
+    {
+        if((fno.fattrib & (AM_HID | AM_DIR)) || !IsWavName(fno.fname))
+            continue;
+        if(num_records_ >= max_records_ || strlen(fno.fname) >= kNameLength)
+        {
+            num_skipped_++;
+            continue;
+        }
+        Record& r = records_[num_records_++];
+        memset(&r, 0, sizeof(r));
+        strcpy(r.name, fno.fname);
+        r.file_size = fno.fsize;
+        r.fdate     = fno.fdate;
+        r.ftime     = fno.ftime;
+        r.state     = HeaderState::PENDING;
+    }
+}
+
+void WavIndex::MergeIndexFile(uint32_t dir_checksum)
+{
+    // without a usable index file, all headers stay pending
+    rebuilt_ = true;
+    dirty_   = true;
+
+    char path[kPathLength];
+    FIL  file;
+    if(!MakePath(kFileName, path, sizeof(path))
+       || f_open(&file, path, FA_OPEN_EXISTING | FA_READ) != FR_OK)
+        return;
+
+    FileHeader header;
+    if(ReadFile(&file, &header, sizeof(header)) != sizeof(header)
+       || header.magic != kMagic || header.format_version != kFormatVersion
+       || header.record_size != sizeof(Record))
+    {
+        f_close(&file);
+        return;
+    }
+
+    // both lists are sorted, so the old records are matched in one pass
+    uint32_t checksum = kFnvBasis;
+    size_t   matched = 0, pos = 0;
+    for(uint32_t i = 0; i < header.num_records; i++)
+    {
+        Record old;
+        if(ReadFile(&file, &old, sizeof(old)) != sizeof(old))
+            break;
+        checksum = Fnv(checksum, &old, sizeof(old));
+        old.name[kNameLength - 1] = '\0';
+        while(pos < num_records_ && strcmp(records_[pos].name, old.name) < 0)
+            pos++;
+        if(pos < num_records_ && strcmp(records_[pos].name, old.name) == 0
+           && SameFile(records_[pos], old))
+        {
+            records_[pos] = old;
+            matched++;
+        }
+    }
+    f_close(&file);
+
+    if(checksum != header.checksum)
+    {
+        // a damaged index, its headers can't be trusted
+        for(size_t i = 0; i < num_records_; i++)
+            records_[i].state = HeaderState::PENDING;
+        return;
+    }
+    if(header.dir_checksum == dir_checksum && header.num_records == matched
+       && matched == num_records_)
+    {
+        rebuilt_ = false;
+        dirty_   = false;
+    }
+}
+
+int WavIndex::Find(const char* name) const
+{
+    size_t lo = 0, hi = num_records_;
+    while(lo < hi)
+    {
+        const size_t mid = lo + (hi - lo) / 2;
+        const int    cmp = strcmp(records_[mid].name, name);
+        if(cmp == 0)
+            return static_cast<int>(mid);
+        if(cmp < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return -1;
+}
+
+bool WavIndex::MakePath(const char* name, char* path, size_t size) const
+{
+    const size_t dir_len  = strlen(dir_);
+    const bool   slash    = dir_len > 0 && dir_[dir_len - 1] != '/';
+    const size_t name_len = strlen(name);
+    if(dir_len + slash + name_len + 1 > size)
+        return false;
+    memcpy(path, dir_, dir_len);
+    if(slash)
+        path[dir_len] = '/';
+    memcpy(path + dir_len + slash, name, name_len + 1);
+    return true;
+}
+
+bool WavIndex::GetPath(size_t idx, char* path, size_t size) const
+{
+    return idx < num_records_ && MakePath(records_[idx].name, path, size);
+}
+
+WavIndex::Result WavIndex::LoadHeader(size_t idx)
+{
+    if(idx >= num_records_)
+        return Result::ERR_INVALID_INDEX;
+    Record& r = records_[idx];
+    if(r.state != HeaderState::PENDING)
+        return r.state == HeaderState::VALID ? Result::OK
+                                             : Result::ERR_NOT_WAV;
+
+    char path[kPathLength];
+    FIL  file;
+    if(!GetPath(idx, path, sizeof(path))
+       || f_open(&file, path, FA_OPEN_EXISTING | FA_READ) != FR_OK)
+        return Result::ERR_OPEN;
+    WavReader reader;
+    if(reader.Open(&file, ReadFile, SeekFile) == WavReader::Result::OK)
+    {
+        Update(idx, reader);
+    }
+    else
+    {
+        r.state = HeaderState::INVALID;
+        dirty_  = true;
+    }
+    f_close(&file);
+    return r.state == HeaderState::VALID ? Result::OK : Result::ERR_NOT_WAV;
+}
+
+void WavIndex::Update(size_t idx, const WavReader& reader)
+{
+    if(idx >= num_records_ || records_[idx].state == HeaderState::VALID)
+        return;
+    Record&                  r   = records_[idx];
+    const WavReader::Format& fmt = reader.GetFormat();
+    r.sample_rate     = fmt.sample_rate;
+    r.num_frames      = fmt.num_frames;
+    r.num_channels    = fmt.num_channels;
+    r.bits_per_sample = static_cast<uint8_t>(fmt.bits_per_sample);
+    r.sample_format   = static_cast<uint8_t>(fmt.sample_format);
+    r.root_note       = reader.GetRootNote();
+    const WavReader::Loop* loop = reader.GetLoop(0);
+    r.loop_start                = loop ? loop->start : 0;
+    r.loop_end                  = loop ? loop->end : 0;
+    r.state                     = HeaderState::VALID;
+    dirty_                      = true;
+}
+
+WavIndex::Result WavIndex::Save()
+{
+    if(!dirty_)
+        return Result::OK;
+
+    FileHeader header     = {};
+    header.magic          = kMagic;
+    header.format_version = kFormatVersion;
+    header.record_size    = sizeof(Record);
+    header.num_records    = num_records_;
+    header.dir_checksum   = dir_checksum_;
+    header.checksum
+        = Fnv(kFnvBasis, records_, num_records_ * sizeof(Record));
+
+    char path[kPathLength];
+    FIL  file;
+    if(!MakePath(kFileName, path, sizeof(path))
+       || f_open(&file, path, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+        return Result::ERR_WRITE;
+    UINT       written = 0, total = 0;
+    const UINT records = num_records_ * sizeof(Record);
+    f_write(&file, &header, sizeof(header), &written);
+    total += written;
+    f_write(&file, records_, records, &written);
+    total += written;
+    if(f_close(&file) != FR_OK || total != sizeof(header) + records)
+        return Result::ERR_WRITE;
+    dirty_ = false;
+    return Result::OK;
+}
+
+} // namespace daisy
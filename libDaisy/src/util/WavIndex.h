@@ -0,0 +1,179 @@
+#pragma once
+#ifndef DSY_WAVINDEX_H
+#define DSY_WAVINDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ff.h"
+#include "util/WavReader.h"
+
+namespace daisy
+{
+/** @brief Sorted index of the WAV files of a directory, cached on the card.
+ *  @addtogroup utility
+ *
+ *  Opening every file of a directory to read its header makes the boot
+ *  slow once the card holds many files. The index keeps the name, the
+ *  size, the format and the first loop of each file in a file of the
+ *  directory (kFileName), along with a checksum of the state of the
+ *  directory: the name, size and modification time of every WAV file.
+ *
+ *  `Init()` lists the directory, which reads no file, and compares the
+ *  checksum to the one of the index file. When they match, the records
+ *  are read back in one go. When files were added, removed or changed,
+ *  the index is written again: records of unchanged files are kept, the
+ *  headers of the others are only read when they are needed, by
+ *  `LoadHeader()`, and stored by the next `Save()`.
+ *
+ *  The records live in memory passed by the application and are sorted by
+ *  name, so a file is found by a binary search. Thousands of files fit in
+ *  a buffer in SDRAM:
+ *
+ *  \code
+ *  WavIndex::Record DSY_SDRAM_BSS records[4096];
+ *  WavIndex index;
+ *  index.Init("0:/samples", records, 4096);
+ *  int idx = index.Find("kick.wav");
+ *  if(idx >= 0 && index.LoadHeader(idx) == WavIndex::Result::OK)
+ *      uint32_t rate = index.GetRecord(idx)->sample_rate;
+ *  \endcode
+ *
+ *  Records are 96 bytes. The index file has a 32 byte header followed by
+ *  the records:
+ *
+ *  | field              | size    |
+ *  |--------------------|---------|
+ *  | magic              | 4 bytes |
+ *  | format version     | 2 bytes |
+ *  | record size        | 2 bytes |
+ *  | number of records  | 4 bytes |
+ *  | directory checksum | 4 bytes |
+ *  | checksum           | 4 bytes, of the records |
+ *  | reserved           | 12 bytes |
+ */
+class WavIndex
+{
+  public:
+    enum class Result
+    {
+        OK,
+        ERR_NO_DIR,
+        ERR_INVALID_INDEX,
+        ERR_OPEN,
+        ERR_NOT_WAV,
+        ERR_WRITE,
+    };
+
+    enum class HeaderState : uint8_t
+    {
+        /** Not read yet, see LoadHeader() */
+        PENDING,
+        VALID,
+        /** The file couldn't be read as a WAV file */
+        INVALID,
+    };
+
+    struct Record
+    {
+        /** Name of the file in the directory */
+        char     name[64];
+        uint32_t file_size;
+        /** Modification date and time, as in FILINFO */
+        uint16_t fdate, ftime;
+        /** The fields below are set once the state is VALID */
+        uint32_t sample_rate;
+        uint32_t num_frames;
+        /** First loop of the `smpl` chunk, both 0 if there is none */
+        uint32_t    loop_start, loop_end;
+        uint16_t    num_channels;
+        uint8_t     bits_per_sample;
+        uint8_t     sample_format; /**< A WavReader::SampleFormat */
+        uint8_t     root_note;
+        HeaderState state;
+        uint8_t     reserved[2];
+    };
+
+    /** Longest name of a file, including the terminating zero. Files with
+     *  longer names are left out of the index.
+     */
+    static constexpr size_t kNameLength = sizeof(Record::name);
+    /** Longest path of a file, as in FatFs */
+    static constexpr size_t kPathLength = 256;
+    /** Name of the index file in the directory */
+    static constexpr char kFileName[] = "wavindex.dat";
+    /** Marks the beginning of an index file ("WIDX" in the file) */
+    static constexpr uint32_t kMagic = 0x58444957;
+    /** Version of the format of the index file */
+    static constexpr uint16_t kFormatVersion = 1;
+
+    WavIndex() : records_(nullptr), num_records_(0), max_records_(0) {}
+    ~WavIndex() {}
+
+    /** Lists a directory and loads or updates its index file.
+     *  \param dir path of the directory, e.g. "0:/" or "0:/samples"
+     *  \param records memory for the records
+     *  \param max_records number of records that fit. Further files are
+     *  left out, see GetNumSkipped().
+     *  \return OK, ERR_NO_DIR, or ERR_WRITE if the index file couldn't be
+     *  written. The records are usable in both of the last cases.
+     */
+    Result Init(const char* dir, Record* records, size_t max_records);
+
+    /** \return number of WAV files in the index */
+    inline size_t GetNumFiles() const { return num_records_; }
+
+    /** \return number of WAV files left out, because there was no room
+     *  for them or their name was too long
+     */
+    inline size_t GetNumSkipped() const { return num_skipped_; }
+
+    /** \return true if Init() found the directory changed, or the index
+     *  file missing, and wrote a new index
+     */
+    inline bool WasRebuilt() const { return rebuilt_; }
+
+    /** \return a record in the order of the names, or nullptr */
+    inline const Record* GetRecord(size_t idx) const
+    {
+        return idx < num_records_ ? &records_[idx] : nullptr;
+    }
+
+    /** Finds a file by name with a binary search.
+     *  \return the index of the file, or -1 if there is none
+     */
+    int Find(const char* name) const;
+
+    /** Writes the path of a file, its directory and its name.
+     *  \return false if the index is invalid or the path doesn't fit
+     */
+    bool GetPath(size_t idx, char* path, size_t size) const;
+
+    /** Reads the header of a file if it wasn't read yet. This opens the
+     *  file, so it isn't for the audio callback.
+     *  \return OK if the record is VALID
+     */
+    Result LoadHeader(size_t idx);
+
+    /** Fills the record of a file that isn't VALID yet from a reader that
+     *  opened it, e.g. the one used to play it, at no extra cost.
+     */
+    void Update(size_t idx, const WavReader& reader);
+
+    /** Writes the index file if a record changed since Init() */
+    Result Save();
+
+  private:
+    void ListDirectory(DIR* dir);
+    void MergeIndexFile(uint32_t dir_checksum);
+    bool MakePath(const char* name, char* path, size_t size) const;
+
+    char     dir_[kPathLength];
+    Record*  records_;
+    size_t   num_records_, max_records_, num_skipped_;
+    uint32_t dir_checksum_;
+    bool     rebuilt_, dirty_;
+};
+
+} // namespace daisy
+
+#endif
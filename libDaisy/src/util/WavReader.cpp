@@ -0,0 +1,338 @@
+#include <string.h>
+#include "util/WavReader.h"
+#include "daisy_core.h"
+
+namespace daisy
+{
+namespace
+{
+constexpr size_t kFormatChunkSize     = 16;
+constexpr size_t kExtensibleChunkSize = 40;
+constexpr size_t kSamplerHeaderSize   = 36;
+constexpr size_t kSamplerLoopSize     = 24;
+constexpr size_t kCuePointSize        = 24;
+constexpr uint8_t kDefaultRootNote    = 60;
+
+inline uint16_t Le16(const uint8_t* p)
+{
+    return uint16_t(p[0]) | uint16_t(p[1]) << 8;
+}
+
+inline uint32_t Le32(const uint8_t* p)
+{
+    return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16
+           | uint32_t(p[3]) << 24;
+}
+
+/** Converts one raw little endian sample of kBytes bytes to float */
+template <size_t kBytes>
+inline float Decode(const uint8_t* p);
+
+template <>
+inline float Decode<1>(const uint8_t* p)
+{
+    return float(int32_t(p[0]) - 128) * S82F_SCALE;
+}
+
+template <>
+inline float Decode<2>(const uint8_t* p)
+{
+    return float(int16_t(Le16(p))) * S162F_SCALE;
+}
+
+template <>
+inline float Decode<3>(const uint8_t* p)
+{
+    // the 24 bits go to the top of an int32, which keeps the sign
+    const uint32_t v = uint32_t(p[0]) << 8 | uint32_t(p[1]) << 16
+                       | uint32_t(p[2]) << 24;
+    return float(int32_t(v)) * S322F_SCALE;
+}
+
+template <>
+inline float Decode<4>(const uint8_t* p)
+{
+    return float(int32_t(Le32(p))) * S322F_SCALE;
+}
+
+/** Converts n raw samples at the start of dst to floats, in place.
+ *
+ *  The samples are converted from the last to the first, four at a time.
+ *  A float is never narrower than a raw sample, so float i starts at or
+ *  after raw sample i, and each store only overwrites raw samples that are
+ *  already converted, or were loaded just before.
+ */
+template <size_t kBytes>
+void ConvertInPlace(float* dst, size_t n)
+{
+    const uint8_t* raw = reinterpret_cast<const uint8_t*>(dst);
+    size_t         i   = n;
+    for(; i % 4 != 0; i--)
+        dst[i - 1] = Decode<kBytes>(raw + (i - 1) * kBytes);
+    for(; i > 0; i -= 4)
+    {
+        const uint8_t* p = raw + (i - 4) * kBytes;
+        const float    a = Decode<kBytes>(p);
+        const float    b = Decode<kBytes>(p + kBytes);
+        const float    c = Decode<kBytes>(p + 2 * kBytes);
+        const float    d = Decode<kBytes>(p + 3 * kBytes);
+        dst[i - 4]       = a;
+        dst[i - 3]       = b;
+        dst[i - 2]       = c;
+        dst[i - 1]       = d;
+    }
+}
+
+#if !UNIT_TEST
+size_t FatFsRead(void* context, void* dst, size_t size)
+{
+    UINT bytesread = 0;
+    if(f_read(static_cast<FIL*>(context), dst, size, &bytesread) != FR_OK)
+        return 0;
+    return bytesread;
+}
+
+bool FatFsSeek(void* context, uint32_t position)
+{
+    // f_lseek stops at the end of a file opened for reading
+    FIL* file = static_cast<FIL*>(context);
+    return f_lseek(file, position) == FR_OK && f_tell(file) == position;
+}
+#endif
+} // namespace
+
+WavReader::Result
+WavReader::Open(void* context, ReadCallback read, SeekCallback seek)
+{
+    context_   = context;
+    read_      = read;
+    seek_      = seek;
+    file_pos_  = UINT32_MAX;
+    position_  = 0;
+    format_    = Format();
+    num_loops_ = 0;
+    num_cues_  = 0;
+    root_note_ = kDefaultRootNote;
+
+    uint8_t riff[12];
+    if(!SeekBytes(0) || ReadBytes(riff, sizeof(riff)) != sizeof(riff))
+        return Result::ERR_READ;
+    if(Le32(riff) != kWavFileChunkId || Le32(riff + 8) != kWavFileWaveId)
+        return Result::ERR_NOT_WAV;
+
+    // a RIFF size that is too small to be true is from a recording that
+    // was never finalized, the chunks are then walked to the end of file
+    const uint32_t riff_size = Le32(riff + 4);
+    const uint32_t riff_end  = riff_size >= 4 && riff_size <= UINT32_MAX - 8
+                                  ? riff_size + 8
+                                  : UINT32_MAX;
+
+    bool     has_format = false, has_data = false;
+    uint32_t pos        = sizeof(riff);
+    while(riff_end - pos >= 8)
+    {
+        uint8_t header[8];
+        if(!SeekBytes(pos) || ReadBytes(header, sizeof(header)) != 8)
+            break;
+        const uint32_t id   = Le32(header);
+        const uint32_t size = Le32(header + 4);
+        const uint32_t body = pos + 8;
+        const uint32_t room = riff_end - body;
+
+        if(id == kWavFileSubChunk1Id)
+        {
+            const Result result = ReadFormatChunk(size);
+            if(result != Result::OK)
+                return result;
+            has_format = true;
+        }
+        else if(id == kWavFileSubChunk2Id)
+        {
+            format_.data_offset = body;
+            format_.data_size   = size < room ? size : room;
+            has_data            = true;
+        }
+        else if(id == kWavFileSamplerId)
+        {
+            ReadSamplerChunk(size);
+        }
+        else if(id == kWavFileCueId)
+        {
+            ReadCueChunk(size);
+        }
+
+        // chunks start on even positions
+        const uint32_t padded = size + (size & 1);
+        if(padded < size || padded > room)
+            break;
+        pos = body + padded;
+    }
+
+    if(!has_format)
+        return Result::ERR_NO_FORMAT;
+    if(!has_data)
+        return Result::ERR_NO_DATA;
+    format_.num_frames = format_.data_size / format_.block_align;
+    return SeekBytes(format_.data_offset) ? Result::OK : Result::ERR_READ;
+}
+
+#if !UNIT_TEST
+WavReader::Result WavReader::Open(FIL* file)
+{
+    return Open(file, FatFsRead, FatFsSeek);
+}
+#endif
+
+size_t WavReader::Read(float* dst, size_t num_frames)
+{
+    if(position_ >= format_.num_frames)
+        return 0;
+    const uint32_t left = format_.num_frames - position_;
+    num_frames          = num_frames < left ? num_frames : left;
+
+    const size_t bytes = ReadBytes(dst, num_frames * format_.block_align);
+    num_frames         = bytes / format_.block_align;
+    position_ += num_frames;
+
+    const size_t n = num_frames * format_.num_channels;
+    switch(format_.sample_format)
+    {
+        case SampleFormat::U8: ConvertInPlace<1>(dst, n); break;
+        case SampleFormat::S16: ConvertInPlace<2>(dst, n); break;
+        case SampleFormat::S24: ConvertInPlace<3>(dst, n); break;
+        case SampleFormat::S32: ConvertInPlace<4>(dst, n); break;
+        case SampleFormat::F32: break; // already little endian floats
+    }
+
+    // a partial frame at the end of a truncated file is dropped
+    if(bytes % format_.block_align != 0)
+        SeekBytes(format_.data_offset + position_ * format_.block_align);
+    return num_frames;
+}
+
+bool WavReader::Seek(uint32_t frame)
+{
+    if(frame > format_.num_frames)
+        return false;
+    if(!SeekBytes(format_.data_offset + frame * format_.block_align))
+        return false;
+    position_ = frame;
+    return true;
+}
+
+void WavReader::GetHeader(WAV_FormatTypeDef& header) const
+{
+    header.ChunkId       = kWavFileChunkId;
+    header.FileSize      = 36 + format_.data_size;
+    header.FileFormat    = kWavFileWaveId;
+    header.SubChunk1ID   = kWavFileSubChunk1Id;
+    header.SubChunk1Size = kFormatChunkSize;
+    header.AudioFormat   = format_.sample_format == SampleFormat::F32
+                               ? WAVE_FORMAT_IEEE_FLOAT
+                               : WAVE_FORMAT_PCM;
+    header.NbrChannels   = format_.num_channels;
+    header.SampleRate    = format_.sample_rate;
+    header.ByteRate      = format_.sample_rate * format_.block_align;
+    header.BlockAlign    = format_.block_align;
+    header.BitPerSample  = format_.bits_per_sample;
+    header.SubChunk2ID   = kWavFileSubChunk2Id;
+    header.SubCHunk2Size = format_.data_size;
+}
+
+size_t WavReader::ReadBytes(void* dst, size_t size)
+{
+    const size_t bytes = read_(context_, dst, size);
+    file_pos_ += bytes;
+    return bytes;
+}
+
+bool WavReader::SeekBytes(uint32_t position)
+{
+    if(position == file_pos_)
+        return true;
+    if(!seek_(context_, position))
+    {
+        file_pos_ = UINT32_MAX;
+        return false;
+    }
+    file_pos_ = position;
+    return true;
+}
+
+WavReader::Result WavReader::ReadFormatChunk(uint32_t size)
+{
+    if(size < kFormatChunkSize)
+        return Result::ERR_UNSUPPORTED_FORMAT;
+    uint8_t      fmt[kExtensibleChunkSize];
+    const size_t len = size < sizeof(fmt) ? size : sizeof(fmt);
+    if(ReadBytes(fmt, len) != len)
+        return Result::ERR_READ;
+
+    uint16_t code = Le16(fmt);
+    if(code == WAVE_FORMAT_EXTENSIBLE && len >= kExtensibleChunkSize)
+        code = Le16(fmt + 24); // the first bytes of the sub format GUID
+
+    format_.num_channels    = Le16(fmt + 2);
+    format_.sample_rate     = Le32(fmt + 4);
+    format_.block_align     = Le16(fmt + 12);
+    format_.bits_per_sample = Le16(fmt + 14);
+
+    const uint16_t bits = format_.bits_per_sample;
+    if(code == WAVE_FORMAT_PCM && bits == 8)
+        format_.sample_format = SampleFormat::U8;
+    else if(code == WAVE_FORMAT_PCM && bits == 16)
+        format_.sample_format = SampleFormat::S16;
+    else if(code == WAVE_FORMAT_PCM && bits == 24)
+        format_.sample_format = SampleFormat::S24;
+    else if(code == WAVE_FORMAT_PCM && bits == 32)
+        format_.sample_format = SampleFormat::S32;
+    else if(code == WAVE_FORMAT_IEEE_FLOAT && bits == 32)
+        format_.sample_format = SampleFormat::F32;
+    else
+        return Result::ERR_UNSUPPORTED_FORMAT;
+
+    const uint16_t channels = format_.num_channels;
+    if(channels == 0 || channels > kMaxChannels
+       || format_.block_align != channels * (bits / 8))
+        return Result::ERR_UNSUPPORTED_FORMAT;
+    return Result::OK;
+}
+
+void WavReader::ReadSamplerChunk(uint32_t size)
+{
+    uint8_t      smpl[kSamplerHeaderSize + kMaxLoops * kSamplerLoopSize];
+    const size_t len = size < sizeof(smpl) ? size : sizeof(smpl);
+    if(len < kSamplerHeaderSize || ReadBytes(smpl, len) != len)
+        return;
+
+    const uint32_t note = Le32(smpl + 12);
+    root_note_          = note < 128 ? note : kDefaultRootNote;
+
+    const uint32_t count     = Le32(smpl + 28);
+    const size_t   available = (len - kSamplerHeaderSize) / kSamplerLoopSize;
+    num_loops_               = count < available ? count : available;
+    for(size_t i = 0; i < num_loops_; i++)
+    {
+        const uint8_t* p = smpl + kSamplerHeaderSize + i * kSamplerLoopSize;
+        loops_[i].type       = Le32(p + 4);
+        loops_[i].start      = Le32(p + 8);
+        loops_[i].end        = Le32(p + 12) + 1; // the chunk stores the last
+        loops_[i].play_count = Le32(p + 20);
+    }
+}
+
+void WavReader::ReadCueChunk(uint32_t size)
+{
+    uint8_t      cue[4 + kMaxCues * kCuePointSize];
+    const size_t len = size < sizeof(cue) ? size : sizeof(cue);
+    if(len < 4 || ReadBytes(cue, len) != len)
+        return;
+
+    const uint32_t count     = Le32(cue);
+    const size_t   available = (len - 4) / kCuePointSize;
+    num_cues_                = count < available ? count : available;
+    for(size_t i = 0; i < num_cues_; i++)
+        cues_[i] = Le32(cue + 4 + i * kCuePointSize + 20);
+}
+
+} // namespace daisy
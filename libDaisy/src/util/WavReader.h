@@ -0,0 +1,200 @@
+#pragma once
+#ifndef DSY_WAVREADER_H
+#define DSY_WAVREADER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "util/wav_format.h"
+#if !UNIT_TEST
+#include "ff.h"
+#endif
+
+namespace daisy
+{
+/** @brief Streaming reader for WAV files of any common sample format.
+ *  @addtogroup utility
+ *
+ *  `Open()` walks the RIFF chunks instead of assuming a 44 byte header, so
+ *  files with LIST/bext/junk chunks, an extensible format, or the data
+ *  before the metadata all load. Besides the format and the position of
+ *  the samples, it collects the loops and the root note of a `smpl` chunk
+ *  and the positions of a `cue ` chunk.
+ *
+ *  `Read()` converts 8/16/24/32 bit integer and 32 bit float samples of
+ *  any number of channels to interleaved floats. The raw samples are read
+ *  straight into the caller's buffer, in one read for the whole request,
+ *  and converted in place by a loop per format, so there is no per sample
+ *  switch and no intermediate copy. Large reads into a word aligned buffer
+ *  let FatFs transfer whole sectors directly.
+ *
+ *  The file is accessed through read and seek callbacks, so the reader
+ *  works on FatFs files (`Open(FIL*)`), memory, or anything else.
+ *
+ *  \code
+ *  WavReader reader;
+ *  if(reader.Open(&file) == WavReader::Result::OK)
+ *  {
+ *      const WavReader::Format& fmt = reader.GetFormat();
+ *      size_t frames = reader.Read(buffer, buffer_size / fmt.num_channels);
+ *  }
+ *  \endcode
+ */
+class WavReader
+{
+  public:
+    /** Reads up to size bytes at the current position.
+     *  \return the number of bytes read
+     */
+    typedef size_t (*ReadCallback)(void* context, void* dst, size_t size);
+
+    /** Moves to an absolute byte position.
+     *  \return false if the position can't be reached
+     */
+    typedef bool (*SeekCallback)(void* context, uint32_t position);
+
+    enum class Result
+    {
+        OK,
+        ERR_READ,
+        ERR_NOT_WAV,
+        ERR_NO_FORMAT,
+        ERR_NO_DATA,
+        ERR_UNSUPPORTED_FORMAT,
+    };
+
+    /** Sample formats that Read() can convert */
+    enum class SampleFormat
+    {
+        U8,
+        S16,
+        S24,
+        S32,
+        F32,
+    };
+
+    /** Format of the samples in the data chunk */
+    struct Format
+    {
+        SampleFormat sample_format;
+        uint16_t     num_channels;
+        uint32_t     sample_rate;
+        /** Bits per sample of the container, 8 to 32 */
+        uint16_t bits_per_sample;
+        /** Bytes per frame of all channels */
+        uint16_t block_align;
+        /** Byte position of the first sample in the file */
+        uint32_t data_offset;
+        /** Size of the samples in bytes */
+        uint32_t data_size;
+        /** Number of frames of all channels */
+        uint32_t num_frames;
+    };
+
+    /** A loop from a `smpl` chunk, in frames */
+    struct Loop
+    {
+        uint32_t start;
+        /** First frame after the loop */
+        uint32_t end;
+        /** 0 forward, 1 alternating, 2 backward */
+        uint32_t type;
+        /** Number of repeats, 0 loops forever */
+        uint32_t play_count;
+    };
+
+    static constexpr size_t kMaxLoops    = 4;
+    static constexpr size_t kMaxCues     = 16;
+    static constexpr size_t kMaxChannels = 64;
+
+    WavReader() {}
+    ~WavReader() {}
+
+    /** Reads the chunks of a file, and moves to its first sample.
+     *  \param context passed to the callbacks, e.g. a file handle
+     *  \param read reads from the current position
+     *  \param seek moves to an absolute position
+     */
+    Result Open(void* context, ReadCallback read, SeekCallback seek);
+
+#if !UNIT_TEST
+    /** Reads the chunks of a file opened with f_open().
+     *  The file must stay open while the reader is used.
+     */
+    Result Open(FIL* file);
+#endif
+
+    /** Reads and converts up to num_frames frames to interleaved floats.
+     *  \param dst room for num_frames * num_channels floats
+     *  \return the number of frames read, less than num_frames at the end
+     *  of the data
+     */
+    size_t Read(float* dst, size_t num_frames);
+
+    /** Moves to a frame of the data. Returns false if it is past the end or
+     *  the file can't seek.
+     */
+    bool Seek(uint32_t frame);
+
+    /** Moves back to the first frame */
+    inline bool Rewind() { return Seek(0); }
+
+    /** \return the frame that the next Read() starts at */
+    inline uint32_t GetPosition() const { return position_; }
+
+    /** \return true once all frames were read */
+    inline bool IsEof() const { return position_ >= format_.num_frames; }
+
+    inline const Format& GetFormat() const { return format_; }
+
+    /** \return number of loops in the `smpl` chunk, up to kMaxLoops */
+    inline size_t GetNumLoops() const { return num_loops_; }
+
+    /** \return a loop of the `smpl` chunk, or nullptr */
+    inline const Loop* GetLoop(size_t idx) const
+    {
+        return idx < num_loops_ ? &loops_[idx] : nullptr;
+    }
+
+    /** \return the MIDI note of the recorded pitch from the `smpl` chunk,
+     *  60 when there is none
+     */
+    inline uint8_t GetRootNote() const { return root_note_; }
+
+    /** \return number of cue points, up to kMaxCues */
+    inline size_t GetNumCues() const { return num_cues_; }
+
+    /** \return the frame of a cue point, in the order of the `cue ` chunk */
+    inline uint32_t GetCue(size_t idx) const
+    {
+        return idx < num_cues_ ? cues_[idx] : 0;
+    }
+
+    /** Fills the canonical 44 byte header with the format that was read,
+     *  for code that still uses WAV_FormatTypeDef.
+     */
+    void GetHeader(WAV_FormatTypeDef& header) const;
+
+  private:
+    size_t ReadBytes(void* dst, size_t size);
+    bool   SeekBytes(uint32_t position);
+    Result ReadFormatChunk(uint32_t size);
+    void   ReadSamplerChunk(uint32_t size);
+    void   ReadCueChunk(uint32_t size);
+
+    void*        context_;
+    ReadCallback read_;
+    SeekCallback seek_;
+    uint32_t     file_pos_;
+    uint32_t     position_;
+
+    Format   format_;
+    Loop     loops_[kMaxLoops];
+    size_t   num_loops_;
+    uint32_t cues_[kMaxCues];
+    size_t   num_cues_;
+    uint8_t  root_note_;
+};
+
+} // namespace daisy
+
+#endif
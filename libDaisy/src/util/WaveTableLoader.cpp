@@ -1,5 +1,4 @@
 #include "WaveTableLoader.h"
-#include "daisy_core.h"
 namespace daisy
 {
 void WaveTableLoader::Init(float *mem, size_t mem_size)
@@ -22,48 +21,24 @@ WaveTableLoader::Result WaveTableLoader::SetWaveTableInfo(size_t samps,
 
 WaveTableLoader::Result WaveTableLoader::Import(const char *filename)
 {
-    if(f_open(&fp_, filename, FA_READ | FA_OPEN_EXISTING) == FR_OK)
+    if(f_open(&fp_, filename, FA_READ | FA_OPEN_EXISTING) != FR_OK)
+        return Result::ERR_FILE_READ;
+
+    WavReader               reader;
+    const WavReader::Result result = reader.Open(&fp_);
+    if(result != WavReader::Result::OK)
     {
-        // First Grab the Wave header info
-        unsigned int br;
-        f_read(&fp_, &header_, sizeof(header_), &br);
-        uint32_t wptr = 0;
-        do
-        {
-            f_read(&fp_, workspace, kWorkspaceSize * sizeof(workspace[0]), &br);
-            // Fill mem
-            switch(header_.BitPerSample)
-            {
-                case 16:
-                {
-                    int16_t *wsp;
-                    wsp = (int16_t *)workspace;
-                    for(size_t i = 0; i < kWorkspaceSize * 2; i++)
-                    {
-                        buf_[wptr] = s162f(wsp[i]);
-                        wptr++;
-                    }
-                }
-                break;
-                case 32:
-                {
-                    float *wsp;
-                    wsp = (float *)workspace;
-                    for(size_t i = 0; i < kWorkspaceSize; i++)
-                    {
-                        buf_[wptr] = wsp[i];
-                    }
-                }
-                break;
-                default: break;
-            }
-        } while(!f_eof(&fp_) || wptr <= buf_size_ - 1);
         f_close(&fp_);
+        return result == WavReader::Result::ERR_READ
+                   ? Result::ERR_FILE_READ
+                   : Result::ERR_UNSUPPORTED_FORMAT;
     }
-    else
-    {
-        return Result::ERR_FILE_READ;
-    }
+    reader.GetHeader(header_);
+
+    // As much of the file as fits, in one read
+    const size_t channels = reader.GetFormat().num_channels;
+    reader.Read(buf_, buf_size_ / channels);
+    f_close(&fp_);
     return Result::OK;
 }
 
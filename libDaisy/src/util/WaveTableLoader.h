@@ -1,6 +1,7 @@
 #pragma once
 #include "fatfs.h"
 #include "util/wav_format.h"
+#include "util/WavReader.h"
 namespace daisy
 {
 /** Loads a bank of wavetables into memory. 
@@ -8,7 +9,8 @@ namespace daisy
  ** but the user can do whatever they want with the data once
  ** it's imported. 
  **
- ** A internal 4kB workspace is used for reading from the file, and conveting to the correct memory location. 
+ ** The samples are read straight into the user-provided memory with a WavReader,
+ ** and converted to float there, so no workspace is needed.
  ** */
 class WaveTableLoader
 {
@@ -19,6 +21,7 @@ class WaveTableLoader
         ERR_TABLE_INFO_OVERFLOW,
         ERR_FILE_READ,
         ERR_GENERIC,
+        ERR_UNSUPPORTED_FORMAT,
     };
     WaveTableLoader() {}
     ~WaveTableLoader() {}
@@ -34,9 +37,9 @@ class WaveTableLoader
      ** And the wavheader data will be stored internally to the class, 
      ** but will not be stored in the user-provided buffer.
      **
-     ** Currently only 16-bit and 32-bit data is supported.
-     ** The importer also assumes data is mono so stereo data will be loaded as-is 
-     ** (i.e. interleaved)
+     ** 8, 16, 24 and 32-bit integer and 32-bit float data are supported,
+     ** with any chunks around the samples.
+     ** Data with several channels is loaded interleaved.
      ** */
     Result Import(const char *filename);
 
@@ -44,14 +47,12 @@ class WaveTableLoader
     float *GetTable(size_t idx);
 
   private:
-    static constexpr int kWorkspaceSize = 1024;
-    float *              buf_;
-    size_t               buf_size_;
-    WAV_FormatTypeDef    header_;
-    size_t               samps_per_table_;
-    size_t               num_tables_;
-    int32_t              workspace[kWorkspaceSize];
-    FIL                  fp_;
+    float *           buf_;
+    size_t            buf_size_;
+    WAV_FormatTypeDef header_;
+    size_t            samps_per_table_;
+    size_t            num_tables_;
+    FIL               fp_;
 };
 
 } // namespace daisy
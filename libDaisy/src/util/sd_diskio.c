@@ -59,6 +59,8 @@ static volatile DSTATUS Stat = STA_NOINIT;
 //static volatile  UINT  WriteStatus = 0, ReadStatus = 0;
 static uint32_t WriteStatus = 0;
 static uint32_t ReadStatus  = 0;
+
+static const SD_CacheTypeDef *sd_cache = NULL;
 /* Private function prototypes -----------------------------------------------*/
 static DSTATUS SD_CheckStatus(BYTE lun);
 DSTATUS        SD_initialize(BYTE);
@@ -104,6 +106,14 @@ static DSTATUS SD_CheckStatus(BYTE lun)
   */
 DSTATUS SD_initialize(BYTE lun)
 {
+    if(sd_cache != NULL)
+    {
+        /* write what is still dirty, then forget it, as the card may have
+           been changed. A new card isn't initialized yet and rejects the
+           writes, so they only reach the card that is still in. */
+        sd_cache->sync(sd_cache->context);
+        sd_cache->invalidate(sd_cache->context);
+    }
 #if !defined(DISABLE_SD_INIT)
 
     if(BSP_SD_Init() == MSD_OK)
@@ -136,6 +146,23 @@ DSTATUS SD_status(BYTE lun)
   * @retval DRESULT: Operation result
   */
 DRESULT SD_read(BYTE lun, BYTE *buff, DWORD sector, UINT count)
+{
+    if(sd_cache != NULL)
+    {
+        return sd_cache->read(sd_cache->context, buff, sector, count);
+    }
+    return SD_ReadUncached(lun, buff, sector, count);
+}
+
+/**
+  * @brief  Reads Sector(s) without the cache
+  * @param  lun : not used
+  * @param  *buff: Data buffer to store read data
+  * @param  sector: Sector address (LBA)
+  * @param  count: Number of sectors to read
+  * @retval DRESULT: Operation result
+  */
+DRESULT SD_ReadUncached(BYTE lun, BYTE *buff, DWORD sector, UINT count)
 {
     DRESULT res = RES_ERROR;
     ReadStatus  = 0;
@@ -193,6 +220,23 @@ DRESULT SD_read(BYTE lun, BYTE *buff, DWORD sector, UINT count)
   */
 #if _USE_WRITE == 1
 DRESULT SD_write(BYTE lun, const BYTE *buff, DWORD sector, UINT count)
+{
+    if(sd_cache != NULL)
+    {
+        return sd_cache->write(sd_cache->context, buff, sector, count);
+    }
+    return SD_WriteUncached(lun, buff, sector, count);
+}
+
+/**
+  * @brief  Writes Sector(s) without the cache
+  * @param  lun : not used
+  * @param  *buff: Data to be written
+  * @param  sector: Sector address (LBA)
+  * @param  count: Number of sectors to write
+  * @retval DRESULT: Operation result
+  */
+DRESULT SD_WriteUncached(BYTE lun, const BYTE *buff, DWORD sector, UINT count)
 {
     DRESULT res = RES_ERROR;
     WriteStatus = 0;
@@ -266,7 +310,10 @@ DRESULT SD_ioctl(BYTE lun, BYTE cmd, void *buff)
     switch(cmd)
     {
         /* Make sure that no pending write process */
-        case CTRL_SYNC: res = RES_OK; break;
+        case CTRL_SYNC:
+            res = sd_cache != NULL ? sd_cache->sync(sd_cache->context)
+                                   : RES_OK;
+            break;
 
         /* Get number of sectors on the disk (DWORD) */
         case GET_SECTOR_COUNT:
@@ -297,6 +344,15 @@ DRESULT SD_ioctl(BYTE lun, BYTE cmd, void *buff)
 #endif /* _USE_IOCTL == 1 */
 
 
+/**
+  * @brief  Sets the cache that SD_read and SD_write go through
+  * @param  cache: the cache, or NULL to use the card directly
+  */
+void SD_SetCache(const SD_CacheTypeDef *cache)
+{
+    sd_cache = cache;
+}
+
 /**
   * @brief Tx Transfer completed callbacks
   * @param hsd: SD handle
@@ -6,10 +6,38 @@ extern "C"
 {
 #endif
 
+#include "ff_gen_drv.h"
 #include "util/bsp_sd_diskio.h"
 
+    /** A cache between FatFs and the card, e.g. a daisy::BlockCache */
+    typedef struct
+    {
+        DRESULT (*read)(void *context, BYTE *buff, DWORD sector, UINT count);
+        DRESULT (*write)(void       *context,
+                         const BYTE *buff,
+                         DWORD       sector,
+                         UINT        count);
+        /** Writes what the cache holds, for CTRL_SYNC */
+        DRESULT (*sync)(void *context);
+        /** Forgets what the cache holds, after a sync when the card is
+            initialized */
+        void (*invalidate)(void *context);
+        void *context;
+    } SD_CacheTypeDef;
+
     extern const Diskio_drvTypeDef SD_Driver; /**< & */
 
+    /** Sends the reads and writes of FatFs through a cache, or straight to
+        the card with NULL */
+    void SD_SetCache(const SD_CacheTypeDef *cache);
+
+    /** Reads the card without the cache, for the cache */
+    DRESULT SD_ReadUncached(BYTE lun, BYTE *buff, DWORD sector, UINT count);
+
+    /** Writes the card without the cache, for the cache */
+    DRESULT
+    SD_WriteUncached(BYTE lun, const BYTE *buff, DWORD sector, UINT count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -33,11 +33,19 @@ extern USBH_HandleTypeDef hUsbHostHS;
 
 #define USB_DEFAULT_BLOCK_SIZE 512
 
+/* Sectors per transfer through the scratch buffer */
+#define USB_SCRATCH_SECTORS 4
+
 #define ENABLE_USB_DMA_CACHE_MAINTENANCE 1
 
 /* Private variables ---------------------------------------------------------*/
-static DWORD DMA_BUFFER_MEM_SECTION scratch[_MAX_SS / 4];
-extern USBH_HandleTypeDef           hUSB_Host;
+static DWORD DMA_BUFFER_MEM_SECTION
+    scratch[USB_SCRATCH_SECTORS * _MAX_SS / 4] __attribute__((aligned(32)));
+extern USBH_HandleTypeDef hUSB_Host;
+
+static const USBH_CacheTypeDef *read_cache    = NULL;
+static BYTE *                   pending_buff  = NULL;
+static uint32_t                 pending_bytes = 0;
 
 /* Private function prototypes -----------------------------------------------*/
 DSTATUS USBH_initialize(BYTE);
@@ -108,78 +116,155 @@ DSTATUS USBH_status(BYTE lun)
 /* USER CODE END beforeReadSection */
 
 /**
-  * @brief  Reads Sector(s)
+  * @brief  Maps a failed transfer to the state of the unit
+  * @param  lun : lun id
+  * @retval DRESULT: Operation result
+  */
+static DRESULT USBH_ReadError(BYTE lun)
+{
+    MSC_LUNTypeDef info;
+    USBH_MSC_GetLUNInfo(&hUSB_Host, lun, &info);
+
+    switch(info.sense.asc)
+    {
+        case SCSI_ASC_LOGICAL_UNIT_NOT_READY:
+        case SCSI_ASC_MEDIUM_NOT_PRESENT:
+        case SCSI_ASC_NOT_READY_TO_READY_CHANGE:
+            USBH_ErrLog("USB Disk is not ready!");
+            return RES_NOTRDY;
+
+        default: return RES_ERROR;
+    }
+}
+
+/**
+  * @brief  Reads Sector(s) without the cache
   * @param  lun : lun id
   * @param  *buff: Data buffer to store read data
   * @param  sector: Sector address (LBA)
   * @param  count: Number of sectors to read (1..128)
   * @retval DRESULT: Operation result
   */
-DRESULT USBH_read(BYTE lun, BYTE *buff, DWORD sector, UINT count)
+static DRESULT USBH_ReadUncached(BYTE lun, BYTE *buff, DWORD sector, UINT count)
 {
-    DRESULT            res = RES_ERROR;
-    MSC_LUNTypeDef     info;
     USBH_StatusTypeDef status = USBH_OK;
 
-#if(ENABLE_USB_DMA_CACHE_MAINTENANCE == 1)
-    uint32_t alignedAddr;
-    alignedAddr = (uint32_t)buff & ~0x1F;
-    SCB_CleanDCache_by_Addr((uint32_t *)alignedAddr,
-                            count * BLOCKSIZE + ((uint32_t)buff - alignedAddr));
-#endif
-
     if(((DWORD)buff & 3)
        && (((HCD_HandleTypeDef *)hUSB_Host.pData)->Init.dma_enable))
     {
-        while((count--) && (status == USBH_OK))
+        /* DMA needs word aligned buffers, read through the scratch buffer,
+         * as many sectors at a time as it holds */
+        while(count > 0 && status == USBH_OK)
         {
+            UINT n = count < USB_SCRATCH_SECTORS ? count : USB_SCRATCH_SECTORS;
+#if(ENABLE_USB_DMA_CACHE_MAINTENANCE == 1)
+            SCB_CleanDCache_by_Addr((uint32_t *)scratch, n * BLOCKSIZE);
+#endif
             status = USBH_MSC_Read(
-                &hUSB_Host, lun, sector + count, (uint8_t *)scratch, 1);
-
+                &hUSB_Host, lun, sector, (uint8_t *)scratch, n);
+#if(ENABLE_USB_DMA_CACHE_MAINTENANCE == 1)
+            SCB_InvalidateDCache_by_Addr((uint32_t *)scratch, n * BLOCKSIZE);
+#endif
             if(status == USBH_OK)
             {
-                memcpy(&buff[count * _MAX_SS], scratch, _MAX_SS);
-            }
-            else
-            {
-                break;
+                memcpy(buff, scratch, n * _MAX_SS);
+                buff += n * _MAX_SS;
+                sector += n;
+                count -= n;
             }
         }
     }
     else
     {
+#if(ENABLE_USB_DMA_CACHE_MAINTENANCE == 1)
+        uint32_t alignedAddr;
+        alignedAddr = (uint32_t)buff & ~0x1F;
+        SCB_CleanDCache_by_Addr((uint32_t *)alignedAddr,
+                                count * BLOCKSIZE
+                                    + ((uint32_t)buff - alignedAddr));
+#endif
         status = USBH_MSC_Read(&hUSB_Host, lun, sector, buff, count);
-    }
 #if(ENABLE_USB_DMA_CACHE_MAINTENANCE == 1)
-    /* the SCB_InvalidateDCache_by_Addr() requires a 32-Byte aligned address,
+        /* the SCB_InvalidateDCache_by_Addr() requires a 32-Byte aligned address,
                      * adjust the address and the D-Cache size to invalidate accordingly. */
-    SCB_InvalidateDCache_by_Addr((uint32_t *)alignedAddr,
-                                 count * BLOCKSIZE
-                                     + ((uint32_t)buff - alignedAddr));
+        SCB_InvalidateDCache_by_Addr((uint32_t *)alignedAddr,
+                                     count * BLOCKSIZE
+                                         + ((uint32_t)buff - alignedAddr));
 #endif
+    }
 
-    if(status == USBH_OK)
+    return status == USBH_OK ? RES_OK : USBH_ReadError(lun);
+}
+
+/**
+  * @brief  Reads Sector(s)
+  * @param  lun : lun id
+  * @param  *buff: Data buffer to store read data
+  * @param  sector: Sector address (LBA)
+  * @param  count: Number of sectors to read (1..128)
+  * @retval DRESULT: Operation result
+  */
+DRESULT USBH_read(BYTE lun, BYTE *buff, DWORD sector, UINT count)
+{
+    if(read_cache != NULL)
     {
-        res = RES_OK;
+        return read_cache->read(read_cache->context, buff, sector, count);
     }
-    else
+    return USBH_ReadUncached(lun, buff, sector, count);
+}
+
+/**
+  * @brief  Starts reading Sector(s) without waiting
+  * @param  lun : lun id
+  * @param  *buff: Data buffer, aligned to 32 bytes
+  * @param  sector: Sector address (LBA)
+  * @param  count: Number of sectors to read
+  * @retval USBH Status
+  */
+USBH_StatusTypeDef
+USBH_ReadStart(BYTE lun, BYTE *buff, DWORD sector, UINT count)
+{
+    if(hUSB_Host.gState != HOST_CLASS)
     {
-        USBH_MSC_GetLUNInfo(&hUSB_Host, lun, &info);
+        return USBH_FAIL;
+    }
+#if(ENABLE_USB_DMA_CACHE_MAINTENANCE == 1)
+    SCB_CleanDCache_by_Addr((uint32_t *)buff, count * BLOCKSIZE);
+#endif
+    pending_buff  = buff;
+    pending_bytes = count * BLOCKSIZE;
+    return USBH_MSC_ReadStart(&hUSB_Host, lun, sector, buff, count);
+}
 
-        switch(info.sense.asc)
-        {
-            case SCSI_ASC_LOGICAL_UNIT_NOT_READY:
-            case SCSI_ASC_MEDIUM_NOT_PRESENT:
-            case SCSI_ASC_NOT_READY_TO_READY_CHANGE:
-                USBH_ErrLog("USB Disk is not ready!");
-                res = RES_NOTRDY;
-                break;
+/**
+  * @brief  Advances the read started by USBH_ReadStart
+  * @param  lun : lun id
+  * @retval USBH Status: USBH_BUSY until the data is there
+  */
+USBH_StatusTypeDef USBH_ReadPoll(BYTE lun)
+{
+    USBH_StatusTypeDef status = USBH_FAIL;
 
-            default: res = RES_ERROR; break;
-        }
+    if(hUSB_Host.gState == HOST_CLASS)
+    {
+        status = USBH_MSC_ReadPoll(&hUSB_Host, lun);
     }
+#if(ENABLE_USB_DMA_CACHE_MAINTENANCE == 1)
+    if(status != USBH_BUSY)
+    {
+        SCB_InvalidateDCache_by_Addr((uint32_t *)pending_buff, pending_bytes);
+    }
+#endif
+    return status;
+}
 
-    return res;
+/**
+  * @brief  Sets the cache that USBH_read goes through
+  * @param  cache: the cache, or NULL to read the disk directly
+  */
+void USBH_SetCache(const USBH_CacheTypeDef *cache)
+{
+    read_cache = cache;
 }
 
 /* USER CODE BEGIN beforeWriteSection */
@@ -200,6 +285,12 @@ DRESULT USBH_write(BYTE lun, const BYTE *buff, DWORD sector, UINT count)
     DRESULT            res = RES_ERROR;
     MSC_LUNTypeDef     info;
     USBH_StatusTypeDef status = USBH_OK;
+
+    if(read_cache != NULL)
+    {
+        /* also waits for the read ahead, the unit does one thing at a time */
+        read_cache->invalidate(read_cache->context, sector, count);
+    }
 #if(ENABLE_USB_DMA_CACHE_MAINTENANCE == 1)
     uint32_t alignedAddr;
     /*
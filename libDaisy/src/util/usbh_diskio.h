@@ -26,11 +26,35 @@
 /* Includes ------------------------------------------------------------------*/
 #include "usbh_core.h"
 #include "usbh_msc.h"
+#ifdef __cplusplus
+extern "C"
+{
+#endif
 /* Exported types ------------------------------------------------------------*/
+/** A cache between FatFs and the disk, e.g. a daisy::ReadAheadCache */
+typedef struct
+{
+    DRESULT (*read)(void *context, BYTE *buff, DWORD sector, UINT count);
+    /** Forgets sectors before they are written */
+    void (*invalidate)(void *context, DWORD sector, UINT count);
+    void *context;
+} USBH_CacheTypeDef;
+
 /* Exported constants --------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
 extern const Diskio_drvTypeDef USBH_Driver;
 
+void USBH_SetCache(const USBH_CacheTypeDef *cache);
+
+/* Reads without waiting, for the cache */
+USBH_StatusTypeDef
+USBH_ReadStart(BYTE lun, BYTE *buff, DWORD sector, UINT count);
+USBH_StatusTypeDef USBH_ReadPoll(BYTE lun);
+
+#ifdef __cplusplus
+}
+#endif
+
 /* USER CODE BEGIN lastSection */
 /* can be used to modify / undefine previous code or add new definitions */
 /* USER CODE END lastSection */
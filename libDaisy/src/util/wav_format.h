@@ -16,6 +16,8 @@ const uint32_t kWavFileChunkId     = 0x46464952; /**< "RIFF" */
 const uint32_t kWavFileWaveId      = 0x45564157; /**< "WAVE" */
 const uint32_t kWavFileSubChunk1Id = 0x20746d66; /**< "fmt " */
 const uint32_t kWavFileSubChunk2Id = 0x61746164; /**< "data" */
+const uint32_t kWavFileSamplerId   = 0x6c706d73; /**< "smpl" */
+const uint32_t kWavFileCueId       = 0x20657563; /**< "cue " */
 
 /** Standard Format codes for the waveform data.
  ** 
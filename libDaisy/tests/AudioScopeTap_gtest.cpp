@@ -0,0 +1,366 @@
+#include "util/AudioScopeTap.h"
+#include "ui/ScopePage.h"
+#include "ui/SpectrumPage.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace daisy;
+
+namespace
+{
+/** A display in memory, one bool per pixel */
+class TestDisplay : public OneBitGraphicsDisplayImpl<TestDisplay>
+{
+  public:
+    TestDisplay() { Fill(false); }
+
+    uint16_t Height() const override { return 64; }
+    uint16_t Width() const override { return 128; }
+
+    void Fill(bool on) override
+    {
+        for(size_t x = 0; x < 128; x++)
+            for(size_t y = 0; y < 64; y++)
+                pixels[x][y] = on;
+    }
+
+    void DrawPixel(uint_fast8_t x, uint_fast8_t y, bool on) override
+    {
+        if(x < 128 && y < 64)
+            pixels[x][y] = on;
+    }
+
+    void Update() override {}
+
+    /** @return rows lit in a column, or -1 for top when there are none */
+    int Top(size_t x) const
+    {
+        for(size_t y = 0; y < 64; y++)
+        {
+            if(pixels[x][y])
+                return int(y);
+        }
+        return -1;
+    }
+    int Bottom(size_t x) const
+    {
+        for(int y = 63; y >= 0; y--)
+        {
+            if(pixels[x][y])
+                return y;
+        }
+        return -1;
+    }
+
+    bool pixels[128][64];
+};
+
+UiCanvasDescriptor MakeCanvas(TestDisplay& display)
+{
+    UiCanvasDescriptor canvas;
+    canvas.id_            = 0;
+    canvas.handle_        = &display;
+    canvas.updateRateMs_  = 50;
+    canvas.clearFunction_ = nullptr;
+    canvas.flushFunction_ = nullptr;
+    return canvas;
+}
+
+AudioScopeTap::Config
+MakeConfig(size_t decimation, bool trigger, size_t fft_size, size_t interval)
+{
+    AudioScopeTap::Config config;
+    config.decimation   = decimation;
+    config.trigger      = trigger;
+    config.fft_size     = fft_size;
+    config.fft_interval = interval;
+    return config;
+}
+
+/** Feeds a sine in blocks of 48 samples */
+void FeedSine(AudioScopeTap& tap,
+              float          amplitude,
+              float          cycles_per_sample,
+              size_t         samples,
+              size_t&        phase)
+{
+    float block[48];
+    for(size_t done = 0; done < samples; done += 48)
+    {
+        for(size_t i = 0; i < 48; i++, phase++)
+            block[i] = amplitude
+                       * sinf(6.28318530718f * cycles_per_sample * phase);
+        tap.Process(block, 48);
+    }
+}
+} // namespace
+
+TEST(util_AudioScopeTap, a_scope_envelope_and_double_buffer)
+{
+    static AudioScopeTap tap;
+    ASSERT_EQ(tap.Init(MakeConfig(4, false, 0, 0)),
+              AudioScopeTap::Result::OK);
+    static AudioScopeTap::ScopeFrame frame;
+    EXPECT_FALSE(tap.ReadScope(frame));
+
+    // a ramp, in blocks that don't line up with the points
+    std::vector<float> ramp(4 * AudioScopeTap::kScopePoints);
+    for(size_t i = 0; i < ramp.size(); i++)
+        ramp[i] = i / 1000.f;
+    for(size_t pos = 0; pos < ramp.size(); pos += 30)
+        tap.Process(&ramp[pos], std::min<size_t>(30, ramp.size() - pos));
+    EXPECT_EQ(tap.GetScopeFrames(), 1u);
+    ASSERT_TRUE(tap.ReadScope(frame));
+    for(size_t p = 0; p < AudioScopeTap::kScopePoints; p++)
+    {
+        EXPECT_FLOAT_EQ(frame.min[p], 4 * p / 1000.f);
+        EXPECT_FLOAT_EQ(frame.max[p], (4 * p + 3) / 1000.f);
+    }
+
+    // the frame being written doesn't change the one that's read
+    std::vector<float> zeros(ramp.size() / 2, 0.f);
+    tap.Process(zeros.data(), zeros.size());
+    ASSERT_TRUE(tap.ReadScope(frame));
+    EXPECT_FLOAT_EQ(frame.max[10], 43 / 1000.f);
+    tap.Process(zeros.data(), zeros.size());
+    EXPECT_EQ(tap.GetScopeFrames(), 2u);
+    ASSERT_TRUE(tap.ReadScope(frame));
+    EXPECT_EQ(frame.max[10], 0.f);
+
+    // every other sample of an interleaved buffer
+    std::vector<float> stereo(2 * ramp.size(), -1.f);
+    for(size_t i = 0; i < ramp.size(); i++)
+        stereo[2 * i] = ramp[i];
+    tap.Process(stereo.data(), ramp.size(), 2);
+    ASSERT_TRUE(tap.ReadScope(frame));
+    EXPECT_FLOAT_EQ(frame.min[5], 20 / 1000.f);
+}
+
+TEST(util_AudioScopeTap, b_trigger_holds_the_waveform_still)
+{
+    static AudioScopeTap::ScopeFrame first, second;
+    // 128 points aren't a whole number of periods
+    auto difference = [&](bool trigger) {
+        AudioScopeTap tap;
+        tap.Init(MakeConfig(1, trigger, 0, 0));
+        size_t phase = 0;
+        FeedSine(tap, 1.f, 1.f / 37.f, 48 * 20, phase);
+        EXPECT_TRUE(tap.ReadScope(first));
+        const uint32_t frames = tap.GetScopeFrames();
+        while(tap.GetScopeFrames() == frames)
+            FeedSine(tap, 1.f, 1.f / 37.f, 48, phase);
+        EXPECT_TRUE(tap.ReadScope(second));
+        float diff = 0.f;
+        for(size_t p = 0; p < AudioScopeTap::kScopePoints; p++)
+            diff = std::max(diff, std::fabs(first.max[p] - second.max[p]));
+        return diff;
+    };
+    EXPECT_LT(difference(true), 0.2f);
+    EXPECT_GT(difference(false), 0.5f);
+
+    // frames start on a rising edge through 0
+    AudioScopeTap tap;
+    tap.Init(MakeConfig(1, true, 0, 0));
+    size_t phase = 5;
+    FeedSine(tap, 1.f, 1.f / 37.f, 48 * 10, phase);
+    ASSERT_TRUE(tap.ReadScope(first));
+    EXPECT_GE(first.max[0], 0.f);
+    EXPECT_LT(first.max[0], 0.2f);
+    EXPECT_GT(first.max[1], first.max[0]);
+
+    // without an edge, a frame starts after waiting for one frame
+    tap.Init(MakeConfig(1, true, 0, 0));
+    std::vector<float> dc(2 * AudioScopeTap::kScopePoints - 2, 0.5f);
+    tap.Process(dc.data(), dc.size());
+    EXPECT_EQ(tap.GetScopeFrames(), 0u);
+    tap.Process(dc.data(), 1);
+    EXPECT_EQ(tap.GetScopeFrames(), 1u);
+}
+
+TEST(util_AudioScopeTap, c_spectrum_matches_a_dft)
+{
+    static AudioScopeTap tap;
+    constexpr size_t     n = 256;
+    ASSERT_EQ(tap.Init(MakeConfig(8, false, n, 4096)),
+              AudioScopeTap::Result::OK);
+    EXPECT_EQ(tap.GetNumBins(), n / 2);
+    EXPECT_FLOAT_EQ(tap.GetBinFrequency(20, 48000.f), 3750.f);
+
+    std::vector<float> noise(n);
+    uint32_t           seed = 7;
+    for(size_t i = 0; i < n; i++)
+    {
+        seed     = seed * 1664525 + 1013904223;
+        noise[i] = (seed >> 8) / float(1 << 24) - 0.5f;
+    }
+    tap.Process(noise.data(), n);
+
+    // the window comes with the block, then one step per block: 7 passes,
+    // the split and the magnitudes
+    const float zero = 0.f;
+    for(size_t block = 0; block < 9; block++)
+    {
+        EXPECT_EQ(tap.GetSpectrumFrames(), 0u);
+        tap.Process(&zero, 1);
+    }
+    EXPECT_EQ(tap.GetSpectrumFrames(), 1u);
+
+    static AudioScopeTap::SpectrumFrame frame;
+    ASSERT_TRUE(tap.ReadSpectrum(frame));
+    ASSERT_EQ(frame.num_bins, n / 2);
+    for(size_t k = 0; k < n / 2; k++)
+    {
+        double re = 0.0, im = 0.0;
+        for(size_t i = 0; i < n; i++)
+        {
+            const double w = 0.5 - 0.5 * cos(2.0 * M_PI * i / n);
+            re += noise[i] * w * cos(2.0 * M_PI * k * i / n);
+            im -= noise[i] * w * sin(2.0 * M_PI * k * i / n);
+        }
+        const double power = (re * re + im * im) * 16.0 / (n * n);
+        EXPECT_NEAR(frame.power[k], power, 1e-4 + power * 1e-3) << k;
+    }
+}
+
+TEST(util_AudioScopeTap, d_spectrum_of_a_sine)
+{
+    static AudioScopeTap tap;
+    tap.Init(MakeConfig(8, false, 512, 2048));
+    size_t phase = 0;
+    // half scale at bin 40
+    FeedSine(tap, 0.5f, 40.f / 512.f, 48 * 100, phase);
+    EXPECT_GE(tap.GetSpectrumFrames(), 2u);
+
+    static AudioScopeTap::SpectrumFrame frame;
+    ASSERT_TRUE(tap.ReadSpectrum(frame));
+    size_t peak = 0;
+    for(size_t k = 0; k < frame.num_bins; k++)
+    {
+        if(frame.power[k] > frame.power[peak])
+            peak = k;
+    }
+    EXPECT_EQ(peak, 40u);
+    EXPECT_NEAR(frame.power[40], 0.25f, 0.005f);
+    // the main lobe of the Hann window is 4 bins wide
+    EXPECT_NEAR(frame.power[39], 0.25f / 4, 0.005f);
+    EXPECT_LT(frame.power[45], 1e-5f);
+}
+
+TEST(util_AudioScopeTap, e_config)
+{
+    AudioScopeTap tap;
+    EXPECT_EQ(tap.Init(MakeConfig(0, false, 256, 1)),
+              AudioScopeTap::Result::ERR_CONFIG);
+    EXPECT_EQ(tap.Init(MakeConfig(1, false, 32, 1)),
+              AudioScopeTap::Result::ERR_CONFIG);
+    EXPECT_EQ(tap.Init(MakeConfig(1, false, 1024, 1)),
+              AudioScopeTap::Result::ERR_CONFIG);
+    EXPECT_EQ(tap.Init(MakeConfig(1, false, 200, 1)),
+              AudioScopeTap::Result::ERR_CONFIG);
+    EXPECT_EQ(tap.Init(MakeConfig(1, false, 0, 1)),
+              AudioScopeTap::Result::OK);
+    EXPECT_EQ(tap.GetNumBins(), 0u);
+    const float                  sample = 1.f;
+    AudioScopeTap::SpectrumFrame frame;
+    for(size_t i = 0; i < 100; i++)
+        tap.Process(&sample, 1);
+    EXPECT_FALSE(tap.ReadSpectrum(frame));
+}
+
+TEST(util_AudioScopeTap, f_scope_page)
+{
+    static AudioScopeTap tap;
+    tap.Init(MakeConfig(2, false, 0, 0));
+    static TestDisplay display;
+    const UiCanvasDescriptor canvas = MakeCanvas(display);
+    ScopePage                page;
+    page.Init(&tap);
+    page.SetOneBitGraphicsDisplayToDrawTo(0);
+
+    // before the first frame, only the zero line
+    page.Draw(canvas);
+    EXPECT_EQ(display.Top(0), 32);
+    EXPECT_EQ(display.Top(1), -1);
+
+    // a constant is a row
+    std::vector<float> dc(2 * AudioScopeTap::kScopePoints, 0.5f);
+    tap.Process(dc.data(), dc.size());
+    display.Fill(false);
+    page.Draw(canvas);
+    for(size_t x = 0; x < 128; x++)
+    {
+        EXPECT_EQ(display.Top(x), 16) << x;
+        EXPECT_EQ(display.Bottom(x), x % 4 == 0 ? 32 : 16) << x;
+    }
+
+    // a full scale square wave fills its columns, and the steps between
+    // columns are connected
+    std::vector<float> square(dc.size());
+    for(size_t i = 0; i < square.size(); i++)
+        square[i] = (i / 32) % 2 == 0 ? 1.f : -1.f;
+    tap.Process(square.data(), square.size());
+    display.Fill(false);
+    page.Draw(canvas);
+    EXPECT_EQ(display.Top(3), 0);
+    EXPECT_EQ(display.Bottom(3), 0);
+    EXPECT_EQ(display.Top(16), 0);
+    EXPECT_EQ(display.Bottom(16), 63);
+    EXPECT_EQ(display.Top(17), 63);
+
+    // zoomed in, the square is clipped to the display
+    page.OnArrowButton(ArrowButtonType::up, 1, false);
+    EXPECT_EQ(page.GetGain(), 2.f);
+    display.Fill(false);
+    page.Draw(canvas);
+    EXPECT_EQ(display.Top(3), 0);
+    EXPECT_EQ(display.Top(21), 63);
+
+    // other canvases are left alone
+    UiCanvasDescriptor other = canvas;
+    other.id_                = 1;
+    display.Fill(false);
+    page.Draw(other);
+    EXPECT_EQ(display.Top(3), -1);
+}
+
+TEST(util_AudioScopeTap, g_spectrum_page)
+{
+    static AudioScopeTap tap;
+    tap.Init(MakeConfig(8, false, 256, 1024));
+    static TestDisplay display;
+    const UiCanvasDescriptor canvas = MakeCanvas(display);
+    SpectrumPage             page;
+    page.Init(&tap);
+    page.SetOneBitGraphicsDisplayToDrawTo(0);
+    page.SetLogFrequency(false);
+
+    // full scale at bin 64, the middle of the linear axis
+    size_t phase = 0;
+    FeedSine(tap, 1.f, 64.f / 256.f, 48 * 40, phase);
+    page.Draw(canvas);
+
+    size_t tallest = 0;
+    for(size_t x = 0; x < 128; x++)
+    {
+        if(display.Top(x) >= 0)
+        {
+            EXPECT_EQ(display.Bottom(x), 63);
+        }
+        if(display.Top(x) >= 0
+           && (display.Top(tallest) < 0
+               || display.Top(x) < display.Top(tallest)))
+            tallest = x;
+    }
+    EXPECT_EQ(display.Top(tallest), 0);
+    EXPECT_NEAR(float(tallest), 63.f, 1.f);
+    EXPECT_EQ(display.Top(10), -1);
+
+    // -6 dB at the neighbours of the peak bin, on a range of 24 dB
+    page.SetRange(0.f);
+    EXPECT_EQ(page.GetRange(), SpectrumPage::kMinRangeDb);
+    display.Fill(false);
+    page.Draw(canvas);
+    EXPECT_NEAR(display.Top(tallest - 1), 17, 1);
+}
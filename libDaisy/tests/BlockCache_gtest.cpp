@@ -0,0 +1,309 @@
+#include "util/BlockCache.h"
+#include "FatFsImage.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+
+using namespace daisy;
+
+namespace
+{
+constexpr size_t kSector = BlockCache::kSectorSize;
+
+/** A disk in memory, that counts its transactions */
+struct RamDisk
+{
+    std::vector<uint8_t> data;
+    size_t               reads  = 0;
+    size_t               writes = 0;
+    bool                 fail   = false;
+
+    explicit RamDisk(size_t sectors) : data(sectors * kSector)
+    {
+        for(size_t i = 0; i < data.size(); i++)
+            data[i] = static_cast<uint8_t>(i * 7 + i / kSector);
+    }
+
+    static bool
+    Read(void* context, uint8_t* buffer, uint32_t sector, uint32_t count)
+    {
+        RamDisk* disk = static_cast<RamDisk*>(context);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer) & 31, 0u);
+        if(disk->fail || (sector + count) * kSector > disk->data.size())
+            return false;
+        memcpy(buffer, &disk->data[sector * kSector], count * kSector);
+        disk->reads++;
+        return true;
+    }
+
+    static bool Write(void*          context,
+                      const uint8_t* buffer,
+                      uint32_t       sector,
+                      uint32_t       count)
+    {
+        RamDisk* disk = static_cast<RamDisk*>(context);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer) & 31, 0u);
+        if(disk->fail || (sector + count) * kSector > disk->data.size())
+            return false;
+        memcpy(&disk->data[sector * kSector], buffer, count * kSector);
+        disk->writes++;
+        return true;
+    }
+
+    BlockCache::Device GetDevice() { return {Read, Write, this}; }
+};
+
+BlockCache::Config MakeConfig(uint8_t* buffer, size_t blocks, size_t sectors)
+{
+    BlockCache::Config config;
+    config.buffer        = buffer;
+    config.num_blocks    = blocks;
+    config.block_sectors = sectors;
+    return config;
+}
+} // namespace
+
+TEST(util_BlockCache, a_reads_and_writes_match_the_disk)
+{
+    RamDisk disk(250);
+    // what the disk holds once everything is written
+    const std::vector<uint8_t> initial = disk.data;
+    std::vector<uint8_t>       model   = disk.data;
+    alignas(32) static uint8_t blocks[8 * 4 * kSector];
+    BlockCache                 cache;
+    ASSERT_EQ(cache.Init(MakeConfig(blocks, 8, 4), disk.GetDevice()),
+              BlockCache::Result::OK);
+
+    // unaligned buffers, random places, up to the odd end of the disk
+    std::vector<uint8_t> buffer(16 * kSector + 1);
+    uint32_t             seed = 1;
+    for(size_t i = 0; i < 2000; i++)
+    {
+        seed                 = seed * 1664525 + 1013904223;
+        const uint32_t count    = 1 + (seed >> 8) % 12;
+        const uint32_t first    = (seed >> 16) % (250 - count + 1);
+        uint8_t*       data     = &buffer[1];
+        uint8_t*       expected = &model[first * kSector];
+        if(seed & 0x80000000)
+        {
+            for(size_t j = 0; j < count * kSector; j++)
+                data[j] = static_cast<uint8_t>(seed + j * 3);
+            ASSERT_EQ(cache.Write(data, first, count), BlockCache::Result::OK);
+            memcpy(expected, data, count * kSector);
+        }
+        else
+        {
+            ASSERT_EQ(cache.Read(data, first, count), BlockCache::Result::OK);
+            ASSERT_EQ(memcmp(data, expected, count * kSector), 0)
+                << first << " " << count;
+        }
+        if(i % 100 == 0)
+        {
+            ASSERT_EQ(cache.Flush(), BlockCache::Result::OK);
+        }
+    }
+    EXPECT_EQ(cache.GetStats().reads + cache.GetStats().writes, 2000u);
+    EXPECT_GT(cache.GetHitRate(), 0.f);
+
+    // nothing is lost once flushed
+    ASSERT_EQ(cache.Flush(), BlockCache::Result::OK);
+    EXPECT_EQ(cache.GetDirtyBlocks(), 0u);
+    EXPECT_EQ(disk.data, model);
+    EXPECT_NE(disk.data, initial);
+
+    // past the end of the disk
+    EXPECT_EQ(cache.Read(&buffer[1], 250, 1), BlockCache::Result::ERR_DEVICE);
+}
+
+TEST(util_BlockCache, b_sequential_writes_are_coalesced)
+{
+    RamDisk disk(1024);
+    alignas(32) static uint8_t blocks[8 * 8 * kSector];
+    BlockCache                 cache;
+    cache.Init(MakeConfig(blocks, 8, 8), disk.GetDevice());
+
+    // a sector at a time, like FatFs appending to a file
+    uint8_t buffer[kSector];
+    for(uint32_t sector = 0; sector < 256; sector++)
+    {
+        memset(buffer, sector, sizeof(buffer));
+        ASSERT_EQ(cache.Write(buffer, sector, 1), BlockCache::Result::OK);
+    }
+    ASSERT_EQ(cache.Flush(), BlockCache::Result::OK);
+    for(uint32_t sector = 0; sector < 256; sector++)
+        ASSERT_EQ(disk.data[sector * kSector + 17], uint8_t(sector));
+
+    // the whole cache per transaction, and the rest never read
+    const BlockCache::Stats& stats = cache.GetStats();
+    EXPECT_EQ(disk.writes, 256u / 64);
+    EXPECT_EQ(stats.device_writes, 256u / 64);
+    EXPECT_EQ(stats.device_write_sectors, 256u);
+    EXPECT_EQ(disk.reads, 0u);
+    EXPECT_EQ(stats.write_backs, 3u);
+    EXPECT_EQ(stats.write_misses, 256u / 8);
+    EXPECT_EQ(stats.write_hits, 256u - 256u / 8);
+
+    // a sector written over and over is written once
+    cache.ResetStats();
+    for(size_t i = 0; i < 100; i++)
+    {
+        memset(buffer, i, sizeof(buffer));
+        cache.Write(buffer, 500, 1);
+        cache.Read(buffer, 501, 1);
+    }
+    EXPECT_EQ(cache.GetDirtyBlocks(), 1u);
+    ASSERT_EQ(cache.Flush(), BlockCache::Result::OK);
+    // the sectors around the written one are read once, in two runs
+    EXPECT_EQ(cache.GetStats().device_writes, 1u);
+    EXPECT_EQ(cache.GetStats().device_reads, 2u);
+    EXPECT_EQ(disk.data[500 * kSector], 99);
+    EXPECT_GT(cache.GetHitRate(), 0.98f);
+}
+
+TEST(util_BlockCache, c_direct_transfers_and_errors)
+{
+    RamDisk disk(1024);
+    alignas(32) static uint8_t blocks[4 * 8 * kSector];
+    BlockCache                 cache;
+    cache.Init(MakeConfig(blocks, 4, 8), disk.GetDevice());
+
+    // whole blocks to an aligned buffer are one transaction, not cached
+    alignas(32) static uint8_t buffer[32 * kSector + 32];
+    ASSERT_EQ(cache.Read(buffer, 64, 32), BlockCache::Result::OK);
+    EXPECT_EQ(memcmp(buffer, &disk.data[64 * kSector], 32 * kSector), 0);
+    memset(buffer, 0x5a, 32 * kSector);
+    ASSERT_EQ(cache.Write(buffer, 128, 32), BlockCache::Result::OK);
+    EXPECT_EQ(disk.data[128 * kSector], 0x5a);
+    EXPECT_EQ(disk.reads, 1u);
+    EXPECT_EQ(disk.writes, 1u);
+    EXPECT_EQ(cache.GetDirtyBlocks(), 0u);
+
+    // unaligned, they go through the blocks
+    ASSERT_EQ(cache.Read(buffer + 1, 64, 16), BlockCache::Result::OK);
+    EXPECT_EQ(disk.reads, 3u);
+    ASSERT_EQ(cache.Read(buffer + 1, 64, 16), BlockCache::Result::OK);
+    EXPECT_EQ(disk.reads, 3u);
+
+    // cached blocks take the place of the disk for the direct ones
+    memset(buffer, 0x11, kSector);
+    cache.Write(buffer, 72, 1);
+    ASSERT_EQ(cache.Read(buffer, 64, 32), BlockCache::Result::OK);
+    EXPECT_EQ(buffer[8 * kSector], 0x11);
+    EXPECT_NE(disk.data[72 * kSector], 0x11);
+
+    // sectors that couldn't be written stay dirty
+    disk.fail = true;
+    EXPECT_EQ(cache.Flush(), BlockCache::Result::ERR_DEVICE);
+    EXPECT_EQ(cache.GetDirtyBlocks(), 1u);
+    disk.fail = false;
+    EXPECT_EQ(cache.Flush(), BlockCache::Result::OK);
+    EXPECT_EQ(disk.data[72 * kSector], 0x11);
+
+    // unless they are forgotten
+    cache.Write(buffer, 300, 1);
+    cache.Invalidate();
+    EXPECT_EQ(cache.GetDirtyBlocks(), 0u);
+    EXPECT_EQ(cache.Flush(), BlockCache::Result::OK);
+    EXPECT_NE(disk.data[300 * kSector], 0x11);
+}
+
+TEST(util_BlockCache, d_config)
+{
+    RamDisk    disk(16);
+    BlockCache cache;
+    alignas(32) static uint8_t blocks[2 * 4 * kSector + 1];
+    EXPECT_EQ(cache.Init(MakeConfig(nullptr, 2, 4), disk.GetDevice()),
+              BlockCache::Result::ERR_CONFIG);
+    EXPECT_EQ(cache.Init(MakeConfig(blocks + 1, 2, 4), disk.GetDevice()),
+              BlockCache::Result::ERR_CONFIG);
+    EXPECT_EQ(cache.Init(MakeConfig(blocks, 1, 4), disk.GetDevice()),
+              BlockCache::Result::ERR_CONFIG);
+    EXPECT_EQ(cache.Init(MakeConfig(blocks, 2, 33), disk.GetDevice()),
+              BlockCache::Result::ERR_CONFIG);
+    EXPECT_FALSE(cache.IsEnabled());
+    uint8_t buffer[kSector];
+    EXPECT_EQ(cache.Read(buffer, 0, 1), BlockCache::Result::ERR_CONFIG);
+    EXPECT_EQ(cache.Write(buffer, 0, 1), BlockCache::Result::ERR_CONFIG);
+    EXPECT_EQ(cache.Flush(), BlockCache::Result::ERR_CONFIG);
+    EXPECT_EQ(cache.Init(MakeConfig(blocks, 2, 4), disk.GetDevice()),
+              BlockCache::Result::OK);
+    EXPECT_TRUE(cache.IsEnabled());
+}
+
+TEST(util_BlockCache, e_records_while_playing_from_an_image)
+{
+    FatFsImage image;
+    ASSERT_TRUE(image.Init());
+    std::vector<uint8_t> sample(256 * 1024);
+    for(size_t i = 0; i < sample.size(); i++)
+        sample[i] = static_cast<uint8_t>(i * 13 + (i >> 10));
+    ASSERT_TRUE(image.WriteFile("0:/sample.raw", sample.data(), sample.size()));
+
+    // plays a file 2 KB per refill, while recording 1500 bytes per block
+    // of audio to another, synced every 64 blocks
+    std::vector<uint8_t> take(1500);
+    auto                 session = [&](const char* path) {
+        FIL play, record;
+        EXPECT_EQ(f_open(&play, "0:/sample.raw", FA_READ), FR_OK);
+        EXPECT_EQ(f_open(&record, path, FA_CREATE_ALWAYS | FA_WRITE), FR_OK);
+        std::vector<uint8_t> chunk(2048);
+        for(size_t pos = 0, block = 0; pos < sample.size();
+            pos += chunk.size(), block++)
+        {
+            UINT read = 0, written = 0;
+            EXPECT_EQ(f_read(&play, chunk.data(), chunk.size(), &read), FR_OK);
+            EXPECT_EQ(memcmp(chunk.data(), &sample[pos], read), 0);
+            for(size_t i = 0; i < take.size(); i++)
+                take[i] = static_cast<uint8_t>(block + i);
+            EXPECT_EQ(f_write(&record, take.data(), take.size(), &written),
+                      FR_OK);
+            if(block % 64 == 63)
+            {
+                EXPECT_EQ(f_sync(&record), FR_OK);
+            }
+        }
+        f_close(&play);
+        EXPECT_EQ(f_close(&record), FR_OK);
+    };
+
+    FatFsImage::TakeTransfers();
+    FatFsImage::TakeWriteTransfers();
+    session("0:/direct.raw");
+    const size_t direct
+        = FatFsImage::TakeTransfers() + FatFsImage::TakeWriteTransfers();
+
+    alignas(32) static uint8_t blocks[32 * 8 * kSector];
+    BlockCache                 cache;
+    const BlockCache::Config config = MakeConfig(blocks, 32, 8);
+    ASSERT_EQ(cache.Init(config, FatFsImage::GetBlockDevice()),
+              BlockCache::Result::OK);
+    FatFsImage::SetBlockCache(&cache);
+    session("0:/cached.raw");
+    EXPECT_EQ(cache.GetDirtyBlocks(), 0u);
+    FatFsImage::SetBlockCache(nullptr);
+    const size_t cached
+        = FatFsImage::TakeTransfers() + FatFsImage::TakeWriteTransfers();
+    const BlockCache::Stats& stats = cache.GetStats();
+    EXPECT_EQ(cached, stats.device_reads + stats.device_writes);
+    // 8 sectors per read, and the recording written in runs of blocks
+    EXPECT_LE(cached * 3, direct);
+    EXPECT_GT(cache.GetHitRate(), 0.5f);
+
+    // both takes reached the image, read without the cache
+    FIL                  a, b;
+    std::vector<uint8_t> da(64 * 1024), db(64 * 1024);
+    ASSERT_EQ(f_open(&a, "0:/direct.raw", FA_READ), FR_OK);
+    ASSERT_EQ(f_open(&b, "0:/cached.raw", FA_READ), FR_OK);
+    EXPECT_EQ(f_size(&a), 128u * take.size());
+    EXPECT_EQ(f_size(&b), f_size(&a));
+    for(FSIZE_t pos = 0; pos < f_size(&a); pos += da.size())
+    {
+        UINT ra = 0, rb = 0;
+        f_read(&a, da.data(), da.size(), &ra);
+        f_read(&b, db.data(), db.size(), &rb);
+        ASSERT_EQ(ra, rb);
+        ASSERT_EQ(memcmp(da.data(), db.data(), ra), 0);
+    }
+    f_close(&a);
+    f_close(&b);
+}
@@ -0,0 +1,231 @@
+#include <stdio.h>
+#include <string.h>
+#include "FatFsImage.h"
+#include "diskio.h"
+
+// FatFs itself, built for the host
+extern "C"
+{
+#include "ff.c"
+#include "option/unicode.c"
+}
+
+namespace
+{
+constexpr uint32_t kDefaultTime = (40u << 25) | (1u << 21) | (1u << 16);
+
+FILE*    image        = nullptr;
+size_t   num_sectors  = 0;
+size_t   sectors_read = 0;
+size_t   transfers    = 0;
+size_t   writes       = 0;
+uint32_t fattime      = kDefaultTime;
+
+daisy::ReadAheadCache* read_cache  = nullptr;
+daisy::BlockCache*     block_cache = nullptr;
+
+// the transfer of the device, done when the latency has passed
+size_t   latency_polls = 0;
+size_t   polls_left    = 0;
+bool     transfer_ok   = false;
+
+bool ReadImage(BYTE* buff, DWORD sector, UINT count)
+{
+    if(fseek(image, long(sector) * 512, SEEK_SET) != 0
+       || fread(buff, 512, count, image) != count)
+        return false;
+    sectors_read += count;
+    transfers++;
+    return true;
+}
+
+bool WriteImage(const BYTE* buff, DWORD sector, UINT count)
+{
+    if(fseek(image, long(sector) * 512, SEEK_SET) != 0
+       || fwrite(buff, 512, count, image) != count)
+        return false;
+    writes++;
+    return true;
+}
+
+bool StartRead(void*, uint8_t* buffer, uint32_t sector, uint32_t count)
+{
+    if(sector + count > num_sectors)
+        return false;
+    transfer_ok = ReadImage(buffer, sector, count);
+    polls_left  = latency_polls;
+    return true;
+}
+
+daisy::ReadAheadCache::Transfer PollRead(void*)
+{
+    if(polls_left > 0)
+    {
+        polls_left--;
+        return daisy::ReadAheadCache::Transfer::BUSY;
+    }
+    return transfer_ok ? daisy::ReadAheadCache::Transfer::DONE
+                       : daisy::ReadAheadCache::Transfer::FAILED;
+}
+
+bool BlockRead(void*, uint8_t* buffer, uint32_t sector, uint32_t count)
+{
+    return sector + count <= num_sectors && ReadImage(buffer, sector, count);
+}
+
+bool BlockWrite(void*, const uint8_t* buffer, uint32_t sector, uint32_t count)
+{
+    return sector + count <= num_sectors && WriteImage(buffer, sector, count);
+}
+} // namespace
+
+extern "C"
+{
+    DSTATUS disk_initialize(BYTE) { return image ? 0 : STA_NOINIT; }
+
+    DSTATUS disk_status(BYTE) { return image ? 0 : STA_NOINIT; }
+
+    DRESULT disk_read(BYTE, BYTE* buff, DWORD sector, UINT count)
+    {
+        if(block_cache != nullptr)
+            return block_cache->Read(buff, sector, count)
+                           == daisy::BlockCache::Result::OK
+                       ? RES_OK
+                       : RES_ERROR;
+        if(read_cache != nullptr)
+            return read_cache->Read(buff, sector, count)
+                           == daisy::ReadAheadCache::Result::OK
+                       ? RES_OK
+                       : RES_ERROR;
+        return ReadImage(buff, sector, count) ? RES_OK : RES_ERROR;
+    }
+
+    DRESULT disk_write(BYTE, const BYTE* buff, DWORD sector, UINT count)
+    {
+        if(block_cache != nullptr)
+            return block_cache->Write(buff, sector, count)
+                           == daisy::BlockCache::Result::OK
+                       ? RES_OK
+                       : RES_ERROR;
+        if(read_cache != nullptr)
+            read_cache->Invalidate(sector, count);
+        return WriteImage(buff, sector, count) ? RES_OK : RES_ERROR;
+    }
+
+    DRESULT disk_ioctl(BYTE, BYTE cmd, void* buff)
+    {
+        switch(cmd)
+        {
+            case CTRL_SYNC:
+                if(block_cache != nullptr
+                   && block_cache->Flush() != daisy::BlockCache::Result::OK)
+                    return RES_ERROR;
+                return RES_OK;
+            case GET_SECTOR_COUNT:
+                *static_cast<DWORD*>(buff) = num_sectors;
+                return RES_OK;
+            case GET_SECTOR_SIZE:
+                *static_cast<WORD*>(buff) = 512;
+                return RES_OK;
+            case GET_BLOCK_SIZE:
+                *static_cast<DWORD*>(buff) = 1;
+                return RES_OK;
+            default: return RES_PARERR;
+        }
+    }
+
+    DWORD get_fattime() { return fattime; }
+}
+
+FatFsImage::~FatFsImage()
+{
+    if(file_ != nullptr)
+    {
+        f_mount(nullptr, "0:", 0);
+        fclose(static_cast<FILE*>(file_));
+        image       = nullptr;
+        read_cache  = nullptr;
+        block_cache = nullptr;
+    }
+}
+
+bool FatFsImage::Init(size_t sectors)
+{
+    file_       = tmpfile();
+    image       = static_cast<FILE*>(file_);
+    num_sectors = sectors;
+    fattime     = kDefaultTime;
+    read_cache  = nullptr;
+    block_cache = nullptr;
+    if(image == nullptr)
+        return false;
+    // a sparse file of the full size
+    if(fseek(image, long(sectors) * 512 - 1, SEEK_SET) != 0
+       || fputc(0, image) == EOF)
+        return false;
+
+    static BYTE work[_MAX_SS];
+    if(f_mkfs("0:", FM_ANY | FM_SFD, 0, work, sizeof(work)) != FR_OK)
+        return false;
+    sectors_read = 0;
+    transfers    = 0;
+    writes       = 0;
+    return f_mount(&fs_, "0:", 1) == FR_OK;
+}
+
+bool FatFsImage::WriteFile(const char* path, const void* data, size_t size)
+{
+    FIL  fil;
+    UINT written = 0;
+    if(f_open(&fil, path, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+        return false;
+    f_write(&fil, data, size, &written);
+    return f_close(&fil) == FR_OK && written == size;
+}
+
+void FatFsImage::SetTime(uint32_t time)
+{
+    fattime = time;
+}
+
+size_t FatFsImage::TakeSectorsRead()
+{
+    const size_t sectors = sectors_read;
+    sectors_read         = 0;
+    return sectors;
+}
+
+size_t FatFsImage::TakeTransfers()
+{
+    const size_t count = transfers;
+    transfers          = 0;
+    return count;
+}
+
+size_t FatFsImage::TakeWriteTransfers()
+{
+    const size_t count = writes;
+    writes             = 0;
+    return count;
+}
+
+void FatFsImage::SetReadCache(daisy::ReadAheadCache* cache)
+{
+    read_cache = cache;
+}
+
+daisy::ReadAheadCache::Device FatFsImage::GetDevice(size_t latency)
+{
+    latency_polls = latency;
+    return {StartRead, PollRead, nullptr};
+}
+
+void FatFsImage::SetBlockCache(daisy::BlockCache* cache)
+{
+    block_cache = cache;
+}
+
+daisy::BlockCache::Device FatFsImage::GetBlockDevice()
+{
+    return {BlockRead, BlockWrite, nullptr};
+}
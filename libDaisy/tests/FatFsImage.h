@@ -0,0 +1,63 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "ff.h"
+#include "util/ReadAheadCache.h"
+#include "util/BlockCache.h"
+
+/** FatFs on the host, over a disk image in a temporary file.
+ *
+ *  Init() formats the image and mounts it at "0:", so code that uses the
+ *  FatFs API, e.g. daisy::WavIndex, runs unchanged in the tests. Only one
+ *  image can be mounted at a time.
+ */
+class FatFsImage
+{
+  public:
+    FatFsImage() : file_(nullptr) {}
+    ~FatFsImage();
+
+    /** Creates and mounts an image of num_sectors sectors of 512 bytes */
+    bool Init(size_t num_sectors = 32768);
+
+    /** Writes a whole file */
+    bool WriteFile(const char* path, const void* data, size_t size);
+
+    /** Sets the time stamp given to files written from now on, until the
+     *  next Init(), in the format of get_fattime()
+     */
+    static void SetTime(uint32_t fattime);
+
+    /** \return sectors read from the image since the last call */
+    static size_t TakeSectorsRead();
+
+    /** \return transactions that read the image since the last call */
+    static size_t TakeTransfers();
+
+    /** \return transactions that wrote the image since the last call */
+    static size_t TakeWriteTransfers();
+
+    /** Sends the reads and writes of FatFs through a cache, like the USB
+     *  host driver does, or directly to the image with nullptr.
+     */
+    static void SetReadCache(daisy::ReadAheadCache* cache);
+
+    /** \return a device that reads the image asynchronously, for the
+     *  cache. A transfer is done after `latency` polls, like a USB
+     *  transaction that takes that many passes of the main loop.
+     */
+    static daisy::ReadAheadCache::Device GetDevice(size_t latency);
+
+    /** Sends the reads and writes of FatFs through a write-back cache,
+     *  like the SD card driver does, and CTRL_SYNC to its Flush(), or
+     *  directly to the image with nullptr.
+     */
+    static void SetBlockCache(daisy::BlockCache* cache);
+
+    /** \return a device that reads and writes the image, for the cache */
+    static daisy::BlockCache::Device GetBlockDevice();
+
+  private:
+    FATFS fs_;
+    void* file_;
+};
@@ -495,4 +495,29 @@ TEST(util_MappedStringListValue, e_stepUpDown)
     val = 4;
     val.Step(-100, false);
     EXPECT_EQ(val, 0);
-}
\ No newline at end of file
+}
+
+TEST(util_MappedValue, a_rawRoundTrip)
+{
+    MappedFloatValue f(0.1f, 10.0f, 1.0f, MappedFloatValue::Mapping::log);
+    f = 3.14159f;
+    const auto fRaw = f.GetRaw();
+    f.ResetToDefault();
+    f.SetFromRaw(fRaw);
+    EXPECT_EQ(f.Get(), 3.14159f);
+
+    MappedIntValue i(-100, 100, 0, 1, 10);
+    i = -42;
+    const auto iRaw = i.GetRaw();
+    i.ResetToDefault();
+    i.SetFromRaw(iRaw);
+    EXPECT_EQ(i.Get(), -42);
+
+    const char*           items[] = {"a", "b", "c"};
+    MappedStringListValue l(items, 3, 0);
+    l = 2;
+    const auto lRaw = l.GetRaw();
+    l.ResetToDefault();
+    l.SetFromRaw(lRaw);
+    EXPECT_EQ(l.GetIndex(), 2);
+}
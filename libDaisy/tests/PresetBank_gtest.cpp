@@ -0,0 +1,298 @@
+#include "util/PresetBank.h"
+#include <gtest/gtest.h>
+
+using namespace daisy;
+
+using TestBank = PresetBank<8, 4>;
+
+namespace
+{
+struct CallbackCounter
+{
+    int numCalls = 0;
+};
+
+void CountCallback(void* context, const MappedValue&)
+{
+    static_cast<CallbackCounter*>(context)->numCalls++;
+}
+
+const char* listItems[] = {"a", "b", "c", "d"};
+
+/** Clears the mock flash, which erases to 0xff like the hardware */
+void EraseBank(QSPIHandle& qspi)
+{
+    qspi.Erase(0, 4 * TestBank::kSlotSize);
+}
+} // namespace
+
+TEST(util_PresetBank, a_emptySlots)
+{
+    QSPIHandle qspi;
+    EraseBank(qspi);
+    TestBank bank(qspi);
+    bank.Init();
+
+    for(size_t i = 0; i < 4; i++)
+    {
+        EXPECT_FALSE(bank.IsSlotUsed(i));
+        EXPECT_EQ(bank.GetSlotName(i), nullptr);
+        EXPECT_EQ(bank.Recall(i), TestBank::Result::ERR_NO_PRESET);
+    }
+    EXPECT_EQ(bank.Recall(4), TestBank::Result::ERR_INVALID_SLOT);
+    EXPECT_EQ(bank.Store(4), TestBank::Result::ERR_INVALID_SLOT);
+}
+
+TEST(util_PresetBank, b_addParams)
+{
+    QSPIHandle qspi;
+    TestBank   bank(qspi);
+    bank.Init();
+
+    MappedFloatValue f(0.0f, 1.0f, 0.5f);
+    EXPECT_EQ(bank.AddParam(1, f), TestBank::Result::OK);
+    EXPECT_EQ(bank.AddParam(1, f), TestBank::Result::ERR_DUPLICATE_ID);
+    for(uint16_t id = 2; id < 9; id++)
+        EXPECT_EQ(bank.AddParam(id, f), TestBank::Result::OK);
+    EXPECT_EQ(bank.AddParam(9, f), TestBank::Result::ERR_TOO_MANY_PARAMS);
+    EXPECT_EQ(bank.GetNumParams(), 8u);
+}
+
+TEST(util_PresetBank, c_storeAndRecall)
+{
+    QSPIHandle qspi;
+    EraseBank(qspi);
+    TestBank bank(qspi);
+    bank.Init();
+
+    MappedFloatValue f(
+        20.0f, 20000.0f, 1000.0f, MappedFloatValue::Mapping::log);
+    MappedIntValue        i(-10, 10, 0, 1, 5);
+    MappedStringListValue l(listItems, 4, 0);
+    bank.AddParam(10, f);
+    bank.AddParam(20, i);
+    bank.AddParam(30, l);
+
+    f = 123.456f;
+    i = -7;
+    l = 2;
+    EXPECT_EQ(bank.Store(1, "Lead"), TestBank::Result::OK);
+    EXPECT_TRUE(bank.IsSlotUsed(1));
+    EXPECT_FALSE(bank.IsSlotUsed(0));
+    EXPECT_STREQ(bank.GetSlotName(1), "Lead");
+    // names are cut to fit
+    EXPECT_EQ(bank.Store(3, "A name that is too long"), TestBank::Result::OK);
+    EXPECT_STREQ(bank.GetSlotName(3), "A name that is ");
+
+    f.ResetToDefault();
+    i.ResetToDefault();
+    l.ResetToDefault();
+    EXPECT_EQ(bank.Recall(1), TestBank::Result::OK);
+    EXPECT_EQ(bank.GetNumPending(), 3u);
+
+    // values are applied by Process(), not by Recall()
+    EXPECT_EQ(f.Get(), 1000.0f);
+    bank.Process(3);
+    EXPECT_FALSE(bank.IsRecallPending());
+    // values are restored without any loss of precision
+    EXPECT_EQ(f.Get(), 123.456f);
+    EXPECT_EQ(i.Get(), -7);
+    EXPECT_EQ(l.GetIndex(), 2);
+}
+
+TEST(util_PresetBank, d_onlyChangedParamsAreApplied)
+{
+    QSPIHandle qspi;
+    EraseBank(qspi);
+    TestBank bank(qspi);
+    bank.Init();
+
+    MappedFloatValue a(0.0f, 1.0f, 0.5f);
+    MappedFloatValue b(0.0f, 1.0f, 0.5f);
+    MappedFloatValue c(0.0f, 1.0f, 0.5f);
+    CallbackCounter  counter;
+    bank.AddParam(0, a, CountCallback, &counter);
+    bank.AddParam(1, b, CountCallback, &counter);
+    bank.AddParam(2, c, CountCallback, &counter);
+    bank.Store(0);
+
+    b = 0.25f;
+    bank.Recall(0);
+    EXPECT_EQ(bank.GetNumPending(), 1u);
+    EXPECT_EQ(bank.Process(8), 1u);
+    EXPECT_EQ(counter.numCalls, 1);
+    EXPECT_EQ(b.Get(), 0.5f);
+
+    // recalling the same preset again is a no-op
+    bank.Recall(0);
+    EXPECT_EQ(bank.GetNumPending(), 0u);
+    EXPECT_EQ(bank.Process(8), 0u);
+    EXPECT_EQ(counter.numCalls, 1);
+}
+
+TEST(util_PresetBank, e_updatesAreSpreadOverBlocks)
+{
+    QSPIHandle qspi;
+    EraseBank(qspi);
+    TestBank bank(qspi);
+    bank.Init();
+
+    MappedIntValue  vals[6] = {{0, 100, 0, 1, 10},
+                              {0, 100, 0, 1, 10},
+                              {0, 100, 0, 1, 10},
+                              {0, 100, 0, 1, 10},
+                              {0, 100, 0, 1, 10},
+                              {0, 100, 0, 1, 10}};
+    CallbackCounter counter;
+    for(uint16_t n = 0; n < 6; n++)
+    {
+        bank.AddParam(n, vals[n], CountCallback, &counter);
+        vals[n] = n + 1;
+    }
+    bank.Store(2);
+    for(auto& v : vals)
+        v.ResetToDefault();
+
+    bank.Recall(2);
+    // two updates per "block"
+    EXPECT_EQ(bank.Process(2), 2u);
+    EXPECT_EQ(bank.Process(2), 2u);
+    EXPECT_EQ(counter.numCalls, 4);
+    EXPECT_TRUE(bank.IsRecallPending());
+    EXPECT_EQ(bank.Process(2), 2u);
+    EXPECT_FALSE(bank.IsRecallPending());
+    for(int n = 0; n < 6; n++)
+        EXPECT_EQ(vals[n].Get(), n + 1);
+}
+
+TEST(util_PresetBank, f_schemaChanges)
+{
+    QSPIHandle qspi;
+    EraseBank(qspi);
+
+    MappedFloatValue a(0.0f, 1.0f, 0.1f);
+    MappedFloatValue b(0.0f, 1.0f, 0.2f);
+    MappedFloatValue c(0.0f, 1.0f, 0.3f);
+
+    // old firmware: parameters 1 & 2
+    {
+        TestBank bank(qspi);
+        bank.Init(0, 1);
+        bank.AddParam(1, a);
+        bank.AddParam(2, b);
+        a = 0.7f;
+        b = 0.8f;
+        bank.Store(0);
+    }
+
+    a.ResetToDefault();
+    b.ResetToDefault();
+
+    // new firmware: parameter 1 removed, parameter 3 added, different order
+    TestBank bank(qspi);
+    bank.Init(0, 2);
+    bank.AddParam(3, c);
+    bank.AddParam(2, b);
+    EXPECT_EQ(bank.Recall(0), TestBank::Result::OK);
+    bank.Process(8);
+    EXPECT_EQ(a.Get(), 0.1f); // not registered, untouched
+    EXPECT_EQ(b.Get(), 0.8f);
+    EXPECT_EQ(c.Get(), 0.3f); // missing from preset, untouched
+}
+
+TEST(util_PresetBank, g_serializeToBuffer)
+{
+    QSPIHandle qspi;
+    TestBank   bank(qspi);
+    bank.Init();
+
+    MappedFloatValue a(0.0f, 1.0f, 0.5f);
+    MappedIntValue   b(0, 10, 5, 1, 2);
+    bank.AddParam(0, a);
+    bank.AddParam(1, b);
+
+    uint8_t small[8];
+    EXPECT_EQ(bank.Serialize(small, sizeof(small)), 0u);
+
+    uint8_t buffer[TestBank::kMaxPresetSize];
+    a = 0.9f;
+    b = 9;
+    const size_t size = bank.Serialize(buffer, sizeof(buffer), "SD");
+    EXPECT_EQ(size, bank.GetSerializedSize());
+
+    a.ResetToDefault();
+    b.ResetToDefault();
+    EXPECT_EQ(bank.RecallFromBuffer(buffer, size), TestBank::Result::OK);
+    bank.Process(2);
+    EXPECT_EQ(a.Get(), 0.9f);
+    EXPECT_EQ(b.Get(), 9);
+
+    // truncated or corrupted data is rejected
+    EXPECT_EQ(bank.RecallFromBuffer(buffer, size - 1),
+              TestBank::Result::ERR_NO_PRESET);
+    buffer[size - 1] ^= 0x01;
+    EXPECT_EQ(bank.RecallFromBuffer(buffer, size),
+              TestBank::Result::ERR_NO_PRESET);
+    buffer[size - 1] ^= 0x01;
+    buffer[offsetof(TestBank::Header, name) + 2] = 'x';
+    EXPECT_EQ(bank.RecallFromBuffer(buffer, size),
+              TestBank::Result::ERR_NO_PRESET);
+}
+
+namespace
+{
+/** Runs an audio block whenever the bank reads the value, like the audio
+ *  callback interrupting a recall from the main loop
+ */
+class InterruptingValue : public MappedIntValue
+{
+  public:
+    InterruptingValue() : MappedIntValue(0, 100, 0, 1, 10) {}
+    using MappedIntValue::operator=;
+
+    uint32_t GetRaw() const override
+    {
+        if(bank != nullptr)
+            bank->Process(1);
+        return MappedIntValue::GetRaw();
+    }
+
+    TestBank* bank = nullptr;
+};
+} // namespace
+
+TEST(util_PresetBank, h_processInterruptsARecall)
+{
+    QSPIHandle qspi;
+    TestBank   bank(qspi);
+    bank.Init();
+
+    InterruptingValue vals[4];
+    for(uint16_t n = 0; n < 4; n++)
+        bank.AddParam(n, vals[n]);
+
+    uint8_t first[TestBank::kMaxPresetSize], second[TestBank::kMaxPresetSize];
+    for(int n = 0; n < 4; n++)
+        vals[n] = 10 * (n + 1);
+    const size_t size = bank.Serialize(first, sizeof(first));
+    for(int n = 0; n < 4; n++)
+        vals[n] = 50 + n;
+    bank.Serialize(second, sizeof(second));
+    for(auto& v : vals)
+    {
+        v.ResetToDefault();
+        v.bank = &bank;
+    }
+
+    // each recall overtakes the blocks that apply the previous one
+    EXPECT_EQ(bank.RecallFromBuffer(first, size), TestBank::Result::OK);
+    EXPECT_EQ(bank.RecallFromBuffer(second, size), TestBank::Result::OK);
+    EXPECT_EQ(bank.RecallFromBuffer(first, size), TestBank::Result::OK);
+    EXPECT_LE(bank.GetNumPending(), 4u);
+    while(bank.Process(1) > 0) {}
+
+    EXPECT_FALSE(bank.IsRecallPending());
+    EXPECT_EQ(bank.GetNumPending(), 0u);
+    for(int n = 0; n < 4; n++)
+        EXPECT_EQ(vals[n].Get(), 10 * (n + 1));
+}
@@ -0,0 +1,244 @@
+#include "util/ReadAheadCache.h"
+#include "FatFsImage.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+
+using namespace daisy;
+
+namespace
+{
+constexpr size_t kSector = ReadAheadCache::kSectorSize;
+
+/** A disk in memory, a transfer takes `latency` polls */
+struct RamDisk
+{
+    std::vector<uint8_t> data;
+    size_t               latency   = 0;
+    size_t               polls     = 0;
+    size_t               transfers = 0;
+
+    explicit RamDisk(size_t sectors) : data(sectors * kSector)
+    {
+        for(size_t i = 0; i < data.size(); i++)
+            data[i] = static_cast<uint8_t>(i * 7 + i / kSector);
+    }
+
+    static bool
+    Start(void* context, uint8_t* buffer, uint32_t sector, uint32_t count)
+    {
+        RamDisk* disk = static_cast<RamDisk*>(context);
+        if((sector + count) * kSector > disk->data.size())
+            return false;
+        memcpy(buffer, &disk->data[sector * kSector], count * kSector);
+        disk->polls = disk->latency;
+        disk->transfers++;
+        return true;
+    }
+
+    static ReadAheadCache::Transfer Poll(void* context)
+    {
+        RamDisk* disk = static_cast<RamDisk*>(context);
+        if(disk->polls == 0)
+            return ReadAheadCache::Transfer::DONE;
+        disk->polls--;
+        return ReadAheadCache::Transfer::BUSY;
+    }
+
+    ReadAheadCache::Device GetDevice() { return {Start, Poll, this}; }
+};
+
+ReadAheadCache::Config
+MakeConfig(uint8_t* buffer, size_t lines, size_t sectors, size_t ahead)
+{
+    ReadAheadCache::Config config;
+    config.buffer           = buffer;
+    config.num_lines        = lines;
+    config.line_sectors     = sectors;
+    config.read_ahead_lines = ahead;
+    return config;
+}
+} // namespace
+
+TEST(util_ReadAheadCache, a_reads_match_the_disk)
+{
+    RamDisk disk(250);
+    disk.latency = 2;
+    alignas(32) static uint8_t lines[8 * 4 * kSector];
+    ReadAheadCache             cache;
+    ASSERT_EQ(cache.Init(MakeConfig(lines, 8, 4, 2), disk.GetDevice()),
+              ReadAheadCache::Result::OK);
+
+    // unaligned buffers, random places, up to the odd end of the disk
+    std::vector<uint8_t> buffer(16 * kSector + 1);
+    uint32_t             seed = 1;
+    for(size_t i = 0; i < 500; i++)
+    {
+        seed                 = seed * 1664525 + 1013904223;
+        const uint32_t count = 1 + (seed >> 8) % 12;
+        const uint32_t first = (seed >> 16) % (250 - count + 1);
+        ASSERT_EQ(cache.Read(&buffer[1], first, count),
+                  ReadAheadCache::Result::OK);
+        ASSERT_EQ(
+            memcmp(&buffer[1], &disk.data[first * kSector], count * kSector),
+            0)
+            << first << " " << count;
+        if(i % 3 == 0)
+            cache.Process();
+    }
+    EXPECT_GT(cache.GetStats().hit_sectors, 0u);
+    EXPECT_EQ(cache.GetStats().reads, 500u);
+
+    // past the end of the disk
+    EXPECT_EQ(cache.Read(&buffer[1], 250, 1),
+              ReadAheadCache::Result::ERR_DEVICE);
+}
+
+TEST(util_ReadAheadCache, b_sequential_reads_load_ahead)
+{
+    RamDisk disk(1024);
+    disk.latency = 4;
+    alignas(32) static uint8_t lines[8 * 8 * kSector];
+    ReadAheadCache             cache;
+    cache.Init(MakeConfig(lines, 8, 8, 3), disk.GetDevice());
+
+    // a sector at a time, with a few passes of the main loop in between
+    uint8_t buffer[kSector];
+    for(uint32_t sector = 0; sector < 1024; sector++)
+    {
+        ASSERT_EQ(cache.Read(buffer, sector, 1), ReadAheadCache::Result::OK);
+        ASSERT_EQ(memcmp(buffer, &disk.data[sector * kSector], kSector), 0);
+        for(size_t i = 0; i < 3; i++)
+            cache.Process();
+    }
+    const ReadAheadCache::Stats& stats = cache.GetStats();
+    EXPECT_EQ(stats.transfers, 1024u / 8);
+    EXPECT_EQ(disk.transfers, 1024u / 8);
+    EXPECT_EQ(stats.read_aheads, 1024u / 8 - 1);
+    EXPECT_EQ(stats.read_ahead_hits, 1024u / 8 - 1);
+    // only the first line was waited for
+    EXPECT_EQ(stats.waits, 0u);
+    EXPECT_EQ(stats.miss_sectors, 1u);
+}
+
+TEST(util_ReadAheadCache, c_hints_and_direct_reads)
+{
+    RamDisk disk(1024);
+    disk.latency = 1;
+    alignas(32) static uint8_t lines[4 * 8 * kSector];
+    ReadAheadCache             cache;
+    cache.Init(MakeConfig(lines, 4, 8, 0), disk.GetDevice());
+
+    // whole lines to an aligned buffer are one transaction, not cached
+    alignas(32) static uint8_t buffer[32 * kSector];
+    ASSERT_EQ(cache.Read(buffer, 64, 32), ReadAheadCache::Result::OK);
+    EXPECT_EQ(memcmp(buffer, &disk.data[64 * kSector], 32 * kSector), 0);
+    EXPECT_EQ(cache.GetStats().transfers, 1u);
+    ASSERT_EQ(cache.Read(buffer, 64, 1), ReadAheadCache::Result::OK);
+    EXPECT_EQ(cache.GetStats().transfers, 2u);
+
+    // hinted sectors are loaded by Process()
+    cache.ResetStats();
+    cache.Hint(300, 20); // lines at 296, 304 and 312
+    for(size_t i = 0; i < 10; i++)
+        cache.Process();
+    EXPECT_EQ(cache.GetStats().read_aheads, 3u);
+    EXPECT_FALSE(cache.IsBusy());
+    ASSERT_EQ(cache.Read(buffer, 300, 20), ReadAheadCache::Result::OK);
+    EXPECT_EQ(memcmp(buffer, &disk.data[300 * kSector], 20 * kSector), 0);
+    EXPECT_EQ(cache.GetStats().hit_sectors, 20u);
+    EXPECT_EQ(cache.GetStats().transfers, 3u);
+
+    // lines loaded ahead and not read yet aren't replaced by more hints
+    cache.Hint(500, 64);
+    for(size_t i = 0; i < 40; i++)
+        cache.Process();
+    EXPECT_EQ(cache.GetStats().read_aheads, 3u + 4u);
+
+    // written sectors are forgotten
+    disk.data[301 * kSector] ^= 0xff;
+    cache.Invalidate(301, 1);
+    ASSERT_EQ(cache.Read(buffer, 301, 1), ReadAheadCache::Result::OK);
+    EXPECT_EQ(buffer[0], disk.data[301 * kSector]);
+}
+
+TEST(util_ReadAheadCache, d_config)
+{
+    RamDisk        disk(16);
+    ReadAheadCache cache;
+    alignas(32) static uint8_t lines[2 * 4 * kSector + 1];
+    EXPECT_EQ(cache.Init(MakeConfig(nullptr, 2, 4, 1), disk.GetDevice()),
+              ReadAheadCache::Result::ERR_CONFIG);
+    EXPECT_EQ(cache.Init(MakeConfig(lines + 1, 2, 4, 1), disk.GetDevice()),
+              ReadAheadCache::Result::ERR_CONFIG);
+    EXPECT_EQ(cache.Init(MakeConfig(lines, 1, 4, 1), disk.GetDevice()),
+              ReadAheadCache::Result::ERR_CONFIG);
+    EXPECT_FALSE(cache.IsEnabled());
+    uint8_t buffer[kSector];
+    EXPECT_EQ(cache.Read(buffer, 0, 1), ReadAheadCache::Result::ERR_CONFIG);
+    EXPECT_EQ(cache.Init(MakeConfig(lines, 2, 4, 1), disk.GetDevice()),
+              ReadAheadCache::Result::OK);
+    EXPECT_TRUE(cache.IsEnabled());
+}
+
+TEST(util_ReadAheadCache, e_streams_a_file_from_an_image)
+{
+    FatFsImage image;
+    ASSERT_TRUE(image.Init());
+    std::vector<uint8_t> file(512 * 1024);
+    for(size_t i = 0; i < file.size(); i++)
+        file[i] = static_cast<uint8_t>(i * 13 + (i >> 10));
+    ASSERT_TRUE(image.WriteFile("0:/sample.raw", file.data(), file.size()));
+
+    // reads the file like a streaming player, 2 KB per refill, with a
+    // few passes of the main loop between refills
+    auto stream = [&](ReadAheadCache* cache) {
+        FIL fil;
+        EXPECT_EQ(f_open(&fil, "0:/sample.raw", FA_READ), FR_OK);
+        std::vector<uint8_t> chunk(2048);
+        for(size_t pos = 0; pos < file.size(); pos += chunk.size())
+        {
+            UINT read = 0;
+            EXPECT_EQ(f_read(&fil, chunk.data(), chunk.size(), &read), FR_OK);
+            EXPECT_EQ(read, chunk.size());
+            EXPECT_EQ(memcmp(chunk.data(), &file[pos], read), 0);
+            if(cache != nullptr)
+            {
+                cache->HintFile(&fil, chunk.size());
+                for(size_t i = 0; i < 8; i++)
+                    cache->Process();
+            }
+        }
+        f_close(&fil);
+    };
+
+    FatFsImage::TakeTransfers();
+    stream(nullptr);
+    const size_t direct = FatFsImage::TakeTransfers();
+
+    alignas(32) static uint8_t lines[16 * 16 * kSector];
+    ReadAheadCache             cache;
+    const ReadAheadCache::Config config = MakeConfig(lines, 16, 16, 4);
+    ASSERT_EQ(cache.Init(config, FatFsImage::GetDevice(4)),
+              ReadAheadCache::Result::OK);
+    FatFsImage::SetReadCache(&cache);
+    stream(&cache);
+    const size_t cached = FatFsImage::TakeTransfers();
+
+    // 8 KB per transaction instead of 2 KB, and the refills don't wait
+    EXPECT_GE(direct, file.size() / 2048);
+    EXPECT_LE(cached, direct / 3);
+    EXPECT_EQ(cached, cache.GetStats().transfers);
+    EXPECT_LE(cache.GetStats().waits, 2u);
+
+    // writes go around the cache, and replace what it holds
+    FIL  fil;
+    UINT written = 0;
+    ASSERT_EQ(f_open(&fil, "0:/sample.raw", FA_WRITE), FR_OK);
+    const uint8_t patch[4] = {1, 2, 3, 4};
+    f_write(&fil, patch, sizeof(patch), &written);
+    f_close(&fil);
+    memcpy(file.data(), patch, sizeof(patch));
+    stream(&cache);
+    FatFsImage::SetReadCache(nullptr);
+}
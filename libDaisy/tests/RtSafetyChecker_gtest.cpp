@@ -0,0 +1,194 @@
+#include "util/RtSafetyChecker.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace daisy;
+
+namespace
+{
+/** A tiny deterministic random generator for the parameter runs */
+class TestRandom
+{
+  public:
+    uint32_t Next()
+    {
+        state_ = state_ * 1664525u + 1013904223u;
+        return state_ >> 8;
+    }
+    float NextFloat() { return float(Next() & 0xffff) / 65535.0f; }
+
+  private:
+    uint32_t state_ = 12345u;
+};
+
+/** A simple one pole filter, written like typical callback code */
+class TestFilter
+{
+  public:
+    void  SetCoefficient(float coeff) { coeff_ = coeff; }
+    float Process(float in)
+    {
+        state_ += coeff_ * (in - state_);
+        return state_;
+    }
+
+  private:
+    float coeff_ = 0.5f;
+    float state_ = 0.0f;
+};
+
+/** Runs `num_blocks` callbacks with randomized parameters. Each callback
+ *  advances the unit test clock by a random duration up to `max_block_us`.
+ *  Returns the longest duration.
+ */
+template <typename CallbackFn>
+uint32_t RunRandomized(int num_blocks, uint32_t max_block_us, CallbackFn cb)
+{
+    TestRandom rand;
+    uint32_t   longest = 0;
+    for(int block = 0; block < num_blocks; block++)
+    {
+        const float    param    = rand.NextFloat();
+        const uint32_t duration = rand.Next() % (max_block_us + 1);
+        if(duration > longest)
+            longest = duration;
+
+        RtSafetyChecker::ScopedAudioThread scope;
+        cb(param);
+        {
+            RtSafetyChecker::ScopedUnmonitored unmonitored;
+            System::SetUsForUnitTest(System::GetUs() + duration);
+        }
+    }
+    return longest;
+}
+} // namespace
+
+TEST(util_RtSafetyChecker, a_stateAfterReset)
+{
+    RtSafetyChecker::Reset();
+    EXPECT_FALSE(RtSafetyChecker::IsInAudioThread());
+    EXPECT_EQ(RtSafetyChecker::GetNumViolations(), 0u);
+    EXPECT_EQ(RtSafetyChecker::GetNumCallbacks(), 0u);
+    EXPECT_EQ(RtSafetyChecker::GetWorstCallbackTimeUs(), 0u);
+}
+
+TEST(util_RtSafetyChecker, b_detectsAllocation)
+{
+    RtSafetyChecker::Reset();
+    {
+        RtSafetyChecker::ScopedAudioThread scope;
+        EXPECT_TRUE(RtSafetyChecker::IsInAudioThread());
+        volatile int* value = new int(5);
+        delete value;
+    }
+    EXPECT_FALSE(RtSafetyChecker::IsInAudioThread());
+    EXPECT_EQ(RtSafetyChecker::GetNumViolations(
+                  RtSafetyChecker::Violation::ALLOCATION),
+              1u);
+    EXPECT_EQ(RtSafetyChecker::GetNumViolations(
+                  RtSafetyChecker::Violation::DEALLOCATION),
+              1u);
+    EXPECT_EQ(RtSafetyChecker::GetNumCallbacks(), 1u);
+}
+
+TEST(util_RtSafetyChecker, c_detectsMallocAndPrint)
+{
+    RtSafetyChecker::Reset();
+    {
+        RtSafetyChecker::ScopedAudioThread scope;
+        void* volatile ptr = malloc(16);
+        ptr                = realloc(ptr, 32);
+        free(ptr);
+        // not a literal, so the compiler can't remove the call
+        const char* volatile format = "%s";
+        printf(format, "");
+        puts("");
+    }
+    EXPECT_EQ(RtSafetyChecker::GetNumViolations(
+                  RtSafetyChecker::Violation::ALLOCATION),
+              2u);
+    EXPECT_EQ(RtSafetyChecker::GetNumViolations(
+                  RtSafetyChecker::Violation::DEALLOCATION),
+              1u);
+    EXPECT_EQ(
+        RtSafetyChecker::GetNumViolations(RtSafetyChecker::Violation::PRINT),
+        2u);
+    EXPECT_EQ(RtSafetyChecker::GetNumViolations(), 5u);
+}
+
+TEST(util_RtSafetyChecker, d_ignoresCallsOutsideOfCallback)
+{
+    RtSafetyChecker::Reset();
+    std::vector<float> buffer(256);
+    {
+        RtSafetyChecker::ScopedAudioThread scope;
+        // writing to preallocated memory is fine
+        for(auto& sample : buffer)
+            sample = 0.0f;
+        {
+            RtSafetyChecker::ScopedUnmonitored unmonitored;
+            EXPECT_FALSE(RtSafetyChecker::IsInAudioThread());
+            buffer.resize(1024);
+        }
+        EXPECT_TRUE(RtSafetyChecker::IsInAudioThread());
+    }
+    buffer.resize(4096);
+    EXPECT_EQ(RtSafetyChecker::GetNumViolations(), 0u);
+}
+
+TEST(util_RtSafetyChecker, e_violationCallback)
+{
+    RtSafetyChecker::Reset();
+    int numCalls = 0;
+    RtSafetyChecker::SetViolationCallback(
+        [](RtSafetyChecker::Violation violation, void* context) {
+            EXPECT_EQ(violation, RtSafetyChecker::Violation::ALLOCATION);
+            (*static_cast<int*>(context))++;
+        },
+        &numCalls);
+    {
+        RtSafetyChecker::ScopedAudioThread scope;
+        void* volatile ptr = malloc(4);
+        RtSafetyChecker::SetViolationCallback(nullptr);
+        free(ptr);
+    }
+    EXPECT_EQ(numCalls, 1);
+    EXPECT_EQ(RtSafetyChecker::GetNumViolations(), 2u);
+}
+
+TEST(util_RtSafetyChecker, f_randomizedRunWithoutViolations)
+{
+    RtSafetyChecker::Reset();
+    TestFilter         filter;
+    std::vector<float> block(48);
+    const auto         longest = RunRandomized(10000, 500, [&](float param) {
+        filter.SetCoefficient(param);
+        for(auto& sample : block)
+            sample = filter.Process(param - 0.5f);
+    });
+
+    EXPECT_EQ(RtSafetyChecker::GetNumViolations(), 0u);
+    EXPECT_EQ(RtSafetyChecker::GetNumCallbacks(), 10000u);
+    EXPECT_EQ(RtSafetyChecker::GetWorstCallbackTimeUs(), longest);
+}
+
+TEST(util_RtSafetyChecker, g_randomizedRunCatchesRareAllocation)
+{
+    RtSafetyChecker::Reset();
+    std::vector<float> history;
+    // only some parameter values take the path that grows the vector
+    RunRandomized(1000, 100, [&](float param) {
+        if(param > 0.99f)
+            history.push_back(param);
+    });
+
+    EXPECT_GT(RtSafetyChecker::GetNumViolations(
+                  RtSafetyChecker::Violation::ALLOCATION),
+              0u);
+    EXPECT_EQ(RtSafetyChecker::GetNumViolations(
+                  RtSafetyChecker::Violation::PRINT),
+              0u);
+}
@@ -0,0 +1,303 @@
+#include "util/SampleCatalog.h"
+#include <gtest/gtest.h>
+#include <string.h>
+
+using namespace daisy;
+
+namespace
+{
+using Entry = SampleCatalog::Entry;
+
+Entry MakeSample(const char* name, uint32_t frames, uint8_t channels)
+{
+    Entry e = {};
+    strncpy(e.name, name, SampleCatalog::kNameLength - 1);
+    e.kind         = SampleCatalog::Kind::SAMPLE;
+    e.format       = SampleCatalog::kFormatFloat;
+    e.num_channels = channels;
+    e.num_frames   = frames;
+    // whole blocks of 64 floats per channel
+    e.size = (frames + 63) / 64 * 64 * channels * sizeof(float);
+    e.sample_rate  = 48000;
+    e.root_note    = 60;
+    return e;
+}
+
+/** An image with three samples added out of order, and a wavetable */
+struct TestImage
+{
+    uint8_t buffer[8192];
+    size_t  size;
+
+    TestImage()
+    {
+        // not a multiple of the alignment, so the padding shows
+        static constexpr uint32_t frames = 13;
+
+        memset(buffer, 0xff, sizeof(buffer));
+        SampleCatalogWriter writer;
+        writer.Init(buffer, sizeof(buffer), 8);
+
+        const char* names[] = {"snare", "hat", "kick"};
+        for(uint32_t n = 0; n < 3; n++)
+        {
+            Entry e = MakeSample(names[n], frames, 2);
+            e.loop_start = 2;
+            e.loop_end   = 10;
+            float* data  = reinterpret_cast<float*>(writer.Add(e));
+            for(uint32_t c = 0; c < 2; c++)
+                for(uint32_t i = 0; i < frames; i++)
+                    data[c * 64 + i] = n * 100.0f + c * frames + i;
+        }
+
+        // 2 tables of 64 samples, with mips of 32 and 16
+        Entry wt        = MakeSample("wavetable", 128, 1);
+        wt.kind         = SampleCatalog::Kind::WAVETABLE;
+        wt.table_size   = 64;
+        wt.num_tables   = 2;
+        wt.num_mips     = 3;
+        wt.size         = 2 * (64 + 32 + 16) * sizeof(float);
+        float* data     = reinterpret_cast<float*>(writer.Add(wt));
+        for(size_t i = 0; i < 2 * (64 + 32 + 16); i++)
+            data[i] = static_cast<float>(i);
+
+        size = writer.Finish();
+    }
+};
+
+/** Rewrites the checksum of the entry table after a change */
+void FixTableChecksum(uint8_t* image)
+{
+    SampleCatalog::Header* header
+        = reinterpret_cast<SampleCatalog::Header*>(image);
+    header->checksum = SampleCatalog::Checksum(
+        image + sizeof(SampleCatalog::Header),
+        header->num_entries * sizeof(Entry));
+}
+} // namespace
+
+TEST(util_SampleCatalog, a_roundTrip)
+{
+    TestImage     image;
+    SampleCatalog catalog;
+    ASSERT_EQ(catalog.Init(image.buffer, image.size),
+              SampleCatalog::Result::OK);
+    ASSERT_EQ(catalog.GetNumEntries(), 4u);
+
+    // sorted by name
+    EXPECT_STREQ(catalog.GetEntry(0)->name, "hat");
+    EXPECT_STREQ(catalog.GetEntry(1)->name, "kick");
+    EXPECT_STREQ(catalog.GetEntry(2)->name, "snare");
+    EXPECT_STREQ(catalog.GetEntry(3)->name, "wavetable");
+    EXPECT_EQ(catalog.GetEntry(4), nullptr);
+
+    const Entry* kick = catalog.Find("kick");
+    ASSERT_NE(kick, nullptr);
+    EXPECT_EQ(kick->num_frames, 13u);
+    EXPECT_EQ(kick->loop_start, 2u);
+    EXPECT_EQ(kick->loop_end, 10u);
+    EXPECT_EQ(kick->root_note, 60);
+    EXPECT_EQ(catalog.Find("clap"), nullptr);
+    EXPECT_EQ(catalog.Find("zzz"), nullptr);
+    EXPECT_EQ(catalog.Find(""), nullptr);
+
+    // planar channels, the data of "kick" was written third
+    const float* left
+        = static_cast<const float*>(catalog.GetChannel(*kick, 0));
+    const float* right
+        = static_cast<const float*>(catalog.GetChannel(*kick, 1));
+    EXPECT_EQ(SampleCatalog::GetChannelBytes(*kick), 64 * sizeof(float));
+    EXPECT_EQ(left[0], 200.0f);
+    EXPECT_EQ(left[12], 212.0f);
+    EXPECT_EQ(right[0], 213.0f);
+    EXPECT_EQ(catalog.GetChannel(*kick, 2), nullptr);
+}
+
+TEST(util_SampleCatalog, b_zeroCopy)
+{
+    TestImage     image;
+    SampleCatalog catalog;
+    ASSERT_EQ(catalog.Init(image.buffer, image.size),
+              SampleCatalog::Result::OK);
+
+    for(size_t i = 0; i < catalog.GetNumEntries(); i++)
+    {
+        const Entry*   e = catalog.GetEntry(i);
+        const uint8_t* data
+            = static_cast<const uint8_t*>(catalog.GetData(*e));
+        // the data is read in place, aligned to a cache line
+        EXPECT_GE(data, image.buffer);
+        EXPECT_LE(data + e->size, image.buffer + image.size);
+        EXPECT_EQ(e->offset % SampleCatalog::kAlignment, 0u);
+        EXPECT_TRUE(catalog.Verify(*e));
+    }
+    EXPECT_EQ(image.size % SampleCatalog::kAlignment, 0u);
+
+    size_t sizes[4];
+    for(size_t i = 0; i < 4; i++)
+        sizes[i] = catalog.GetEntry(i)->size;
+    // the writer kept room for 8 entries in the table
+    EXPECT_EQ(SampleCatalogWriter::GetImageSize(4, sizes)
+                  + 4 * sizeof(Entry),
+              image.size);
+}
+
+TEST(util_SampleCatalog, c_verifyDetectsCorruptData)
+{
+    TestImage     image;
+    SampleCatalog catalog;
+    ASSERT_EQ(catalog.Init(image.buffer, image.size),
+              SampleCatalog::Result::OK);
+
+    const Entry* snare = catalog.Find("snare");
+    image.buffer[snare->offset + 5] ^= 0x10;
+    // the index is still valid, the data is not
+    EXPECT_EQ(catalog.Init(image.buffer, image.size),
+              SampleCatalog::Result::OK);
+    EXPECT_FALSE(catalog.Verify(*snare));
+    EXPECT_TRUE(catalog.Verify(*catalog.Find("kick")));
+}
+
+TEST(util_SampleCatalog, d_rejectsBadImages)
+{
+    SampleCatalog catalog;
+    {
+        TestImage image;
+        EXPECT_EQ(catalog.Init(image.buffer, 8),
+                  SampleCatalog::Result::ERR_TOO_SMALL);
+        EXPECT_EQ(catalog.Init(image.buffer, image.size - 1),
+                  SampleCatalog::Result::ERR_TOO_SMALL);
+        EXPECT_EQ(catalog.GetNumEntries(), 0u);
+    }
+    {
+        // erased flash
+        uint8_t erased[256];
+        memset(erased, 0xff, sizeof(erased));
+        EXPECT_EQ(catalog.Init(erased, sizeof(erased)),
+                  SampleCatalog::Result::ERR_NOT_CATALOG);
+    }
+    {
+        TestImage image;
+        reinterpret_cast<SampleCatalog::Header*>(image.buffer)
+            ->format_version
+            = SampleCatalog::kFormatVersion + 1;
+        EXPECT_EQ(catalog.Init(image.buffer, image.size),
+                  SampleCatalog::Result::ERR_VERSION);
+    }
+    {
+        TestImage image;
+        image.buffer[sizeof(SampleCatalog::Header) + 40] ^= 1;
+        EXPECT_EQ(catalog.Init(image.buffer, image.size),
+                  SampleCatalog::Result::ERR_CHECKSUM);
+    }
+    {
+        // a valid checksum doesn't make an entry pointing out of the image
+        TestImage image;
+        Entry*    e = reinterpret_cast<Entry*>(image.buffer
+                                            + sizeof(SampleCatalog::Header));
+        e[1].offset = static_cast<uint32_t>(image.size - 32);
+        FixTableChecksum(image.buffer);
+        EXPECT_EQ(catalog.Init(image.buffer, image.size),
+                  SampleCatalog::Result::ERR_CORRUPT);
+    }
+    {
+        // nor entries out of order
+        TestImage image;
+        Entry*    e = reinterpret_cast<Entry*>(image.buffer
+                                            + sizeof(SampleCatalog::Header));
+        e[0].name[0] = 'z';
+        FixTableChecksum(image.buffer);
+        EXPECT_EQ(catalog.Init(image.buffer, image.size),
+                  SampleCatalog::Result::ERR_CORRUPT);
+        EXPECT_EQ(catalog.Find("kick"), nullptr);
+    }
+}
+
+TEST(util_SampleCatalog, e_wavetableMips)
+{
+    TestImage     image;
+    SampleCatalog catalog;
+    ASSERT_EQ(catalog.Init(image.buffer, image.size),
+              SampleCatalog::Result::OK);
+    const Entry* wt = catalog.Find("wavetable");
+    ASSERT_NE(wt, nullptr);
+
+    EXPECT_EQ(SampleCatalog::GetMipSize(*wt, 0), 64u);
+    EXPECT_EQ(SampleCatalog::GetMipSize(*wt, 2), 16u);
+
+    // each table is followed by its mips
+    EXPECT_EQ(catalog.GetWaveTable(*wt, 0, 0)[0], 0.0f);
+    EXPECT_EQ(catalog.GetWaveTable(*wt, 0, 1)[0], 64.0f);
+    EXPECT_EQ(catalog.GetWaveTable(*wt, 0, 2)[0], 96.0f);
+    EXPECT_EQ(catalog.GetWaveTable(*wt, 1, 0)[0], 112.0f);
+    EXPECT_EQ(catalog.GetWaveTable(*wt, 1, 2)[15], 223.0f);
+    EXPECT_EQ(catalog.GetWaveTable(*wt, 2, 0), nullptr);
+    EXPECT_EQ(catalog.GetWaveTable(*wt, 0, 3), nullptr);
+    EXPECT_EQ(catalog.GetWaveTable(*catalog.Find("kick"), 0, 0), nullptr);
+
+    // one level per octave above the table rate, up to the smallest mip
+    EXPECT_EQ(SampleCatalog::GetMipLevel(*wt, 0.5f), 0u);
+    EXPECT_EQ(SampleCatalog::GetMipLevel(*wt, 1.0f), 0u);
+    EXPECT_EQ(SampleCatalog::GetMipLevel(*wt, 1.5f), 1u);
+    EXPECT_EQ(SampleCatalog::GetMipLevel(*wt, 3.0f), 2u);
+    EXPECT_EQ(SampleCatalog::GetMipLevel(*wt, 64.0f), 2u);
+}
+
+TEST(util_SampleCatalog, f_writerLimits)
+{
+    uint8_t             buffer[1024];
+    SampleCatalogWriter writer;
+
+    writer.Init(buffer, sizeof(buffer), 2);
+    EXPECT_NE(writer.Add(MakeSample("a", 4, 1)), nullptr);
+    EXPECT_NE(writer.Add(MakeSample("a", 4, 1)), nullptr);
+    EXPECT_EQ(writer.Add(MakeSample("b", 4, 1)), nullptr); // table full
+    EXPECT_EQ(writer.Finish(), 0u);                        // duplicate name
+
+    writer.Init(buffer, sizeof(buffer), 2);
+    EXPECT_EQ(writer.Add(MakeSample("big", 1024, 1)), nullptr);
+    EXPECT_NE(writer.Add(MakeSample("small", 4, 1)), nullptr);
+    EXPECT_GT(writer.Finish(), 0u);
+}
+
+TEST(util_SampleCatalog, g_rejectsBadSamples)
+{
+    SampleCatalog catalog;
+    auto          corrupt = [&](void (*change)(Entry& hat)) {
+        TestImage image;
+        Entry*    e = reinterpret_cast<Entry*>(image.buffer
+                                            + sizeof(SampleCatalog::Header));
+        change(e[0]);
+        FixTableChecksum(image.buffer);
+        return catalog.Init(image.buffer, image.size);
+    };
+
+    // more frames than the data holds
+    EXPECT_EQ(corrupt([](Entry& e) { e.num_frames = 65; }),
+              SampleCatalog::Result::ERR_CORRUPT);
+    EXPECT_EQ(corrupt([](Entry& e) { e.num_frames = 0xffffffff; }),
+              SampleCatalog::Result::ERR_CORRUPT);
+    // an unknown format
+    EXPECT_EQ(corrupt([](Entry& e) { e.format = 4; }),
+              SampleCatalog::Result::ERR_CORRUPT);
+    // a loop out of the sample, or backwards
+    EXPECT_EQ(corrupt([](Entry& e) { e.loop_end = 14; }),
+              SampleCatalog::Result::ERR_CORRUPT);
+    EXPECT_EQ(corrupt([](Entry& e) { e.loop_start = 11; }),
+              SampleCatalog::Result::ERR_CORRUPT);
+
+    // a smaller encoding fits in the same data, up to a block per 36 bytes
+    EXPECT_EQ(corrupt([](Entry& e) { e.format = 1; }),
+              SampleCatalog::Result::OK);
+    EXPECT_EQ(corrupt([](Entry& e) {
+                  e.format     = 1;
+                  e.num_frames = 7 * 64;
+                  e.loop_end   = 7 * 64;
+              }),
+              SampleCatalog::Result::OK);
+    EXPECT_EQ(corrupt([](Entry& e) {
+                  e.format     = 1;
+                  e.num_frames = 7 * 64 + 1;
+              }),
+              SampleCatalog::Result::ERR_CORRUPT);
+}
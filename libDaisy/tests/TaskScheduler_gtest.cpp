@@ -0,0 +1,291 @@
+#include "util/TaskScheduler.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace daisy;
+
+namespace
+{
+/** TIM2 of the Daisy Seed, that wraps every 2^32 / 200 MHz = 21.47 s */
+constexpr uint32_t kTicksPerUs = 200;
+
+void SetClockUs(uint32_t us)
+{
+    System::SetTickFreqForUnitTest(kTicksPerUs * 1000000);
+    System::SetTickForUnitTest(us * kTicksPerUs);
+}
+
+uint32_t GetClockUs()
+{
+    return System::GetTick() / kTicksPerUs;
+}
+
+void AdvanceClock(uint32_t us)
+{
+    System::SetTickForUnitTest(System::GetTick() + us * kTicksPerUs);
+}
+
+/** A task that takes `cost_us` of virtual time */
+struct Job
+{
+    uint32_t              cost_us = 0;
+    std::vector<uint32_t> starts;
+    std::vector<int>*     order = nullptr;
+    int                   id    = 0;
+
+    static void Run(void* context)
+    {
+        Job* job = static_cast<Job*>(context);
+        job->starts.push_back(GetClockUs());
+        if(job->order != nullptr)
+            job->order->push_back(job->id);
+        AdvanceClock(job->cost_us);
+    }
+};
+
+TaskScheduler::TaskConfig MakeTask(Job&     job,
+                                   uint32_t period,
+                                   uint8_t  priority,
+                                   uint32_t deadline = 0,
+                                   uint32_t budget   = 0)
+{
+    TaskScheduler::TaskConfig config;
+    config.function    = Job::Run;
+    config.context     = &job;
+    config.period_us   = period;
+    config.priority    = priority;
+    config.deadline_us = deadline;
+    config.budget_us   = budget;
+    return config;
+}
+} // namespace
+
+TEST(util_TaskScheduler, a_periodic_tasks)
+{
+    SetClockUs(0);
+    static TaskScheduler scheduler;
+    scheduler.Init();
+    Job fast, slow;
+    fast.cost_us = 10;
+    const int a  = scheduler.AddTask(MakeTask(fast, 1000, 1));
+    const int b  = scheduler.AddTask(MakeTask(slow, 2500, 0));
+    ASSERT_NE(a, TaskScheduler::kInvalidTask);
+    ASSERT_NE(b, TaskScheduler::kInvalidTask);
+
+    scheduler.Simulate(10000);
+    EXPECT_EQ(GetClockUs(), 10000u);
+    ASSERT_EQ(fast.starts.size(), 10u);
+    for(size_t i = 0; i < fast.starts.size(); i++)
+        EXPECT_EQ(fast.starts[i], 1000 * i);
+    // waits for the fast task at 0 and 5000
+    EXPECT_EQ(slow.starts, (std::vector<uint32_t>{10, 2500, 5010, 7500}));
+
+    const TaskScheduler::TaskStats& stats = scheduler.GetStats(a);
+    EXPECT_EQ(stats.runs, 10u);
+    EXPECT_EQ(stats.last_us, 10u);
+    EXPECT_EQ(stats.total_us, 100u);
+    EXPECT_EQ(stats.deadline_misses, 0u);
+    EXPECT_EQ(scheduler.GetStats(b).max_latency_us, 10u);
+
+    // nothing is due until the next release
+    EXPECT_EQ(scheduler.GetTimeToNextUs(), 0u);
+    SetClockUs(10020);
+    scheduler.Process();
+    EXPECT_EQ(scheduler.GetTimeToNextUs(), 1000u - 30u);
+}
+
+TEST(util_TaskScheduler, b_priorities_and_deadlines)
+{
+    SetClockUs(500);
+    static TaskScheduler scheduler;
+    scheduler.Init();
+    std::vector<int> order;
+    Job              jobs[4];
+    for(int i = 0; i < 4; i++)
+    {
+        jobs[i].order = &order;
+        jobs[i].id    = i;
+    }
+    // the highest priority first, then the earliest deadline
+    scheduler.AddTask(MakeTask(jobs[0], 1000, 0, 900));
+    scheduler.AddTask(MakeTask(jobs[1], 1000, 1, 800));
+    scheduler.AddTask(MakeTask(jobs[2], 1000, 1, 300));
+    scheduler.AddTask(MakeTask(jobs[3], 0, 2));
+    EXPECT_EQ(scheduler.Process(), 4u);
+    EXPECT_EQ(order, (std::vector<int>{3, 2, 1, 0}));
+
+    // one-shot tasks run once, until they're scheduled again
+    order.clear();
+    SetClockUs(1500);
+    scheduler.Process();
+    EXPECT_EQ(order, (std::vector<int>{2, 1, 0}));
+    scheduler.Schedule(3, 200);
+    SetClockUs(1600);
+    EXPECT_EQ(scheduler.Process(), 0u);
+    SetClockUs(1700);
+    EXPECT_EQ(scheduler.Process(), 1u);
+    EXPECT_EQ(jobs[3].starts.back(), 1700u);
+
+    // cancelled and removed tasks don't run, and free slots are reused
+    scheduler.Cancel(0);
+    scheduler.RemoveTask(1);
+    order.clear();
+    SetClockUs(2500);
+    scheduler.Process();
+    EXPECT_EQ(order, (std::vector<int>{2}));
+    EXPECT_EQ(scheduler.AddTask(MakeTask(jobs[1], 0, 0)), 1);
+    scheduler.Schedule(0, 0);
+    order.clear();
+    scheduler.Process();
+    EXPECT_EQ(order, (std::vector<int>{0, 1}));
+
+    TaskScheduler::TaskConfig invalid;
+    EXPECT_EQ(scheduler.AddTask(invalid), TaskScheduler::kInvalidTask);
+    for(size_t i = 4; i < TaskScheduler::kMaxTasks; i++)
+        EXPECT_NE(scheduler.AddTask(MakeTask(jobs[0], 0, 0)),
+                  TaskScheduler::kInvalidTask);
+    EXPECT_EQ(scheduler.AddTask(MakeTask(jobs[0], 0, 0)),
+              TaskScheduler::kInvalidTask);
+}
+
+TEST(util_TaskScheduler, c_background_work_waits_for_the_ui)
+{
+    // the UI every ms, done within 300 us, and a background job that
+    // always has 600 us of work
+    auto run = [](uint32_t background_budget, TaskScheduler::TaskStats& ui,
+                  TaskScheduler::TaskStats& background) {
+        SetClockUs(0);
+        static TaskScheduler scheduler;
+        scheduler.Init();
+        Job ui_job, io_job;
+        ui_job.cost_us = 100;
+        io_job.cost_us = 600;
+        const int a
+            = scheduler.AddTask(MakeTask(ui_job, 1000, 2, 300, 100));
+        const int b
+            = scheduler.AddTask(MakeTask(io_job, 1, 0, 0, background_budget));
+        scheduler.Simulate(100000);
+        ui         = scheduler.GetStats(a);
+        background = scheduler.GetStats(b);
+    };
+
+    TaskScheduler::TaskStats ui, background;
+    run(0, ui, background);
+    EXPECT_GT(ui.deadline_misses, 10u);
+    EXPECT_GE(ui.max_latency_us, 300u);
+
+    run(600, ui, background);
+    EXPECT_EQ(ui.runs, 100u);
+    EXPECT_EQ(ui.deadline_misses, 0u);
+    EXPECT_EQ(ui.max_latency_us, 0u);
+    EXPECT_EQ(ui.skipped, 0u);
+    // one piece of background work per ms still fits
+    EXPECT_GE(background.runs, 99u);
+    EXPECT_GT(background.deferrals, 0u);
+    EXPECT_EQ(background.budget_overruns, 0u);
+}
+
+namespace
+{
+/** Writes 50 us pieces for as long as the scheduler allows */
+struct Writer
+{
+    TaskScheduler* scheduler;
+    uint32_t       pieces = 0;
+
+    static void Run(void* context)
+    {
+        Writer* writer = static_cast<Writer*>(context);
+        do
+        {
+            AdvanceClock(50);
+            writer->pieces++;
+        } while(writer->scheduler->GetTimeLeftUs() >= 50);
+    }
+};
+} // namespace
+
+TEST(util_TaskScheduler, d_time_left_for_pieces_of_work)
+{
+    SetClockUs(0);
+    static TaskScheduler scheduler;
+    scheduler.Init();
+    EXPECT_EQ(scheduler.GetTimeLeftUs(), UINT32_MAX);
+
+    Job refill;
+    refill.cost_us = 200;
+    Writer writer;
+    writer.scheduler = &scheduler;
+    // refills every 2 ms, at most 500 us late
+    const int a = scheduler.AddTask(MakeTask(refill, 2000, 1, 700, 200));
+    TaskScheduler::TaskConfig config;
+    config.function  = Writer::Run;
+    config.context   = &writer;
+    config.period_us = 1;
+    const int b      = scheduler.AddTask(config);
+
+    scheduler.Simulate(200000);
+    EXPECT_EQ(scheduler.GetStats(a).runs, 100u);
+    EXPECT_EQ(scheduler.GetStats(a).deadline_misses, 0u);
+    EXPECT_LE(scheduler.GetStats(a).max_latency_us, 500u);
+    // the writer gets most of the rest
+    EXPECT_GT(writer.pieces * 50, 200000u * 8 / 10);
+    EXPECT_EQ(scheduler.GetRunningTask(), TaskScheduler::kInvalidTask);
+    EXPECT_GT(scheduler.GetStats(b).max_us, 1000u);
+}
+
+TEST(util_TaskScheduler, e_overruns_and_skipped_periods)
+{
+    // the ticks wrap 2 ms in
+    System::SetTickFreqForUnitTest(kTicksPerUs * 1000000);
+    System::SetTickForUnitTest(0u - 2000 * kTicksPerUs);
+    static TaskScheduler scheduler;
+    scheduler.Init();
+    Job tick, stall;
+    tick.cost_us  = 5;
+    stall.cost_us = 3200;
+    const int a   = scheduler.AddTask(MakeTask(tick, 1000, 0, 0, 10));
+    TaskScheduler::TaskConfig config = MakeTask(stall, 0, 1, 0, 1000);
+    config.delay_us                  = 2500;
+    config.name                      = "stall";
+    const int b                      = scheduler.AddTask(config);
+    EXPECT_STREQ(scheduler.GetName(b), "stall");
+
+    // across the wrap of the clock
+    scheduler.Simulate(10000);
+    const TaskScheduler::TaskStats& ticks = scheduler.GetStats(a);
+    // the releases at 3000 and 4000 are dropped, 5000 runs late
+    EXPECT_EQ(ticks.skipped, 2u);
+    EXPECT_EQ(ticks.runs, 8u);
+    EXPECT_EQ(ticks.deadline_misses, 0u);
+    EXPECT_EQ(ticks.max_latency_us, 700u);
+    EXPECT_EQ(ticks.budget_overruns, 0u);
+    EXPECT_EQ(scheduler.GetStats(b).runs, 1u);
+    EXPECT_EQ(scheduler.GetStats(b).budget_overruns, 1u);
+    EXPECT_EQ(scheduler.GetStats(b).max_us, 3200u);
+
+    scheduler.ResetStats();
+    EXPECT_EQ(scheduler.GetStats(a).runs, 0u);
+}
+
+TEST(util_TaskScheduler, f_runs_past_the_wrap_of_the_timer)
+{
+    // the buttons of the oscillator, for a minute
+    SetClockUs(0);
+    static TaskScheduler scheduler;
+    scheduler.Init();
+    Job buttons;
+    buttons.cost_us = 20;
+    const int a = scheduler.AddTask(MakeTask(buttons, 10000, 2, 2000, 50));
+
+    scheduler.Simulate(60000000);
+    const TaskScheduler::TaskStats& stats = scheduler.GetStats(a);
+    EXPECT_EQ(stats.runs, 6000u);
+    EXPECT_EQ(stats.skipped, 0u);
+    EXPECT_EQ(stats.deadline_misses, 0u);
+    EXPECT_EQ(stats.max_latency_us, 0u);
+    // the ticks wrapped twice
+    EXPECT_EQ(System::GetTick(), uint32_t(60000000ull * kTicksPerUs));
+    EXPECT_EQ(buttons.starts.back(), GetClockUs() - 10000);
+    EXPECT_EQ(scheduler.GetTimeToNextUs(), 0u);
+}
@@ -0,0 +1,311 @@
+#include "util/WavIndex.h"
+#include "FatFsImage.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace daisy;
+
+namespace
+{
+void Put16(std::vector<uint8_t>& v, uint32_t x)
+{
+    v.push_back(x & 0xff);
+    v.push_back((x >> 8) & 0xff);
+}
+
+void Put32(std::vector<uint8_t>& v, uint32_t x)
+{
+    Put16(v, x & 0xffff);
+    Put16(v, x >> 16);
+}
+
+void PutId(std::vector<uint8_t>& v, const char* id)
+{
+    v.insert(v.end(), id, id + 4);
+}
+
+/** A 16 bit WAV file, with a smpl chunk when loop_end isn't 0 */
+std::vector<uint8_t> MakeWav(uint16_t channels,
+                             uint32_t rate,
+                             uint32_t frames,
+                             uint32_t loop_start = 0,
+                             uint32_t loop_end   = 0)
+{
+    std::vector<uint8_t> body;
+    PutId(body, "WAVE");
+    PutId(body, "fmt ");
+    Put32(body, 16);
+    Put16(body, 1);
+    Put16(body, channels);
+    Put32(body, rate);
+    Put32(body, rate * channels * 2);
+    Put16(body, channels * 2);
+    Put16(body, 16);
+    if(loop_end != 0)
+    {
+        PutId(body, "smpl");
+        Put32(body, 36 + 24);
+        for(uint32_t i = 0; i < 9; i++)
+            Put32(body, i == 3 ? 48 : (i == 7 ? 1 : 0)); // note, loops
+        Put32(body, 0);                                  // loop id
+        Put32(body, 0);                                  // forward
+        Put32(body, loop_start);
+        Put32(body, loop_end - 1); // the last frame of the loop
+        Put32(body, 0);
+        Put32(body, 0);
+    }
+    PutId(body, "data");
+    Put32(body, frames * channels * 2);
+    body.resize(body.size() + frames * channels * 2, 0);
+
+    std::vector<uint8_t> file;
+    PutId(file, "RIFF");
+    Put32(file, body.size());
+    file.insert(file.end(), body.begin(), body.end());
+    return file;
+}
+
+bool Write(FatFsImage&                 image,
+           const std::string&          path,
+           const std::vector<uint8_t>& data)
+{
+    return image.WriteFile(path.c_str(), data.data(), data.size());
+}
+
+/** A directory of a few files, not in order, and some that don't count */
+void MakeSamples(FatFsImage& image)
+{
+    ASSERT_EQ(f_mkdir("0:/samples"), FR_OK);
+    ASSERT_TRUE(
+        Write(image, "0:/samples/snare.wav", MakeWav(1, 44100, 100)));
+    ASSERT_TRUE(
+        Write(image, "0:/samples/Pad.WAV", MakeWav(2, 48000, 300, 10, 200)));
+    ASSERT_TRUE(Write(image, "0:/samples/kick.wav", MakeWav(1, 44100, 50)));
+    ASSERT_TRUE(Write(image, "0:/samples/notes.txt", MakeWav(1, 44100, 1)));
+    ASSERT_TRUE(Write(image, "0:/samples/broken.wav", {'R', 'I', 'F', 'F'}));
+    ASSERT_EQ(f_mkdir("0:/samples/folder.wav"), FR_OK);
+    const std::string long_name(WavIndex::kNameLength, 'x');
+    ASSERT_TRUE(Write(
+        image, "0:/samples/" + long_name + ".wav", MakeWav(1, 44100, 1)));
+}
+} // namespace
+
+TEST(util_WavIndex, a_buildsSortedIndex)
+{
+    FatFsImage image;
+    ASSERT_TRUE(image.Init());
+    MakeSamples(image);
+
+    WavIndex         index;
+    WavIndex::Record records[16];
+    EXPECT_EQ(index.Init("0:/samples", records, 16), WavIndex::Result::OK);
+    EXPECT_TRUE(index.WasRebuilt());
+    ASSERT_EQ(index.GetNumFiles(), 4u);
+    EXPECT_EQ(index.GetNumSkipped(), 1u); // the long name
+
+    EXPECT_STREQ(index.GetRecord(0)->name, "Pad.WAV");
+    EXPECT_STREQ(index.GetRecord(1)->name, "broken.wav");
+    EXPECT_STREQ(index.GetRecord(2)->name, "kick.wav");
+    EXPECT_STREQ(index.GetRecord(3)->name, "snare.wav");
+    EXPECT_EQ(index.GetRecord(4), nullptr);
+    EXPECT_EQ(index.Find("kick.wav"), 2);
+    EXPECT_EQ(index.Find("notes.txt"), -1);
+    EXPECT_EQ(index.Find("zzz.wav"), -1);
+
+    // no header was read yet
+    for(size_t i = 0; i < index.GetNumFiles(); i++)
+        EXPECT_EQ(index.GetRecord(i)->state, WavIndex::HeaderState::PENDING);
+    EXPECT_EQ(index.GetRecord(2)->file_size, 44u + 100u);
+
+    char path[64];
+    EXPECT_TRUE(index.GetPath(2, path, sizeof(path)));
+    EXPECT_STREQ(path, "0:/samples/kick.wav");
+    EXPECT_FALSE(index.GetPath(2, path, 8));
+    EXPECT_FALSE(index.GetPath(4, path, sizeof(path)));
+
+    EXPECT_EQ(index.LoadHeader(0), WavIndex::Result::OK);
+    const WavIndex::Record* pad = index.GetRecord(0);
+    EXPECT_EQ(pad->state, WavIndex::HeaderState::VALID);
+    EXPECT_EQ(pad->sample_rate, 48000u);
+    EXPECT_EQ(pad->num_channels, 2u);
+    EXPECT_EQ(pad->num_frames, 300u);
+    EXPECT_EQ(pad->bits_per_sample, 16u);
+    EXPECT_EQ(pad->root_note, 48u);
+    EXPECT_EQ(pad->loop_start, 10u);
+    EXPECT_EQ(pad->loop_end, 200u);
+
+    EXPECT_EQ(index.LoadHeader(1), WavIndex::Result::ERR_NOT_WAV);
+    EXPECT_EQ(index.GetRecord(1)->state, WavIndex::HeaderState::INVALID);
+    EXPECT_EQ(index.LoadHeader(4), WavIndex::Result::ERR_INVALID_INDEX);
+    EXPECT_EQ(index.Save(), WavIndex::Result::OK);
+
+    // the index file itself isn't a WAV file
+    FILINFO fno;
+    EXPECT_EQ(f_stat("0:/samples/wavindex.dat", &fno), FR_OK);
+    EXPECT_EQ(fno.fsize, 32u + 4 * sizeof(WavIndex::Record));
+
+    EXPECT_EQ(index.Init("0:/missing", records, 16),
+              WavIndex::Result::ERR_NO_DIR);
+    EXPECT_EQ(index.GetNumFiles(), 0u);
+}
+
+TEST(util_WavIndex, b_reusesIndexWhenUnchanged)
+{
+    FatFsImage image;
+    ASSERT_TRUE(image.Init());
+    MakeSamples(image);
+
+    WavIndex         index;
+    WavIndex::Record records[16];
+    index.Init("0:/samples", records, 16);
+    for(size_t i = 0; i < index.GetNumFiles(); i++)
+        index.LoadHeader(i);
+    index.Save();
+    const size_t first_boot = FatFsImage::TakeSectorsRead();
+
+    memset(records, 0, sizeof(records));
+    WavIndex again;
+    EXPECT_EQ(again.Init("0:/samples", records, 16), WavIndex::Result::OK);
+    EXPECT_FALSE(again.WasRebuilt());
+    ASSERT_EQ(again.GetNumFiles(), 4u);
+    EXPECT_EQ(again.GetRecord(0)->state, WavIndex::HeaderState::VALID);
+    EXPECT_EQ(again.GetRecord(0)->loop_end, 200u);
+    EXPECT_EQ(again.GetRecord(1)->state, WavIndex::HeaderState::INVALID);
+    EXPECT_EQ(again.GetRecord(3)->sample_rate, 44100u);
+    EXPECT_LT(FatFsImage::TakeSectorsRead(), first_boot);
+
+    // nothing changed, so nothing is written
+    EXPECT_EQ(again.LoadHeader(0), WavIndex::Result::OK);
+    EXPECT_EQ(again.Save(), WavIndex::Result::OK);
+}
+
+TEST(util_WavIndex, c_updatesChangedFiles)
+{
+    FatFsImage image;
+    ASSERT_TRUE(image.Init());
+    MakeSamples(image);
+
+    WavIndex::Record records[16];
+    {
+        WavIndex index;
+        index.Init("0:/samples", records, 16);
+        for(size_t i = 0; i < index.GetNumFiles(); i++)
+            index.LoadHeader(i);
+        index.Save();
+    }
+
+    // same size, new time stamp
+    FatFsImage::SetTime((41u << 25) | (2u << 21) | (3u << 16));
+    ASSERT_TRUE(Write(image, "0:/samples/kick.wav", MakeWav(2, 22050, 25)));
+    ASSERT_TRUE(Write(image, "0:/samples/clap.wav", MakeWav(1, 44100, 10)));
+    ASSERT_EQ(f_unlink("0:/samples/snare.wav"), FR_OK);
+
+    WavIndex index;
+    EXPECT_EQ(index.Init("0:/samples", records, 16), WavIndex::Result::OK);
+    EXPECT_TRUE(index.WasRebuilt());
+    ASSERT_EQ(index.GetNumFiles(), 4u);
+    EXPECT_EQ(index.Find("snare.wav"), -1);
+
+    // unchanged files keep their headers, the others are read on demand
+    const int pad = index.Find("Pad.WAV"), kick = index.Find("kick.wav");
+    const int clap = index.Find("clap.wav");
+    ASSERT_GE(pad, 0);
+    ASSERT_GE(kick, 0);
+    ASSERT_GE(clap, 0);
+    EXPECT_EQ(index.GetRecord(pad)->state, WavIndex::HeaderState::VALID);
+    EXPECT_EQ(index.GetRecord(kick)->state, WavIndex::HeaderState::PENDING);
+    EXPECT_EQ(index.GetRecord(clap)->state, WavIndex::HeaderState::PENDING);
+    EXPECT_EQ(index.LoadHeader(kick), WavIndex::Result::OK);
+    EXPECT_EQ(index.GetRecord(kick)->sample_rate, 22050u);
+    EXPECT_EQ(index.GetRecord(kick)->num_channels, 2u);
+    index.Save();
+
+    WavIndex again;
+    again.Init("0:/samples", records, 16);
+    EXPECT_FALSE(again.WasRebuilt());
+    EXPECT_EQ(again.GetRecord(kick)->sample_rate, 22050u);
+    EXPECT_EQ(again.GetRecord(clap)->state, WavIndex::HeaderState::PENDING);
+}
+
+TEST(util_WavIndex, d_ignoresDamagedIndex)
+{
+    FatFsImage image;
+    ASSERT_TRUE(image.Init());
+    MakeSamples(image);
+
+    WavIndex::Record records[16];
+    {
+        WavIndex index;
+        index.Init("0:/samples", records, 16);
+        index.LoadHeader(0);
+        index.Save();
+    }
+
+    // flip a bit of the first record
+    FIL  fil;
+    UINT bytes;
+    char c;
+    ASSERT_EQ(f_open(&fil, "0:/samples/wavindex.dat", FA_READ | FA_WRITE),
+              FR_OK);
+    f_lseek(&fil, 32 + 80);
+    f_read(&fil, &c, 1, &bytes);
+    c ^= 1;
+    f_lseek(&fil, 32 + 80);
+    f_write(&fil, &c, 1, &bytes);
+    f_close(&fil);
+
+    WavIndex index;
+    EXPECT_EQ(index.Init("0:/samples", records, 16), WavIndex::Result::OK);
+    EXPECT_TRUE(index.WasRebuilt());
+    EXPECT_EQ(index.GetRecord(0)->state, WavIndex::HeaderState::PENDING);
+    EXPECT_EQ(index.LoadHeader(0), WavIndex::Result::OK);
+    EXPECT_EQ(index.GetRecord(0)->sample_rate, 48000u);
+}
+
+TEST(util_WavIndex, e_thousandsOfFiles)
+{
+    FatFsImage image;
+    ASSERT_TRUE(image.Init());
+    ASSERT_EQ(f_mkdir("0:/many"), FR_OK);
+
+    // written in reverse order
+    const std::vector<uint8_t> wav = MakeWav(1, 44100, 4);
+    for(int i = 2499; i >= 0; i--)
+    {
+        char path[32];
+        snprintf(path, sizeof(path), "0:/many/tone%04d.wav", i);
+        ASSERT_TRUE(image.WriteFile(path, wav.data(), wav.size()));
+    }
+
+    std::vector<WavIndex::Record> records(2000);
+    WavIndex                      index;
+    EXPECT_EQ(index.Init("0:/many", records.data(), records.size()),
+              WavIndex::Result::OK);
+    EXPECT_EQ(index.GetNumFiles(), 2000u);
+    EXPECT_EQ(index.GetNumSkipped(), 500u);
+    for(size_t i = 1; i < index.GetNumFiles(); i++)
+        EXPECT_LT(strcmp(index.GetRecord(i - 1)->name,
+                         index.GetRecord(i)->name),
+                  0);
+
+    // every file of the index is found
+    size_t found = 0;
+    for(int i = 0; i < 2500; i++)
+    {
+        char name[16];
+        snprintf(name, sizeof(name), "tone%04d.wav", i);
+        const int idx = index.Find(name);
+        if(idx >= 0)
+        {
+            EXPECT_STREQ(index.GetRecord(idx)->name, name);
+            found++;
+        }
+    }
+    EXPECT_EQ(found, 2000u);
+
+    WavIndex again;
+    again.Init("0:/many", records.data(), records.size());
+    EXPECT_FALSE(again.WasRebuilt());
+}
@@ -0,0 +1,456 @@
+#include "util/WavReader.h"
+#include "daisy_core.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace daisy;
+
+namespace
+{
+/** A file in memory, for the reader callbacks */
+struct MemoryFile
+{
+    std::vector<uint8_t> data;
+    size_t               pos   = 0;
+    size_t               reads = 0;
+
+    static size_t Read(void* context, void* dst, size_t size)
+    {
+        MemoryFile* file = static_cast<MemoryFile*>(context);
+        size_t      left = file->data.size() - file->pos;
+        size            = size < left ? size : left;
+        memcpy(dst, file->data.data() + file->pos, size);
+        file->pos += size;
+        file->reads++;
+        return size;
+    }
+
+    static bool Seek(void* context, uint32_t position)
+    {
+        MemoryFile* file = static_cast<MemoryFile*>(context);
+        if(position > file->data.size())
+            return false;
+        file->pos = position;
+        return true;
+    }
+};
+
+void Put16(std::vector<uint8_t>& v, uint32_t x)
+{
+    v.push_back(x & 0xff);
+    v.push_back((x >> 8) & 0xff);
+}
+
+void Put32(std::vector<uint8_t>& v, uint32_t x)
+{
+    Put16(v, x & 0xffff);
+    Put16(v, x >> 16);
+}
+
+void PutId(std::vector<uint8_t>& v, const char* id)
+{
+    v.insert(v.end(), id, id + 4);
+}
+
+/** Builds the WAV variants of the test corpus chunk by chunk */
+struct WavBuilder
+{
+    std::vector<uint8_t> chunks;
+
+    WavBuilder& Chunk(const char* id, const std::vector<uint8_t>& body)
+    {
+        PutId(chunks, id);
+        Put32(chunks, body.size());
+        chunks.insert(chunks.end(), body.begin(), body.end());
+        if(body.size() & 1)
+            chunks.push_back(0);
+        return *this;
+    }
+
+    WavBuilder& Format(uint16_t code, uint16_t channels, uint16_t bits)
+    {
+        std::vector<uint8_t> fmt;
+        Put16(fmt, code);
+        Put16(fmt, channels);
+        Put32(fmt, 44100);
+        Put32(fmt, 44100 * channels * bits / 8);
+        Put16(fmt, channels * bits / 8);
+        Put16(fmt, bits);
+        return Chunk("fmt ", fmt);
+    }
+
+    WavBuilder&
+    Extensible(uint16_t sub_format, uint16_t channels, uint16_t bits)
+    {
+        std::vector<uint8_t> fmt;
+        Put16(fmt, WAVE_FORMAT_EXTENSIBLE);
+        Put16(fmt, channels);
+        Put32(fmt, 96000);
+        Put32(fmt, 96000 * channels * bits / 8);
+        Put16(fmt, channels * bits / 8);
+        Put16(fmt, bits);
+        Put16(fmt, 22);   // extension size
+        Put16(fmt, bits); // valid bits
+        Put32(fmt, 0);    // channel mask
+        Put16(fmt, sub_format);
+        // the rest of the KSDATAFORMAT_SUBTYPE GUID
+        const uint8_t guid_tail[14] = {0x00, 0x00, 0x00, 0x00, 0x10,
+                                       0x00, 0x80, 0x00, 0x00, 0xAA,
+                                       0x00, 0x38, 0x9B, 0x71};
+        fmt.insert(fmt.end(), guid_tail, guid_tail + 14);
+        return Chunk("fmt ", fmt);
+    }
+
+    /** A smpl chunk with one loop per pair of points */
+    WavBuilder& Sampler(uint32_t note, const std::vector<uint32_t>& points)
+    {
+        std::vector<uint8_t> smpl;
+        for(int i = 0; i < 3; i++)
+            Put32(smpl, 0);
+        Put32(smpl, note);
+        for(int i = 0; i < 3; i++)
+            Put32(smpl, 0);
+        Put32(smpl, points.size() / 2);
+        Put32(smpl, 0);
+        for(size_t i = 0; i + 1 < points.size(); i += 2)
+        {
+            Put32(smpl, i / 2);         // cue point id
+            Put32(smpl, 0);             // forward
+            Put32(smpl, points[i]);     // start
+            Put32(smpl, points[i + 1]); // last frame of the loop
+            Put32(smpl, 0);
+            Put32(smpl, 0);
+        }
+        return Chunk("smpl", smpl);
+    }
+
+    WavBuilder& Cues(const std::vector<uint32_t>& frames)
+    {
+        std::vector<uint8_t> cue;
+        Put32(cue, frames.size());
+        for(size_t i = 0; i < frames.size(); i++)
+        {
+            Put32(cue, i);
+            Put32(cue, frames[i]);
+            PutId(cue, "data");
+            Put32(cue, 0);
+            Put32(cue, 0);
+            Put32(cue, frames[i]);
+        }
+        return Chunk("cue ", cue);
+    }
+
+    MemoryFile Finish(uint32_t riff_size_override = 0) const
+    {
+        MemoryFile file;
+        PutId(file.data, "RIFF");
+        Put32(file.data,
+              riff_size_override ? riff_size_override : chunks.size() + 4);
+        PutId(file.data, "WAVE");
+        file.data.insert(file.data.end(), chunks.begin(), chunks.end());
+        return file;
+    }
+};
+
+/** Raw samples of a format, and the floats they convert to */
+struct Samples
+{
+    std::vector<uint8_t> raw;
+    std::vector<float>   expected;
+};
+
+Samples MakeSamples(WavReader::SampleFormat format, size_t count)
+{
+    Samples  s;
+    uint32_t seed = 12345;
+    for(size_t i = 0; i < count; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        switch(format)
+        {
+            case WavReader::SampleFormat::U8:
+                s.raw.push_back(seed >> 24);
+                s.expected.push_back((int32_t(seed >> 24) - 128) / 128.0f);
+                break;
+            case WavReader::SampleFormat::S16:
+                Put16(s.raw, seed >> 16);
+                s.expected.push_back(int16_t(seed >> 16) / 32768.0f);
+                break;
+            case WavReader::SampleFormat::S24:
+            {
+                const int32_t v = int32_t(seed) >> 8;
+                s.raw.push_back(v & 0xff);
+                s.raw.push_back((v >> 8) & 0xff);
+                s.raw.push_back((v >> 16) & 0xff);
+                s.expected.push_back(v / 8388608.0f);
+            }
+            break;
+            case WavReader::SampleFormat::S32:
+                Put32(s.raw, seed);
+                s.expected.push_back(float(int32_t(seed)) * S322F_SCALE);
+                break;
+            case WavReader::SampleFormat::F32:
+            {
+                const float f = int32_t(seed) / 2147483648.0f;
+                uint32_t    bits;
+                memcpy(&bits, &f, 4);
+                Put32(s.raw, bits);
+                s.expected.push_back(f);
+            }
+            break;
+        }
+    }
+    return s;
+}
+
+struct FormatCase
+{
+    WavReader::SampleFormat format;
+    uint16_t                code;
+    uint16_t                bits;
+};
+
+const FormatCase kFormats[] = {
+    {WavReader::SampleFormat::U8, WAVE_FORMAT_PCM, 8},
+    {WavReader::SampleFormat::S16, WAVE_FORMAT_PCM, 16},
+    {WavReader::SampleFormat::S24, WAVE_FORMAT_PCM, 24},
+    {WavReader::SampleFormat::S32, WAVE_FORMAT_PCM, 32},
+    {WavReader::SampleFormat::F32, WAVE_FORMAT_IEEE_FLOAT, 32},
+};
+
+WavReader::Result Open(WavReader& reader, MemoryFile& file)
+{
+    return reader.Open(&file, MemoryFile::Read, MemoryFile::Seek);
+}
+
+/** Reads all frames, num_frames at a time */
+std::vector<float>
+ReadAll(WavReader& reader, size_t num_frames, size_t* num_reads = nullptr)
+{
+    const size_t       channels = reader.GetFormat().num_channels;
+    std::vector<float> out, block(num_frames * channels);
+    size_t             reads = 0;
+    while(size_t n = reader.Read(block.data(), num_frames))
+    {
+        out.insert(out.end(), block.begin(), block.begin() + n * channels);
+        reads++;
+    }
+    if(num_reads)
+        *num_reads = reads;
+    return out;
+}
+} // namespace
+
+TEST(util_WavReader, a_allFormatsAndChannels)
+{
+    for(const FormatCase& fc : kFormats)
+    {
+        for(uint16_t channels : {1, 2, 3, 6})
+        {
+            const size_t  frames  = 1001;
+            const Samples samples = MakeSamples(fc.format, frames * channels);
+            MemoryFile    file    = WavBuilder()
+                                  .Format(fc.code, channels, fc.bits)
+                                  .Chunk("data", samples.raw)
+                                  .Finish();
+
+            WavReader reader;
+            ASSERT_EQ(Open(reader, file), WavReader::Result::OK);
+            const WavReader::Format& fmt = reader.GetFormat();
+            EXPECT_EQ(fmt.sample_format, fc.format);
+            EXPECT_EQ(fmt.num_channels, channels);
+            EXPECT_EQ(fmt.sample_rate, 44100u);
+            EXPECT_EQ(fmt.num_frames, frames);
+            EXPECT_EQ(fmt.data_offset, 44u);
+
+            // in odd sized pieces, and all at once
+            for(size_t piece : {size_t(37), size_t(64), frames})
+            {
+                ASSERT_TRUE(reader.Rewind());
+                const std::vector<float> out = ReadAll(reader, piece);
+                ASSERT_EQ(out.size(), samples.expected.size());
+                for(size_t i = 0; i < out.size(); i++)
+                    ASSERT_EQ(out[i], samples.expected[i])
+                        << fc.bits << " bits, " << channels << " channels, "
+                        << piece << " frames per read, sample " << i;
+                EXPECT_TRUE(reader.IsEof());
+            }
+        }
+    }
+}
+
+TEST(util_WavReader, b_oneFileReadPerRequest)
+{
+    const Samples samples
+        = MakeSamples(WavReader::SampleFormat::S16, 2 * 4096);
+    MemoryFile file = WavBuilder()
+                          .Format(WAVE_FORMAT_PCM, 2, 16)
+                          .Chunk("data", samples.raw)
+                          .Finish();
+    WavReader  reader;
+    ASSERT_EQ(Open(reader, file), WavReader::Result::OK);
+
+    file.reads = 0;
+    size_t num_reads;
+    ReadAll(reader, 1024, &num_reads);
+    EXPECT_EQ(num_reads, 4u);
+    // the end is known from the size of the data, it takes no read
+    EXPECT_EQ(file.reads, 4u);
+}
+
+TEST(util_WavReader, c_extensibleFormat)
+{
+    for(const FormatCase& fc : kFormats)
+    {
+        const Samples samples = MakeSamples(fc.format, 2 * 100);
+        MemoryFile    file    = WavBuilder()
+                              .Extensible(fc.code, 2, fc.bits)
+                              .Chunk("data", samples.raw)
+                              .Finish();
+        WavReader reader;
+        ASSERT_EQ(Open(reader, file), WavReader::Result::OK);
+        EXPECT_EQ(reader.GetFormat().sample_format, fc.format);
+        EXPECT_EQ(reader.GetFormat().sample_rate, 96000u);
+        EXPECT_EQ(ReadAll(reader, 64), samples.expected);
+    }
+}
+
+TEST(util_WavReader, d_chunksAroundTheData)
+{
+    // odd sized metadata before the format, junk before the data, and the
+    // loops and cues after it
+    const Samples samples = MakeSamples(WavReader::SampleFormat::S24, 500);
+    const std::vector<uint8_t> list(13, 'x'), junk(28, 0);
+    MemoryFile                 file = WavBuilder()
+                          .Chunk("LIST", list)
+                          .Format(WAVE_FORMAT_PCM, 1, 24)
+                          .Chunk("JUNK", junk)
+                          .Chunk("data", samples.raw)
+                          .Sampler(48, {100, 199, 300, 449})
+                          .Cues({0, 250, 400})
+                          .Finish();
+
+    WavReader reader;
+    ASSERT_EQ(Open(reader, file), WavReader::Result::OK);
+    EXPECT_EQ(reader.GetFormat().data_offset, 12u + 22 + 24 + 36 + 8);
+    EXPECT_EQ(reader.GetRootNote(), 48);
+    ASSERT_EQ(reader.GetNumLoops(), 2u);
+    EXPECT_EQ(reader.GetLoop(0)->start, 100u);
+    EXPECT_EQ(reader.GetLoop(0)->end, 200u);
+    EXPECT_EQ(reader.GetLoop(1)->start, 300u);
+    EXPECT_EQ(reader.GetLoop(1)->end, 450u);
+    EXPECT_EQ(reader.GetLoop(2), nullptr);
+    ASSERT_EQ(reader.GetNumCues(), 3u);
+    EXPECT_EQ(reader.GetCue(1), 250u);
+    EXPECT_EQ(reader.GetCue(2), 400u);
+
+    // the walk doesn't disturb the samples
+    EXPECT_EQ(ReadAll(reader, 128), samples.expected);
+}
+
+TEST(util_WavReader, e_seek)
+{
+    const Samples samples = MakeSamples(WavReader::SampleFormat::S16, 2 * 800);
+    MemoryFile    file    = WavBuilder()
+                          .Format(WAVE_FORMAT_PCM, 2, 16)
+                          .Chunk("data", samples.raw)
+                          .Finish();
+    WavReader reader;
+    ASSERT_EQ(Open(reader, file), WavReader::Result::OK);
+
+    float frame[2];
+    ASSERT_TRUE(reader.Seek(500));
+    EXPECT_EQ(reader.GetPosition(), 500u);
+    ASSERT_EQ(reader.Read(frame, 1), 1u);
+    EXPECT_EQ(frame[0], samples.expected[1000]);
+    EXPECT_EQ(frame[1], samples.expected[1001]);
+    EXPECT_EQ(reader.GetPosition(), 501u);
+
+    ASSERT_TRUE(reader.Seek(800));
+    EXPECT_TRUE(reader.IsEof());
+    EXPECT_EQ(reader.Read(frame, 1), 0u);
+    EXPECT_FALSE(reader.Seek(801));
+}
+
+TEST(util_WavReader, f_truncatedAndUnfinishedFiles)
+{
+    // the data chunk claims more than the file holds
+    Samples samples = MakeSamples(WavReader::SampleFormat::S16, 300);
+    MemoryFile file = WavBuilder()
+                          .Format(WAVE_FORMAT_PCM, 1, 16)
+                          .Chunk("data", samples.raw)
+                          .Finish();
+    file.data[40] = 0x00;
+    file.data[41] = 0x10; // 4096 bytes
+    file.data.pop_back(); // and half a frame at the end
+    WavReader reader;
+    ASSERT_EQ(Open(reader, file), WavReader::Result::OK);
+    const std::vector<float> out = ReadAll(reader, 64);
+    samples.expected.pop_back();
+    EXPECT_EQ(out, samples.expected);
+
+    // a recording that never wrote the RIFF size
+    samples = MakeSamples(WavReader::SampleFormat::F32, 100);
+    file    = WavBuilder()
+               .Format(WAVE_FORMAT_IEEE_FLOAT, 1, 32)
+               .Chunk("data", samples.raw)
+               .Finish(0xffffffff);
+    ASSERT_EQ(Open(reader, file), WavReader::Result::OK);
+    EXPECT_EQ(ReadAll(reader, 64), samples.expected);
+}
+
+TEST(util_WavReader, g_errors)
+{
+    WavReader     reader;
+    const Samples samples = MakeSamples(WavReader::SampleFormat::S16, 8);
+
+    MemoryFile empty;
+    EXPECT_EQ(Open(reader, empty), WavReader::Result::ERR_READ);
+
+    MemoryFile not_wav = WavBuilder().Chunk("data", samples.raw).Finish();
+    not_wav.data[8]    = 'A';
+    EXPECT_EQ(Open(reader, not_wav), WavReader::Result::ERR_NOT_WAV);
+
+    MemoryFile no_fmt = WavBuilder().Chunk("data", samples.raw).Finish();
+    EXPECT_EQ(Open(reader, no_fmt), WavReader::Result::ERR_NO_FORMAT);
+
+    MemoryFile no_data = WavBuilder().Format(WAVE_FORMAT_PCM, 1, 16).Finish();
+    EXPECT_EQ(Open(reader, no_data), WavReader::Result::ERR_NO_DATA);
+
+    MemoryFile alaw = WavBuilder()
+                          .Format(WAVE_FORMAT_ALAW, 1, 8)
+                          .Chunk("data", samples.raw)
+                          .Finish();
+    EXPECT_EQ(Open(reader, alaw), WavReader::Result::ERR_UNSUPPORTED_FORMAT);
+
+    MemoryFile odd_bits = WavBuilder()
+                              .Format(WAVE_FORMAT_PCM, 1, 12)
+                              .Chunk("data", samples.raw)
+                              .Finish();
+    EXPECT_EQ(Open(reader, odd_bits),
+              WavReader::Result::ERR_UNSUPPORTED_FORMAT);
+}
+
+TEST(util_WavReader, h_canonicalHeader)
+{
+    const Samples samples = MakeSamples(WavReader::SampleFormat::S24, 2 * 10);
+    MemoryFile    file    = WavBuilder()
+                          .Chunk("LIST", std::vector<uint8_t>(6, 0))
+                          .Format(WAVE_FORMAT_PCM, 2, 24)
+                          .Chunk("data", samples.raw)
+                          .Finish();
+    WavReader reader;
+    ASSERT_EQ(Open(reader, file), WavReader::Result::OK);
+
+    WAV_FormatTypeDef header;
+    reader.GetHeader(header);
+    EXPECT_EQ(header.ChunkId, kWavFileChunkId);
+    EXPECT_EQ(header.AudioFormat, WAVE_FORMAT_PCM);
+    EXPECT_EQ(header.NbrChannels, 2);
+    EXPECT_EQ(header.SampleRate, 44100u);
+    EXPECT_EQ(header.BlockAlign, 6);
+    EXPECT_EQ(header.BitPerSample, 24);
+    EXPECT_EQ(header.SubCHunk2Size, 60u);
+}
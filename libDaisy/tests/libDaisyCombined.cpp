@@ -1,7 +1,17 @@
 #include "sys/system.cpp"
 #include "ui/AbstractMenu.cpp"
 #include "ui/UI.cpp"
+#include "ui/ScopePage.cpp"
+#include "ui/SpectrumPage.cpp"
 #include "util/MappedValue.cpp"
+#include "util/RtSafetyChecker.cpp"
+#include "util/WavReader.cpp"
+#include "util/SampleCatalog.cpp"
+#include "util/WavIndex.cpp"
+#include "util/ReadAheadCache.cpp"
+#include "util/BlockCache.cpp"
+#include "util/AudioScopeTap.cpp"
+#include "util/TaskScheduler.cpp"
 #include "util/oled_fonts.c"
 #include "per/qspi.cpp"
 #include "hid/midi_parser.cpp"
@@ -6,7 +6,9 @@ using namespace daisysp;
 using namespace seed;
 
 DaisySeed hw;
+TaskScheduler scheduler;
 Oscillator osc1, osc2;
+GPIO button1, button2, buttonQuant, buttonScaleLock;
 AdcChannelConfig adcConfig[7];  // 7 controls (added key control)
 
 float volume1 = 0.f, volume2 = 0.f;
@@ -170,6 +172,38 @@ void UpdateWaveform2()
     }
 }
 
+void PollButtons(void*)
+{
+    // Handle OSC1 button (D14)
+    bool currentButtonState1 = !button1.Read();
+    if(currentButtonState1 && !lastButtonState1) {
+        UpdateWaveform1();
+    }
+    lastButtonState1 = currentButtonState1;
+    
+    // Handle OSC2 button (D13)
+    bool currentButtonState2 = !button2.Read();
+    if(currentButtonState2 && !lastButtonState2) {
+        UpdateWaveform2();
+    }
+    lastButtonState2 = currentButtonState2;
+    
+    // Handle quantization mode button (D12)
+    bool currentButtonStateQuant = !buttonQuant.Read();
+    if(currentButtonStateQuant && !lastButtonStateQuant) {
+        // Cycle through quantization modes: OFF → CHROMATIC → MAJOR → MINOR → OFF...
+        quantizeMode = static_cast<QuantMode>((static_cast<int>(quantizeMode) + 1) % 4);
+    }
+    lastButtonStateQuant = currentButtonStateQuant;
+    
+    // Handle scale lock button (D11)
+    bool currentButtonStateScaleLock = !buttonScaleLock.Read();
+    if(currentButtonStateScaleLock && !lastButtonStateScaleLock) {
+        scaleLockEnabled = !scaleLockEnabled;
+    }
+    lastButtonStateScaleLock = currentButtonStateScaleLock;
+}
+
 int main(void)
 {
     hw.Configure();
@@ -183,7 +217,6 @@ int main(void)
     osc2.SetWaveform(Oscillator::WAVE_POLYBLEP_TRI);
 
     // Initialize buttons
-    GPIO button1, button2, buttonQuant, buttonScaleLock;
     button1.Init(D14, GPIO::Mode::INPUT, GPIO::Pull::PULLUP);  // OSC1 waveform
     button2.Init(D13, GPIO::Mode::INPUT, GPIO::Pull::PULLUP);  // OSC2 waveform
     buttonQuant.Init(D12, GPIO::Mode::INPUT, GPIO::Pull::PULLUP); // Quantization mode
@@ -202,37 +235,19 @@ int main(void)
 
     hw.StartAudio(AudioCallback);
 
+    // Buttons are polled every 10 ms, which also debounces them. The
+    // deadline keeps them responsive when more main loop tasks are added.
+    TaskScheduler::TaskConfig buttons;
+    buttons.function = PollButtons;
+    buttons.name = "buttons";
+    buttons.period_us = 10000;
+    buttons.deadline_us = 2000;
+    buttons.budget_us = 50;
+    buttons.priority = 2;
+    scheduler.AddTask(buttons);
+
     while(1)
     {
-        // Handle OSC1 button (D14)
-        bool currentButtonState1 = !button1.Read();
-        if(currentButtonState1 && !lastButtonState1) {
-            UpdateWaveform1();
-        }
-        lastButtonState1 = currentButtonState1;
-        
-        // Handle OSC2 button (D13)
-        bool currentButtonState2 = !button2.Read();
-        if(currentButtonState2 && !lastButtonState2) {
-            UpdateWaveform2();
-        }
-        lastButtonState2 = currentButtonState2;
-        
-        // Handle quantization mode button (D12)
-        bool currentButtonStateQuant = !buttonQuant.Read();
-        if(currentButtonStateQuant && !lastButtonStateQuant) {
-            // Cycle through quantization modes: OFF → CHROMATIC → MAJOR → MINOR → OFF...
-            quantizeMode = static_cast<QuantMode>((static_cast<int>(quantizeMode) + 1) % 4);
-        }
-        lastButtonStateQuant = currentButtonStateQuant;
-        
-        // Handle scale lock button (D11)
-        bool currentButtonStateScaleLock = !buttonScaleLock.Read();
-        if(currentButtonStateScaleLock && !lastButtonStateScaleLock) {
-            scaleLockEnabled = !scaleLockEnabled;
-        }
-        lastButtonStateScaleLock = currentButtonStateScaleLock;
-        
-        System::Delay(10);
+        scheduler.Process();
     }
 }
\ No newline at end of file
@@ -0,0 +1,422 @@
+/** samplepack: packs a directory of WAV files into a SampleCatalog image,
+ *  to be flashed to the QSPI chip of the Daisy. See README.md.
+ */
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "util/SampleCatalog.h"
+#include "util/WavReader.h"
+#include "Sampling/samplecodec.h"
+#include "Spectral/fft.h"
+
+using daisy::SampleCatalog;
+using daisy::SampleCatalogWriter;
+using daisy::WavReader;
+using daisysp::RealFft;
+using daisysp::SampleCodec;
+
+namespace
+{
+struct Options
+{
+    SampleCodec::Format format     = SampleCodec::Format::FLOAT32;
+    size_t              table_size = 2048;
+    size_t              num_mips   = 0; // down to RealFft::kMinSize
+    const char*         dir        = nullptr;
+    const char*         output     = nullptr;
+};
+
+/** An entry with its data, before the image is laid out */
+struct Item
+{
+    SampleCatalog::Entry entry;
+    std::vector<uint8_t> data;
+};
+
+size_t ReadFile(void* context, void* dst, size_t size)
+{
+    return fread(dst, 1, size, static_cast<FILE*>(context));
+}
+
+bool SeekFile(void* context, uint32_t position)
+{
+    return fseek(static_cast<FILE*>(context), position, SEEK_SET) == 0;
+}
+
+bool HasWavExtension(const std::string& name)
+{
+    if(name.size() < 4)
+        return false;
+    std::string ext = name.substr(name.size() - 4);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".wav";
+}
+
+/** WAV files of a directory, sorted so the image is reproducible */
+std::vector<std::string> ListWavFiles(const std::string& dir)
+{
+    std::vector<std::string> names;
+    DIR*                     d = opendir(dir.c_str());
+    if(d == nullptr)
+        return names;
+    while(struct dirent* e = readdir(d))
+    {
+        if(e->d_name[0] != '.' && HasWavExtension(e->d_name))
+            names.push_back(e->d_name);
+    }
+    closedir(d);
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+/** Reads all frames of a file, interleaved */
+bool LoadWav(const std::string&  path,
+             WavReader&          reader,
+             std::vector<float>& frames)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if(file == nullptr)
+    {
+        fprintf(stderr, "%s: can't open\n", path.c_str());
+        return false;
+    }
+    WavReader::Result res = reader.Open(file, ReadFile, SeekFile);
+    if(res != WavReader::Result::OK)
+    {
+        fprintf(stderr, "%s: not a supported WAV file\n", path.c_str());
+        fclose(file);
+        return false;
+    }
+    const WavReader::Format& fmt = reader.GetFormat();
+    frames.resize(size_t(fmt.num_frames) * fmt.num_channels);
+    const size_t read = reader.Read(frames.data(), fmt.num_frames);
+    fclose(file);
+    if(read != fmt.num_frames)
+    {
+        fprintf(stderr, "%s: truncated data\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+/** Entry name of a file, without the extension */
+bool SetName(SampleCatalog::Entry& entry, const std::string& file)
+{
+    const std::string name = file.substr(0, file.size() - 4);
+    if(name.size() >= SampleCatalog::kNameLength)
+    {
+        fprintf(stderr,
+                "%s: name longer than %zu characters\n",
+                file.c_str(),
+                SampleCatalog::kNameLength - 1);
+        return false;
+    }
+    strncpy(entry.name, name.c_str(), SampleCatalog::kNameLength - 1);
+    return true;
+}
+
+bool PackSample(const std::string& dir,
+                const std::string& file,
+                const Options&     opt,
+                Item&              item)
+{
+    WavReader          reader;
+    std::vector<float> frames;
+    if(!LoadWav(dir + "/" + file, reader, frames))
+        return false;
+    const WavReader::Format& fmt = reader.GetFormat();
+    if(fmt.num_channels > 255)
+    {
+        fprintf(stderr, "%s: too many channels\n", file.c_str());
+        return false;
+    }
+
+    SampleCatalog::Entry& e = item.entry;
+    if(!SetName(e, file))
+        return false;
+    e.kind         = SampleCatalog::Kind::SAMPLE;
+    e.format       = static_cast<uint8_t>(opt.format);
+    e.num_channels = static_cast<uint8_t>(fmt.num_channels);
+    e.num_frames   = fmt.num_frames;
+    e.sample_rate  = fmt.sample_rate;
+    e.root_note    = reader.GetRootNote();
+    if(const WavReader::Loop* loop = reader.GetLoop(0))
+    {
+        e.loop_start = loop->start;
+        e.loop_end   = loop->end;
+    }
+
+    // one channel after the other
+    const size_t channel_bytes
+        = SampleCodec::GetEncodedSize(opt.format, fmt.num_frames);
+    item.data.resize(channel_bytes * fmt.num_channels);
+    std::vector<float> channel(fmt.num_frames);
+    for(size_t ch = 0; ch < fmt.num_channels; ch++)
+    {
+        for(size_t i = 0; i < fmt.num_frames; i++)
+            channel[i] = frames[i * fmt.num_channels + ch];
+        SampleCodec::Encode(opt.format,
+                            channel.data(),
+                            fmt.num_frames,
+                            &item.data[ch * channel_bytes]);
+    }
+    e.size = static_cast<uint32_t>(item.data.size());
+    return true;
+}
+
+/** Writes a table and its mips. Each mip keeps the harmonics below its
+ *  own Nyquist frequency: the spectrum of the table is cut, transformed
+ *  back at the full size, and decimated, which is exact once cut.
+ */
+void MakeMips(const float* table, size_t size, size_t num_mips, float* out)
+{
+    RealFft fft;
+    fft.Init(size);
+    std::vector<float> in(table, table + size), spectrum(size), cut(size);
+    std::vector<float> full(size);
+    fft.Forward(in.data(), spectrum.data());
+
+    for(size_t mip = 0; mip < num_mips; mip++)
+    {
+        const size_t length = size >> mip;
+        cut                 = spectrum;
+        // bins from length / 2 up are above the Nyquist of the mip,
+        // spectrum[1] is the Nyquist bin of the full table
+        if(mip > 0)
+        {
+            cut[1] = 0.0f;
+            for(size_t k = length / 2; k < size / 2; k++)
+                cut[2 * k] = cut[2 * k + 1] = 0.0f;
+        }
+        fft.Inverse(cut.data(), full.data());
+        for(size_t i = 0; i < length; i++)
+            out[i] = full[i << mip];
+        out += length;
+    }
+}
+
+bool PackWaveTable(const std::string& dir,
+                   const std::string& file,
+                   const Options&     opt,
+                   Item&              item)
+{
+    WavReader          reader;
+    std::vector<float> frames;
+    if(!LoadWav(dir + "/" + file, reader, frames))
+        return false;
+    const WavReader::Format& fmt = reader.GetFormat();
+    if(fmt.num_frames == 0 || fmt.num_frames % opt.table_size != 0)
+    {
+        fprintf(stderr,
+                "%s: length isn't a multiple of %zu samples\n",
+                file.c_str(),
+                opt.table_size);
+        return false;
+    }
+
+    SampleCatalog::Entry& e = item.entry;
+    if(!SetName(e, file))
+        return false;
+    size_t num_mips = opt.num_mips;
+    if(num_mips == 0)
+        while((opt.table_size >> num_mips) >= RealFft::kMinSize)
+            num_mips++;
+    size_t floats = 0;
+    for(size_t mip = 0; mip < num_mips; mip++)
+        floats += opt.table_size >> mip;
+
+    e.kind         = SampleCatalog::Kind::WAVETABLE;
+    e.format       = SampleCatalog::kFormatFloat;
+    e.num_channels = 1;
+    e.num_frames   = fmt.num_frames;
+    e.sample_rate  = fmt.sample_rate;
+    e.root_note    = reader.GetRootNote();
+    e.table_size   = static_cast<uint16_t>(opt.table_size);
+    e.num_tables   = static_cast<uint16_t>(fmt.num_frames / opt.table_size);
+    e.num_mips     = static_cast<uint8_t>(num_mips);
+
+    // mixed down to mono
+    std::vector<float> mono(fmt.num_frames);
+    for(size_t i = 0; i < fmt.num_frames; i++)
+    {
+        float sum = 0.0f;
+        for(size_t ch = 0; ch < fmt.num_channels; ch++)
+            sum += frames[i * fmt.num_channels + ch];
+        mono[i] = sum / fmt.num_channels;
+    }
+
+    item.data.resize(e.num_tables * floats * sizeof(float));
+    float* out = reinterpret_cast<float*>(item.data.data());
+    for(size_t t = 0; t < e.num_tables; t++)
+        MakeMips(&mono[t * opt.table_size],
+                 opt.table_size,
+                 num_mips,
+                 out + t * floats);
+    e.size = static_cast<uint32_t>(item.data.size());
+    return true;
+}
+
+bool ParseFormat(const char* name, SampleCodec::Format& format)
+{
+    static const struct
+    {
+        const char*         name;
+        SampleCodec::Format format;
+    } formats[] = {{"float32", SampleCodec::Format::FLOAT32},
+                   {"bfp12", SampleCodec::Format::BFP12},
+                   {"bfp8", SampleCodec::Format::BFP8},
+                   {"adpcm4", SampleCodec::Format::ADPCM4}};
+    for(const auto& f : formats)
+    {
+        if(strcmp(name, f.name) == 0)
+        {
+            format = f.format;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IsPowerOfTwo(size_t x)
+{
+    return x != 0 && (x & (x - 1)) == 0;
+}
+
+void Usage()
+{
+    fprintf(stderr,
+            "usage: samplepack [-f float32|bfp12|bfp8|adpcm4] "
+            "[-t table_size] [-m mips] <dir> <image.bin>\n"
+            "  -f  format of the samples, default float32\n"
+            "  -t  samples per table of the files in <dir>/wavetables, "
+            "default 2048\n"
+            "  -m  mip levels of the wavetables, default down to %zu "
+            "samples\n",
+            RealFft::kMinSize);
+}
+
+bool ParseArgs(int argc, char** argv, Options& opt)
+{
+    int i = 1;
+    for(; i + 1 < argc && argv[i][0] == '-'; i += 2)
+    {
+        const char* value = argv[i + 1];
+        if(strcmp(argv[i], "-f") == 0)
+        {
+            if(!ParseFormat(value, opt.format))
+                return false;
+        }
+        else if(strcmp(argv[i], "-t") == 0)
+            opt.table_size = strtoul(value, nullptr, 0);
+        else if(strcmp(argv[i], "-m") == 0)
+            opt.num_mips = strtoul(value, nullptr, 0);
+        else
+            return false;
+    }
+    if(argc - i != 2)
+        return false;
+    opt.dir    = argv[i];
+    opt.output = argv[i + 1];
+
+    // RealFft builds the mips
+    if(!IsPowerOfTwo(opt.table_size) || opt.table_size < RealFft::kMinSize
+       || opt.table_size > RealFft::kMaxSize)
+    {
+        fprintf(stderr,
+                "table size must be a power of two from %zu to %zu\n",
+                RealFft::kMinSize,
+                RealFft::kMaxSize);
+        return false;
+    }
+    if(opt.num_mips > 16 || (opt.table_size >> opt.num_mips) == 0)
+    {
+        fprintf(stderr, "too many mip levels for the table size\n");
+        return false;
+    }
+    return true;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if(!ParseArgs(argc, argv, opt))
+    {
+        Usage();
+        return 1;
+    }
+
+    std::vector<Item> items;
+    const std::string dir = opt.dir, tables_dir = dir + "/wavetables";
+    for(const std::string& file : ListWavFiles(dir))
+    {
+        items.push_back(Item());
+        if(!PackSample(dir, file, opt, items.back()))
+            return 1;
+    }
+    for(const std::string& file : ListWavFiles(tables_dir))
+    {
+        items.push_back(Item());
+        if(!PackWaveTable(tables_dir, file, opt, items.back()))
+            return 1;
+    }
+    if(items.empty() || items.size() > 0xffff)
+    {
+        fprintf(stderr, "%s: no WAV files, or too many\n", opt.dir);
+        return 1;
+    }
+
+    std::vector<size_t> sizes;
+    for(const Item& item : items)
+        sizes.push_back(item.data.size());
+    std::vector<uint8_t> image(
+        SampleCatalogWriter::GetImageSize(items.size(), sizes.data()));
+
+    SampleCatalogWriter writer;
+    writer.Init(image.data(), image.size(), items.size());
+    for(const Item& item : items)
+    {
+        uint8_t* data = writer.Add(item.entry);
+        memcpy(data, item.data.data(), item.data.size());
+    }
+    const size_t size = writer.Finish();
+    if(size == 0)
+    {
+        fprintf(stderr, "two files have the same name\n");
+        return 1;
+    }
+
+    // the image is read back as the firmware would
+    SampleCatalog catalog;
+    if(catalog.Init(image.data(), size) != SampleCatalog::Result::OK)
+    {
+        fprintf(stderr, "internal error, the image doesn't load\n");
+        return 1;
+    }
+
+    FILE* out = fopen(opt.output, "wb");
+    if(out == nullptr || fwrite(image.data(), 1, size, out) != size)
+    {
+        fprintf(stderr, "%s: can't write\n", opt.output);
+        return 1;
+    }
+    fclose(out);
+
+    for(size_t i = 0; i < catalog.GetNumEntries(); i++)
+    {
+        const SampleCatalog::Entry* e = catalog.GetEntry(i);
+        printf("%-31s %-9s %8u frames %3u ch %9u bytes\n",
+               e->name,
+               e->kind == SampleCatalog::Kind::WAVETABLE ? "wavetable"
+                                                         : "sample",
+               e->num_frames,
+               e->num_channels,
+               e->size);
+    }
+    printf("%zu entries, %zu bytes\n", catalog.GetNumEntries(), size);
+    return 0;
+}